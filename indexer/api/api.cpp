@@ -3,10 +3,98 @@
 #include "jetplusplus/json/jsonConverter.hpp"
 #include "jetplusplus/json/value.hpp"
 #include "indexer/indexer.hpp"
+#include "indexer/impactRefresher.hpp"
+#include "impact/impact.hpp"
+#include "metrics/metrics.hpp"
+#include "db/indexdb.hpp"
+#include "dedup/duplicateDetector.hpp"
+#include "delta/deltaIndex.hpp"
+#include "delta/deltaPersister.hpp"
+#include "delta/writeAheadLog.hpp"
+#include "http/httpResponse.hpp"
+#include "http/queryString.hpp"
 #include <mongocxx/instance.hpp>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <memory>
+#include <functional>
+#include <stdexcept>
+
+/**
+ * @brief Wraps a route handler with request count and latency metrics.
+ * 
+ * @param route The route label, e.g. "/index".
+ * @param handler The route handler.
+ * @return The instrumented handler.
+ */
+static std::function<void(jetpp::Request&, jetpp::Response&)> instrumented(const std::string& route, std::function<void(jetpp::Request&, jetpp::Response&)> handler) {
+    metrics::Registry& registry = metrics::Registry::instance();
+    std::string labels = "route=\"" + route + "\"";
+    metrics::Counter& requests = registry.counter("http_requests_total", "HTTP requests received", labels);
+    metrics::Histogram& latency = registry.histogram("http_request_duration_seconds", "HTTP request latency", labels);
+
+    return [&requests, &latency, handler](jetpp::Request& req, jetpp::Response& res) {
+        requests.add();
+        metrics::ScopedTimer timer(latency);
+        handler(req, res);
+    };
+}
+
+/**
+ * @brief Serializes a delta lookup for the searchers.
+ * 
+ * @param terms The looked up terms.
+ * @param lookup The postings of every term and the (changes to the) shadowed documents.
+ * @return std::string {"sequence", "epoch", "shadowVersion", "full", "shadowed": [url], "unshadowed": [url], "terms": [{"term", "postings": [{"url", "tf", "docLength"}]}]}.
+ */
+static std::string deltaToJson(const std::vector<std::string>& terms, const delta::DeltaLookup& lookup) {
+    auto urlArray = [](const std::vector<std::string>& urls) {
+        std::vector<jetpp::JsonValue> values;
+        values.reserve(urls.size());
+        for (const std::string& url : urls) {
+            jetpp::JsonValue value;
+            value.setString(url);
+            values.push_back(value);
+        }
+        jetpp::JsonValue array;
+        array.setArray(values);
+        return array;
+    };
+
+    std::vector<jetpp::JsonValue> termValues;
+    for (std::size_t t = 0; t < terms.size(); t++) {
+        std::vector<jetpp::JsonValue> postings;
+        for (const delta::DeltaPosting& posting : lookup.terms[t]) {
+            jetpp::JsonValue url;
+            url.setString(posting.url);
+            jetpp::JsonValue value;
+            value.setObject({{"url", url}, {"tf", jetpp::JsonValue(static_cast<double>(posting.tf))}, {"docLength", jetpp::JsonValue(static_cast<double>(posting.docLength))}});
+            postings.push_back(value);
+        }
+        jetpp::JsonValue term;
+        term.setString(terms[t]);
+        jetpp::JsonValue postingArray;
+        postingArray.setArray(postings);
+        jetpp::JsonValue value;
+        value.setObject({{"term", term}, {"postings", postingArray}});
+        termValues.push_back(value);
+    }
+
+    jetpp::JsonValue termArray;
+    termArray.setArray(termValues);
+    jetpp::JsonValue json;
+    json.setObject({
+        {"sequence", jetpp::JsonValue(static_cast<double>(lookup.sequence))},
+        {"epoch", jetpp::JsonValue(static_cast<double>(lookup.epoch))},
+        {"shadowVersion", jetpp::JsonValue(static_cast<double>(lookup.shadowVersion))},
+        {"full", jetpp::JsonValue(lookup.full)},
+        {"shadowed", urlArray(lookup.shadowed)},
+        {"unshadowed", urlArray(lookup.unshadowed)},
+        {"terms", termArray}
+    });
+    return json.toJsonString();
+}
 
 /**
  * @brief Main function to run the indexing server.
@@ -14,22 +102,157 @@
  * This function sets up a router to handle HTTP POST requests for indexing documents.
  * It initializes the MongoDB instance, sets up the endpoint, and starts the server.
  * 
+ * --shards N partitions the index by URL hash into N shards, each served by its own search
+ * process. --export-snapshot FILE [--shard I] writes a snapshot of one shard for the searchers
+ * to load at startup and exits instead of serving.
+ * 
+ * --dedup off|skip|alias sets what happens to documents whose SimHash is within
+ * --dedup-distance D bits (default 3) of an indexed document; the default, alias, records
+ * them with their canonical document instead of indexing their terms.
+ * 
+ * With --delta on (the default), indexed and deleted documents go to an in-memory delta
+ * index that the searchers query through /delta/postings, and are written to MongoDB in the
+ * background; --delta off writes them before answering.
+ * 
+ * --wal DIR logs every delta version to segment files in DIR before answering, so acknowledged
+ * documents survive a crash; they are replayed into the delta at startup. Concurrent requests
+ * share one fdatasync; --wal-group-delay-us U waits up to U microseconds for more of them.
+ * 
+ * @param argc The number of arguments.
+ * @param argv The arguments.
  * @return int Returns 0 on successful execution, 1 on failure.
  */
-int main() {
+int main(int argc, char** argv) {
+
+    std::string snapshotPath;
+    std::size_t snapshotShard = 0;
+    dedup::DuplicateAction duplicateAction = dedup::DuplicateAction::Alias;
+    unsigned duplicateDistance = 3;
+    bool useDelta = true;
+    std::string walDirectory;
+    long walGroupDelay = 0;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + option);
+            }
+            std::string value = argv[++i];
+            if (option == "--shards") {
+                indexer_db::IndexerDB::useShards(static_cast<std::size_t>(std::stoul(value)));
+            } else if (option == "--export-snapshot") {
+                snapshotPath = value;
+            } else if (option == "--shard") {
+                snapshotShard = static_cast<std::size_t>(std::stoul(value));
+            } else if (option == "--dedup") {
+                duplicateAction = dedup::parseAction(value);
+            } else if (option == "--dedup-distance") {
+                duplicateDistance = static_cast<unsigned>(std::stoul(value));
+                if (duplicateDistance < 1 || duplicateDistance > dedup::MAX_DISTANCE) {
+                    throw std::invalid_argument("--dedup-distance must be between 1 and " + std::to_string(dedup::MAX_DISTANCE));
+                }
+            } else if (option == "--delta") {
+                if (value != "on" && value != "off") {
+                    throw std::invalid_argument("--delta must be on or off");
+                }
+                useDelta = value == "on";
+            } else if (option == "--wal") {
+                walDirectory = value;
+            } else if (option == "--wal-group-delay-us") {
+                walGroupDelay = std::stol(value);
+                if (walGroupDelay < 0) {
+                    throw std::invalid_argument("--wal-group-delay-us must not be negative");
+                }
+            } else {
+                throw std::invalid_argument("unknown option " + option);
+            }
+        }
+        if (snapshotShard >= indexer_db::IndexerDB::shardCount()) {
+            throw std::invalid_argument("--shard must be below --shards");
+        }
+        if (!walDirectory.empty() && !useDelta) {
+            throw std::invalid_argument("--wal needs --delta on");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid arguments: " << e.what() << '\n'
+                  << "Usage: Indexer [--shards N] [--export-snapshot FILE [--shard I]] [--dedup off|skip|alias] [--dedup-distance D] [--delta on|off] [--wal DIR [--wal-group-delay-us U]]" << std::endl;
+        return 1;
+    }
 
     jetpp::Router router;
 
     // Call mongocxx instance once to initialize MongoDB driver
     mongocxx::instance instance{};
 
+    if (!snapshotPath.empty()) {
+        try {
+            indexer_db::IndexerDB db;
+            snapshot::SnapshotHeader header = db.exportSnapshot(snapshotPath, snapshotShard);
+            std::cout << "Exported shard " << header.shard << " of " << header.shards << " to " << snapshotPath << ": "
+                      << header.termCount << " terms, " << header.documentCount << " documents, "
+                      << header.postingCount << " postings, " << header.fileSize << " bytes" << std::endl;
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error exporting snapshot: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Canonical documents of earlier runs, so their duplicates are recognized after a restart
+    dedup::DuplicateDetector duplicates(duplicateDistance);
+    if (duplicateAction != dedup::DuplicateAction::Off) {
+        indexer_db::IndexerDB db;
+        for (const indexer_db::Fingerprint& fingerprint : db.getCanonicalFingerprints()) {
+            duplicates.add(fingerprint.url, fingerprint.simHash);
+        }
+        std::cout << "Loaded " << duplicates.stats().documents << " document fingerprints" << std::endl;
+    }
+
+    // Documents indexed since their last write to MongoDB; the persister drains them in the background
+    delta::DeltaIndex deltaIndex(indexer_db::IndexerDB::shardCount());
+
+    // Versions acknowledged but not yet written to MongoDB are replayed into the delta before the persister starts
+    std::unique_ptr<delta::WriteAheadLog> writeAheadLog;
+    if (!walDirectory.empty()) {
+        try {
+            writeAheadLog = std::make_unique<delta::WriteAheadLog>(walDirectory, deltaIndex, std::chrono::microseconds(walGroupDelay));
+            std::cout << "Recovered " << writeAheadLog->stats().recovered << " documents from the write-ahead log" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error opening the write-ahead log: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    indexer::Indexer persistIndexer;
+    std::unique_ptr<delta::DeltaPersister> deltaPersister;
+    if (useDelta) {
+        deltaPersister = std::make_unique<delta::DeltaPersister>(deltaIndex, [&](const delta::PendingDocument& document) { persistIndexer.persistDocument(document); });
+    }
+    delta::DeltaIndex* delta = useDelta ? &deltaIndex : nullptr;
+    delta::WriteAheadLog* wal = writeAheadLog.get();
+
+    // Recompute the stored impacts once the corpus has grown or shrunk by more than 10%, checked every 100 documents
+    indexer::ImpactRefresher impactRefresher(100, impact::STATS_DRIFT);
+
     /**
      * @brief Endpoint to handle document indexing requests.
      * 
      * This endpoint receives a document in JSON format via a POST request,
      * extracts the URL and content, initializes the indexer, and indexes the document.
      */
-    router.post("/index", [&](jetpp::Request& req, jetpp::Response& res) {
+    metrics::Registry& registry = metrics::Registry::instance();
+    metrics::Counter& indexErrors = registry.counter("http_request_errors_total", "HTTP requests answered with 500", "route=\"/index\"");
+    registry.counter("index_impact_refreshes_total", "Completed impact refreshes", "", [&]() { return static_cast<double>(impactRefresher.completed()); });
+    registry.gauge("index_fingerprints", "Canonical documents held by the duplicate detector", "", [&]() { return static_cast<double>(duplicates.stats().documents); });
+    registry.gauge("index_delta_documents", "Documents held by the delta index", "", [&]() { return static_cast<double>(deltaIndex.stats().documents); });
+    registry.gauge("index_delta_pending", "Delta versions waiting to be written to MongoDB", "", [&]() { return static_cast<double>(deltaIndex.stats().pending); });
+    registry.counter("index_delta_persisted_total", "Delta versions written to MongoDB and drained", "", [&]() { return static_cast<double>(deltaIndex.stats().persisted); });
+    registry.counter("index_delta_persist_errors_total", "Delta writes that failed and were retried", "", [&]() { return deltaPersister ? static_cast<double>(deltaPersister->failures()) : 0.0; });
+    registry.counter("index_wal_appends_total", "Delta versions appended to the write-ahead log", "", [&]() { return wal ? static_cast<double>(wal->stats().appends) : 0.0; });
+    registry.counter("index_wal_syncs_total", "Group commits of the write-ahead log, one fdatasync each", "", [&]() { return wal ? static_cast<double>(wal->stats().syncs) : 0.0; });
+    registry.gauge("index_wal_bytes", "Bytes in the write-ahead log segments", "", [&]() { return wal ? static_cast<double>(wal->stats().bytes) : 0.0; });
+    registry.gauge("index_wal_segments", "Write-ahead log segment files", "", [&]() { return wal ? static_cast<double>(wal->stats().segments) : 0.0; });
+
+    router.post("/index", instrumented("/index", [&](jetpp::Request& req, jetpp::Response& res) {
         try {
             // Get the document from the request body
             std::string document = req.body;
@@ -45,22 +268,101 @@ int main() {
             // Initialize MongoDB indexer
             std::shared_ptr<indexer::Indexer> indexPtr;
             try {
-                indexPtr = std::make_shared<indexer::Indexer>();
+                indexPtr = std::make_shared<indexer::Indexer>(&duplicates, duplicateAction, delta, wal);
             } catch (const std::exception& e) {
                 std::cerr << "Error initializing indexer: " << e.what() << std::endl;
             }
 
             // Create an indexing document
             indexer::Document indexingDocument{url, content};
-            // Index the document
-            indexPtr->indexDocument(&indexingDocument);
+            // Index the document, unless it nearly duplicates an indexed one
+            if (!indexPtr->indexDocument(&indexingDocument)) {
+                res.status(200).send("Near-duplicate, not indexed");
+                return;
+            }
+            impactRefresher.documentIndexed();
 
             // Send success response
             res.status(200).send("Processing successful");
         } catch (const std::exception& e) {
             std::cerr << "Error processing indexing request: " << e.what() << std::endl;
-            res.status(500).send("Internal Server Error");
+            indexErrors.add();
+            http::send(res, 500, "Internal Server Error");
         }
+    }));
+
+    /**
+     * @brief Endpoint to delete a document; the JSON body holds its "url".
+     */
+    router.post("/index/delete", instrumented("/index/delete", [&](jetpp::Request& req, jetpp::Response& res) {
+        try {
+            jetpp::JsonConverter jsonConverter;
+            jetpp::JsonValue doc = jsonConverter.stringToJson(req.body);
+            std::string url = doc.asObject["url"].asString;
+            if (url.empty()) {
+                http::send(res, 400, "Missing url");
+                return;
+            }
+
+            indexer::Indexer indexer(&duplicates, duplicateAction, delta, wal);
+            indexer.removeDocument(url);
+            res.status(200).send("Deleted");
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing delete request: " << e.what() << std::endl;
+            http::send(res, 500, "Internal Server Error");
+        }
+    }));
+
+    /**
+     * @brief Endpoint for the searchers: the delta postings of the '+'-separated, percent-encoded terms in q and
+     * the documents of the shard whose persisted postings are outdated. With epoch and since,
+     * the shadow version a searcher holds, only the documents that entered or left the delta
+     * since are listed.
+     */
+    router.post("/delta/postings", instrumented("/delta/postings", [&](jetpp::Request& req, jetpp::Response& res) {
+        try {
+            std::vector<std::string> terms;
+            std::istringstream query(http::decodeTerms(req.query["q"]));
+            std::string term;
+            while (std::getline(query, term, '+')) {
+                if (!term.empty()) terms.push_back(term);
+            }
+            std::size_t shard = req.query["shard"].empty() ? 0 : static_cast<std::size_t>(std::stoul(req.query["shard"]));
+            if (shard >= indexer_db::IndexerDB::shardCount()) {
+                http::send(res, 400, "Invalid shard");
+                return;
+            }
+
+            // A searcher holding the shadowed documents of an earlier version only gets the changes since
+            std::uint64_t epoch = req.query["epoch"].empty() ? 0 : std::stoull(req.query["epoch"]);
+            std::uint64_t since = req.query["since"].empty() ? 0 : std::stoull(req.query["since"]);
+
+            std::string body = deltaToJson(terms, deltaIndex.lookup(terms, shard, epoch, since));
+            res.addHeader("Content-Type", "application/json");
+            res.status(200).send(body);
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing delta request: " << e.what() << std::endl;
+            http::send(res, 400, "Bad Request");
+        }
+    }));
+
+    /**
+     * @brief Endpoint to recompute the corpus statistics and all impacts in the background.
+     */
+    router.post("/impacts/refresh", instrumented("/impacts/refresh", [&](jetpp::Request& req, jetpp::Response& res) {
+        if (impactRefresher.refresh(true)) {
+            http::send(res, 202, "Refresh started");
+        } else {
+            http::send(res, 409, "Refresh already running");
+        }
+    }));
+
+    /**
+     * @brief Endpoint exposing all metrics in the Prometheus text format.
+     */
+    router.get("/metrics", [&](jetpp::Request& req, jetpp::Response& res) {
+        res.addHeader("Content-Type", "text/plain; version=0.0.4");
+        res.send(registry.render());
     });
 
     // Start Jet++ server on port 7001
@@ -0,0 +1,563 @@
+#include "bulk/bulkBuilder.hpp"
+#include "bulk/corpusDump.hpp"
+#include "db/indexdb.hpp"
+#include "indexer/indexer.hpp"
+#include "shard/shard.hpp"
+#include "snapshot/snapshotWriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unistd.h>
+
+namespace bulk {
+
+    namespace {
+
+        // Estimated bytes of a term's hash node and empty posting vector, on top of the term itself
+        const std::size_t TERM_OVERHEAD = 96;
+
+        // Buffer of every run file stream
+        const std::size_t RUN_BUFFER = std::size_t(1) << 20;
+
+        // Shard of a document that was superseded by a later line with the same URL
+        const std::uint32_t SUPERSEDED = 0xffffffffu;
+
+        /**
+         * @struct RunPosting
+         * @brief A posting in a partial index or run file; the document is (worker << 32) | local id.
+         */
+        struct RunPosting {
+            std::uint64_t document;
+            float tf;
+            std::int32_t docLength;
+        };
+
+        using PartialIndex = std::unordered_map<std::string, std::vector<RunPosting>>;
+
+        /**
+         * @struct Worker
+         * @brief State of one tokenizer thread.
+         */
+        struct Worker {
+            PartialIndex index;                     // Terms of the documents since the last spill
+            std::size_t bytes = 0;                  // Estimated size of index
+            std::vector<std::string> urls;          // URL by local document id
+            std::vector<std::int32_t> lengths;      // Document length by local document id
+            std::vector<std::uint32_t> shards;      // Shard by local document id, SUPERSEDED if replaced
+            std::vector<std::string> runs;          // Run files spilled by this worker, in order
+            std::uint64_t invalid = 0;              // Lines that are not documents
+        };
+
+        std::uint64_t documentId(std::size_t worker, std::size_t local) {
+            return (static_cast<std::uint64_t>(worker) << 32) | static_cast<std::uint64_t>(local);
+        }
+
+        std::FILE* openRun(const std::string& path, const char* mode) {
+            std::FILE* file = std::fopen(path.c_str(), mode);
+            if (!file) {
+                throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+            }
+            std::setvbuf(file, nullptr, _IOFBF, RUN_BUFFER);
+            return file;
+        }
+
+        /**
+         * @brief Writes a partial index to a run file sorted by term and clears it.
+         *
+         * A run is a sequence of terms: uint32 length, the term bytes, uint32 posting count
+         * and the RunPostings of the term.
+         */
+        void spill(PartialIndex& index, const std::string& path) {
+            std::vector<PartialIndex::value_type*> terms;
+            terms.reserve(index.size());
+            for (auto& entry : index) {
+                terms.push_back(&entry);
+            }
+            std::sort(terms.begin(), terms.end(), [](const PartialIndex::value_type* a, const PartialIndex::value_type* b) { return a->first < b->first; });
+
+            std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(openRun(path, "wb"), std::fclose);
+            for (const PartialIndex::value_type* term : terms) {
+                std::uint32_t length = static_cast<std::uint32_t>(term->first.size());
+                std::uint32_t count = static_cast<std::uint32_t>(term->second.size());
+                if (std::fwrite(&length, sizeof(length), 1, file.get()) != 1 ||
+                    std::fwrite(term->first.data(), 1, length, file.get()) != length ||
+                    std::fwrite(&count, sizeof(count), 1, file.get()) != 1 ||
+                    std::fwrite(term->second.data(), sizeof(RunPosting), count, file.get()) != count) {
+                    throw std::runtime_error("cannot write " + path + ": " + std::strerror(errno));
+                }
+            }
+            if (std::fclose(file.release()) != 0) {
+                throw std::runtime_error("cannot write " + path + ": " + std::strerror(errno));
+            }
+            index.clear();
+        }
+
+        /**
+         * @class RunSource
+         * @brief Terms of a run in ascending order, each with its postings.
+         */
+        class RunSource {
+        public:
+            virtual ~RunSource() = default;
+
+            // Advances to the next term; false at the end
+            virtual bool next() = 0;
+
+            const std::string& term() const { return this->current; }
+            const std::vector<RunPosting>& postings() const { return this->currentPostings; }
+
+        protected:
+            std::string current;
+            std::vector<RunPosting> currentPostings;
+        };
+
+        /**
+         * @class FileRun
+         * @brief A run spilled to disk, read sequentially.
+         */
+        class FileRun : public RunSource {
+        public:
+            explicit FileRun(const std::string& path) : path(path), file(openRun(path, "rb"), std::fclose) {}
+
+            bool next() override {
+                std::uint32_t length;
+                if (std::fread(&length, sizeof(length), 1, this->file.get()) != 1) {
+                    if (std::ferror(this->file.get())) {
+                        throw std::runtime_error("cannot read " + this->path);
+                    }
+                    return false;
+                }
+                std::uint32_t count;
+                this->current.resize(length);
+                if (std::fread(&this->current[0], 1, length, this->file.get()) != length ||
+                    std::fread(&count, sizeof(count), 1, this->file.get()) != 1) {
+                    throw std::runtime_error("truncated run " + this->path);
+                }
+                this->currentPostings.resize(count);
+                if (std::fread(this->currentPostings.data(), sizeof(RunPosting), count, this->file.get()) != count) {
+                    throw std::runtime_error("truncated run " + this->path);
+                }
+                return true;
+            }
+
+        private:
+            std::string path;
+            std::unique_ptr<std::FILE, int (*)(std::FILE*)> file;
+        };
+
+        /**
+         * @class MemoryRun
+         * @brief The partial index a worker holds at the end, sorted in place of being spilled.
+         */
+        class MemoryRun : public RunSource {
+        public:
+            explicit MemoryRun(PartialIndex& index) {
+                this->terms.reserve(index.size());
+                for (auto& entry : index) {
+                    this->terms.push_back(&entry);
+                }
+                std::sort(this->terms.begin(), this->terms.end(), [](const PartialIndex::value_type* a, const PartialIndex::value_type* b) { return a->first < b->first; });
+            }
+
+            bool next() override {
+                if (this->position >= this->terms.size()) {
+                    return false;
+                }
+                PartialIndex::value_type* entry = this->terms[this->position++];
+                this->current = entry->first;
+                this->currentPostings.swap(entry->second);
+                std::vector<RunPosting>().swap(entry->second);
+                return true;
+            }
+
+        private:
+            std::vector<PartialIndex::value_type*> terms;
+            std::size_t position = 0;
+        };
+
+        /**
+         * @struct LoadBatch
+         * @brief Terms of one shard written to MongoDB together.
+         */
+        struct LoadBatch {
+            std::size_t shard = 0;
+            std::vector<indexer_db::TermPostings> terms;
+        };
+
+        /**
+         * @class LoadQueue
+         * @brief Bounded queue between the merge and the loader threads.
+         */
+        class LoadQueue {
+        public:
+            explicit LoadQueue(std::size_t capacity) : capacity(std::max<std::size_t>(1, capacity)) {}
+
+            // Waits for room; throws the error of a failed loader
+            void push(LoadBatch batch) {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->changed.wait(lock, [this]() { return this->error || this->batches.size() < this->capacity; });
+                if (this->error) {
+                    std::rethrow_exception(this->error);
+                }
+                this->batches.push_back(std::move(batch));
+                this->changed.notify_all();
+            }
+
+            // Waits for a batch; false once closed and drained or after a failure
+            bool pop(LoadBatch& batch) {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->changed.wait(lock, [this]() { return this->error || this->closed || !this->batches.empty(); });
+                if (this->error || this->batches.empty()) {
+                    return false;
+                }
+                batch = std::move(this->batches.front());
+                this->batches.pop_front();
+                this->changed.notify_all();
+                return true;
+            }
+
+            void close() {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->closed = true;
+                this->changed.notify_all();
+            }
+
+            void fail(std::exception_ptr failure) {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (!this->error) {
+                    this->error = failure;
+                }
+                this->changed.notify_all();
+            }
+
+            std::exception_ptr failure() {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->error;
+            }
+
+        private:
+            std::size_t capacity;
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::deque<LoadBatch> batches;
+            bool closed = false;
+            std::exception_ptr error;
+        };
+
+        /**
+         * @class Loaders
+         * @brief Threads writing batches to MongoDB, each with its own client; joined on destruction.
+         */
+        class Loaders {
+        public:
+            Loaders(std::size_t count, const impact::CorpusStats& stats, std::int64_t updatedMs) : queue(count * 2) {
+                for (std::size_t i = 0; i < count; i++) {
+                    this->threads.emplace_back([this, stats, updatedMs]() {
+                        try {
+                            indexer_db::IndexerDB db;
+                            LoadBatch batch;
+                            while (this->queue.pop(batch)) {
+                                db.loadTerms(batch.terms, batch.shard, stats, updatedMs);
+                            }
+                        } catch (...) {
+                            this->queue.fail(std::current_exception());
+                        }
+                    });
+                }
+            }
+
+            ~Loaders() {
+                this->queue.close();
+                for (std::thread& thread : this->threads) {
+                    thread.join();
+                }
+            }
+
+            void push(LoadBatch batch) {
+                this->queue.push(std::move(batch));
+            }
+
+            // Waits until every batch is written and throws the first loader error
+            void finish() {
+                this->queue.close();
+                for (std::thread& thread : this->threads) {
+                    thread.join();
+                }
+                this->threads.clear();
+                if (std::exception_ptr failure = this->queue.failure()) {
+                    std::rethrow_exception(failure);
+                }
+            }
+
+        private:
+            LoadQueue queue;
+            std::vector<std::thread> threads;
+        };
+
+        double secondsSince(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    /**
+     * @brief Constructor for the BulkBuilder class.
+     *
+     * @param options The options.
+     */
+    BulkBuilder::BulkBuilder(BulkOptions options) : options(std::move(options)) {
+        this->options.shards = std::max<std::size_t>(1, this->options.shards);
+        this->options.threads = std::max<std::size_t>(1, this->options.threads);
+        this->options.loaders = std::max<std::size_t>(1, this->options.loaders);
+    }
+
+    /**
+     * @brief Destructor; removes the run files.
+     */
+    BulkBuilder::~BulkBuilder() {
+        for (const std::string& path : this->runFiles) {
+            std::remove(path.c_str());
+        }
+    }
+
+    /**
+     * @brief Returns the path of the snapshot of a shard.
+     *
+     * @param directory The snapshot directory.
+     * @param shard The shard.
+     * @param shards The number of shards.
+     * @return std::string directory/index-<shard>-of-<shards>.snapshot.
+     */
+    std::string BulkBuilder::snapshotPath(const std::string& directory, std::size_t shard, std::size_t shards) {
+        return directory + "/index-" + std::to_string(shard) + "-of-" + std::to_string(shards) + ".snapshot";
+    }
+
+    /**
+     * @brief Runs the build.
+     *
+     * The term documents are stamped with the start of the build and the snapshots are
+     * created one millisecond later, so searchers serve every loaded term from the snapshot;
+     * terms the indexer writes afterwards are stamped later and re-read from the database.
+     * The indexer should not run during the build, since the load replaces whole terms.
+     *
+     * @return BulkStats The outcome.
+     * @throws std::runtime_error On read, write or database errors.
+     */
+    BulkStats BulkBuilder::run() {
+        BulkStats result;
+        std::int64_t startedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string runPrefix = this->options.tempDirectory + "/bulk-" + std::to_string(getpid()) + "-";
+
+        // Tokenize phase: every thread builds a partial index of its range of lines
+        auto phaseStart = std::chrono::steady_clock::now();
+        CorpusDump dump(this->options.input);
+        std::vector<std::pair<std::size_t, std::size_t>> ranges = dump.split(this->options.threads);
+        std::vector<Worker> workers(ranges.size());
+        std::vector<std::exception_ptr> errors(ranges.size());
+        std::size_t budget = std::max<std::size_t>(this->options.memoryBytes / workers.size(), std::size_t(1) << 20);
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < workers.size(); w++) {
+            threads.emplace_back([&, w]() {
+                try {
+                    Worker& worker = workers[w];
+                    std::string_view text = dump.data().substr(ranges[w].first, ranges[w].second - ranges[w].first);
+                    std::string url;
+                    std::string content;
+                    std::unordered_map<std::string, int> counts;
+                    std::size_t begin = 0;
+                    while (begin < text.size()) {
+                        std::size_t end = std::min(text.find('\n', begin), text.size());
+                        std::string_view line = text.substr(begin, end - begin);
+                        begin = end + 1;
+                        if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+                            continue;
+                        }
+                        if (!CorpusDump::parseLine(line, url, content)) {
+                            worker.invalid++;
+                            continue;
+                        }
+
+                        counts.clear();
+                        indexer::Indexer::splitContentUniqueTerms(content, counts, ' ');
+                        std::uint64_t document = documentId(w, worker.urls.size());
+                        std::int32_t docLength = static_cast<std::int32_t>(content.size());
+                        for (auto& term : indexer::Indexer::termFrequencies(counts)) {
+                            if (term.first.empty()) {
+                                continue;
+                            }
+                            auto entry = worker.index.try_emplace(std::move(term.first));
+                            if (entry.second) {
+                                worker.bytes += entry.first->first.size() + TERM_OVERHEAD;
+                            } else if (entry.first->second.back().document == document) {
+                                // Whitespace removal merged two spellings of the term, keep the first
+                                continue;
+                            }
+                            entry.first->second.push_back(RunPosting{document, term.second, docLength});
+                            worker.bytes += sizeof(RunPosting);
+                        }
+                        worker.shards.push_back(static_cast<std::uint32_t>(shard::shardOf(url, this->options.shards)));
+                        worker.urls.push_back(std::move(url));
+                        worker.lengths.push_back(docLength);
+
+                        if (worker.bytes > budget) {
+                            worker.runs.push_back(runPrefix + std::to_string(w) + "-" + std::to_string(worker.runs.size()) + ".run");
+                            spill(worker.index, worker.runs.back());
+                            worker.bytes = 0;
+                        }
+                    }
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (Worker& worker : workers) {
+            this->runFiles.insert(this->runFiles.end(), worker.runs.begin(), worker.runs.end());
+        }
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+
+        // The last line of a URL wins, like a later POST /index of the same page
+        std::unordered_map<std::string_view, std::pair<std::size_t, std::size_t>> latest;
+        long long totalLength = 0;
+        for (std::size_t w = 0; w < workers.size(); w++) {
+            result.invalid += workers[w].invalid;
+            result.runs += workers[w].runs.size();
+            for (std::size_t d = 0; d < workers[w].urls.size(); d++) {
+                auto entry = latest.emplace(workers[w].urls[d], std::make_pair(w, d));
+                if (!entry.second) {
+                    std::pair<std::size_t, std::size_t> earlier = entry.first->second;
+                    workers[earlier.first].shards[earlier.second] = SUPERSEDED;
+                    totalLength -= workers[earlier.first].lengths[earlier.second];
+                    entry.first->second = std::make_pair(w, d);
+                    result.duplicates++;
+                }
+                totalLength += workers[w].lengths[d];
+            }
+        }
+        result.documents = latest.size();
+        std::unordered_map<std::string_view, std::pair<std::size_t, std::size_t>>().swap(latest);
+        result.tokenizeSeconds = secondsSince(phaseStart);
+
+        // The statistics are final before the first impact is computed
+        impact::CorpusStats& stats = result.stats;
+        stats.totalDocuments = static_cast<std::int64_t>(result.documents);
+        stats.avgDocLength = result.documents == 0 ? 0 : static_cast<double>(totalLength) / static_cast<double>(result.documents);
+        stats.version = 1;
+        if (this->options.load) {
+            indexer_db::IndexerDB db;
+            stats.version = db.getCorpusStats().version + 1;
+        }
+
+        // Merge phase: assemble every term from the runs and partial indexes in term order
+        phaseStart = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<RunSource>> sources;
+        for (Worker& worker : workers) {
+            for (const std::string& path : worker.runs) {
+                sources.push_back(std::make_unique<FileRun>(path));
+            }
+            sources.push_back(std::make_unique<MemoryRun>(worker.index));
+        }
+        auto later = [&sources](std::size_t a, std::size_t b) {
+            int order = sources[a]->term().compare(sources[b]->term());
+            return order != 0 ? order > 0 : a > b;
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+        for (std::size_t s = 0; s < sources.size(); s++) {
+            if (sources[s]->next()) heap.push(s);
+        }
+
+        std::vector<std::unique_ptr<snapshot::SnapshotWriter>> writers;
+        if (!this->options.snapshotDirectory.empty()) {
+            for (std::size_t shard = 0; shard < this->options.shards; shard++) {
+                writers.push_back(std::make_unique<snapshot::SnapshotWriter>(snapshotPath(this->options.snapshotDirectory, shard, this->options.shards), stats,
+                                                                             static_cast<std::uint32_t>(shard), static_cast<std::uint32_t>(this->options.shards), startedMs + 1));
+            }
+        }
+        std::unique_ptr<Loaders> loaders;
+        if (this->options.load) {
+            loaders = std::make_unique<Loaders>(this->options.loaders, stats, startedMs);
+        }
+
+        std::vector<std::vector<indexer_db::IndexDocument>> postings(this->options.shards);
+        std::vector<LoadBatch> batches(this->options.shards);
+        for (std::size_t shard = 0; shard < this->options.shards; shard++) {
+            batches[shard].shard = shard;
+        }
+        while (!heap.empty()) {
+            std::string term = sources[heap.top()]->term();
+            while (!heap.empty() && sources[heap.top()]->term() == term) {
+                std::size_t s = heap.top();
+                heap.pop();
+                for (const RunPosting& posting : sources[s]->postings()) {
+                    const Worker& worker = workers[posting.document >> 32];
+                    std::size_t local = static_cast<std::size_t>(posting.document & 0xffffffffu);
+                    if (worker.shards[local] == SUPERSEDED) {
+                        continue;
+                    }
+                    postings[worker.shards[local]].push_back(indexer_db::IndexDocument{worker.urls[local], posting.tf, posting.docLength});
+                }
+                if (sources[s]->next()) heap.push(s);
+            }
+
+            bool found = false;
+            for (std::size_t shard = 0; shard < this->options.shards; shard++) {
+                if (postings[shard].empty()) {
+                    continue;
+                }
+                found = true;
+                result.postings += postings[shard].size();
+                std::vector<impact::ImpactPosting> impacts = impact::computeImpacts(postings[shard], stats);
+                if (!writers.empty()) {
+                    writers[shard]->addTerm(term, impacts);
+                }
+                if (loaders) {
+                    batches[shard].terms.push_back(indexer_db::TermPostings{term, std::move(postings[shard]), std::move(impacts)});
+                    if (batches[shard].terms.size() >= LOAD_BATCH_TERMS) {
+                        loaders->push(std::move(batches[shard]));
+                        batches[shard] = LoadBatch();
+                        batches[shard].shard = shard;
+                    }
+                }
+                postings[shard].clear();
+            }
+            if (found) result.terms++;
+        }
+
+        for (std::unique_ptr<snapshot::SnapshotWriter>& writer : writers) {
+            writer->finish();
+        }
+        for (std::size_t shard = 0; shard < writers.size(); shard++) {
+            result.snapshots.push_back(snapshotPath(this->options.snapshotDirectory, shard, this->options.shards));
+        }
+        if (loaders) {
+            for (LoadBatch& batch : batches) {
+                if (!batch.terms.empty()) loaders->push(std::move(batch));
+            }
+            loaders->finish();
+
+            // Published last, so searchers only switch to the new statistics once every term is written
+            indexer_db::IndexerDB db;
+            db.storeCorpusStats(stats);
+        }
+        result.mergeSeconds = secondsSince(phaseStart);
+        return result;
+    }
+
+}
@@ -0,0 +1,250 @@
+#include "bulk/corpusDump.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bulk {
+
+    namespace {
+
+        /**
+         * @class LineParser
+         * @brief Minimal JSON reader for one flat object per line.
+         */
+        class LineParser {
+        public:
+            explicit LineParser(std::string_view text) : text(text) {}
+
+            bool done() {
+                this->skipSpace();
+                return this->position >= this->text.size();
+            }
+
+            bool consume(char c) {
+                this->skipSpace();
+                if (this->position < this->text.size() && this->text[this->position] == c) {
+                    this->position++;
+                    return true;
+                }
+                return false;
+            }
+
+            bool peek(char c) {
+                this->skipSpace();
+                return this->position < this->text.size() && this->text[this->position] == c;
+            }
+
+            // Reads a string literal, decoding escapes to UTF-8
+            bool string(std::string& out) {
+                out.clear();
+                if (!this->consume('"')) return false;
+                while (this->position < this->text.size()) {
+                    char c = this->text[this->position++];
+                    if (c == '"') return true;
+                    if (c != '\\') {
+                        out.push_back(c);
+                        continue;
+                    }
+                    if (this->position >= this->text.size()) return false;
+                    char escape = this->text[this->position++];
+                    switch (escape) {
+                        case '"': case '\\': case '/': out.push_back(escape); break;
+                        case 'b': out.push_back('\b'); break;
+                        case 'f': out.push_back('\f'); break;
+                        case 'n': out.push_back('\n'); break;
+                        case 'r': out.push_back('\r'); break;
+                        case 't': out.push_back('\t'); break;
+                        case 'u': {
+                            unsigned code;
+                            if (!this->hex4(code)) return false;
+                            if (code >= 0xD800 && code < 0xDC00) {
+                                unsigned low;
+                                if (this->position + 1 >= this->text.size() || this->text[this->position] != '\\' || this->text[this->position + 1] != 'u') return false;
+                                this->position += 2;
+                                if (!this->hex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            appendUtf8(out, code);
+                            break;
+                        }
+                        default: return false;
+                    }
+                }
+                return false;
+            }
+
+            // Skips a value of any type
+            bool skipValue() {
+                this->skipSpace();
+                if (this->position >= this->text.size()) return false;
+                char c = this->text[this->position];
+                if (c == '"') {
+                    std::string ignored;
+                    return this->string(ignored);
+                }
+                if (c == '{' || c == '[') {
+                    char close = c == '{' ? '}' : ']';
+                    this->position++;
+                    if (this->consume(close)) return true;
+                    do {
+                        if (c == '{') {
+                            std::string key;
+                            if (!this->string(key) || !this->consume(':')) return false;
+                        }
+                        if (!this->skipValue()) return false;
+                    } while (this->consume(','));
+                    return this->consume(close);
+                }
+                std::size_t start = this->position;
+                while (this->position < this->text.size() && std::strchr(",}] \t\r", this->text[this->position]) == nullptr) {
+                    this->position++;
+                }
+                return this->position > start;
+            }
+
+        private:
+            std::string_view text;
+            std::size_t position = 0;
+
+            void skipSpace() {
+                while (this->position < this->text.size() && std::strchr(" \t\r", this->text[this->position]) != nullptr) {
+                    this->position++;
+                }
+            }
+
+            bool hex4(unsigned& code) {
+                if (this->position + 4 > this->text.size()) return false;
+                code = 0;
+                for (int i = 0; i < 4; i++) {
+                    char h = this->text[this->position++];
+                    code <<= 4;
+                    if (h >= '0' && h <= '9') code |= static_cast<unsigned>(h - '0');
+                    else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned>(h - 'a' + 10);
+                    else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned>(h - 'A' + 10);
+                    else return false;
+                }
+                return true;
+            }
+
+            static void appendUtf8(std::string& out, unsigned code) {
+                if (code < 0x80) {
+                    out.push_back(static_cast<char>(code));
+                } else if (code < 0x800) {
+                    out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                } else if (code < 0x10000) {
+                    out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                } else {
+                    out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+            }
+        };
+    }
+
+    /**
+     * @brief Constructor for the CorpusDump class; maps the file.
+     *
+     * @param path The path of the dump.
+     * @throws std::runtime_error If the file cannot be opened or mapped.
+     */
+    CorpusDump::CorpusDump(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("cannot stat " + path + ": " + std::strerror(error));
+        }
+        this->size = static_cast<std::size_t>(info.st_size);
+        if (this->size > 0) {
+            void* mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                int error = errno;
+                close(fd);
+                throw std::runtime_error("cannot map " + path + ": " + std::strerror(error));
+            }
+            madvise(mapping, this->size, MADV_SEQUENTIAL);
+            this->bytes = static_cast<const char*>(mapping);
+        }
+        close(fd);
+    }
+
+    /**
+     * @brief Destructor; unmaps the file.
+     */
+    CorpusDump::~CorpusDump() {
+        if (this->bytes) {
+            munmap(const_cast<char*>(this->bytes), this->size);
+        }
+    }
+
+    /**
+     * @brief Splits the file into ranges of whole lines of about equal size.
+     *
+     * Every boundary is moved forward to the start of the next line.
+     *
+     * @param parts The number of ranges.
+     * @return std::vector<std::pair<std::size_t, std::size_t>> The [begin, end) byte ranges, in file order.
+     */
+    std::vector<std::pair<std::size_t, std::size_t>> CorpusDump::split(std::size_t parts) const {
+        parts = parts == 0 ? 1 : parts;
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        std::size_t begin = 0;
+        for (std::size_t p = 1; p <= parts; p++) {
+            std::size_t end = p == parts ? this->size : std::max(begin, this->size / parts * p);
+            while (end < this->size && end > 0 && this->bytes[end - 1] != '\n') {
+                end++;
+            }
+            ranges.emplace_back(begin, end);
+            begin = end;
+        }
+        return ranges;
+    }
+
+    /**
+     * @brief Reads the URL and content of one line.
+     *
+     * @param line The line, without the newline.
+     * @param url Receives the URL.
+     * @param content Receives the content.
+     * @return True if the line is an object with string "url" and "content" members.
+     */
+    bool CorpusDump::parseLine(std::string_view line, std::string& url, std::string& content) {
+        LineParser parser(line);
+        if (!parser.consume('{')) return false;
+
+        bool hasUrl = false;
+        bool hasContent = false;
+        std::string key;
+        if (!parser.consume('}')) {
+            do {
+                if (!parser.string(key) || !parser.consume(':')) return false;
+                if (key == "url" && parser.peek('"')) {
+                    if (!parser.string(url)) return false;
+                    hasUrl = true;
+                } else if (key == "content" && parser.peek('"')) {
+                    if (!parser.string(content)) return false;
+                    hasContent = true;
+                } else if (!parser.skipValue()) {
+                    return false;
+                }
+            } while (parser.consume(','));
+            if (!parser.consume('}')) return false;
+        }
+        return parser.done() && hasUrl && hasContent && !url.empty();
+    }
+
+}
@@ -0,0 +1,86 @@
+#include "bulk/bulkBuilder.hpp"
+#include <mongocxx/instance.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Main function of the offline bulk index builder.
+ *
+ * --input FILE reads a JSONL dump with one {"url": ..., "content": ...} object per line.
+ * --snapshot-dir DIR writes one snapshot per shard for Search --snapshot; --load off skips
+ * loading the index, impacts and statistics into MongoDB. --shards N partitions the index
+ * like Indexer --shards. --threads T (default: all cores) tokenizes in parallel,
+ * --loaders L threads write to MongoDB, --memory-mb M bounds the partial indexes before
+ * they are spilled as sorted runs to --temp-dir DIR.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return int 0 on success, 1 on failure.
+ */
+int main(int argc, char** argv) {
+    bulk::BulkOptions options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + option);
+            }
+            std::string value = argv[++i];
+            if (option == "--input") {
+                options.input = value;
+            } else if (option == "--snapshot-dir") {
+                options.snapshotDirectory = value;
+            } else if (option == "--load") {
+                if (value != "on" && value != "off") {
+                    throw std::invalid_argument("--load must be on or off");
+                }
+                options.load = value == "on";
+            } else if (option == "--shards") {
+                options.shards = static_cast<std::size_t>(std::stoul(value));
+            } else if (option == "--threads") {
+                options.threads = static_cast<std::size_t>(std::stoul(value));
+            } else if (option == "--loaders") {
+                options.loaders = static_cast<std::size_t>(std::stoul(value));
+            } else if (option == "--memory-mb") {
+                options.memoryBytes = static_cast<std::size_t>(std::stoul(value)) << 20;
+            } else if (option == "--temp-dir") {
+                options.tempDirectory = value;
+            } else {
+                throw std::invalid_argument("unknown option " + option);
+            }
+        }
+        if (options.input.empty()) {
+            throw std::invalid_argument("--input is required");
+        }
+        if (!options.load && options.snapshotDirectory.empty()) {
+            throw std::invalid_argument("--load off needs --snapshot-dir");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid arguments: " << e.what() << '\n'
+                  << "Usage: BulkIndexer --input FILE [--snapshot-dir DIR] [--load on|off] [--shards N] [--threads T] [--loaders L] [--memory-mb M] [--temp-dir DIR]" << std::endl;
+        return 1;
+    }
+
+    // Call mongocxx instance once to initialize MongoDB driver
+    mongocxx::instance instance{};
+
+    try {
+        bulk::BulkBuilder builder(options);
+        bulk::BulkStats stats = builder.run();
+        std::cout << "Indexed " << stats.documents << " documents (" << stats.duplicates << " superseded, " << stats.invalid << " invalid lines) in "
+                  << stats.tokenizeSeconds << " s, " << stats.runs << " runs spilled" << std::endl;
+        std::cout << "Wrote " << stats.terms << " terms, " << stats.postings << " postings in " << stats.mergeSeconds << " s; corpus statistics version "
+                  << stats.stats.version << ", average length " << stats.stats.avgDocLength << std::endl;
+        for (const std::string& path : stats.snapshots) {
+            std::cout << "Snapshot " << path << std::endl;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error building the index: " << e.what() << std::endl;
+        return 1;
+    }
+}
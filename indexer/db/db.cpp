@@ -1,14 +1,58 @@
 #include "db/indexdb.hpp"
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/builder/stream/array.hpp>
 #include <bsoncxx/json.hpp>
 #include <mongocxx/exception/exception.hpp>
 #include <mongocxx/bulk_write.hpp>
+#include <mongocxx/model/replace_one.hpp>
+#include <mongocxx/options/bulk_write.hpp>
+#include <mongocxx/options/replace.hpp>
 #include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include "shard/shard.hpp"
+#include "snapshot/snapshotWriter.hpp"
+#include <chrono>
 
 namespace indexer_db {
 
+    // Number of shards the index is partitioned into, set once by useShards
+    static std::size_t shards = 1;
+
+    // Names of the collections of a shard
+    static std::string indexCollection(std::size_t shard) {
+        return shard::collectionName("index", shard, shards);
+    }
+
+    static std::string impactsCollection(std::size_t shard) {
+        return shard::collectionName("impacts", shard, shards);
+    }
+
+    // Milliseconds since the epoch, the "updatedMs" stamp of written terms
+    static std::int64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Sets the number of shards the index is partitioned into.
+     * 
+     * @param count The number of shards; 1 writes the unsharded collections.
+     */
+    void IndexerDB::useShards(std::size_t count) {
+        shards = count == 0 ? 1 : count;
+    }
+
+    /**
+     * @brief Returns the number of shards the index is partitioned into.
+     * 
+     * @return std::size_t The number of shards.
+     */
+    std::size_t IndexerDB::shardCount() {
+        return shards;
+    }
+
     /**
      * @brief Constructor for the IndexerDB class.
      * 
@@ -38,20 +82,29 @@ namespace indexer_db {
      * 
      * This function updates or inserts a document into the MongoDB index collection for a specific term.
      * 
+     * The impact-ordered postings of the term are rewritten with the given corpus statistics;
+     * before the first impact refresh there are none and the searcher computes them itself.
+     * 
+     * Both are written to the shard the URL of the document hashes to. The term document is
+     * stamped with "updatedMs", which searchers serving a snapshot poll for.
+     * 
      * @param document The document to be indexed.
      * @param term The term for which the document is being indexed.
+     * @param stats The corpus statistics the impacts are computed with.
+     * @throws std::exception If reading or writing the term fails; the error is logged first.
      */
-    void IndexerDB::upsertIndexDocument(const IndexDocument& document, std::string term) {
+    void IndexerDB::upsertIndexDocument(const IndexDocument& document, std::string term, const impact::CorpusStats& stats) {
         try {
             bsoncxx::builder::stream::document doc_builder{};
             doc_builder << "url" << document.url
                         << "tf" << document.tf
                         << "docLength" << document.docLength;
 
+            std::size_t shard = shard::shardOf(document.url, shards);
             auto db = this->client->database("AsuraCrow_DB");
-            auto indexDocuments = db.collection("index");
+            auto indexDocuments = db.collection(indexCollection(shard));
 
-            auto documents = this->getTermDocuments(term);
+            auto documents = this->getTermDocuments(term, shard);
 
             // Check for updating a document
             bool found = false;
@@ -82,65 +135,496 @@ namespace indexer_db {
             auto update = bsoncxx::builder::stream::document{} << "$set"
                                                                << bsoncxx::builder::stream::open_document
                                                                << "documents" << arr_builder
+                                                               << "updatedMs" << nowMs()
                                                                << bsoncxx::builder::stream::close_document
                                                                << bsoncxx::builder::stream::finalize;
 
             indexDocuments.update_one(filter.view(), update.view(), mongocxx::options::update().upsert(true));
+
+            if (stats.totalDocuments > 0) {
+                this->writeImpacts(term, documents, stats, shard);
+            }
         } catch (const mongocxx::exception& e) {
             std::cerr << "MongoDB Error upserting document: " << e.what() << std::endl;
+            throw;
         } catch (const std::exception& e) {
             std::cerr << "Error upserting document into MongoDB: " << e.what() << std::endl;
+            throw;
         }
     }
 
+    /**
+     * @brief Removes the postings of a document from every term except the given ones.
+     * 
+     * Pulls the URL from the "index" and "impacts" term documents of its shard that contain
+     * it and are not kept, and stamps the touched term documents with "updatedMs". Before an
+     * updated document is upserted, this drops the postings of the terms it no longer
+     * contains; for a new document it matches nothing.
+     * 
+     * @param url The URL of the document.
+     * @param keep The terms whose postings stay; empty removes every posting.
+     * @throws std::exception If a write fails.
+     */
+    void IndexerDB::removePostings(const std::string& url, const std::vector<std::string>& keep) {
+        std::size_t shard = shard::shardOf(url, shards);
+        auto db = this->client->database("AsuraCrow_DB");
+
+        bsoncxx::builder::basic::array kept{};
+        for (const std::string& term : keep) {
+            kept.append(term);
+        }
+
+        auto indexFilter = bsoncxx::builder::stream::document{} << "documents.url" << url
+                                                                << "term" << bsoncxx::builder::stream::open_document << "$nin" << kept.view() << bsoncxx::builder::stream::close_document
+                                                                << bsoncxx::builder::stream::finalize;
+        auto indexUpdate = bsoncxx::builder::stream::document{} << "$pull"
+                                                                << bsoncxx::builder::stream::open_document
+                                                                << "documents" << bsoncxx::builder::stream::open_document << "url" << url << bsoncxx::builder::stream::close_document
+                                                                << bsoncxx::builder::stream::close_document
+                                                                << "$set"
+                                                                << bsoncxx::builder::stream::open_document
+                                                                << "updatedMs" << nowMs()
+                                                                << bsoncxx::builder::stream::close_document
+                                                                << bsoncxx::builder::stream::finalize;
+        db.collection(indexCollection(shard)).update_many(indexFilter.view(), indexUpdate.view());
+
+        auto impactFilter = bsoncxx::builder::stream::document{} << "postings.url" << url
+                                                                 << "term" << bsoncxx::builder::stream::open_document << "$nin" << kept.view() << bsoncxx::builder::stream::close_document
+                                                                 << bsoncxx::builder::stream::finalize;
+        auto impactUpdate = bsoncxx::builder::stream::document{} << "$pull"
+                                                                 << bsoncxx::builder::stream::open_document
+                                                                 << "postings" << bsoncxx::builder::stream::open_document << "url" << url << bsoncxx::builder::stream::close_document
+                                                                 << bsoncxx::builder::stream::close_document
+                                                                 << bsoncxx::builder::stream::finalize;
+        db.collection(impactsCollection(shard)).update_many(impactFilter.view(), impactUpdate.view());
+    }
+
     /**
      * @brief Retrieves documents that contain a specific term from the database.
      * 
      * This function fetches documents associated with a specific term from the MongoDB index collection.
      * 
      * @param term The search term.
+     * @param shard The shard whose postings are read.
      * @return A vector of IndexDocument structures containing documents that include the term.
+     * @throws std::exception If the read fails, so that the caller does not overwrite the term with a partial list.
      */
-    std::vector<IndexDocument> IndexerDB::getTermDocuments(std::string term) {
+    std::vector<IndexDocument> IndexerDB::getTermDocuments(std::string term, std::size_t shard) {
         std::vector<IndexDocument> result;
+        auto db = this->client->database("AsuraCrow_DB");
+        auto indexDocuments = db.collection(indexCollection(shard));
+        auto filter = bsoncxx::builder::stream::document{} << "term" << term << bsoncxx::builder::stream::finalize;
+
+        // Define projection option
+        mongocxx::options::find findOpts{};
+        findOpts.projection(bsoncxx::builder::basic::make_document(bsoncxx::builder::basic::kvp("documents", 1)));
+
+        // Retrieve one index document matching the term from the database
+        auto cursor = indexDocuments.find_one(filter.view(), findOpts);
+
+        if (cursor) {
+            result = decodePostings(cursor->view());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Decodes the postings array of a term document.
+     * 
+     * @param termDoc The term document.
+     * @return std::vector<IndexDocument> The valid postings of the term.
+     */
+    std::vector<IndexDocument> IndexerDB::decodePostings(bsoncxx::document::view termDoc) {
+        std::vector<IndexDocument> result;
+        if (termDoc.find("documents") == termDoc.end()) {
+            return result;
+        }
+
+        auto documents_array = termDoc["documents"].get_array().value;
+        for (const auto& doc_value : documents_array) {
+            auto doc = doc_value.get_document().value;
+            if (doc.find("url") != doc.end() &&
+                doc.find("tf") != doc.end() &&
+                doc.find("docLength") != doc.end()) {
+
+                IndexDocument index_doc;
+                index_doc.url = doc["url"].get_string().value.to_string();
+                index_doc.tf = doc["tf"].get_double().value;
+                index_doc.docLength = doc["docLength"].get_int32().value;
+                result.push_back(index_doc);
+            } else {
+                std::cerr << "Error: Invalid document retrieved from MongoDB." << std::endl;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Writes the impact-ordered postings of a term into the "impacts" collection of a shard.
+     * 
+     * The IDF of the impacts is based on the shard's own postings; a sharded search rescales
+     * it to the corpus-wide document frequency at query time.
+     * 
+     * @param term The term.
+     * @param documents All postings of the term in the shard.
+     * @param stats The corpus statistics the impacts are computed with.
+     * @param shard The shard the postings belong to.
+     */
+    void IndexerDB::writeImpacts(const std::string& term, const std::vector<IndexDocument>& documents, const impact::CorpusStats& stats, std::size_t shard) {
+        std::vector<impact::ImpactPosting> impacts = impact::computeImpacts(documents, stats);
+
+        bsoncxx::builder::stream::array postings_builder{};
+        for (const impact::ImpactPosting& posting : impacts) {
+            postings_builder << bsoncxx::builder::stream::open_document
+                             << "url" << posting.url
+                             << "impact" << static_cast<std::int32_t>(posting.impact)
+                             << bsoncxx::builder::stream::close_document;
+        }
+
+        std::int32_t maxImpact = impacts.empty() ? 0 : impacts.front().impact;
+        auto impactDoc = bsoncxx::builder::stream::document{} << "term" << term
+                                                              << "statsVersion" << static_cast<std::int64_t>(stats.version)
+                                                              << "maxImpact" << maxImpact
+                                                              << "postings" << postings_builder
+                                                              << bsoncxx::builder::stream::finalize;
+
+        auto db = this->client->database("AsuraCrow_DB");
+        auto impactDocuments = db.collection(impactsCollection(shard));
+        auto filter = bsoncxx::builder::stream::document{} << "term" << term << bsoncxx::builder::stream::finalize;
+        impactDocuments.replace_one(filter.view(), impactDoc.view(), mongocxx::options::replace().upsert(true));
+    }
+
+    /**
+     * @brief Gets the corpus statistics of the last impact refresh from the "stats" collection.
+     * 
+     * @return impact::CorpusStats The statistics, with totalDocuments 0 if impacts were never refreshed.
+     */
+    impact::CorpusStats IndexerDB::getCorpusStats() {
+        impact::CorpusStats stats;
         try {
             auto db = this->client->database("AsuraCrow_DB");
-            auto indexDocuments = db.collection("index");
-            auto filter = bsoncxx::builder::stream::document{} << "term" << term << bsoncxx::builder::stream::finalize;
+            auto statsDocuments = db.collection("stats");
+            auto filter = bsoncxx::builder::stream::document{} << "_id" << "corpus" << bsoncxx::builder::stream::finalize;
 
-            // Define projection option
-            mongocxx::options::find findOpts{};
-            findOpts.projection(bsoncxx::builder::basic::make_document(bsoncxx::builder::basic::kvp("documents", 1)));
+            auto cursor = statsDocuments.find_one(filter.view());
+            if (cursor) {
+                auto statsDoc = cursor->view();
+                stats.totalDocuments = statsDoc["totalDocuments"].get_int64().value;
+                stats.avgDocLength = statsDoc["avgDocLength"].get_double().value;
+                stats.version = statsDoc["version"].get_int64().value;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error retrieving corpus statistics from MongoDB: " << e.what() << std::endl;
+        }
+        return stats;
+    }
 
-            // Retrieve one index document matching the term from the database
-            auto cursor = indexDocuments.find_one(filter.view(), findOpts);
+    /**
+     * @brief Counts the documents of the corpus.
+     * 
+     * @return std::int64_t The number of documents in the "websites" collection.
+     */
+    std::int64_t IndexerDB::countDocuments() {
+        auto db = this->client->database("AsuraCrow_DB");
+        auto websiteDocuments = db.collection("websites");
+        return websiteDocuments.count_documents({});
+    }
 
-            if (cursor) {
-                auto termDoc = *cursor;
-
-                if (termDoc.find("documents") != termDoc.end()) {
-                    auto documents_array = termDoc["documents"].get_array().value;
-                    for (const auto& doc_value : documents_array) {
-                        auto doc = doc_value.get_document().value;
-                        if (doc.find("url") != doc.end() &&
-                            doc.find("tf") != doc.end() &&
-                            doc.find("docLength") != doc.end()) {
-
-                            IndexDocument index_doc;
-                            index_doc.url = doc["url"].get_string().value.to_string();
-                            index_doc.tf = doc["tf"].get_double().value;
-                            index_doc.docLength = doc["docLength"].get_int32().value;
-                            result.push_back(index_doc);
-                        } else {
-                            std::cerr << "Error: Invalid document retrieved from MongoDB." << std::endl;
+    /**
+     * @brief Stores the fingerprint of a document in the "fingerprints" collection.
+     * 
+     * The SimHash is stored as the int64 with the same bits. An alias carries the URL of its
+     * canonical document and, as its terms are not in the index, the terms and length it is
+     * indexed with once the canonical document is deleted.
+     * 
+     * @param fingerprint The fingerprint; a non-empty canonical records the document as an alias.
+     * @throws std::exception If the write fails; the error is logged first.
+     */
+    void IndexerDB::upsertFingerprint(const Fingerprint& fingerprint) {
+        try {
+            auto db = this->client->database("AsuraCrow_DB");
+            auto fingerprints = db.collection("fingerprints");
+
+            bsoncxx::builder::stream::document doc_builder{};
+            doc_builder << "url" << fingerprint.url
+                        << "simHash" << static_cast<std::int64_t>(fingerprint.simHash)
+                        << "updatedMs" << nowMs();
+            if (!fingerprint.canonical.empty()) {
+                bsoncxx::builder::stream::array terms_builder{};
+                for (const auto& term : fingerprint.terms) {
+                    terms_builder << bsoncxx::builder::stream::open_document
+                                  << "term" << term.first
+                                  << "tf" << term.second
+                                  << bsoncxx::builder::stream::close_document;
+                }
+                doc_builder << "canonical" << fingerprint.canonical
+                            << "terms" << terms_builder
+                            << "docLength" << fingerprint.docLength;
+            }
+
+            auto filter = bsoncxx::builder::stream::document{} << "url" << fingerprint.url << bsoncxx::builder::stream::finalize;
+            fingerprints.replace_one(filter.view(), doc_builder.view(), mongocxx::options::replace().upsert(true));
+        } catch (const std::exception& e) {
+            std::cerr << "Error storing fingerprint in MongoDB: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    /**
+     * @brief Removes the fingerprint of a document from the "fingerprints" collection.
+     * 
+     * @param url The URL of the document.
+     * @throws std::exception If the write fails; the error is logged first.
+     */
+    void IndexerDB::removeFingerprint(const std::string& url) {
+        try {
+            auto db = this->client->database("AsuraCrow_DB");
+            auto filter = bsoncxx::builder::stream::document{} << "url" << url << bsoncxx::builder::stream::finalize;
+            db.collection("fingerprints").delete_one(filter.view());
+        } catch (const std::exception& e) {
+            std::cerr << "Error removing fingerprint from MongoDB: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    /**
+     * @brief Reads the aliases of a canonical document from the "fingerprints" collection.
+     * 
+     * @param canonical The URL of the canonical document.
+     * @return std::vector<Fingerprint> The fingerprints of its aliases, with their terms.
+     * @throws std::exception If the read fails; the error is logged first.
+     */
+    std::vector<Fingerprint> IndexerDB::getAliases(const std::string& canonical) {
+        std::vector<Fingerprint> result;
+        try {
+            auto db = this->client->database("AsuraCrow_DB");
+            auto filter = bsoncxx::builder::stream::document{} << "canonical" << canonical << bsoncxx::builder::stream::finalize;
+
+            for (auto&& doc : db.collection("fingerprints").find(filter.view())) {
+                if (doc.find("url") == doc.end() || doc.find("simHash") == doc.end()) {
+                    continue;
+                }
+                Fingerprint fingerprint;
+                fingerprint.url = doc["url"].get_string().value.to_string();
+                fingerprint.simHash = static_cast<std::uint64_t>(doc["simHash"].get_int64().value);
+                fingerprint.canonical = canonical;
+                if (doc.find("docLength") != doc.end()) {
+                    fingerprint.docLength = doc["docLength"].get_int32().value;
+                }
+                if (doc.find("terms") != doc.end()) {
+                    for (const auto& term_value : doc["terms"].get_array().value) {
+                        auto term = term_value.get_document().value;
+                        if (term.find("term") != term.end() && term.find("tf") != term.end()) {
+                            fingerprint.terms.emplace_back(term["term"].get_string().value.to_string(), static_cast<float>(term["tf"].get_double().value));
                         }
                     }
                 }
+                result.push_back(std::move(fingerprint));
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error retrieving documents from MongoDB: " << e.what() << std::endl;
+            std::cerr << "Error retrieving aliases from MongoDB: " << e.what() << std::endl;
+            throw;
         }
         return result;
     }
 
-}
\ No newline at end of file
+    /**
+     * @brief Reads the fingerprints of all canonical documents from the "fingerprints" collection.
+     * 
+     * @return std::vector<Fingerprint> The fingerprints without a canonical document.
+     */
+    std::vector<Fingerprint> IndexerDB::getCanonicalFingerprints() {
+        std::vector<Fingerprint> result;
+        try {
+            auto db = this->client->database("AsuraCrow_DB");
+            auto fingerprints = db.collection("fingerprints");
+            auto filter = bsoncxx::builder::stream::document{} << "canonical" << bsoncxx::builder::stream::open_document
+                                                               << "$exists" << false
+                                                               << bsoncxx::builder::stream::close_document
+                                                               << bsoncxx::builder::stream::finalize;
+
+            mongocxx::options::find findOpts{};
+            findOpts.projection(bsoncxx::builder::basic::make_document(bsoncxx::builder::basic::kvp("url", 1), bsoncxx::builder::basic::kvp("simHash", 1)));
+
+            for (auto&& doc : fingerprints.find(filter.view(), findOpts)) {
+                if (doc.find("url") == doc.end() || doc.find("simHash") == doc.end()) {
+                    continue;
+                }
+                Fingerprint fingerprint;
+                fingerprint.url = doc["url"].get_string().value.to_string();
+                fingerprint.simHash = static_cast<std::uint64_t>(doc["simHash"].get_int64().value);
+                result.push_back(std::move(fingerprint));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error retrieving fingerprints from MongoDB: " << e.what() << std::endl;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Recomputes the corpus statistics and the impacts of every term.
+     * 
+     * The first pass over the index collects the length of every distinct document for the
+     * average document length, the second rewrites the impacts of every term. Both passes
+     * cover all shards, so the statistics describe the whole corpus. The statistics are
+     * stored last, so their version only changes once all impacts match it.
+     * 
+     * @return impact::CorpusStats The new corpus statistics.
+     */
+    impact::CorpusStats IndexerDB::refreshImpacts() {
+        auto db = this->client->database("AsuraCrow_DB");
+
+        impact::CorpusStats stats;
+        stats.totalDocuments = this->countDocuments();
+        stats.version = this->getCorpusStats().version + 1;
+
+        // Average length over the distinct documents of the index
+        std::unordered_map<std::string, int> lengths;
+        for (std::size_t shard = 0; shard < shards; shard++) {
+            auto indexDocuments = db.collection(indexCollection(shard));
+            for (auto&& termDoc : indexDocuments.find({})) {
+                for (const IndexDocument& posting : decodePostings(termDoc)) {
+                    lengths[posting.url] = posting.docLength;
+                }
+            }
+        }
+        long long totalLength = 0;
+        for (const auto& length : lengths) {
+            totalLength += length.second;
+        }
+        stats.avgDocLength = lengths.empty() ? 0 : static_cast<double>(totalLength) / lengths.size();
+
+        // Rewrite the impacts of every term with the new statistics
+        for (std::size_t shard = 0; shard < shards; shard++) {
+            auto indexDocuments = db.collection(indexCollection(shard));
+            for (auto&& termDoc : indexDocuments.find({})) {
+                if (termDoc.find("term") == termDoc.end()) continue;
+                std::string term = termDoc["term"].get_string().value.to_string();
+                this->writeImpacts(term, decodePostings(termDoc), stats, shard);
+            }
+        }
+
+        this->storeCorpusStats(stats);
+        return stats;
+    }
+
+    /**
+     * @brief Stores the corpus statistics in the "stats" collection.
+     * 
+     * @param stats The statistics.
+     */
+    void IndexerDB::storeCorpusStats(const impact::CorpusStats& stats) {
+        auto db = this->client->database("AsuraCrow_DB");
+        auto statsDocuments = db.collection("stats");
+        auto filter = bsoncxx::builder::stream::document{} << "_id" << "corpus" << bsoncxx::builder::stream::finalize;
+        auto statsDoc = bsoncxx::builder::stream::document{} << "_id" << "corpus"
+                                                             << "totalDocuments" << static_cast<std::int64_t>(stats.totalDocuments)
+                                                             << "avgDocLength" << stats.avgDocLength
+                                                             << "version" << static_cast<std::int64_t>(stats.version)
+                                                             << bsoncxx::builder::stream::finalize;
+        statsDocuments.replace_one(filter.view(), statsDoc.view(), mongocxx::options::replace().upsert(true));
+    }
+
+    /**
+     * @brief Replaces the term and impact documents of many terms of a shard with unordered bulk writes.
+     * 
+     * Every term becomes one upserting replace in each of the "index" and "impacts"
+     * collections of the shard, so a load can be repeated and the server applies the writes
+     * of a batch in any order.
+     * 
+     * @param terms The complete postings of every term.
+     * @param shard The shard the postings belong to.
+     * @param stats The corpus statistics the impacts were computed with.
+     * @param updatedMs The "updatedMs" stamp of the term documents.
+     * @throws std::runtime_error On database errors.
+     */
+    void IndexerDB::loadTerms(const std::vector<TermPostings>& terms, std::size_t shard, const impact::CorpusStats& stats, std::int64_t updatedMs) {
+        if (terms.empty()) {
+            return;
+        }
+        try {
+            auto db = this->client->database("AsuraCrow_DB");
+            mongocxx::options::bulk_write unordered;
+            unordered.ordered(false);
+            auto indexWrites = db.collection(indexCollection(shard)).create_bulk_write(unordered);
+            auto impactWrites = db.collection(impactsCollection(shard)).create_bulk_write(unordered);
+
+            for (const TermPostings& term : terms) {
+                auto filter = bsoncxx::builder::stream::document{} << "term" << term.term << bsoncxx::builder::stream::finalize;
+
+                bsoncxx::builder::stream::array documents{};
+                for (const IndexDocument& d : term.documents) {
+                    documents << bsoncxx::builder::stream::open_document
+                              << "url" << d.url
+                              << "tf" << d.tf
+                              << "docLength" << d.docLength
+                              << bsoncxx::builder::stream::close_document;
+                }
+                auto termDoc = bsoncxx::builder::stream::document{} << "term" << term.term
+                                                                    << "documents" << documents
+                                                                    << "updatedMs" << updatedMs
+                                                                    << bsoncxx::builder::stream::finalize;
+                mongocxx::model::replace_one indexWrite{filter.view(), termDoc.view()};
+                indexWrite.upsert(true);
+                indexWrites.append(indexWrite);
+
+                bsoncxx::builder::stream::array postings{};
+                for (const impact::ImpactPosting& posting : term.impacts) {
+                    postings << bsoncxx::builder::stream::open_document
+                             << "url" << posting.url
+                             << "impact" << static_cast<std::int32_t>(posting.impact)
+                             << bsoncxx::builder::stream::close_document;
+                }
+                std::int32_t maxImpact = term.impacts.empty() ? 0 : term.impacts.front().impact;
+                auto impactDoc = bsoncxx::builder::stream::document{} << "term" << term.term
+                                                                      << "statsVersion" << static_cast<std::int64_t>(stats.version)
+                                                                      << "maxImpact" << maxImpact
+                                                                      << "postings" << postings
+                                                                      << bsoncxx::builder::stream::finalize;
+                mongocxx::model::replace_one impactWrite{filter.view(), impactDoc.view()};
+                impactWrite.upsert(true);
+                impactWrites.append(impactWrite);
+            }
+
+            indexWrites.execute();
+            impactWrites.execute();
+        } catch (const mongocxx::exception& e) {
+            throw std::runtime_error(std::string("bulk load of shard ") + std::to_string(shard) + " failed: " + e.what());
+        }
+    }
+
+    /**
+     * @brief Exports the term dictionary, postings, document table and corpus statistics of a shard into a snapshot file.
+     * 
+     * The impacts are recomputed from the index collection with the statistics read at the
+     * start, rather than copied from the impacts collection, so every term of the snapshot
+     * uses the same statistics even if documents are indexed during the export. The creation
+     * time is taken before the first term is read; searchers loading the snapshot re-read
+     * every term stamped at or after it from the database.
+     * 
+     * @param path The path of the snapshot; replaced atomically.
+     * @param shard The shard to export.
+     * @return snapshot::SnapshotHeader The header of the written snapshot.
+     * @throws std::runtime_error On database or write errors.
+     */
+    snapshot::SnapshotHeader IndexerDB::exportSnapshot(const std::string& path, std::size_t shard) {
+        std::int64_t createdMs = nowMs();
+        impact::CorpusStats stats = this->getCorpusStats();
+        if (stats.totalDocuments == 0) {
+            // Never refreshed, the searcher counts the documents the same way
+            stats.totalDocuments = this->countDocuments();
+        }
+
+        snapshot::SnapshotWriter writer(path, stats, static_cast<std::uint32_t>(shard), static_cast<std::uint32_t>(shards), createdMs);
+        auto db = this->client->database("AsuraCrow_DB");
+        auto indexDocuments = db.collection(indexCollection(shard));
+        for (auto&& termDoc : indexDocuments.find({})) {
+            if (termDoc.find("term") == termDoc.end()) continue;
+            std::vector<IndexDocument> postings = decodePostings(termDoc);
+            if (postings.empty()) continue;
+            writer.addTerm(termDoc["term"].get_string().value.to_string(), impact::computeImpacts(postings, stats));
+        }
+        return writer.finish();
+    }
+
+}
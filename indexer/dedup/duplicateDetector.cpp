@@ -0,0 +1,187 @@
+#include "dedup/duplicateDetector.hpp"
+#include "dedup/simHash.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace dedup {
+
+    /**
+     * @brief Parses a duplicate action.
+     *
+     * @param name "off", "skip" or "alias".
+     * @return DuplicateAction The action.
+     * @throws std::invalid_argument For any other name.
+     */
+    DuplicateAction parseAction(const std::string& name) {
+        if (name == "off") return DuplicateAction::Off;
+        if (name == "skip") return DuplicateAction::Skip;
+        if (name == "alias") return DuplicateAction::Alias;
+        throw std::invalid_argument("unknown duplicate action " + name);
+    }
+
+    /**
+     * @brief Constructor for the DuplicateDetector class.
+     *
+     * The 64 bits are split as evenly as possible: with 3 as threshold, into 4 bands of 16 bits.
+     *
+     * @param maxDistance The Hamming threshold, 1 to MAX_DISTANCE.
+     * @throws std::invalid_argument If the threshold is out of range.
+     */
+    DuplicateDetector::DuplicateDetector(unsigned maxDistance) : distance(maxDistance) {
+        if (maxDistance < 1 || maxDistance > MAX_DISTANCE) {
+            throw std::invalid_argument("duplicate distance must be between 1 and " + std::to_string(MAX_DISTANCE));
+        }
+        unsigned count = maxDistance + 1;
+        this->bands.resize(count);
+        unsigned shift = 0;
+        for (unsigned b = 0; b < count; b++) {
+            unsigned width = 64 / count + (b < 64 % count ? 1 : 0);
+            this->bands[b].shift = shift;
+            this->bands[b].mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+            shift += width;
+        }
+    }
+
+    /**
+     * @brief Adds or updates a canonical document.
+     *
+     * @param url The URL of the document.
+     * @param fingerprint Its SimHash.
+     */
+    void DuplicateDetector::add(const std::string& url, std::uint64_t fingerprint) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->remove(url);
+        this->insert(url, fingerprint);
+    }
+
+    /**
+     * @brief Forgets a deleted document.
+     *
+     * @param url The URL of the document.
+     */
+    void DuplicateDetector::erase(const std::string& url) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->remove(url);
+    }
+
+    /**
+     * @brief Checks whether a document nearly duplicates a canonical document.
+     *
+     * Every band value of the fingerprint selects the documents agreeing on that band; the
+     * closest of them within the threshold, lowest index on ties, is the canonical document.
+     *
+     * @param url The URL of the document.
+     * @param fingerprint Its SimHash.
+     * @param canonical Receives the URL of the closest known document if it is a duplicate.
+     * @return True if the document is a near-duplicate.
+     */
+    bool DuplicateDetector::check(const std::string& url, std::uint64_t fingerprint, std::string& canonical) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->checked++;
+
+        auto self = this->indexes.find(url);
+        std::uint32_t selfIndex = self == this->indexes.end() ? UINT32_MAX : self->second;
+        std::uint32_t best = UINT32_MAX;
+        unsigned bestDistance = this->distance + 1;
+        for (const Band& band : this->bands) {
+            auto bucket = band.documents.find((fingerprint >> band.shift) & band.mask);
+            if (bucket == band.documents.end()) {
+                continue;
+            }
+            for (std::uint32_t index : bucket->second) {
+                if (index == selfIndex) {
+                    continue;
+                }
+                this->candidates++;
+                unsigned distance = hammingDistance(fingerprint, this->fingerprints[index]);
+                if (distance > this->distance) {
+                    continue;
+                }
+                if (distance < bestDistance || (distance == bestDistance && index < best)) {
+                    best = index;
+                    bestDistance = distance;
+                }
+            }
+        }
+
+        if (best == UINT32_MAX) {
+            return false;
+        }
+        this->duplicates++;
+        canonical = this->urls[best];
+        return true;
+    }
+
+    /**
+     * @brief Checks whether a URL is held as a canonical document.
+     *
+     * @param url The URL of the document.
+     * @return True if the URL is held.
+     */
+    bool DuplicateDetector::contains(const std::string& url) const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->indexes.count(url) > 0;
+    }
+
+    /**
+     * @brief Returns the counters.
+     *
+     * @return DuplicateStats The current counters.
+     */
+    DuplicateStats DuplicateDetector::stats() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        DuplicateStats stats;
+        stats.documents = this->indexes.size();
+        stats.checked = this->checked;
+        stats.duplicates = this->duplicates;
+        stats.candidates = this->candidates;
+        return stats;
+    }
+
+    /**
+     * @brief Inserts a document into the bands; the lock must be held.
+     *
+     * @param url The URL, not currently held.
+     * @param fingerprint The fingerprint.
+     */
+    void DuplicateDetector::insert(const std::string& url, std::uint64_t fingerprint) {
+        std::uint32_t index = static_cast<std::uint32_t>(this->urls.size());
+        this->urls.push_back(url);
+        this->fingerprints.push_back(fingerprint);
+        this->indexes[url] = index;
+        for (Band& band : this->bands) {
+            band.documents[(fingerprint >> band.shift) & band.mask].push_back(index);
+        }
+    }
+
+    /**
+     * @brief Removes a document from the bands, if held; the lock must be held.
+     *
+     * The slot of the document stays behind empty; re-indexed URLs are rare enough for that.
+     *
+     * @param url The URL.
+     */
+    void DuplicateDetector::remove(const std::string& url) {
+        auto it = this->indexes.find(url);
+        if (it == this->indexes.end()) {
+            return;
+        }
+        std::uint32_t index = it->second;
+        std::uint64_t fingerprint = this->fingerprints[index];
+        for (Band& band : this->bands) {
+            auto bucket = band.documents.find((fingerprint >> band.shift) & band.mask);
+            if (bucket == band.documents.end()) {
+                continue;
+            }
+            std::vector<std::uint32_t>& documents = bucket->second;
+            documents.erase(std::remove(documents.begin(), documents.end(), index), documents.end());
+            if (documents.empty()) {
+                band.documents.erase(bucket);
+            }
+        }
+        this->urls[index].clear();
+        this->urls[index].shrink_to_fit();
+        this->indexes.erase(it);
+    }
+
+}
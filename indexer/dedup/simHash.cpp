@@ -0,0 +1,74 @@
+#include "dedup/simHash.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+namespace dedup {
+
+    /**
+     * @brief Hashes a term to 64 bits, identically on every platform and in every process.
+     *
+     * FNV-1a alone mixes the last bytes poorly into the high bits, which SimHash weighs as
+     * much as the low ones; the splitmix64 finalizer spreads them.
+     *
+     * @param term The term.
+     * @return std::uint64_t The hash.
+     */
+    std::uint64_t hashTerm(std::string_view term) {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (char c : term) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+    /**
+     * @brief Computes the 64-bit SimHash of a document from its term frequencies.
+     *
+     * Votes are weighted with 1 + ln(tf) rather than tf: with raw counts the handful of most
+     * common words outvote everything else, and unrelated pages of the same language end up
+     * a few bits apart.
+     *
+     * @param terms The terms of the document with their frequencies; empty terms are ignored.
+     * @return std::uint64_t The fingerprint.
+     */
+    std::uint64_t simHash(const std::unordered_map<std::string, int>& terms) {
+        double votes[64] = {};
+        for (const auto& term : terms) {
+            if (term.first.empty()) {
+                continue;
+            }
+            std::uint64_t hash = hashTerm(term.first);
+            double weight = 1.0 + std::log(static_cast<double>(std::max(term.second, 1)));
+            for (int bit = 0; bit < 64; bit++) {
+                votes[bit] += (hash >> bit) & 1 ? weight : -weight;
+            }
+        }
+
+        std::uint64_t fingerprint = 0;
+        for (int bit = 0; bit < 64; bit++) {
+            if (votes[bit] > 0) {
+                fingerprint |= std::uint64_t(1) << bit;
+            }
+        }
+        return fingerprint;
+    }
+
+    /**
+     * @brief Counts the bits two fingerprints differ in.
+     *
+     * @param a The first fingerprint.
+     * @param b The second fingerprint.
+     * @return unsigned The Hamming distance, 0 to 64.
+     */
+    unsigned hammingDistance(std::uint64_t a, std::uint64_t b) {
+        return static_cast<unsigned>(std::bitset<64>(a ^ b).count());
+    }
+
+}
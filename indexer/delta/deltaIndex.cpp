@@ -0,0 +1,296 @@
+#include "delta/deltaIndex.hpp"
+#include "shard/shard.hpp"
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+namespace delta {
+
+    /**
+     * @brief Constructor for the DeltaIndex class.
+     *
+     * @param shards The number of shards the URLs are partitioned into.
+     */
+    DeltaIndex::DeltaIndex(std::size_t shards) : shards(std::max<std::size_t>(1, shards)) {
+        // Below 2^53, so the epoch survives a JSON number
+        std::random_device device;
+        this->epoch = ((std::uint64_t(device()) << 21) | (device() & 0x1FFFFF)) + 1;
+    }
+
+    /**
+     * @brief Adds a document version.
+     *
+     * @param url The URL of the document.
+     * @param terms The terms with their frequency.
+     * @param docLength The length of the document.
+     * @return std::uint64_t The sequence number of the version.
+     */
+    std::uint64_t DeltaIndex::add(const std::string& url, std::vector<std::pair<std::string, float>> terms, int docLength) {
+        Entry entry;
+        entry.docLength = docLength;
+        entry.terms = std::move(terms);
+        return this->replace(url, std::move(entry));
+    }
+
+    /**
+     * @brief Adds a delete of a document.
+     *
+     * @param url The URL of the document.
+     * @return std::uint64_t The sequence number of the delete.
+     */
+    std::uint64_t DeltaIndex::remove(const std::string& url) {
+        Entry entry;
+        entry.deleted = true;
+        return this->replace(url, std::move(entry));
+    }
+
+    /**
+     * @brief Looks up the postings of terms in one shard.
+     *
+     * If the caller's set is of this instance and its version is still covered by the kept
+     * changes, only the documents that entered or left the delta since are returned, the
+     * last change of each; otherwise every document of the shard in the delta.
+     *
+     * @param terms The terms.
+     * @param shard The shard whose documents are returned.
+     * @param epoch The epoch of the caller's set of shadowed documents; 0 if it has none.
+     * @param since The shadow version of the caller's set.
+     * @return DeltaLookup The postings and the changes to the shadowed documents of the shard since the caller's version, or all of them.
+     */
+    DeltaLookup DeltaIndex::lookup(const std::vector<std::string>& terms, std::size_t shard, std::uint64_t epoch, std::uint64_t since) const {
+        DeltaLookup result;
+        result.terms.resize(terms.size());
+
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        result.sequence = this->nextSequence;
+        result.epoch = this->epoch;
+        result.shadowVersion = this->shadowVersion;
+        for (std::size_t t = 0; t < terms.size(); t++) {
+            auto term = this->postings.find(terms[t]);
+            if (term == this->postings.end()) {
+                continue;
+            }
+            for (const auto& posting : term->second) {
+                if (shard::shardOf(posting.first, this->shards) != shard) {
+                    continue;
+                }
+                const Entry& entry = this->documents.at(posting.first);
+                result.terms[t].push_back(DeltaPosting{posting.first, posting.second, entry.docLength});
+            }
+        }
+
+        // The caller's set is current, or the changes since its version are still kept
+        bool covered = since == this->shadowVersion || (!this->shadowChanges.empty() && this->shadowChanges.front().version <= since + 1);
+        if (epoch == this->epoch && since <= this->shadowVersion && covered) {
+            result.full = false;
+            std::unordered_map<std::string, bool> changes;  // Last change of every URL
+            for (std::size_t i = this->shadowVersion - since; i > 0; i--) {
+                const ShadowChange& change = this->shadowChanges[this->shadowChanges.size() - i];
+                if (shard::shardOf(change.url, this->shards) == shard) {
+                    changes[change.url] = change.shadowed;
+                }
+            }
+            for (const auto& change : changes) {
+                (change.second ? result.shadowed : result.unshadowed).push_back(change.first);
+            }
+            return result;
+        }
+        for (const auto& document : this->documents) {
+            if (shard::shardOf(document.first, this->shards) == shard) {
+                result.shadowed.push_back(document.first);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Waits for queued versions and takes them for persistence.
+     *
+     * @param batch Receives up to max versions, oldest first.
+     * @param max The maximum number of versions.
+     * @param wait How long to wait for the first version.
+     * @return True if versions were taken; false on timeout or once stopped.
+     */
+    bool DeltaIndex::take(std::vector<PendingDocument>& batch, std::size_t max, std::chrono::milliseconds wait) {
+        batch.clear();
+        std::vector<std::pair<std::string, std::uint64_t>> taken;
+        {
+            std::unique_lock<std::mutex> lock(this->queueMutex);
+            this->queued.wait_for(lock, wait, [this]() { return this->stopping || !this->queue.empty(); });
+            if (this->stopping) {
+                return false;
+            }
+            while (!this->queue.empty() && taken.size() < max) {
+                taken.push_back(std::move(this->queue.front()));
+                this->queue.pop_front();
+            }
+        }
+
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        for (const auto& version : taken) {
+            auto it = this->documents.find(version.first);
+            if (it == this->documents.end() || it->second.sequence != version.second) {
+                continue;
+            }
+            batch.push_back(PendingDocument{version.first, version.second, it->second.deleted, it->second.docLength, it->second.terms});
+        }
+        return !batch.empty();
+    }
+
+    /**
+     * @brief Drops a version from the delta after it was written, unless it has been superseded.
+     *
+     * Only call this once the database confirmed the write: the write-ahead log deletes
+     * the records of versions that left the delta.
+     *
+     * @param url The URL of the document.
+     * @param sequence The sequence number of the written version.
+     */
+    void DeltaIndex::persisted(const std::string& url, std::uint64_t sequence) {
+        std::unique_lock<std::shared_mutex> lock(this->mutex);
+        auto it = this->documents.find(url);
+        if (it == this->documents.end() || it->second.sequence != sequence) {
+            return;
+        }
+        this->unlink(url, it->second);
+        this->documents.erase(it);
+        this->drained++;
+        this->recordShadow(url, false);
+    }
+
+    /**
+     * @brief Puts versions back at the front of the queue after a failed write.
+     *
+     * @param batch The versions, oldest first.
+     */
+    void DeltaIndex::requeue(const std::vector<PendingDocument>& batch) {
+        {
+            std::lock_guard<std::mutex> lock(this->queueMutex);
+            for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+                this->queue.emplace_front(it->url, it->sequence);
+            }
+        }
+        this->queued.notify_one();
+    }
+
+    /**
+     * @brief Wakes the waiting take calls and makes them return false.
+     */
+    void DeltaIndex::stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->queueMutex);
+            this->stopping = true;
+        }
+        this->queued.notify_all();
+    }
+
+    /**
+     * @brief Returns the oldest sequence number still waiting to be persisted.
+     *
+     * @return std::uint64_t The lowest sequence number in the delta, or the next one to be assigned if it is empty.
+     */
+    std::uint64_t DeltaIndex::oldestPending() const {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        std::uint64_t oldest = this->nextSequence + 1;
+        for (const auto& document : this->documents) {
+            oldest = std::min(oldest, document.second.sequence);
+        }
+        return oldest;
+    }
+
+    /**
+     * @brief Continues the sequence numbers after the given one.
+     *
+     * @param sequence The highest sequence number assigned before a restart.
+     */
+    void DeltaIndex::advance(std::uint64_t sequence) {
+        std::unique_lock<std::shared_mutex> lock(this->mutex);
+        this->nextSequence = std::max(this->nextSequence, sequence);
+    }
+
+    /**
+     * @brief Returns the state and counters.
+     *
+     * @return DeltaStats The current state.
+     */
+    DeltaStats DeltaIndex::stats() const {
+        DeltaStats stats;
+        {
+            std::shared_lock<std::shared_mutex> lock(this->mutex);
+            stats.documents = this->documents.size();
+            stats.terms = this->postings.size();
+            stats.added = this->added;
+            stats.persisted = this->drained;
+        }
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        stats.pending = this->queue.size();
+        return stats;
+    }
+
+    /**
+     * @brief Replaces the current version of a document and queues the new one.
+     *
+     * The sequence number is assigned and the version queued under the same lock, so the
+     * queue is in sequence order.
+     *
+     * @param url The URL.
+     * @param entry The new version, without sequence number.
+     * @return std::uint64_t The sequence number of the new version.
+     */
+    std::uint64_t DeltaIndex::replace(const std::string& url, Entry entry) {
+        std::uint64_t sequence;
+        {
+            std::unique_lock<std::shared_mutex> lock(this->mutex);
+            sequence = entry.sequence = ++this->nextSequence;
+            auto it = this->documents.find(url);
+            if (it != this->documents.end()) {
+                this->unlink(url, it->second);
+            } else {
+                this->recordShadow(url, true);
+            }
+            for (const auto& term : entry.terms) {
+                this->postings[term.first][url] = term.second;
+            }
+            this->documents[url] = std::move(entry);
+            this->added++;
+
+            std::lock_guard<std::mutex> queueLock(this->queueMutex);
+            this->queue.emplace_back(url, sequence);
+        }
+        this->queued.notify_one();
+        return sequence;
+    }
+
+    /**
+     * @brief Removes the postings of a version; the unique lock must be held.
+     *
+     * @param url The URL.
+     * @param entry The version.
+     */
+    void DeltaIndex::unlink(const std::string& url, const Entry& entry) {
+        for (const auto& term : entry.terms) {
+            auto it = this->postings.find(term.first);
+            if (it == this->postings.end()) {
+                continue;
+            }
+            it->second.erase(url);
+            if (it->second.empty()) {
+                this->postings.erase(it);
+            }
+        }
+    }
+
+    /**
+     * @brief Records a document entering or leaving the delta; the unique lock must be held.
+     *
+     * @param url The URL.
+     * @param shadowed Whether the document entered the delta.
+     */
+    void DeltaIndex::recordShadow(const std::string& url, bool shadowed) {
+        this->shadowChanges.push_back(ShadowChange{++this->shadowVersion, url, shadowed});
+        if (this->shadowChanges.size() > SHADOW_HISTORY) {
+            this->shadowChanges.pop_front();
+        }
+    }
+
+}
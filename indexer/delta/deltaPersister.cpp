@@ -0,0 +1,65 @@
+#include "delta/deltaPersister.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace delta {
+
+    /**
+     * @brief Constructor for the DeltaPersister class; starts the writer thread.
+     *
+     * @param index The delta index to drain.
+     * @param write Writes one version to the database; called on the writer thread only.
+     */
+    DeltaPersister::DeltaPersister(DeltaIndex& index, std::function<void(const PendingDocument&)> write) : index(index), write(std::move(write)) {
+        this->worker = std::thread(&DeltaPersister::run, this);
+    }
+
+    /**
+     * @brief Destructor; stops the writer thread after its current write.
+     */
+    DeltaPersister::~DeltaPersister() {
+        this->stopping = true;
+        this->index.stop();
+        if (this->worker.joinable()) {
+            this->worker.join();
+        }
+    }
+
+    /**
+     * @brief Returns the number of failed writes.
+     *
+     * @return std::uint64_t The writes that threw.
+     */
+    std::uint64_t DeltaPersister::failures() const {
+        return this->failed.load();
+    }
+
+    /**
+     * @brief Writer loop: takes batches and writes them until the index is stopped.
+     *
+     * A version leaves the delta only after its write returned, so a search never misses a
+     * document between the delta and the database, and the write-ahead log keeps it until then.
+     */
+    void DeltaPersister::run() {
+        std::vector<PendingDocument> batch;
+        while (!this->stopping) {
+            if (!this->index.take(batch, PERSIST_BATCH, std::chrono::milliseconds(500))) {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                try {
+                    this->write(batch[i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error persisting " << batch[i].url << ", retrying: " << e.what() << std::endl;
+                    this->failed++;
+                    this->index.requeue(std::vector<PendingDocument>(batch.begin() + i, batch.end()));
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                    break;
+                }
+                this->index.persisted(batch[i].url, batch[i].sequence);
+            }
+        }
+    }
+
+}
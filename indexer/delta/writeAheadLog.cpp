@@ -0,0 +1,524 @@
+#include "delta/writeAheadLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "snapshot/snapshotFormat.hpp"
+
+namespace delta {
+
+    namespace {
+
+        /// Size and CRC-32 of the payload in front of every record.
+        const std::size_t HEADER_BYTES = 8;
+
+        /// Upper bound of a payload, so a corrupt size is not mistaken for a huge record.
+        const std::uint32_t MAX_PAYLOAD = std::uint32_t(1) << 30;
+
+        const char* SEGMENT_PREFIX = "wal-";
+        const char* SEGMENT_SUFFIX = ".log";
+
+        void putU32(std::string& out, std::uint32_t value) {
+            for (int i = 0; i < 4; i++) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+
+        void putU64(std::string& out, std::uint64_t value) {
+            for (int i = 0; i < 8; i++) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+
+        void setU32(std::string& out, std::size_t offset, std::uint32_t value) {
+            for (int i = 0; i < 4; i++) out[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+
+        void putString(std::string& out, const std::string& value) {
+            putU32(out, static_cast<std::uint32_t>(value.size()));
+            out.append(value);
+        }
+
+        /**
+         * @brief Encodes a version without its sequence number, behind room for the record header.
+         *
+         * Payload: deleted (1 byte), docLength (4), URL, term count (4), every term with its
+         * frequency (4), then the sequence number (8), which commit appends. Strings are a
+         * 4-byte length followed by the bytes; all numbers are little-endian.
+         */
+        std::string encode(const std::string& url, bool deleted, int docLength, const std::vector<std::pair<std::string, float>>& terms) {
+            std::size_t size = HEADER_BYTES + 1 + 4 + 4 + url.size() + 4 + 8;
+            for (const auto& term : terms) {
+                size += 8 + term.first.size();
+            }
+            std::string record;
+            record.reserve(size);
+            record.append(HEADER_BYTES, '\0');
+            record.push_back(deleted ? 1 : 0);
+            putU32(record, static_cast<std::uint32_t>(docLength));
+            putString(record, url);
+            putU32(record, static_cast<std::uint32_t>(terms.size()));
+            for (const auto& term : terms) {
+                putString(record, term.first);
+                std::uint32_t bits;
+                std::memcpy(&bits, &term.second, sizeof(bits));
+                putU32(record, bits);
+            }
+            return record;
+        }
+
+        /**
+         * @class RecordReader
+         * @brief Bounds-checked reader of one payload.
+         */
+        class RecordReader {
+        public:
+            RecordReader(const char* data, std::size_t size) : data(data), size(size) {}
+
+            bool u32(std::uint32_t& value) {
+                if (this->size - this->position < 4) return false;
+                value = 0;
+                for (int i = 0; i < 4; i++) value |= static_cast<std::uint32_t>(static_cast<unsigned char>(this->data[this->position++])) << (8 * i);
+                return true;
+            }
+
+            bool u64(std::uint64_t& value) {
+                if (this->size - this->position < 8) return false;
+                value = 0;
+                for (int i = 0; i < 8; i++) value |= static_cast<std::uint64_t>(static_cast<unsigned char>(this->data[this->position++])) << (8 * i);
+                return true;
+            }
+
+            bool byte(unsigned char& value) {
+                if (this->position >= this->size) return false;
+                value = static_cast<unsigned char>(this->data[this->position++]);
+                return true;
+            }
+
+            bool string(std::string& value) {
+                std::uint32_t length;
+                if (!this->u32(length) || this->size - this->position < length) return false;
+                value.assign(this->data + this->position, length);
+                this->position += length;
+                return true;
+            }
+
+            bool done() const { return this->position == this->size; }
+
+        private:
+            const char* data;
+            std::size_t size;
+            std::size_t position = 0;
+        };
+
+        /**
+         * @brief Decodes a payload.
+         *
+         * @return True if the payload is a complete version.
+         */
+        bool decode(const char* data, std::size_t size, PendingDocument& version) {
+            RecordReader reader(data, size);
+            unsigned char deleted;
+            std::uint32_t docLength;
+            std::uint32_t count;
+            if (!reader.byte(deleted) || !reader.u32(docLength) || !reader.string(version.url) || !reader.u32(count)) {
+                return false;
+            }
+            version.deleted = deleted != 0;
+            version.docLength = static_cast<int>(docLength);
+            version.terms.clear();
+            for (std::uint32_t i = 0; i < count; i++) {
+                std::string term;
+                std::uint32_t bits;
+                if (!reader.string(term) || !reader.u32(bits)) {
+                    return false;
+                }
+                float tf;
+                std::memcpy(&tf, &bits, sizeof(tf));
+                version.terms.emplace_back(std::move(term), tf);
+            }
+            return reader.u64(version.sequence) && reader.done();
+        }
+
+        std::uint32_t readU32(const char* data) {
+            std::uint32_t value = 0;
+            for (int i = 0; i < 4; i++) value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+            return value;
+        }
+
+        /**
+         * @brief Returns the number of a segment file name, or false if it is no segment.
+         */
+        bool segmentNumber(const std::string& name, std::uint64_t& number) {
+            std::size_t prefix = std::strlen(SEGMENT_PREFIX);
+            std::size_t suffix = std::strlen(SEGMENT_SUFFIX);
+            if (name.size() <= prefix + suffix || name.compare(0, prefix, SEGMENT_PREFIX) != 0 || name.compare(name.size() - suffix, suffix, SEGMENT_SUFFIX) != 0) {
+                return false;
+            }
+            std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+            if (digits.find_first_not_of("0123456789") != std::string::npos) {
+                return false;
+            }
+            number = std::stoull(digits);
+            return true;
+        }
+
+        /**
+         * @brief Makes a created or deleted file name durable.
+         */
+        void syncDirectory(const std::string& directory) {
+            int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+            if (fd < 0) {
+                throw std::runtime_error("cannot open " + directory + ": " + std::strerror(errno));
+            }
+            int result = fsync(fd);
+            int error = errno;
+            close(fd);
+            if (result != 0) {
+                throw std::runtime_error("cannot sync " + directory + ": " + std::strerror(error));
+            }
+        }
+    }
+
+    /**
+     * @brief Constructor for the WriteAheadLog class; replays the log and starts the flusher thread.
+     *
+     * @param directory The directory of the segment files; created if missing.
+     * @param index The delta index the log belongs to; recovered versions are added to it.
+     * @param groupDelay How long the flusher waits for more appends before a sync; zero syncs at once.
+     * @param segmentBytes The size at which a new segment is started.
+     * @throws std::runtime_error If the directory or a segment cannot be read or written.
+     */
+    WriteAheadLog::WriteAheadLog(const std::string& directory, DeltaIndex& index, std::chrono::microseconds groupDelay, std::size_t segmentBytes)
+        : directory(directory), index(index), groupDelay(groupDelay), segmentBytes(segmentBytes) {
+        if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("cannot create " + directory + ": " + std::strerror(errno));
+        }
+        this->recover();
+        this->flusher = std::thread(&WriteAheadLog::run, this);
+    }
+
+    /**
+     * @brief Destructor; syncs the buffered records and stops the flusher thread.
+     */
+    WriteAheadLog::~WriteAheadLog() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->appended.notify_all();
+        if (this->flusher.joinable()) {
+            this->flusher.join();
+        }
+        if (this->fd >= 0) {
+            close(this->fd);
+        }
+    }
+
+    /**
+     * @brief Adds a document version to the delta and waits until it is logged on disk.
+     *
+     * @param url The URL of the document.
+     * @param terms The terms with their frequency.
+     * @param docLength The length of the document.
+     * @return std::uint64_t The sequence number of the version.
+     * @throws std::runtime_error If the log cannot be written; the version is in the delta nonetheless.
+     */
+    std::uint64_t WriteAheadLog::add(const std::string& url, std::vector<std::pair<std::string, float>> terms, int docLength) {
+        std::string record = encode(url, false, docLength, terms);
+        return this->commit(record, [&]() { return this->index.add(url, std::move(terms), docLength); });
+    }
+
+    /**
+     * @brief Adds a delete of a document to the delta and waits until it is logged on disk.
+     *
+     * @param url The URL of the document.
+     * @return std::uint64_t The sequence number of the delete.
+     * @throws std::runtime_error If the log cannot be written; the delete is in the delta nonetheless.
+     */
+    std::uint64_t WriteAheadLog::remove(const std::string& url) {
+        std::string record = encode(url, true, 0, {});
+        return this->commit(record, [&]() { return this->index.remove(url); });
+    }
+
+    /**
+     * @brief Returns the counters.
+     *
+     * @return WalStats The current counters.
+     */
+    WalStats WriteAheadLog::stats() const {
+        WalStats stats;
+        stats.appends = this->appends.load();
+        stats.syncs = this->syncs.load();
+        stats.bytes = this->bytes.load();
+        stats.segments = this->segments.load();
+        stats.recovered = this->recovered.load();
+        return stats;
+    }
+
+    /**
+     * @brief Assigns a version its sequence number, buffers its record and waits for the sync.
+     *
+     * The CRC of the payload is computed before the lock is taken and only continued over the
+     * sequence number under it.
+     *
+     * @param record The encoded version without its sequence number, behind room for the record header; completed in place.
+     * @param assign Adds the version to the delta and returns its sequence number; called under the lock.
+     * @return std::uint64_t The sequence number.
+     * @throws std::runtime_error If an earlier or this group commit failed.
+     */
+    std::uint64_t WriteAheadLog::commit(std::string& record, const std::function<std::uint64_t()>& assign) {
+        std::uint32_t crc = snapshot::checksum(0, record.data() + HEADER_BYTES, record.size() - HEADER_BYTES);
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (!this->error.empty()) {
+            throw std::runtime_error("write-ahead log failed: " + this->error);
+        }
+        if (this->stopping) {
+            throw std::runtime_error("write-ahead log is closed");
+        }
+        std::uint64_t sequence = assign();
+
+        std::size_t tail = record.size();
+        putU64(record, sequence);
+        crc = snapshot::checksum(crc, record.data() + tail, record.size() - tail);
+        setU32(record, 0, static_cast<std::uint32_t>(record.size() - HEADER_BYTES));
+        setU32(record, 4, crc);
+
+        this->buffer.append(record);
+        this->bufferMaxSequence = sequence;
+        this->appendedBytes += record.size();
+        std::uint64_t ticket = this->appendedBytes;
+        this->appends++;
+        this->appended.notify_one();
+
+        this->synced.wait(lock, [&]() { return this->durableBytes >= ticket || !this->error.empty(); });
+        if (this->durableBytes < ticket) {
+            throw std::runtime_error("write-ahead log failed: " + this->error);
+        }
+        return sequence;
+    }
+
+    /**
+     * @brief Replays the existing segments into the delta and rewrites them as one new segment.
+     *
+     * Segments are read in order up to the first incomplete or corrupt record, which is the
+     * tail of a write cut short by a crash. Of every URL, only the version with the highest
+     * sequence number is replayed, oldest first, after the delta's sequence numbers have been
+     * moved past all logged ones.
+     *
+     * @throws std::runtime_error If a segment cannot be read or the new one cannot be written.
+     */
+    void WriteAheadLog::recover() {
+        std::vector<std::pair<std::uint64_t, std::string>> existing;
+        DIR* dir = opendir(this->directory.c_str());
+        if (!dir) {
+            throw std::runtime_error("cannot read " + this->directory + ": " + std::strerror(errno));
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::uint64_t number;
+            if (segmentNumber(entry->d_name, number)) {
+                existing.emplace_back(number, this->directory + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+        std::sort(existing.begin(), existing.end());
+
+        std::unordered_map<std::string, PendingDocument> latest;
+        std::uint64_t maxSequence = 0;
+        for (const auto& segment : existing) {
+            this->nextSegment = segment.first + 1;
+            std::ifstream file(segment.second, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("cannot open " + segment.second);
+            }
+            std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            std::size_t position = 0;
+            while (data.size() - position >= HEADER_BYTES) {
+                std::uint32_t length = readU32(data.data() + position);
+                std::uint32_t crc = readU32(data.data() + position + 4);
+                const char* payload = data.data() + position + HEADER_BYTES;
+                PendingDocument version;
+                if (length > MAX_PAYLOAD || data.size() - position - HEADER_BYTES < length || snapshot::checksum(0, payload, length) != crc || !decode(payload, length, version)) {
+                    break;
+                }
+                position += HEADER_BYTES + length;
+                maxSequence = std::max(maxSequence, version.sequence);
+                auto it = latest.find(version.url);
+                if (it == latest.end() || it->second.sequence < version.sequence) {
+                    latest[version.url] = std::move(version);
+                }
+            }
+            if (position < data.size()) {
+                std::cerr << "Ignoring " << data.size() - position << " bytes of incomplete records at the end of " << segment.second << std::endl;
+            }
+        }
+
+        std::vector<PendingDocument> versions;
+        versions.reserve(latest.size());
+        for (auto& entry : latest) {
+            versions.push_back(std::move(entry.second));
+        }
+        std::sort(versions.begin(), versions.end(), [](const PendingDocument& a, const PendingDocument& b) { return a.sequence < b.sequence; });
+
+        this->index.advance(maxSequence);
+        std::string rewritten;
+        for (PendingDocument& version : versions) {
+            std::string record = encode(version.url, version.deleted, version.docLength, version.terms);
+            std::uint64_t sequence = version.deleted ? this->index.remove(version.url) : this->index.add(version.url, std::move(version.terms), version.docLength);
+            putU64(record, sequence);
+            setU32(record, 0, static_cast<std::uint32_t>(record.size() - HEADER_BYTES));
+            setU32(record, 4, snapshot::checksum(0, record.data() + HEADER_BYTES, record.size() - HEADER_BYTES));
+            rewritten.append(record);
+            this->openMaxSequence = sequence;
+        }
+
+        this->openSegment();
+        if (!rewritten.empty()) {
+            this->writeAndSync(rewritten);
+        }
+        for (const auto& segment : existing) {
+            if (unlink(segment.second.c_str()) != 0) {
+                throw std::runtime_error("cannot delete " + segment.second + ": " + std::strerror(errno));
+            }
+        }
+        if (!existing.empty()) {
+            syncDirectory(this->directory);
+        }
+        this->recovered = versions.size();
+    }
+
+    /**
+     * @brief Creates the next segment file and makes it the open one.
+     *
+     * @throws std::runtime_error If the file cannot be created.
+     */
+    void WriteAheadLog::openSegment() {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s%020llu%s", SEGMENT_PREFIX, static_cast<unsigned long long>(this->nextSegment++), SEGMENT_SUFFIX);
+        std::string path = this->directory + "/" + name;
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("cannot create " + path + ": " + std::strerror(errno));
+        }
+        syncDirectory(this->directory);
+        this->fd = fd;
+        this->openPath = path;
+        this->openBytes = 0;
+        this->segments++;
+    }
+
+    /**
+     * @brief Writes bytes to the open segment and syncs it.
+     *
+     * @param data The bytes.
+     * @throws std::runtime_error If the write or the sync fails.
+     */
+    void WriteAheadLog::writeAndSync(const std::string& data) {
+        std::size_t written = 0;
+        while (written < data.size()) {
+            ssize_t result = write(this->fd, data.data() + written, data.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("cannot write " + this->openPath + ": " + std::strerror(errno));
+            }
+            written += static_cast<std::size_t>(result);
+        }
+        if (fdatasync(this->fd) != 0) {
+            throw std::runtime_error("cannot sync " + this->openPath + ": " + std::strerror(errno));
+        }
+        this->openBytes += data.size();
+        this->bytes += data.size();
+    }
+
+    /**
+     * @brief Deletes the closed segments whose versions are all older than a watermark.
+     *
+     * @param watermark The oldest version in the delta when the last synced round was taken.
+     */
+    void WriteAheadLog::truncate(std::uint64_t watermark) {
+        auto it = this->closed.begin();
+        while (it != this->closed.end()) {
+            if (it->maxSequence >= watermark) {
+                ++it;
+                continue;
+            }
+            if (unlink(it->path.c_str()) != 0) {
+                std::cerr << "Error deleting " << it->path << ": " << std::strerror(errno) << std::endl;
+                ++it;
+                continue;
+            }
+            this->bytes -= it->bytes;
+            this->segments--;
+            it = this->closed.erase(it);
+        }
+    }
+
+    /**
+     * @brief Flusher loop: writes and syncs the buffered records in groups until stopped.
+     *
+     * The delta's oldest version is sampled under the lock before a round is taken. Every
+     * version that superseded an older one by then is in this round or an earlier one, so
+     * once the round is synced, the segments below the sample can go.
+     */
+    void WriteAheadLog::run() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (true) {
+            this->appended.wait_for(lock, std::chrono::seconds(1), [this]() { return this->stopping || !this->buffer.empty(); });
+            if (this->buffer.empty()) {
+                if (this->stopping) {
+                    break;
+                }
+                // Idle: everything appended is on disk
+                std::uint64_t watermark = this->index.oldestPending();
+                lock.unlock();
+                this->truncate(watermark);
+                lock.lock();
+                continue;
+            }
+            if (this->groupDelay.count() > 0 && !this->stopping) {
+                this->appended.wait_for(lock, this->groupDelay, [this]() { return this->stopping; });
+            }
+
+            std::uint64_t watermark = this->index.oldestPending();
+            std::string batch;
+            batch.swap(this->buffer);
+            std::uint64_t end = this->appendedBytes;
+            std::uint64_t maxSequence = this->bufferMaxSequence;
+            lock.unlock();
+
+            std::string failure;
+            try {
+                this->writeAndSync(batch);
+                this->openMaxSequence = maxSequence;
+                this->syncs++;
+                if (this->openBytes >= this->segmentBytes) {
+                    close(this->fd);
+                    this->fd = -1;
+                    this->closed.push_back(Segment{this->openPath, this->openBytes, this->openMaxSequence});
+                    this->openSegment();
+                }
+                this->truncate(watermark);
+            } catch (const std::exception& e) {
+                std::cerr << "Error writing the write-ahead log: " << e.what() << std::endl;
+                failure = e.what();
+            }
+
+            lock.lock();
+            if (!failure.empty()) {
+                this->error = failure;
+                this->synced.notify_all();
+                break;
+            }
+            this->durableBytes = end;
+            this->synced.notify_all();
+        }
+    }
+
+}
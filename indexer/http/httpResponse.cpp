@@ -0,0 +1,95 @@
+#include <http/httpResponse.hpp>
+#include <sys/socket.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace http {
+
+    namespace {
+
+        // Jet++ keeps the client socket and the added headers private. Naming a private member
+        // in an explicit instantiation is allowed, so these templates hand out pointers to them.
+        template <typename Tag, typename Tag::type Member>
+        struct Expose {
+            friend typename Tag::type get(Tag) { return Member; }
+        };
+
+        struct SocketMember {
+            using type = int jetpp::Response::*;
+            friend type get(SocketMember);
+        };
+
+        struct HeadersMember {
+            using type = std::vector<std::string> jetpp::Response::*;
+            friend type get(HeadersMember);
+        };
+
+        template struct Expose<SocketMember, &jetpp::Response::clientSocket>;
+        template struct Expose<HeadersMember, &jetpp::Response::header>;
+
+        bool sendAll(int fd, const char* data, std::size_t size) {
+            while (size > 0) {
+                ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+                if (sent <= 0) return false;
+                data += sent;
+                size -= static_cast<std::size_t>(sent);
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Returns the reason phrase of a status code.
+     *
+     * @param status The status code.
+     * @return std::string The phrase, e.g. "Service Unavailable"; empty for unknown codes.
+     */
+    std::string reasonPhrase(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 202: return "Accepted";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 409: return "Conflict";
+            case 500: return "Internal Server Error";
+            case 503: return "Service Unavailable";
+            default: return "";
+        }
+    }
+
+    /**
+     * @brief Writes a complete HTTP/1.1 response to a socket.
+     *
+     * @param socket The client socket.
+     * @param status The status code.
+     * @param headers Header lines without line breaks, e.g. "Retry-After: 1".
+     * @param body The response body.
+     * @return True if the whole response was written.
+     */
+    bool writeResponse(int socket, int status, const std::vector<std::string>& headers, const std::string& body) {
+        std::string head = "HTTP/1.1 " + std::to_string(status) + " " + reasonPhrase(status) + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Access-Control-Allow-Origin: *\r\n"
+                           "Connection: close\r\n";
+        for (const std::string& header : headers) {
+            head += header + "\r\n";
+        }
+        head += "\r\n";
+        return sendAll(socket, head.data(), head.size()) && sendAll(socket, body.data(), body.size());
+    }
+
+    /**
+     * @brief Sends the response of a Jet++ handler with the given status.
+     *
+     * @param res The response of the handler.
+     * @param status The status code.
+     * @param body The response body.
+     * @return True if the whole response was written.
+     */
+    bool send(jetpp::Response& res, int status, const std::string& body) {
+        return writeResponse(res.*get(SocketMember()), status, res.*get(HeadersMember()), body);
+    }
+
+}
@@ -0,0 +1,99 @@
+#include <http/queryString.hpp>
+#include <cctype>
+
+namespace http {
+
+    /**
+     * @brief Percent-encodes a query string value.
+     *
+     * @param value The raw value.
+     * @return std::string The encoded value; everything but letters, digits and "-_.~" is escaped, '+' included.
+     */
+    std::string urlEncode(const std::string& value) {
+        static const char hex[] = "0123456789ABCDEF";
+        std::string encoded;
+        for (unsigned char c : value) {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+                encoded.push_back(static_cast<char>(c));
+            } else {
+                encoded.push_back('%');
+                encoded.push_back(hex[c >> 4]);
+                encoded.push_back(hex[c & 0xF]);
+            }
+        }
+        return encoded;
+    }
+
+    /**
+     * @brief Decodes the percent escapes of a query string value.
+     *
+     * Jet++ hands out query values as they arrived, so handlers decode them themselves.
+     *
+     * @param value The encoded value.
+     * @return std::string The decoded value; '+' and malformed escapes are kept as they are.
+     */
+    std::string urlDecode(const std::string& value) {
+        auto hexValue = [](char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        std::string decoded;
+        decoded.reserve(value.size());
+        for (std::size_t i = 0; i < value.size(); i++) {
+            int high = value[i] == '%' && i + 2 < value.size() ? hexValue(value[i + 1]) : -1;
+            int low = high >= 0 ? hexValue(value[i + 2]) : -1;
+            if (low >= 0) {
+                decoded.push_back(static_cast<char>(high * 16 + low));
+                i += 2;
+            } else {
+                decoded.push_back(value[i]);
+            }
+        }
+        return decoded;
+    }
+
+    /**
+     * @brief Percent-encodes the terms of a '+'-separated query.
+     *
+     * @param query The query, e.g. a normalized search query string.
+     * @return std::string Every term encoded on its own, joined by unescaped '+'.
+     */
+    std::string encodeTerms(const std::string& query) {
+        std::string encoded;
+        std::size_t start = 0;
+        while (true) {
+            std::size_t plus = query.find('+', start);
+            encoded += urlEncode(query.substr(start, plus == std::string::npos ? std::string::npos : plus - start));
+            if (plus == std::string::npos) break;
+            encoded.push_back('+');
+            start = plus + 1;
+        }
+        return encoded;
+    }
+
+    /**
+     * @brief Decodes a query encoded by encodeTerms.
+     *
+     * The value is split at its unescaped '+' before the terms are decoded, so an escaped '+'
+     * never separates terms on the wire. The terms of a normalized query hold no '+', since
+     * normalizeQuery splits at it, so joining them again loses nothing.
+     *
+     * @param value The encoded query.
+     * @return std::string The decoded terms, joined by '+'.
+     */
+    std::string decodeTerms(const std::string& value) {
+        std::string decoded;
+        std::size_t start = 0;
+        while (true) {
+            std::size_t plus = value.find('+', start);
+            decoded += urlDecode(value.substr(start, plus == std::string::npos ? std::string::npos : plus - start));
+            if (plus == std::string::npos) break;
+            decoded.push_back('+');
+            start = plus + 1;
+        }
+        return decoded;
+    }
+
+}
@@ -0,0 +1,134 @@
+#include <impact/impact.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace impact {
+
+    /**
+     * @brief Calculates the Inverse Document Frequency (IDF) score.
+     *
+     * @param totalDocuments The total number of documents in the corpus.
+     * @param appearances The number of documents in which the term appears.
+     * @return float The IDF score.
+     */
+    float idf(std::int64_t totalDocuments, std::int64_t appearances) {
+        if (appearances <= 0) {
+            return 0;
+        }
+        return static_cast<float>(1 + std::log(totalDocuments / appearances));
+    }
+
+    /**
+     * @brief Calculates the BM25 score of a term in a document.
+     *
+     * @param docLength The length of the document.
+     * @param avgDocLength The average document length; values below 1 disable length normalization.
+     * @param idf The IDF score of the term.
+     * @param tf The term frequency in the document.
+     * @param k1 The BM25 k1 parameter.
+     * @param b The BM25 b parameter.
+     * @return float The BM25 score.
+     */
+    float bm25(int docLength, float avgDocLength, float idf, float tf, float k1, float b) {
+        float relativeLength = avgDocLength >= 1 ? static_cast<float>(docLength) / avgDocLength : 1.0f;
+        return idf * ((tf * (k1 + 1)) / (tf + k1 * (1 - b + b * relativeLength)));
+    }
+
+    /**
+     * @brief Combines TF-IDF and BM25 scores into the total ranking score.
+     *
+     * @param tfIdf The TF-IDF score.
+     * @param bm25 The BM25 score.
+     * @return float The combined score.
+     */
+    float combine(float tfIdf, float bm25) {
+        // Weights for the ranking components
+        float weightTfIdf = 0.3;
+        float weightBM25 = 0.7;
+
+        return tfIdf * weightTfIdf + bm25 * weightBM25;
+    }
+
+    /**
+     * @brief Computes the combined score of a single posting.
+     *
+     * @param tf The term frequency in the document.
+     * @param docLength The length of the document.
+     * @param idf The IDF score of the term.
+     * @param avgDocLength The average document length.
+     * @return float The combined score.
+     */
+    float postingScore(float tf, int docLength, float idf, float avgDocLength) {
+        return combine(tf * idf, bm25(docLength, avgDocLength, idf, tf, K1, B));
+    }
+
+    /**
+     * @brief Quantizes a combined score to a 16 bit impact.
+     *
+     * @param score The combined score.
+     * @return std::uint16_t The impact, rounded and clamped to [0, MAX_IMPACT].
+     */
+    std::uint16_t quantize(float score) {
+        float scaled = std::round(score * IMPACT_SCALE);
+        if (!(scaled > 0)) {
+            return 0;
+        }
+        return static_cast<std::uint16_t>(std::min(scaled, static_cast<float>(MAX_IMPACT)));
+    }
+
+    /**
+     * @brief Converts a sum of impacts back to a combined score.
+     *
+     * @param impacts The summed impacts of a document.
+     * @return float The approximate combined score.
+     */
+    float dequantize(std::uint64_t impacts) {
+        return static_cast<float>(impacts) / IMPACT_SCALE;
+    }
+
+    /**
+     * @brief Rescales the impacts of a term, e.g. to replace the IDF they were computed with.
+     *
+     * Scaling is monotonic, so impact-ordered postings stay impact-ordered.
+     *
+     * @param postings The postings of the term.
+     * @param factor The scale factor.
+     */
+    void rescale(std::vector<ImpactPosting>& postings, float factor) {
+        if (factor == 1.0f) {
+            return;
+        }
+        for (ImpactPosting& posting : postings) {
+            float scaled = std::round(posting.impact * factor);
+            posting.impact = !(scaled > 0) ? 0 : static_cast<std::uint16_t>(std::min(scaled, static_cast<float>(MAX_IMPACT)));
+        }
+    }
+
+    /**
+     * @brief Sorts postings by impact, highest first, and by URL within the same impact.
+     *
+     * @param postings The postings to sort in place.
+     */
+    void sortByImpact(std::vector<ImpactPosting>& postings) {
+        std::sort(postings.begin(), postings.end(), [](const ImpactPosting& a, const ImpactPosting& b) {
+            return a.impact != b.impact ? a.impact > b.impact : a.url < b.url;
+        });
+    }
+
+    /**
+     * @brief Checks whether the corpus changed enough for the stored impacts to be recomputed.
+     *
+     * @param indexed The statistics the impacts were computed with.
+     * @param currentDocuments The current number of documents.
+     * @param threshold The allowed relative change.
+     * @return True if the impacts are missing or out of date.
+     */
+    bool drifted(const CorpusStats& indexed, std::int64_t currentDocuments, double threshold) {
+        if (indexed.totalDocuments <= 0) {
+            return currentDocuments > 0;
+        }
+        double change = std::fabs(static_cast<double>(currentDocuments - indexed.totalDocuments)) / indexed.totalDocuments;
+        return change > threshold;
+    }
+
+}
@@ -0,0 +1,104 @@
+#ifndef BULKBUILDER_HPP
+#define BULKBUILDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "impact/impact.hpp"
+
+namespace bulk {
+
+    /// Terms of one shard written to MongoDB per bulk write.
+    const std::size_t LOAD_BATCH_TERMS = 1000;
+
+    /**
+     * @struct BulkOptions
+     * @brief Input, outputs and resources of a bulk build.
+     */
+    struct BulkOptions {
+        std::string input;                          ///< JSONL dump of {"url", "content"} objects.
+        std::string snapshotDirectory;              ///< Directory the shard snapshots are written to; empty writes none.
+        bool load = true;                           ///< Whether the index, impacts and statistics are loaded into MongoDB.
+        std::size_t shards = 1;                     ///< Shards the index is partitioned into.
+        std::size_t threads = 1;                    ///< Tokenizer threads.
+        std::size_t loaders = 2;                    ///< Threads writing to MongoDB during the merge.
+        std::size_t memoryBytes = std::size_t(2) << 30; ///< Budget of the partial indexes of all threads together.
+        std::string tempDirectory = ".";            ///< Directory of the sorted runs spilled when the budget is exceeded.
+    };
+
+    /**
+     * @struct BulkStats
+     * @brief Outcome of a bulk build.
+     */
+    struct BulkStats {
+        std::uint64_t documents = 0;        ///< Documents indexed.
+        std::uint64_t duplicates = 0;       ///< Earlier lines of a URL that occurs again; the last one is indexed.
+        std::uint64_t invalid = 0;          ///< Non-empty lines without a URL and content.
+        std::uint64_t terms = 0;            ///< Distinct terms.
+        std::uint64_t postings = 0;         ///< Postings over all terms.
+        std::uint64_t runs = 0;             ///< Sorted runs spilled to disk.
+        impact::CorpusStats stats;          ///< Corpus statistics the impacts were computed with.
+        std::vector<std::string> snapshots; ///< Paths of the written snapshots, by shard.
+        double tokenizeSeconds = 0;         ///< Duration of the tokenize phase.
+        double mergeSeconds = 0;            ///< Duration of the merge and write phase.
+    };
+
+    /**
+     * @class BulkBuilder
+     * @brief Builds the whole index offline from a JSONL dump.
+     *
+     * The tokenize phase splits the mapped dump into one range of lines per thread. Every
+     * thread tokenizes its documents with the Indexer's tokenizer into a partial inverted
+     * index of its own; once the partial index exceeds the thread's share of the memory
+     * budget, it is written to a run file sorted by term and cleared.
+     *
+     * When all documents are read, the corpus statistics are final. The merge phase reads
+     * the runs and the remaining partial indexes in term order, so every term's complete
+     * posting list is assembled once: its impacts are computed with the final statistics,
+     * appended to the snapshot of every shard it occurs in, and handed in batches to loader
+     * threads that replace the term and impact documents in MongoDB with bulk writes. The
+     * statistics are stored last, after every term has been written.
+     */
+    class BulkBuilder {
+    public:
+        /**
+         * @brief Constructor for the BulkBuilder class.
+         *
+         * @param options The options.
+         */
+        explicit BulkBuilder(BulkOptions options);
+
+        /**
+         * @brief Destructor; removes the run files.
+         */
+        ~BulkBuilder();
+
+        BulkBuilder(const BulkBuilder&) = delete;
+        BulkBuilder& operator=(const BulkBuilder&) = delete;
+
+        /**
+         * @brief Runs the build.
+         *
+         * @return BulkStats The outcome.
+         */
+        BulkStats run();
+
+        /**
+         * @brief Returns the path of the snapshot of a shard.
+         *
+         * @param directory The snapshot directory.
+         * @param shard The shard.
+         * @param shards The number of shards.
+         * @return std::string directory/index-<shard>-of-<shards>.snapshot.
+         */
+        static std::string snapshotPath(const std::string& directory, std::size_t shard, std::size_t shards);
+
+    private:
+        BulkOptions options;                ///< The options.
+        std::vector<std::string> runFiles;  ///< Run files written so far.
+    };
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef CORPUSDUMP_HPP
+#define CORPUSDUMP_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bulk {
+
+    /**
+     * @class CorpusDump
+     * @brief A JSONL dump of documents, one {"url": ..., "content": ...} object per line, mapped into memory.
+     *
+     * The file is mapped read-only and advised for sequential access, so every reader thread
+     * streams its own byte range straight from the page cache without copying it.
+     */
+    class CorpusDump {
+    public:
+        /**
+         * @brief Constructor for the CorpusDump class; maps the file.
+         *
+         * @param path The path of the dump.
+         */
+        explicit CorpusDump(const std::string& path);
+
+        /**
+         * @brief Destructor; unmaps the file.
+         */
+        ~CorpusDump();
+
+        CorpusDump(const CorpusDump&) = delete;
+        CorpusDump& operator=(const CorpusDump&) = delete;
+
+        /**
+         * @brief Returns the mapped bytes.
+         *
+         * @return std::string_view The whole file.
+         */
+        std::string_view data() const { return std::string_view(this->bytes, this->size); }
+
+        /**
+         * @brief Splits the file into ranges of whole lines of about equal size.
+         *
+         * @param parts The number of ranges.
+         * @return std::vector<std::pair<std::size_t, std::size_t>> The [begin, end) byte ranges, in file order; some may be empty.
+         */
+        std::vector<std::pair<std::size_t, std::size_t>> split(std::size_t parts) const;
+
+        /**
+         * @brief Reads the URL and content of one line.
+         *
+         * Other members are skipped, whatever their type, so exports with an "_id" are accepted.
+         *
+         * @param line The line, without the newline.
+         * @param url Receives the URL.
+         * @param content Receives the content.
+         * @return True if the line is an object with string "url" and "content" members.
+         */
+        static bool parseLine(std::string_view line, std::string& url, std::string& content);
+
+    private:
+        const char* bytes = nullptr;    ///< The mapping; null for an empty file.
+        std::size_t size = 0;           ///< Size of the file.
+    };
+
+}
+
+#endif
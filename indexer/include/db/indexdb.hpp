@@ -8,6 +8,9 @@
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/uri.hpp>
+#include <bsoncxx/document/view.hpp>
+#include "impact/impact.hpp"
+#include "snapshot/snapshotFormat.hpp"
 
 namespace indexer_db {
 
@@ -24,6 +27,28 @@ namespace indexer_db {
         int docLength;      ///< Length of the document.
     };
 
+    /**
+     * @struct Fingerprint
+     * @brief The SimHash of an indexed document and, for a near-duplicate, its canonical document.
+     */
+    struct Fingerprint {
+        std::string url;            ///< URL of the document.
+        std::uint64_t simHash = 0;  ///< SimHash of its term frequencies.
+        std::string canonical;      ///< URL of the document it duplicates; empty for a canonical document.
+        std::vector<std::pair<std::string, float>> terms; ///< Terms with their term frequencies, kept for an alias only.
+        int docLength = 0;          ///< Length of the document, kept for an alias only.
+    };
+
+    /**
+     * @struct TermPostings
+     * @brief All postings of a term in one shard, as written by a bulk load.
+     */
+    struct TermPostings {
+        std::string term;                               ///< The term.
+        std::vector<IndexDocument> documents;           ///< Postings of the term.
+        std::vector<impact::ImpactPosting> impacts;     ///< The same postings with their impacts, highest first.
+    };
+
     /**
      * @class IndexerDB
      * @brief A class to interact with the index database.
@@ -50,10 +75,123 @@ namespace indexer_db {
         /**
          * @brief Upserts (updates or inserts) an index document for a specific term.
          * 
+         * The impact-ordered postings of the term are rewritten as well, once corpus statistics exist.
+         * 
          * @param document The document to be indexed.
          * @param term The term for which the document is being indexed.
+         * @param stats The corpus statistics the impacts are computed with.
+         * @throws std::exception If reading or writing the term fails.
+         */
+        void upsertIndexDocument(const IndexDocument& document, std::string term, const impact::CorpusStats& stats);
+
+        /**
+         * @brief Removes the postings of a document from every term except the given ones.
+         * 
+         * @param url The URL of the document.
+         * @param keep The terms whose postings stay; empty removes every posting.
+         * @throws std::exception If a write fails.
+         */
+        void removePostings(const std::string& url, const std::vector<std::string>& keep);
+
+        /**
+         * @brief Gets the corpus statistics of the last impact refresh.
+         * 
+         * @return The statistics, with totalDocuments 0 if impacts were never refreshed.
+         */
+        impact::CorpusStats getCorpusStats();
+
+        /**
+         * @brief Counts the documents of the corpus.
+         * 
+         * @return The number of documents in the "websites" collection.
+         */
+        std::int64_t countDocuments();
+
+        /**
+         * @brief Stores the fingerprint of a document, replacing an earlier one of the same URL.
+         * 
+         * @param fingerprint The fingerprint; a non-empty canonical records the document as an alias.
+         * @throws std::exception If the write fails.
+         */
+        void upsertFingerprint(const Fingerprint& fingerprint);
+
+        /**
+         * @brief Removes the fingerprint of a document.
+         * 
+         * @param url The URL of the document.
+         * @throws std::exception If the write fails.
          */
-        void upsertIndexDocument(const IndexDocument& document, std::string term);
+        void removeFingerprint(const std::string& url);
+
+        /**
+         * @brief Reads the aliases of a canonical document.
+         * 
+         * @param canonical The URL of the canonical document.
+         * @return The fingerprints of its aliases, with their terms.
+         * @throws std::exception If the read fails.
+         */
+        std::vector<Fingerprint> getAliases(const std::string& canonical);
+
+        /**
+         * @brief Reads the fingerprints of all canonical documents.
+         * 
+         * @return The fingerprints without a canonical document.
+         */
+        std::vector<Fingerprint> getCanonicalFingerprints();
+
+        /**
+         * @brief Recomputes the corpus statistics and the impacts of every term.
+         * 
+         * The new statistics are stored after all impacts have been written.
+         * 
+         * @return The new corpus statistics.
+         */
+        impact::CorpusStats refreshImpacts();
+
+        /**
+         * @brief Replaces the term and impact documents of many terms of a shard with unordered bulk writes.
+         * 
+         * @param terms The complete postings of every term.
+         * @param shard The shard the postings belong to.
+         * @param stats The corpus statistics the impacts were computed with.
+         * @param updatedMs The "updatedMs" stamp of the term documents.
+         * @throws std::runtime_error On database errors.
+         */
+        void loadTerms(const std::vector<TermPostings>& terms, std::size_t shard, const impact::CorpusStats& stats, std::int64_t updatedMs);
+
+        /**
+         * @brief Stores the corpus statistics the impacts were computed with.
+         * 
+         * @param stats The statistics.
+         */
+        void storeCorpusStats(const impact::CorpusStats& stats);
+
+        /**
+         * @brief Exports the term dictionary, postings, document table and corpus statistics of a shard into a snapshot file.
+         * 
+         * @param path The path of the snapshot; replaced atomically.
+         * @param shard The shard to export.
+         * @return The header of the written snapshot.
+         * @throws std::runtime_error On database or write errors.
+         */
+        snapshot::SnapshotHeader exportSnapshot(const std::string& path, std::size_t shard);
+
+        /**
+         * @brief Sets the number of shards the index is partitioned into.
+         * 
+         * Called once at startup, before any document is indexed. Every document goes to the
+         * "index" and "impacts" collections of the shard its URL hashes to.
+         * 
+         * @param shards The number of shards; 1 writes the unsharded collections.
+         */
+        static void useShards(std::size_t shards);
+
+        /**
+         * @brief Returns the number of shards the index is partitioned into.
+         * 
+         * @return The number of shards.
+         */
+        static std::size_t shardCount();
 
     private:
         std::shared_ptr<mongocxx::client> client; ///< Shared pointer to the MongoDB client.
@@ -62,9 +200,28 @@ namespace indexer_db {
          * @brief Retrieves documents that contain a specific term from the database.
          * 
          * @param term The search term.
+         * @param shard The shard whose postings are read.
          * @return A vector of IndexDocument structures containing documents that include the term.
          */
-        std::vector<IndexDocument> getTermDocuments(std::string term);
+        std::vector<IndexDocument> getTermDocuments(std::string term, std::size_t shard);
+
+        /**
+         * @brief Writes the impact-ordered postings of a term.
+         * 
+         * @param term The term.
+         * @param documents All postings of the term.
+         * @param stats The corpus statistics the impacts are computed with.
+         * @param shard The shard the postings belong to.
+         */
+        void writeImpacts(const std::string& term, const std::vector<IndexDocument>& documents, const impact::CorpusStats& stats, std::size_t shard);
+
+        /**
+         * @brief Decodes the postings array of a term document.
+         * 
+         * @param termDoc The term document.
+         * @return The valid postings of the term.
+         */
+        static std::vector<IndexDocument> decodePostings(bsoncxx::document::view termDoc);
     };
 
 }
@@ -0,0 +1,162 @@
+#ifndef DUPLICATEDETECTOR_HPP
+#define DUPLICATEDETECTOR_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dedup {
+
+    /// Largest supported Hamming threshold; the table has threshold + 1 bands of at least 8 bits.
+    const unsigned MAX_DISTANCE = 7;
+
+    /// Documents with fewer distinct terms are never treated as duplicates; their fingerprints are too noisy.
+    const std::size_t MIN_TERMS = 8;
+
+    /**
+     * @enum DuplicateAction
+     * @brief What the indexer does with a near-duplicate document.
+     */
+    enum class DuplicateAction {
+        Off,    ///< Index every document fully.
+        Skip,   ///< Drop the duplicate.
+        Alias   ///< Record the duplicate as an alias of its canonical document instead of indexing its terms.
+    };
+
+    /**
+     * @brief Parses a duplicate action.
+     *
+     * @param name "off", "skip" or "alias".
+     * @return DuplicateAction The action.
+     * @throws std::invalid_argument For any other name.
+     */
+    DuplicateAction parseAction(const std::string& name);
+
+    /**
+     * @struct DuplicateStats
+     * @brief Snapshot of the counters of a DuplicateDetector.
+     */
+    struct DuplicateStats {
+        std::size_t documents = 0;      ///< Canonical documents held.
+        std::uint64_t checked = 0;      ///< Documents checked.
+        std::uint64_t duplicates = 0;   ///< Documents found to be near-duplicates.
+        std::uint64_t candidates = 0;   ///< Fingerprints compared, over all checks.
+    };
+
+    /**
+     * @class DuplicateDetector
+     * @brief Finds documents whose SimHash lies within a Hamming threshold of a known document.
+     *
+     * The fingerprints are split into threshold + 1 bands. Two fingerprints at most threshold
+     * bits apart agree on at least one band, so a lookup only compares the fingerprints that
+     * share a band value with the new one: one hash table per band, keyed by the band's bits.
+     * Only canonical documents are held, so duplicates never chain.
+     *
+     * All methods may be called concurrently.
+     */
+    class DuplicateDetector {
+    public:
+        /**
+         * @brief Constructor for the DuplicateDetector class.
+         *
+         * @param maxDistance The Hamming threshold, 1 to MAX_DISTANCE.
+         * @throws std::invalid_argument If the threshold is out of range.
+         */
+        explicit DuplicateDetector(unsigned maxDistance);
+
+        DuplicateDetector(const DuplicateDetector&) = delete;
+        DuplicateDetector& operator=(const DuplicateDetector&) = delete;
+
+        /**
+         * @brief Adds or updates a canonical document.
+         *
+         * @param url The URL of the document.
+         * @param fingerprint Its SimHash.
+         */
+        void add(const std::string& url, std::uint64_t fingerprint);
+
+        /**
+         * @brief Forgets a deleted document.
+         *
+         * @param url The URL of the document.
+         */
+        void erase(const std::string& url);
+
+        /**
+         * @brief Checks whether a document nearly duplicates a canonical document.
+         *
+         * The document itself is not matched, so a re-indexed document that now duplicates
+         * another one is reported. Nothing is registered; the caller adds or erases the URL
+         * once its fingerprint is stored.
+         *
+         * @param url The URL of the document.
+         * @param fingerprint Its SimHash.
+         * @param canonical Receives the URL of the closest known document if it is a duplicate.
+         * @return True if the document is a near-duplicate.
+         */
+        bool check(const std::string& url, std::uint64_t fingerprint, std::string& canonical);
+
+        /**
+         * @brief Checks whether a URL is held as a canonical document.
+         *
+         * @param url The URL of the document.
+         * @return True if the URL is held.
+         */
+        bool contains(const std::string& url) const;
+
+        /**
+         * @brief Returns the Hamming threshold.
+         *
+         * @return unsigned The largest distance reported as duplicate.
+         */
+        unsigned maxDistance() const { return this->distance; }
+
+        /**
+         * @brief Returns the counters.
+         *
+         * @return DuplicateStats The current counters.
+         */
+        DuplicateStats stats() const;
+
+    private:
+        /**
+         * @struct Band
+         * @brief A bit range of the fingerprints with the documents by its value.
+         */
+        struct Band {
+            unsigned shift = 0;                                                 ///< First bit.
+            std::uint64_t mask = 0;                                             ///< Mask of the band after shifting.
+            std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> documents; ///< Document indexes by band value.
+        };
+
+        unsigned distance;                                      ///< The Hamming threshold.
+        mutable std::mutex mutex;                               ///< Guards everything below.
+        std::vector<Band> bands;                                ///< distance + 1 bands covering all 64 bits.
+        std::vector<std::string> urls;                          ///< URL by document index; empty once removed.
+        std::vector<std::uint64_t> fingerprints;                ///< Fingerprint by document index.
+        std::unordered_map<std::string, std::uint32_t> indexes; ///< Document index by URL.
+        std::uint64_t checked = 0;                              ///< check calls.
+        std::uint64_t duplicates = 0;                           ///< Duplicates found.
+        std::uint64_t candidates = 0;                           ///< Fingerprints compared.
+
+        /**
+         * @brief Inserts a document into the bands; the lock must be held.
+         *
+         * @param url The URL.
+         * @param fingerprint The fingerprint.
+         */
+        void insert(const std::string& url, std::uint64_t fingerprint);
+
+        /**
+         * @brief Removes a document from the bands; the lock must be held.
+         *
+         * @param url The URL.
+         */
+        void remove(const std::string& url);
+    };
+
+}
+
+#endif
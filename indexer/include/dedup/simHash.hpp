@@ -0,0 +1,45 @@
+#ifndef SIMHASH_HPP
+#define SIMHASH_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace dedup {
+
+    /**
+     * @brief Hashes a term to 64 bits, identically on every platform and in every process.
+     *
+     * Fingerprints are stored in the database, so std::hash, which may differ between
+     * builds, cannot be used.
+     *
+     * @param term The term.
+     * @return std::uint64_t FNV-1a of the term with a final avalanche step.
+     */
+    std::uint64_t hashTerm(std::string_view term);
+
+    /**
+     * @brief Computes the 64-bit SimHash of a document from its term frequencies.
+     *
+     * Every term votes on each bit with a weight growing with its frequency, for the bit if it is set in the term's
+     * hash and against it otherwise; the fingerprint has the bits that won. Documents sharing
+     * most of their weighted terms get fingerprints a few bits apart.
+     *
+     * @param terms The terms of the document with their frequencies; empty terms are ignored.
+     * @return std::uint64_t The fingerprint.
+     */
+    std::uint64_t simHash(const std::unordered_map<std::string, int>& terms);
+
+    /**
+     * @brief Counts the bits two fingerprints differ in.
+     *
+     * @param a The first fingerprint.
+     * @param b The second fingerprint.
+     * @return unsigned The Hamming distance, 0 to 64.
+     */
+    unsigned hammingDistance(std::uint64_t a, std::uint64_t b);
+
+}
+
+#endif
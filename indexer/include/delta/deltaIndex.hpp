@@ -0,0 +1,247 @@
+#ifndef DELTAINDEX_HPP
+#define DELTAINDEX_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace delta {
+
+    /// Changes to the set of documents in the delta that are kept for incremental lookups.
+    const std::size_t SHADOW_HISTORY = 65536;
+
+    /**
+     * @struct DeltaPosting
+     * @brief A posting of a document that has not been persisted yet.
+     */
+    struct DeltaPosting {
+        std::string url;    ///< URL of the document.
+        float tf;           ///< Term frequency of the term in the document.
+        int docLength;      ///< Length of the document.
+    };
+
+    /**
+     * @struct PendingDocument
+     * @brief A document version waiting to be written to the database.
+     */
+    struct PendingDocument {
+        std::string url;                                    ///< URL of the document.
+        std::uint64_t sequence = 0;                         ///< Sequence number of this version.
+        bool deleted = false;                               ///< Whether the version is a delete.
+        int docLength = 0;                                  ///< Length of the document.
+        std::vector<std::pair<std::string, float>> terms;   ///< Terms with their frequency; empty for a delete.
+    };
+
+    /**
+     * @struct DeltaLookup
+     * @brief The delta's postings of some terms and the documents it shadows.
+     */
+    struct DeltaLookup {
+        std::uint64_t sequence = 0;                     ///< Last sequence number assigned when the lookup ran.
+        std::uint64_t epoch = 0;                        ///< Identifies the delta index; versions of another instance do not apply.
+        std::uint64_t shadowVersion = 0;                ///< Version of the set of documents in the delta when the lookup ran.
+        bool full = true;                               ///< Whether shadowed is the whole set rather than the changes since the requested version.
+        std::vector<std::vector<DeltaPosting>> terms;   ///< Postings of every requested term, in request order.
+        std::vector<std::string> shadowed;              ///< Documents in the delta, or those that entered it since the requested version; their persisted postings are outdated.
+        std::vector<std::string> unshadowed;            ///< Documents that left the delta since the requested version; empty if full.
+    };
+
+    /**
+     * @struct DeltaStats
+     * @brief Snapshot of the state and counters of a DeltaIndex.
+     */
+    struct DeltaStats {
+        std::size_t documents = 0;      ///< Documents in the delta, deletes included.
+        std::size_t terms = 0;          ///< Distinct terms with postings in the delta.
+        std::size_t pending = 0;        ///< Versions queued for persistence.
+        std::uint64_t added = 0;        ///< Versions added, deletes included.
+        std::uint64_t persisted = 0;    ///< Versions drained after being persisted.
+    };
+
+    /**
+     * @class DeltaIndex
+     * @brief In-memory index of the documents indexed since their last write to the database.
+     *
+     * Every added document or delete gets a sequence number, replaces an earlier version of
+     * the same URL in the delta and is queued for persistence. The searchers look up the
+     * delta's postings next to the persisted ones and drop the persisted postings of every
+     * document the delta holds, so updates and deletes take effect immediately. Once a
+     * version has been written, it leaves the delta, unless a newer version has arrived.
+     *
+     * Every document entering or leaving the delta bumps the shadow version, and the last
+     * SHADOW_HISTORY such changes are kept, so a searcher holding the set of an earlier
+     * version only receives what changed since.
+     *
+     * Lookups may run concurrently with each other and with writes.
+     */
+    class DeltaIndex {
+    public:
+        /**
+         * @brief Constructor for the DeltaIndex class.
+         *
+         * @param shards The number of shards the URLs are partitioned into.
+         */
+        explicit DeltaIndex(std::size_t shards = 1);
+
+        DeltaIndex(const DeltaIndex&) = delete;
+        DeltaIndex& operator=(const DeltaIndex&) = delete;
+
+        /**
+         * @brief Adds a document version.
+         *
+         * @param url The URL of the document.
+         * @param terms The terms with their frequency.
+         * @param docLength The length of the document.
+         * @return std::uint64_t The sequence number of the version.
+         */
+        std::uint64_t add(const std::string& url, std::vector<std::pair<std::string, float>> terms, int docLength);
+
+        /**
+         * @brief Adds a delete of a document.
+         *
+         * @param url The URL of the document.
+         * @return std::uint64_t The sequence number of the delete.
+         */
+        std::uint64_t remove(const std::string& url);
+
+        /**
+         * @brief Looks up the postings of terms in one shard.
+         *
+         * @param terms The terms.
+         * @param shard The shard whose documents are returned.
+         * @param epoch The epoch of the caller's set of shadowed documents; 0 if it has none.
+         * @param since The shadow version of the caller's set.
+         * @return DeltaLookup The postings and the changes to the shadowed documents of the shard since the caller's version, or all of them.
+         */
+        DeltaLookup lookup(const std::vector<std::string>& terms, std::size_t shard, std::uint64_t epoch = 0, std::uint64_t since = 0) const;
+
+        /**
+         * @brief Waits for queued versions and takes them for persistence.
+         *
+         * Versions superseded while queued are skipped; the newer version is queued as well.
+         *
+         * @param batch Receives up to max versions, oldest first.
+         * @param max The maximum number of versions.
+         * @param wait How long to wait for the first version.
+         * @return True if versions were taken; false on timeout or once stopped.
+         */
+        bool take(std::vector<PendingDocument>& batch, std::size_t max, std::chrono::milliseconds wait);
+
+        /**
+         * @brief Drops a version from the delta after it was written, unless it has been superseded.
+         *
+         * Only call this once the database confirmed the write: the write-ahead log deletes
+         * the records of versions that left the delta.
+         *
+         * @param url The URL of the document.
+         * @param sequence The sequence number of the written version.
+         */
+        void persisted(const std::string& url, std::uint64_t sequence);
+
+        /**
+         * @brief Puts versions back at the front of the queue after a failed write.
+         *
+         * @param batch The versions, oldest first.
+         */
+        void requeue(const std::vector<PendingDocument>& batch);
+
+        /**
+         * @brief Wakes the waiting take calls and makes them return false.
+         */
+        void stop();
+
+        /**
+         * @brief Returns the oldest sequence number still waiting to be persisted.
+         *
+         * Every version with a lower sequence number has been written or superseded by a newer one.
+         *
+         * @return std::uint64_t The lowest sequence number in the delta, or the next one to be assigned if it is empty.
+         */
+        std::uint64_t oldestPending() const;
+
+        /**
+         * @brief Continues the sequence numbers after the given one, so recovered versions order after the logged ones.
+         *
+         * @param sequence The highest sequence number assigned before a restart.
+         */
+        void advance(std::uint64_t sequence);
+
+        /**
+         * @brief Returns the state and counters.
+         *
+         * @return DeltaStats The current state.
+         */
+        DeltaStats stats() const;
+
+    private:
+        /**
+         * @struct Entry
+         * @brief The current version of a document in the delta.
+         */
+        struct Entry {
+            std::uint64_t sequence = 0;                         ///< Sequence number of the version.
+            bool deleted = false;                               ///< Whether the version is a delete.
+            int docLength = 0;                                  ///< Length of the document.
+            std::vector<std::pair<std::string, float>> terms;   ///< Terms with their frequency.
+        };
+
+        /**
+         * @struct ShadowChange
+         * @brief A document entering or leaving the delta.
+         */
+        struct ShadowChange {
+            std::uint64_t version;  ///< Shadow version after the change.
+            std::string url;        ///< URL of the document.
+            bool shadowed;          ///< Whether the document entered the delta.
+        };
+
+        std::size_t shards;                                                             ///< Shards the URLs are partitioned into.
+        mutable std::shared_mutex mutex;                                                ///< Guards documents and postings.
+        std::unordered_map<std::string, Entry> documents;                               ///< Current version by URL.
+        std::unordered_map<std::string, std::unordered_map<std::string, float>> postings; ///< Term frequency by URL, by term.
+        mutable std::mutex queueMutex;                                                  ///< Guards queue and stopping.
+        std::condition_variable queued;                                                 ///< Signals queued versions or stop.
+        std::deque<std::pair<std::string, std::uint64_t>> queue;                        ///< URL and sequence of the versions to persist.
+        bool stopping = false;                                                          ///< Set by stop.
+        std::uint64_t nextSequence = 0;                                                 ///< Last assigned sequence number, guarded by mutex.
+        std::uint64_t added = 0;                                                        ///< Versions added, guarded by mutex.
+        std::uint64_t drained = 0;                                                      ///< Versions dropped after persistence, guarded by mutex.
+        std::uint64_t epoch;                                                            ///< Random identity of this instance.
+        std::uint64_t shadowVersion = 0;                                                ///< Changes to the set of documents, guarded by mutex.
+        std::deque<ShadowChange> shadowChanges;                                         ///< The last SHADOW_HISTORY changes, oldest first, guarded by mutex.
+
+        /**
+         * @brief Replaces the current version of a document and queues the new one.
+         *
+         * @param url The URL.
+         * @param entry The new version, without sequence number.
+         * @return std::uint64_t The sequence number of the new version.
+         */
+        std::uint64_t replace(const std::string& url, Entry entry);
+
+        /**
+         * @brief Removes the postings of a version; the unique lock must be held.
+         *
+         * @param url The URL.
+         * @param entry The version.
+         */
+        void unlink(const std::string& url, const Entry& entry);
+
+        /**
+         * @brief Records a document entering or leaving the delta; the unique lock must be held.
+         *
+         * @param url The URL.
+         * @param shadowed Whether the document entered the delta.
+         */
+        void recordShadow(const std::string& url, bool shadowed);
+    };
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef DELTAPERSISTER_HPP
+#define DELTAPERSISTER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include "delta/deltaIndex.hpp"
+
+namespace delta {
+
+    /// Versions taken from the delta per round of writes.
+    const std::size_t PERSIST_BATCH = 64;
+
+    /**
+     * @class DeltaPersister
+     * @brief Drains a delta index into the database in the background.
+     *
+     * Versions are written oldest first and leave the delta once written. A version whose
+     * write throws is put back and retried after a pause, together with the rest of its batch.
+     * Versions still in the delta at shutdown are not written.
+     */
+    class DeltaPersister {
+    public:
+        /**
+         * @brief Constructor for the DeltaPersister class; starts the writer thread.
+         *
+         * @param index The delta index to drain.
+         * @param write Writes one version to the database; called on the writer thread only.
+         */
+        DeltaPersister(DeltaIndex& index, std::function<void(const PendingDocument&)> write);
+
+        /**
+         * @brief Destructor; stops the writer thread after its current write.
+         */
+        ~DeltaPersister();
+
+        DeltaPersister(const DeltaPersister&) = delete;
+        DeltaPersister& operator=(const DeltaPersister&) = delete;
+
+        /**
+         * @brief Returns the number of failed writes.
+         *
+         * @return std::uint64_t The writes that threw.
+         */
+        std::uint64_t failures() const;
+
+    private:
+        DeltaIndex& index;                                  ///< The delta index being drained.
+        std::function<void(const PendingDocument&)> write;  ///< Writes one version.
+        std::atomic<std::uint64_t> failed{0};               ///< Writes that threw.
+        std::atomic<bool> stopping{false};                  ///< Set by the destructor.
+        std::thread worker;                                 ///< The writer thread.
+
+        /**
+         * @brief Writer loop: takes batches and writes them until the index is stopped.
+         */
+        void run();
+    };
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef WRITEAHEADLOG_HPP
+#define WRITEAHEADLOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "delta/deltaIndex.hpp"
+
+namespace delta {
+
+    /// Size at which the log moves on to a new segment file.
+    const std::size_t WAL_SEGMENT_BYTES = std::size_t(64) << 20;
+
+    /**
+     * @struct WalStats
+     * @brief Counters of a WriteAheadLog.
+     */
+    struct WalStats {
+        std::uint64_t appends = 0;      ///< Versions appended since the start.
+        std::uint64_t syncs = 0;        ///< Group commits, one fdatasync each.
+        std::uint64_t bytes = 0;        ///< Bytes in the segment files.
+        std::size_t segments = 0;       ///< Segment files, the open one included.
+        std::uint64_t recovered = 0;    ///< Versions replayed into the delta at startup.
+    };
+
+    /**
+     * @class WriteAheadLog
+     * @brief Append-only log in front of a delta index, so an acknowledged document survives
+     * a crash before the delta is written to the database.
+     *
+     * add and remove put a version into the delta and append it as a record of its URL,
+     * length, terms and sequence number, prefixed by its size and CRC-32. Both happen under
+     * one lock, so the log holds the versions in sequence order. Appends only copy the record
+     * into a buffer; a single flusher thread writes everything buffered since its last round
+     * with one write and one fdatasync, then wakes the callers of the round. While one sync
+     * runs, the next group collects, so the number of syncs follows the disk rather than the
+     * request rate.
+     *
+     * The log is split into segment files. A closed segment is deleted once every version in
+     * it is older than the oldest version the delta still held when a later round was taken,
+     * i.e. once all of them have been persisted or superseded by a version that is on disk.
+     * A version only leaves the delta after its database write returned, so a failing writer
+     * keeps every segment from its first unwritten version on until the writes succeed.
+     *
+     * At startup, the newest logged version of every URL is replayed into the delta, written
+     * to a fresh segment and synced before the old segments are deleted, so a crash during
+     * recovery loses nothing either.
+     */
+    class WriteAheadLog {
+    public:
+        /**
+         * @brief Constructor for the WriteAheadLog class; replays the log and starts the flusher thread.
+         *
+         * @param directory The directory of the segment files; created if missing.
+         * @param index The delta index the log belongs to; recovered versions are added to it.
+         * @param groupDelay How long the flusher waits for more appends before a sync; zero syncs at once.
+         * @param segmentBytes The size at which a new segment is started.
+         */
+        WriteAheadLog(const std::string& directory, DeltaIndex& index, std::chrono::microseconds groupDelay = std::chrono::microseconds(0), std::size_t segmentBytes = WAL_SEGMENT_BYTES);
+
+        /**
+         * @brief Destructor; syncs the buffered records and stops the flusher thread.
+         */
+        ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog&) = delete;
+        WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+        /**
+         * @brief Adds a document version to the delta and waits until it is logged on disk.
+         *
+         * @param url The URL of the document.
+         * @param terms The terms with their frequency.
+         * @param docLength The length of the document.
+         * @return std::uint64_t The sequence number of the version.
+         */
+        std::uint64_t add(const std::string& url, std::vector<std::pair<std::string, float>> terms, int docLength);
+
+        /**
+         * @brief Adds a delete of a document to the delta and waits until it is logged on disk.
+         *
+         * @param url The URL of the document.
+         * @return std::uint64_t The sequence number of the delete.
+         */
+        std::uint64_t remove(const std::string& url);
+
+        /**
+         * @brief Returns the counters.
+         *
+         * @return WalStats The current counters.
+         */
+        WalStats stats() const;
+
+    private:
+        /**
+         * @struct Segment
+         * @brief A closed segment file.
+         */
+        struct Segment {
+            std::string path;               ///< Path of the file.
+            std::uint64_t bytes = 0;        ///< Size of the file.
+            std::uint64_t maxSequence = 0;  ///< Highest sequence number in the file.
+        };
+
+        std::string directory;                  ///< Directory of the segment files.
+        DeltaIndex& index;                      ///< The delta index whose versions are logged.
+        std::chrono::microseconds groupDelay;   ///< Wait for more appends before a sync.
+        std::size_t segmentBytes;               ///< Size at which a new segment is started.
+
+        mutable std::mutex mutex;               ///< Guards the fields up to error.
+        std::condition_variable appended;       ///< Signals buffered records or stop to the flusher.
+        std::condition_variable synced;         ///< Signals a completed group commit to the callers.
+        std::string buffer;                     ///< Records not yet handed to the flusher.
+        std::uint64_t bufferMaxSequence = 0;    ///< Highest sequence number in the buffer.
+        std::uint64_t appendedBytes = 0;        ///< Bytes appended since the start.
+        std::uint64_t durableBytes = 0;         ///< Bytes appended since the start and synced.
+        bool stopping = false;                  ///< Set by the destructor.
+        std::string error;                      ///< Set when a write or sync failed; appends fail from then on.
+
+        int fd = -1;                            ///< The open segment, used by the flusher only.
+        std::string openPath;                   ///< Path of the open segment.
+        std::uint64_t openBytes = 0;            ///< Size of the open segment.
+        std::uint64_t openMaxSequence = 0;      ///< Highest sequence number in the open segment.
+        std::uint64_t nextSegment = 0;          ///< Number of the next segment file.
+        std::vector<Segment> closed;            ///< Closed segments, oldest first, used by the flusher only.
+
+        std::atomic<std::uint64_t> appends{0};      ///< Versions appended.
+        std::atomic<std::uint64_t> syncs{0};        ///< Group commits.
+        std::atomic<std::uint64_t> bytes{0};        ///< Bytes in the segment files.
+        std::atomic<std::size_t> segments{0};       ///< Segment files.
+        std::atomic<std::uint64_t> recovered{0};    ///< Versions replayed at startup.
+        std::thread flusher;                        ///< The group commit thread.
+
+        /**
+         * @brief Assigns a version its sequence number, buffers its record and waits for the sync.
+         *
+         * @param record The encoded version without its sequence number, behind room for the record header; completed in place.
+         * @param assign Adds the version to the delta and returns its sequence number; called under the lock.
+         * @return std::uint64_t The sequence number.
+         */
+        std::uint64_t commit(std::string& record, const std::function<std::uint64_t()>& assign);
+
+        /**
+         * @brief Replays the existing segments into the delta and rewrites them as one new segment.
+         */
+        void recover();
+
+        /**
+         * @brief Creates the next segment file and makes it the open one.
+         */
+        void openSegment();
+
+        /**
+         * @brief Writes bytes to the open segment and syncs it.
+         *
+         * @param data The bytes.
+         */
+        void writeAndSync(const std::string& data);
+
+        /**
+         * @brief Deletes the closed segments whose versions are all older than a watermark.
+         *
+         * @param watermark The oldest version in the delta when the last synced round was taken.
+         */
+        void truncate(std::uint64_t watermark);
+
+        /**
+         * @brief Flusher loop: writes and syncs the buffered records in groups until stopped.
+         */
+        void run();
+    };
+
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef HTTPRESPONSE_HPP
+#define HTTPRESPONSE_HPP
+
+#include "jetplusplus/server/response.hpp"
+#include <string>
+#include <vector>
+
+namespace http {
+
+    /**
+     * @brief Returns the reason phrase of a status code.
+     *
+     * @param status The status code.
+     * @return std::string The phrase, e.g. "Service Unavailable"; empty for unknown codes.
+     */
+    std::string reasonPhrase(int status);
+
+    /**
+     * @brief Writes a complete HTTP/1.1 response to a socket.
+     *
+     * The body is written in full, whatever bytes it holds, and the connection is announced
+     * as closing after it.
+     *
+     * @param socket The client socket.
+     * @param status The status code.
+     * @param headers Header lines without line breaks, e.g. "Retry-After: 1".
+     * @param body The response body.
+     * @return True if the whole response was written.
+     */
+    bool writeResponse(int socket, int status, const std::vector<std::string>& headers, const std::string& body);
+
+    /**
+     * @brief Sends the response of a Jet++ handler with the given status.
+     *
+     * Response::send always writes "200 OK" and stops at the first NUL byte of the body.
+     * This writes the status line, the headers added with Response::addHeader and the whole
+     * body to the client socket instead. The handler must not call Response::send afterwards.
+     *
+     * @param res The response of the handler.
+     * @param status The status code.
+     * @param body The response body.
+     * @return True if the whole response was written.
+     */
+    bool send(jetpp::Response& res, int status, const std::string& body);
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef QUERYSTRING_HPP
+#define QUERYSTRING_HPP
+
+#include <string>
+
+namespace http {
+
+    /**
+     * @brief Percent-encodes a query string value.
+     *
+     * @param value The raw value.
+     * @return std::string The encoded value; everything but letters, digits and "-_.~" is escaped, '+' included.
+     */
+    std::string urlEncode(const std::string& value);
+
+    /**
+     * @brief Decodes the percent escapes of a query string value.
+     *
+     * Jet++ hands out query values as they arrived, so handlers decode them themselves.
+     *
+     * @param value The encoded value.
+     * @return std::string The decoded value; '+' and malformed escapes are kept as they are.
+     */
+    std::string urlDecode(const std::string& value);
+
+    /**
+     * @brief Percent-encodes the terms of a '+'-separated query.
+     *
+     * @param query The query, e.g. a normalized search query string.
+     * @return std::string Every term encoded on its own, joined by unescaped '+'.
+     */
+    std::string encodeTerms(const std::string& query);
+
+    /**
+     * @brief Decodes a query encoded by encodeTerms.
+     *
+     * The value is split at its unescaped '+' before the terms are decoded, so an escaped '+'
+     * never separates terms on the wire.
+     *
+     * @param value The encoded query.
+     * @return std::string The decoded terms, joined by '+'.
+     */
+    std::string decodeTerms(const std::string& value);
+
+}
+
+#endif
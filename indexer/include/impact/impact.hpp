@@ -0,0 +1,169 @@
+#ifndef IMPACT_HPP
+#define IMPACT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace impact {
+
+    /// BM25 tuning parameters.
+    const float K1 = 1.2f;
+    const float B = 0.75f;
+
+    /// Quantization step: an impact of IMPACT_SCALE equals a combined score of 1.0.
+    const float IMPACT_SCALE = 1024.0f;
+
+    /// Largest impact of a single posting (16 bit).
+    const std::uint32_t MAX_IMPACT = 65535;
+
+    /// Relative change of the corpus size after which the stored impacts are recomputed.
+    const double STATS_DRIFT = 0.1;
+
+    /**
+     * @struct CorpusStats
+     * @brief Corpus statistics the impacts were computed with.
+     */
+    struct CorpusStats {
+        std::int64_t totalDocuments = 0;    ///< Number of documents in the corpus.
+        double avgDocLength = 0;            ///< Average document length; 0 if unknown.
+        std::int64_t version = 0;           ///< Incremented by every full impact refresh.
+    };
+
+    /**
+     * @struct ImpactPosting
+     * @brief A posting with its precomputed, quantized score.
+     */
+    struct ImpactPosting {
+        std::string url;            ///< URL of the document.
+        std::uint16_t impact;       ///< Quantized combined TF-IDF/BM25 score of the term in the document.
+    };
+
+    /**
+     * @brief Calculates the Inverse Document Frequency (IDF) score.
+     *
+     * @param totalDocuments The total number of documents in the corpus.
+     * @param appearances The number of documents in which the term appears.
+     * @return float The IDF score.
+     */
+    float idf(std::int64_t totalDocuments, std::int64_t appearances);
+
+    /**
+     * @brief Calculates the BM25 score of a term in a document.
+     *
+     * @param docLength The length of the document.
+     * @param avgDocLength The average document length; values below 1 disable length normalization.
+     * @param idf The IDF score of the term.
+     * @param tf The term frequency in the document.
+     * @param k1 The BM25 k1 parameter.
+     * @param b The BM25 b parameter.
+     * @return float The BM25 score.
+     */
+    float bm25(int docLength, float avgDocLength, float idf, float tf, float k1, float b);
+
+    /**
+     * @brief Combines TF-IDF and BM25 scores into the total ranking score.
+     *
+     * @param tfIdf The TF-IDF score.
+     * @param bm25 The BM25 score.
+     * @return float The combined score.
+     */
+    float combine(float tfIdf, float bm25);
+
+    /**
+     * @brief Computes the combined score of a single posting.
+     *
+     * @param tf The term frequency in the document.
+     * @param docLength The length of the document.
+     * @param idf The IDF score of the term.
+     * @param avgDocLength The average document length.
+     * @return float The combined score.
+     */
+    float postingScore(float tf, int docLength, float idf, float avgDocLength);
+
+    /**
+     * @brief Quantizes a combined score to a 16 bit impact.
+     *
+     * The scale is fixed rather than derived from the corpus, so impacts computed at
+     * different times (with different statistics) can still be added up.
+     *
+     * @param score The combined score.
+     * @return std::uint16_t The impact, rounded and clamped to [0, MAX_IMPACT].
+     */
+    std::uint16_t quantize(float score);
+
+    /**
+     * @brief Converts a sum of impacts back to a combined score.
+     *
+     * @param impacts The summed impacts of a document.
+     * @return float The approximate combined score.
+     */
+    float dequantize(std::uint64_t impacts);
+
+    /**
+     * @brief Rescales the impacts of a term, e.g. to replace the IDF they were computed with.
+     *
+     * The IDF is a per-term factor of the combined score, so scaling by the ratio of two
+     * IDFs recomputes the impacts up to rounding. The order of the postings is kept.
+     *
+     * @param postings The postings of the term.
+     * @param factor The scale factor.
+     */
+    void rescale(std::vector<ImpactPosting>& postings, float factor);
+
+    /**
+     * @brief Sorts postings by impact, highest first, and by URL within the same impact.
+     *
+     * @param postings The postings to sort in place.
+     */
+    void sortByImpact(std::vector<ImpactPosting>& postings);
+
+    /**
+     * @brief Checks whether the corpus changed enough for the stored impacts to be recomputed.
+     *
+     * @param indexed The statistics the impacts were computed with.
+     * @param currentDocuments The current number of documents.
+     * @param threshold The allowed relative change.
+     * @return True if the impacts are missing or out of date.
+     */
+    bool drifted(const CorpusStats& indexed, std::int64_t currentDocuments, double threshold);
+
+    /**
+     * @brief Computes the impact-ordered postings of a term.
+     *
+     * The average length of the corpus is used for BM25 length normalization; while it is
+     * unknown, the average length of the term's documents stands in for it.
+     *
+     * @tparam Posting A posting type with url, tf and docLength members.
+     * @param postings The postings of the term.
+     * @param stats The corpus statistics.
+     * @return std::vector<ImpactPosting> The postings with their impacts, highest first.
+     */
+    template <typename Posting>
+    std::vector<ImpactPosting> computeImpacts(const std::vector<Posting>& postings, const CorpusStats& stats) {
+        std::vector<ImpactPosting> impacts;
+        if (postings.empty()) {
+            return impacts;
+        }
+
+        float avgDocLength = static_cast<float>(stats.avgDocLength);
+        if (avgDocLength < 1) {
+            long long totalLength = 0;
+            for (const Posting& posting : postings) {
+                totalLength += posting.docLength;
+            }
+            avgDocLength = static_cast<float>(totalLength / static_cast<long long>(postings.size()));
+        }
+
+        float termIdf = idf(stats.totalDocuments, static_cast<std::int64_t>(postings.size()));
+        impacts.reserve(postings.size());
+        for (const Posting& posting : postings) {
+            impacts.push_back(ImpactPosting{posting.url, quantize(postingScore(posting.tf, posting.docLength, termIdf, avgDocLength))});
+        }
+        sortByImpact(impacts);
+        return impacts;
+    }
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef IMPACTREFRESHER_HPP
+#define IMPACTREFRESHER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace indexer {
+
+    /**
+     * @class ImpactRefresher
+     * @brief Recomputes the stored impacts in the background when the corpus statistics drift.
+     *
+     * Every checkEvery indexed documents the current corpus size is compared with the size
+     * the impacts were computed with; beyond the drift threshold a full refresh is started.
+     * At most one refresh runs at a time.
+     */
+    class ImpactRefresher {
+    public:
+        /**
+         * @brief Constructor for the ImpactRefresher class.
+         *
+         * @param checkEvery Number of indexed documents between two drift checks.
+         * @param threshold Relative change of the corpus size that triggers a refresh.
+         */
+        ImpactRefresher(std::uint64_t checkEvery, double threshold);
+
+        /**
+         * @brief Destructor; waits for a running refresh.
+         */
+        ~ImpactRefresher();
+
+        ImpactRefresher(const ImpactRefresher&) = delete;
+        ImpactRefresher& operator=(const ImpactRefresher&) = delete;
+
+        /**
+         * @brief Notes an indexed document and checks for drift every checkEvery documents.
+         */
+        void documentIndexed();
+
+        /**
+         * @brief Starts a refresh in the background.
+         *
+         * @param force Refresh even if the statistics did not drift.
+         * @return True if a refresh was started, false if one is already running.
+         */
+        bool refresh(bool force);
+
+        /**
+         * @brief Returns the number of completed refreshes.
+         *
+         * @return The number of completed refreshes.
+         */
+        std::uint64_t completed() const;
+
+    private:
+        std::uint64_t checkEvery;               ///< Indexed documents between two drift checks.
+        double threshold;                       ///< Relative drift that triggers a refresh.
+        std::atomic<std::uint64_t> indexed{0};  ///< Documents indexed since startup.
+        std::atomic<std::uint64_t> refreshes{0}; ///< Completed refreshes.
+        std::atomic<bool> running{false};       ///< Whether a check or refresh is running.
+        std::mutex mutex;                       ///< Guards worker.
+        std::thread worker;                     ///< The background check and refresh.
+
+        /**
+         * @brief Checks the drift (unless forced) and refreshes the impacts.
+         *
+         * @param force Refresh even if the statistics did not drift.
+         */
+        void run(bool force);
+    };
+
+}
+
+#endif
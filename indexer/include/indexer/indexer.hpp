@@ -6,6 +6,9 @@
 #include <memory>
 #include <unordered_map>
 #include "db/indexdb.hpp"
+#include "dedup/duplicateDetector.hpp"
+#include "delta/deltaIndex.hpp"
+#include "delta/writeAheadLog.hpp"
 
 namespace indexer {
 
@@ -36,17 +39,40 @@ namespace indexer {
          */
         Indexer();
 
+        /**
+         * @brief Constructor for the Indexer class with near-duplicate detection and a delta index.
+         * 
+         * @param duplicates The detector holding the canonical documents, shared by all requests; may be null.
+         * @param action What to do with a near-duplicate; Off indexes every document.
+         * @param delta The delta index documents are added to instead of being written directly, shared by all requests; may be null.
+         * @param log The write-ahead log in front of the delta, shared by all requests; may be null.
+         */
+        Indexer(dedup::DuplicateDetector* duplicates, dedup::DuplicateAction action, delta::DeltaIndex* delta = nullptr, delta::WriteAheadLog* log = nullptr);
+
         /**
          * @brief Indexes a given document.
          * 
          * @param doc Pointer to the document to be indexed.
+         * @return True if its terms were indexed, false if it was dropped as a near-duplicate.
+         * @throws std::exception If the fingerprint cannot be stored.
          */
-        void indexDocument(Document *doc);
+        bool indexDocument(Document *doc);
 
-    private:
-        std::shared_ptr<indexer_db::IndexerDB> db; ///< Shared pointer to the database object.
-        int totalDocuments; ///< Total number of documents indexed.
-        std::unordered_map<std::string, std::vector<indexer_db::IndexDocument>> index; ///< Index map storing term to document mappings.
+        /**
+         * @brief Removes a document from the index and indexes the aliases of a canonical document in its place.
+         * 
+         * @param url The URL of the document.
+         * @throws std::exception If a fingerprint cannot be stored or removed.
+         */
+        void removeDocument(const std::string& url);
+
+        /**
+         * @brief Writes a document version to the database.
+         * 
+         * @param document The version; a delete removes every posting of the URL.
+         * @throws std::exception If a write fails.
+         */
+        void persistDocument(const delta::PendingDocument& document);
 
         /**
          * @brief Splits the content into unique terms based on a delimiter.
@@ -55,14 +81,45 @@ namespace indexer {
          * @param terms The map to store the terms and their frequencies.
          * @param delimiter The character used to split the string.
          */
-        void splitContentUniqueTerms(const std::string& str, std::unordered_map<std::string, int> &terms, char delimiter);
+        static void splitContentUniqueTerms(const std::string& str, std::unordered_map<std::string, int> &terms, char delimiter);
+
+        /**
+         * @brief Turns the term counts of a document into term frequencies.
+         * 
+         * @param counts The terms with their number of occurrences, as split by splitContentUniqueTerms.
+         * @return The terms without whitespace, with their frequency relative to the number of unique terms.
+         */
+        static std::vector<std::pair<std::string, float>> termFrequencies(const std::unordered_map<std::string, int>& counts);
 
         /**
          * @brief Removes whitespace from a string.
          * 
          * @param str The string from which whitespace will be removed.
          */
-        void removeWhitespace(std::string& str);
+        static void removeWhitespace(std::string& str);
+
+    private:
+        /**
+         * @brief Adds a document version to the write-ahead log, the delta or the database.
+         * 
+         * @param version The version; a delete removes every posting of the URL.
+         */
+        void addVersion(delta::PendingDocument&& version);
+
+        /**
+         * @brief Indexes or re-assigns the aliases of a deleted canonical document.
+         * 
+         * @param canonical The URL of the deleted canonical document.
+         */
+        void promoteAliases(const std::string& canonical);
+
+        std::shared_ptr<indexer_db::IndexerDB> db; ///< Shared pointer to the database object.
+        int totalDocuments; ///< Total number of documents indexed.
+        std::unordered_map<std::string, std::vector<indexer_db::IndexDocument>> index; ///< Index map storing term to document mappings.
+        dedup::DuplicateDetector* duplicates = nullptr; ///< Canonical documents, not owned; may be null.
+        dedup::DuplicateAction duplicateAction = dedup::DuplicateAction::Off; ///< What to do with a near-duplicate.
+        delta::DeltaIndex* delta = nullptr; ///< Delta index for new documents, not owned; may be null.
+        delta::WriteAheadLog* log = nullptr; ///< Write-ahead log in front of the delta, not owned; may be null.
     };
 
 }
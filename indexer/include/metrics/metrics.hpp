@@ -0,0 +1,224 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace metrics {
+
+    /// Number of independent stripes per metric; threads are spread over them to avoid sharing cache lines.
+    const std::size_t STRIPES = 16;
+
+    /**
+     * @brief Returns the stripe used by the calling thread.
+     * 
+     * Threads get stripes round-robin on first use, so concurrent request threads rarely
+     * write to the same cache line.
+     * 
+     * @return std::size_t The stripe index in [0, STRIPES).
+     */
+    std::size_t threadStripe();
+
+    /**
+     * @class Counter
+     * @brief A monotonically increasing counter, striped per thread.
+     */
+    class Counter {
+    public:
+        /**
+         * @brief Adds to the counter with a single relaxed atomic increment.
+         * 
+         * @param amount The amount to add.
+         */
+        void add(std::uint64_t amount = 1) {
+            this->stripes[threadStripe()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Sums all stripes.
+         * 
+         * @return std::uint64_t The current value.
+         */
+        std::uint64_t value() const;
+
+    private:
+        struct alignas(64) Stripe {
+            std::atomic<std::uint64_t> value{0};
+        };
+        std::array<Stripe, STRIPES> stripes; ///< Per-thread stripes.
+    };
+
+    /**
+     * @class Histogram
+     * @brief A lock-free latency histogram with HDR-style log-linear buckets.
+     * 
+     * Values are recorded in nanoseconds. Every power of two is split into 8 linear
+     * sub-buckets, which bounds the relative error of a bucket to 12.5% from 1 ns up to
+     * about 18 minutes. Each thread records into its own stripe with relaxed atomics;
+     * stripes are only summed when the histogram is scraped.
+     */
+    class Histogram {
+    public:
+        static const int SUB_BUCKET_BITS = 3;
+        static const int BUCKETS = 320;
+
+        /**
+         * @brief Records one value.
+         * 
+         * @param nanos The value in nanoseconds.
+         */
+        void record(std::uint64_t nanos) {
+            Stripe& stripe = this->stripes[threadStripe()];
+            stripe.buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+            stripe.sum.fetch_add(nanos, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Maps a value to its bucket.
+         * 
+         * @param nanos The value in nanoseconds.
+         * @return int The bucket index.
+         */
+        static int bucketIndex(std::uint64_t nanos);
+
+        /**
+         * @brief Returns the largest value that falls into a bucket.
+         * 
+         * @param index The bucket index.
+         * @return std::uint64_t The inclusive upper bound in nanoseconds.
+         */
+        static std::uint64_t bucketUpperBound(int index);
+
+        /**
+         * @brief Sums all stripes into a single bucket array.
+         * 
+         * @param buckets Receives the merged bucket counts.
+         * @param count Receives the total number of values.
+         * @param sum Receives the sum of all values in nanoseconds.
+         */
+        void snapshot(std::array<std::uint64_t, BUCKETS>& buckets, std::uint64_t& count, std::uint64_t& sum) const;
+
+    private:
+        struct alignas(64) Stripe {
+            std::array<std::atomic<std::uint64_t>, BUCKETS> buckets{}; ///< Value counts per bucket.
+            std::atomic<std::uint64_t> sum{0};                          ///< Sum of recorded values.
+        };
+        std::array<Stripe, STRIPES> stripes; ///< Per-thread stripes.
+    };
+
+    /**
+     * @class ScopedTimer
+     * @brief Records the lifetime of a scope into a histogram.
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - this->start;
+            this->histogram.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& histogram;                           ///< Target histogram.
+        std::chrono::steady_clock::time_point start;    ///< Start of the scope.
+    };
+
+    /**
+     * @class Registry
+     * @brief Owns all metrics of the process and renders them in the Prometheus text format.
+     * 
+     * Metrics are created once (typically into a function-local static reference) and never
+     * destroyed, so the hot path only ever touches the metric itself.
+     */
+    class Registry {
+    public:
+        /**
+         * @brief Returns the process-wide registry.
+         * 
+         * @return Registry& The registry.
+         */
+        static Registry& instance();
+
+        /**
+         * @brief Returns the counter with the given name and labels, creating it on first use.
+         * 
+         * @param name The metric name, e.g. "search_requests_total".
+         * @param help The help text.
+         * @param labels The label set in Prometheus syntax without braces, e.g. "route=\"/search\"".
+         * @return Counter& The counter.
+         */
+        Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        /**
+         * @brief Returns the histogram with the given name and labels, creating it on first use.
+         * 
+         * The name should end in "_seconds"; values are exported in seconds.
+         * 
+         * @param name The metric name.
+         * @param help The help text.
+         * @param labels The label set in Prometheus syntax without braces.
+         * @return Histogram& The histogram.
+         */
+        Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        /**
+         * @brief Registers a gauge whose value is read from a callback at scrape time.
+         * 
+         * @param name The metric name.
+         * @param help The help text.
+         * @param labels The label set in Prometheus syntax without braces.
+         * @param read The callback returning the current value.
+         */
+        void gauge(const std::string& name, const std::string& help, const std::string& labels, std::function<double()> read);
+
+        /**
+         * @brief Registers a counter maintained elsewhere (e.g. by a component's own stats) and read at scrape time.
+         * 
+         * @param name The metric name.
+         * @param help The help text.
+         * @param labels The label set in Prometheus syntax without braces.
+         * @param read The callback returning the current, monotonically increasing value.
+         */
+        void counter(const std::string& name, const std::string& help, const std::string& labels, std::function<double()> read);
+
+        /**
+         * @brief Renders all metrics in the Prometheus text exposition format (version 0.0.4).
+         * 
+         * @return std::string The exposition text.
+         */
+        std::string render();
+
+    private:
+        Registry() = default;
+
+        struct Family {
+            std::string help;                                           ///< Help text.
+            std::string type;                                           ///< counter, gauge or histogram.
+            std::map<std::string, std::unique_ptr<Counter>> counters;   ///< Counters by label set.
+            std::map<std::string, std::unique_ptr<Histogram>> histograms; ///< Histograms by label set.
+            std::map<std::string, std::function<double()>> callbacks;   ///< Values read at scrape time, by label set.
+        };
+
+        std::mutex mutex;                       ///< Guards families; never taken on the recording path.
+        std::map<std::string, Family> families; ///< Metric families by name.
+
+        /**
+         * @brief Returns the family of a metric, creating it with the given type.
+         * 
+         * @throws std::logic_error If the name is already registered with another type.
+         */
+        Family& family(const std::string& name, const std::string& help, const std::string& type);
+    };
+
+}
+
+#endif
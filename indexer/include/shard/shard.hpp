@@ -0,0 +1,44 @@
+#ifndef SHARD_HPP
+#define SHARD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace shard {
+
+    /**
+     * @brief Hashes a string with 64 bit FNV-1a.
+     *
+     * Unlike std::hash the value is the same on every platform and in every build, so the
+     * indexer and all searchers agree on where a document lives.
+     *
+     * @param value The string to hash.
+     * @return std::uint64_t The hash.
+     */
+    std::uint64_t stableHash(const std::string& value);
+
+    /**
+     * @brief Returns the shard a document belongs to.
+     *
+     * @param url The URL of the document.
+     * @param shards The number of shards.
+     * @return std::size_t The shard, in [0, shards).
+     */
+    std::size_t shardOf(const std::string& url, std::size_t shards);
+
+    /**
+     * @brief Returns the name of a sharded collection.
+     *
+     * An unsharded deployment keeps the plain names, so existing data stays readable.
+     *
+     * @param base The collection name, e.g. "index".
+     * @param shard The shard.
+     * @param shards The number of shards.
+     * @return std::string The base name if shards is 1, otherwise base + "_" + shard.
+     */
+    std::string collectionName(const std::string& base, std::size_t shard, std::size_t shards);
+
+}
+
+#endif
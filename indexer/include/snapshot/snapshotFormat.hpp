@@ -0,0 +1,128 @@
+#ifndef SNAPSHOTFORMAT_HPP
+#define SNAPSHOTFORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <zlib.h>
+
+namespace snapshot {
+
+    /**
+     * Layout of an index snapshot file (little-endian, every section 8 byte aligned):
+     *
+     *   SnapshotHeader
+     *   postings    per term: docIds (uint32[count]), impacts (uint16[count]), padding;
+     *               impact-ordered like the "impacts" collection
+     *   documents   UrlTableHeader, then the front-coded URL table:
+     *               positions (uint32[documentCount]) rank of every document id's URL in byte order, padding;
+     *               blockOffsets (uint64[blockCount + 1]) into the block data;
+     *               with URL_HOST_DICTIONARY, hostOffsets (uint64[hostCount + 1]) into the host bytes that follow, padding;
+     *               block data: the URLs in byte order, blockSize per block; every block starts with a
+     *               full URL (varint host id and the rest, or the whole URL, as varint length and bytes),
+     *               every further URL is the varint length of the prefix it shares with the previous one
+     *               and the varint length and bytes of the remaining suffix; padding
+     *   terms       TermEntry[termCount] sorted by term bytes, then the term bytes
+     *
+     * The checksum covers everything after the header. The indexer writes the file under a
+     * temporary name and renames it once complete, so a reader never sees a partial file.
+     */
+
+    /// File magic.
+    const char MAGIC[8] = {'A', 'S', 'U', 'R', 'A', 'S', 'N', 'P'};
+
+    /// Version of the layout; readers reject other versions.
+    const std::uint32_t FORMAT_VERSION = 2;
+
+    /// URLs per front-coded block of the document table.
+    const std::uint32_t URL_BLOCK_SIZE = 16;
+
+    /// UrlTableHeader::flags: block heads start with a host dictionary id instead of their scheme and host.
+    const std::uint32_t URL_HOST_DICTIONARY = 1;
+
+    /**
+     * @struct SnapshotHeader
+     * @brief Fixed-size header at the start of a snapshot file.
+     */
+    struct SnapshotHeader {
+        char magic[8];                  ///< MAGIC.
+        std::uint32_t formatVersion;    ///< FORMAT_VERSION.
+        std::uint32_t headerSize;       ///< sizeof(SnapshotHeader).
+        std::uint64_t fileSize;         ///< Size of the whole file.
+        std::uint32_t checksum;         ///< CRC-32 of the bytes after the header.
+        std::uint32_t shard;            ///< Shard the snapshot was exported from.
+        std::uint32_t shards;           ///< Number of shards of the index.
+        std::uint32_t reserved;         ///< Zero.
+        std::int64_t createdMs;         ///< Milliseconds since the epoch when the export started.
+        std::int64_t statsVersion;      ///< Version of the corpus statistics the impacts use.
+        std::int64_t totalDocuments;    ///< Corpus statistics: number of documents.
+        double avgDocLength;            ///< Corpus statistics: average document length.
+        std::uint64_t documentCount;    ///< Entries of the document table.
+        std::uint64_t termCount;        ///< Entries of the term dictionary.
+        std::uint64_t postingCount;     ///< Postings over all terms.
+        std::uint64_t postingsOffset;   ///< Offset of the postings section.
+        std::uint64_t documentsOffset;  ///< Offset of the document table.
+        std::uint64_t termsOffset;      ///< Offset of the term dictionary.
+        std::uint64_t unused;           ///< Zero, room for later fields.
+    };
+
+    /**
+     * @struct TermEntry
+     * @brief Term dictionary entry.
+     */
+    struct TermEntry {
+        std::uint64_t nameOffset;       ///< Offset of the term bytes, relative to the end of the entry array.
+        std::uint32_t nameLength;       ///< Length of the term.
+        std::uint32_t postingCount;     ///< Postings of the term.
+        std::uint64_t postingsOffset;   ///< File offset of the term's docIds; its impacts follow them.
+        std::uint16_t maxImpact;        ///< Impact of the first posting.
+        std::uint16_t reserved[3];      ///< Zero.
+    };
+
+    /**
+     * @struct UrlTableHeader
+     * @brief Header of the front-coded document table.
+     */
+    struct UrlTableHeader {
+        std::uint32_t blockSize;        ///< URLs per block.
+        std::uint32_t flags;            ///< URL_HOST_DICTIONARY or 0.
+        std::uint64_t blockCount;       ///< Blocks, documentCount / blockSize rounded up.
+        std::uint64_t hostCount;        ///< Host dictionary entries; 0 without URL_HOST_DICTIONARY.
+        std::uint64_t blockBytes;       ///< Size of the block data.
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 128, "the snapshot header layout is part of the file format");
+    static_assert(sizeof(TermEntry) == 32, "the term entry layout is part of the file format");
+    static_assert(sizeof(UrlTableHeader) == 32, "the URL table header layout is part of the file format");
+
+    /**
+     * @brief Rounds a size up to the 8 byte section alignment.
+     *
+     * @param size The size.
+     * @return The aligned size.
+     */
+    inline std::uint64_t align8(std::uint64_t size) {
+        return (size + 7) & ~std::uint64_t(7);
+    }
+
+    /**
+     * @brief Continues a CRC-32 over a buffer of any size.
+     *
+     * @param crc The CRC of the preceding bytes (0 to start).
+     * @param data The bytes.
+     * @param size The number of bytes.
+     * @return The CRC including the bytes.
+     */
+    inline std::uint32_t checksum(std::uint32_t crc, const void* data, std::size_t size) {
+        const Bytef* bytes = static_cast<const Bytef*>(data);
+        while (size > 0) {
+            uInt chunk = static_cast<uInt>(size > (1u << 30) ? (1u << 30) : size);
+            crc = static_cast<std::uint32_t>(crc32(crc, bytes, chunk));
+            bytes += chunk;
+            size -= chunk;
+        }
+        return crc;
+    }
+
+}
+
+#endif
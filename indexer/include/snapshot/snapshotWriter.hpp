@@ -0,0 +1,92 @@
+#ifndef SNAPSHOTWRITER_HPP
+#define SNAPSHOTWRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "impact/impact.hpp"
+#include "snapshot/snapshotFormat.hpp"
+
+namespace snapshot {
+
+    /**
+     * @class SnapshotWriter
+     * @brief Streams an index snapshot to a file.
+     *
+     * The postings of every term are written as soon as they are added; only the document
+     * table and the term dictionary are kept in memory until finish(). The file is written
+     * under path + ".tmp" and renamed to path by finish().
+     */
+    class SnapshotWriter {
+    public:
+        /**
+         * @brief Constructor for the SnapshotWriter class; creates the temporary file.
+         *
+         * @param path The path of the snapshot.
+         * @param stats The corpus statistics the impacts were computed with.
+         * @param shard The shard the snapshot is exported from.
+         * @param shards The number of shards of the index.
+         * @param createdMs Milliseconds since the epoch when the export started.
+         * @throws std::runtime_error If the file cannot be created.
+         */
+        SnapshotWriter(const std::string& path, const impact::CorpusStats& stats, std::uint32_t shard, std::uint32_t shards, std::int64_t createdMs);
+
+        /**
+         * @brief Destructor; removes the temporary file if finish() was not called.
+         */
+        ~SnapshotWriter();
+
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+        /**
+         * @brief Adds the postings of a term.
+         *
+         * @param term The term; every term may be added once.
+         * @param postings The impact-ordered postings of the term.
+         * @throws std::runtime_error On write errors.
+         */
+        void addTerm(const std::string& term, const std::vector<impact::ImpactPosting>& postings);
+
+        /**
+         * @brief Writes the document table, the term dictionary and the header, then publishes the file.
+         *
+         * @return SnapshotHeader The header of the written snapshot.
+         * @throws std::runtime_error On write errors.
+         */
+        SnapshotHeader finish();
+
+    private:
+        std::string path;                                   ///< Final path of the snapshot.
+        std::FILE* file = nullptr;                          ///< The temporary file.
+        SnapshotHeader header{};                            ///< Header, completed by finish().
+        std::uint64_t offset = 0;                           ///< Current write offset.
+        std::uint32_t crc = 0;                              ///< CRC-32 of everything written after the header.
+        std::unordered_map<std::string, std::uint32_t> ids; ///< Document id by URL.
+        std::vector<std::string> urls;                      ///< URL by document id.
+        std::vector<std::pair<std::string, TermEntry>> terms; ///< Dictionary entries; nameOffset is assigned by finish().
+
+        /**
+         * @brief Writes the document table as a front-coded URL table.
+         */
+        void writeUrlTable();
+
+        /**
+         * @brief Appends bytes to the file and the checksum.
+         *
+         * @param data The bytes.
+         * @param size The number of bytes.
+         */
+        void write(const void* data, std::size_t size);
+
+        /**
+         * @brief Appends zero bytes up to the next 8 byte boundary.
+         */
+        void pad();
+    };
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "indexer/impactRefresher.hpp"
+#include "db/indexdb.hpp"
+#include "impact/impact.hpp"
+#include <iostream>
+
+namespace indexer {
+
+    /**
+     * @brief Constructor for the ImpactRefresher class.
+     *
+     * @param checkEvery Number of indexed documents between two drift checks.
+     * @param threshold Relative change of the corpus size that triggers a refresh.
+     */
+    ImpactRefresher::ImpactRefresher(std::uint64_t checkEvery, double threshold) : checkEvery(checkEvery), threshold(threshold) {
+    }
+
+    /**
+     * @brief Destructor; waits for a running refresh.
+     */
+    ImpactRefresher::~ImpactRefresher() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->worker.joinable()) {
+            this->worker.join();
+        }
+    }
+
+    /**
+     * @brief Notes an indexed document and checks for drift every checkEvery documents.
+     */
+    void ImpactRefresher::documentIndexed() {
+        if (++this->indexed % this->checkEvery == 0) {
+            this->refresh(false);
+        }
+    }
+
+    /**
+     * @brief Starts a drift check and refresh in the background.
+     *
+     * @param force Refresh even if the statistics did not drift.
+     * @return True if a refresh was started, false if one is already running.
+     */
+    bool ImpactRefresher::refresh(bool force) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->running.exchange(true)) {
+            return false;
+        }
+        // The previous refresh has finished, release its thread before starting the next one
+        if (this->worker.joinable()) {
+            this->worker.join();
+        }
+        this->worker = std::thread(&ImpactRefresher::run, this, force);
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of completed refreshes.
+     *
+     * @return std::uint64_t The number of completed refreshes.
+     */
+    std::uint64_t ImpactRefresher::completed() const {
+        return this->refreshes.load();
+    }
+
+    /**
+     * @brief Checks the drift (unless forced) and refreshes the impacts.
+     *
+     * @param force Refresh even if the statistics did not drift.
+     */
+    void ImpactRefresher::run(bool force) {
+        try {
+            indexer_db::IndexerDB db;
+            if (force || impact::drifted(db.getCorpusStats(), db.countDocuments(), this->threshold)) {
+                impact::CorpusStats stats = db.refreshImpacts();
+                this->refreshes++;
+                std::cerr << "Refreshed impacts for " << stats.totalDocuments << " documents (version " << stats.version << ")" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error refreshing impacts: " << e.what() << std::endl;
+        }
+        this->running = false;
+    }
+
+}
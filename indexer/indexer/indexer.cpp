@@ -2,9 +2,43 @@
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include "metrics/metrics.hpp"
+#include "dedup/simHash.hpp"
 
 namespace indexer {
 
+    namespace {
+
+        /**
+         * @struct IndexMetrics
+         * @brief Histograms and counters of the indexing pipeline, created once per process.
+         */
+        struct IndexMetrics {
+            metrics::Histogram& total;
+            metrics::Histogram& tokenize;
+            metrics::Histogram& upsert;
+            metrics::Counter& documents;
+            metrics::Counter& terms;
+            metrics::Counter& upsertErrors;
+            metrics::Counter& duplicates;
+        };
+
+        IndexMetrics& indexMetrics() {
+            static const std::string stageHelp = "Time spent in each stage of Indexer::indexDocument";
+            static metrics::Registry& registry = metrics::Registry::instance();
+            static IndexMetrics instance{
+                registry.histogram("index_stage_seconds", stageHelp, "stage=\"total\""),
+                registry.histogram("index_stage_seconds", stageHelp, "stage=\"tokenize\""),
+                registry.histogram("index_stage_seconds", stageHelp, "stage=\"upsert\""),
+                registry.counter("index_documents_total", "Documents indexed"),
+                registry.counter("index_terms_total", "Term postings upserted"),
+                registry.counter("index_upsert_errors_total", "Term upserts that failed"),
+                registry.counter("index_duplicates_total", "Near-duplicate documents skipped or indexed as aliases")
+            };
+            return instance;
+        }
+    }
+
     /**
      * @brief Default constructor for the Indexer class.
      * 
@@ -14,35 +48,205 @@ namespace indexer {
         this->db = std::make_shared<indexer_db::IndexerDB>();
     }
 
+    /**
+     * @brief Constructor for the Indexer class with near-duplicate detection and a delta index.
+     * 
+     * @param duplicates The detector holding the canonical documents; may be null.
+     * @param action What to do with a near-duplicate.
+     * @param delta The delta index documents are added to; may be null.
+     * @param log The write-ahead log in front of the delta; may be null.
+     */
+    Indexer::Indexer(dedup::DuplicateDetector* duplicates, dedup::DuplicateAction action, delta::DeltaIndex* delta, delta::WriteAheadLog* log) : Indexer() {
+        this->duplicates = duplicates;
+        this->duplicateAction = action;
+        this->delta = delta;
+        this->log = log;
+    }
+
     /**
      * @brief Indexes a given document.
      * 
      * This function processes the content of the document, extracts unique terms, calculates their term frequencies (TF),
      * and inserts or updates the index database with the term information.
      * 
+     * With duplicate detection enabled, the SimHash of the term frequencies is checked against
+     * the canonical documents first. A near-duplicate is not indexed; as an alias, it is recorded
+     * with the URL of its canonical document and its terms. A canonical document that turns into
+     * a near-duplicate is removed first. Documents with fewer than dedup::MIN_TERMS distinct
+     * terms are always indexed.
+     * 
+     * With a delta index, the terms are added to the delta, where they are searchable at once,
+     * and written to the database in the background. With a write-ahead log, the call returns
+     * once the document is logged on disk.
+     * 
      * @param document Pointer to the document to be indexed.
+     * @return bool True if its terms were indexed, false if it was dropped as a near-duplicate.
+     * @throws std::exception If the fingerprint cannot be stored; the detector is left unchanged.
      */
-    void Indexer::indexDocument(Document* document) {
+    bool Indexer::indexDocument(Document* document) {
+        IndexMetrics& stages = indexMetrics();
+        metrics::ScopedTimer totalTimer(stages.total);
+        stages.documents.add();
+
         std::unordered_map<std::string, int> terms;
-        splitContentUniqueTerms(document->content, terms, ' ');
+        {
+            metrics::ScopedTimer timer(stages.tokenize);
+            splitContentUniqueTerms(document->content, terms, ' ');
+        }
 
-        // Process each term extracted from the document
-        for (const auto& pair : terms) {
-            std::string term = pair.first;
-            removeWhitespace(term);
+        delta::PendingDocument version;
+        version.url = document->url;
+        version.docLength = static_cast<int>(document->content.size());
+        version.terms = termFrequencies(terms);
 
-            // Calculate term frequency (TF) for the current term in the document
-            float tf = static_cast<float>(pair.second) / terms.size();
+        // Near-duplicates of a canonical document add nothing but posting list length
+        if (this->duplicates && this->duplicateAction != dedup::DuplicateAction::Off && terms.size() >= dedup::MIN_TERMS) {
+            indexer_db::Fingerprint fingerprint;
+            fingerprint.url = document->url;
+            fingerprint.simHash = dedup::simHash(terms);
+            if (this->duplicates->check(document->url, fingerprint.simHash, fingerprint.canonical)) {
+                stages.duplicates.add();
+                // The postings of its earlier version would otherwise stay searchable
+                if (this->duplicates->contains(document->url)) {
+                    this->removeDocument(document->url);
+                }
+                if (this->duplicateAction == dedup::DuplicateAction::Alias) {
+                    fingerprint.terms = std::move(version.terms);
+                    fingerprint.docLength = version.docLength;
+                    this->db->upsertFingerprint(fingerprint);
+                }
+                return false;
+            }
+            // The detector only learns the document once its fingerprint is stored
+            this->db->upsertFingerprint(fingerprint);
+            this->duplicates->add(document->url, fingerprint.simHash);
+        }
+
+        this->addVersion(std::move(version));
+        return true;
+    }
+
+    /**
+     * @brief Removes a document from the index.
+     * 
+     * With a delta index, the delete hides the document from searches at once and is written
+     * in the background. The fingerprint is removed at once; the aliases of a canonical document
+     * are indexed in its place, or recorded as aliases of another canonical document they
+     * nearly duplicate.
+     * 
+     * @param url The URL of the document.
+     * @throws std::exception If a fingerprint cannot be stored or removed.
+     */
+    void Indexer::removeDocument(const std::string& url) {
+        delta::PendingDocument version;
+        version.url = url;
+        version.deleted = true;
+        this->addVersion(std::move(version));
+
+        this->db->removeFingerprint(url);
+        if (!this->duplicates) {
+            return;
+        }
+        bool canonical = this->duplicates->contains(url);
+        this->duplicates->erase(url);
+        if (canonical && this->duplicateAction == dedup::DuplicateAction::Alias) {
+            this->promoteAliases(url);
+        }
+    }
+
+    /**
+     * @brief Writes a document version to the database.
+     * 
+     * The URL is first pulled from the terms an earlier version contained and this one does
+     * not, then every term is upserted with its term frequency; a delete pulls the URL from
+     * every term. Both are idempotent, so a version that failed part-way is simply written again.
+     * 
+     * @param document The version; a delete removes every posting of the URL.
+     * @throws std::exception If a write fails, so that the delta persister retries the version.
+     */
+    void Indexer::persistDocument(const delta::PendingDocument& document) {
+        IndexMetrics& stages = indexMetrics();
+        if (document.deleted) {
+            this->db->removePostings(document.url, std::vector<std::string>());
+            return;
+        }
 
+        // Impacts are computed with the statistics of the last refresh so that all terms stay comparable
+        impact::CorpusStats stats = this->db->getCorpusStats();
+
+        // Pull the URL from the terms only an earlier version contained, or they match the page again once it leaves the delta
+        std::vector<std::string> terms;
+        terms.reserve(document.terms.size());
+        for (const auto& term : document.terms) {
+            terms.push_back(term.first);
+        }
+        this->db->removePostings(document.url, terms);
+
+        for (const auto& term : document.terms) {
             try {
-                indexer_db::IndexDocument indexDocument{document->url, tf, static_cast<int>(document->content.size())};
-                this->db.get()->upsertIndexDocument(indexDocument, term);
+                metrics::ScopedTimer timer(stages.upsert);
+                indexer_db::IndexDocument indexDocument{document.url, term.second, document.docLength};
+                this->db.get()->upsertIndexDocument(indexDocument, term.first, stats);
+                stages.terms.add();
             } catch (std::exception& e) {
                 std::cerr << "Error executing upsert: " << e.what() << std::endl;
+                stages.upsertErrors.add();
+                throw;
             }
         }
     }
 
+    /**
+     * @brief Adds a document version to the write-ahead log, the delta or the database.
+     * 
+     * @param version The version; a delete removes every posting of the URL.
+     */
+    void Indexer::addVersion(delta::PendingDocument&& version) {
+        if (this->log) {
+            if (version.deleted) {
+                this->log->remove(version.url);
+            } else {
+                this->log->add(version.url, std::move(version.terms), version.docLength);
+            }
+        } else if (this->delta) {
+            if (version.deleted) {
+                this->delta->remove(version.url);
+            } else {
+                this->delta->add(version.url, std::move(version.terms), version.docLength);
+            }
+        } else {
+            this->persistDocument(version);
+        }
+    }
+
+    /**
+     * @brief Indexes or re-assigns the aliases of a deleted canonical document.
+     * 
+     * An alias that nearly duplicates another canonical document becomes its alias; any other
+     * becomes canonical and is indexed with the terms stored with its fingerprint, so the
+     * first of several similar aliases takes over and the rest follow it.
+     * 
+     * @param canonical The URL of the deleted canonical document, already erased from the detector.
+     * @throws std::exception If a fingerprint cannot be read or stored.
+     */
+    void Indexer::promoteAliases(const std::string& canonical) {
+        for (indexer_db::Fingerprint& alias : this->db->getAliases(canonical)) {
+            alias.canonical.clear();
+            if (this->duplicates->check(alias.url, alias.simHash, alias.canonical)) {
+                this->db->upsertFingerprint(alias);
+                continue;
+            }
+
+            delta::PendingDocument version;
+            version.url = alias.url;
+            version.docLength = alias.docLength;
+            version.terms = std::move(alias.terms);
+            this->db->upsertFingerprint(alias);
+            this->duplicates->add(alias.url, alias.simHash);
+            this->addVersion(std::move(version));
+        }
+    }
+
     /**
      * @brief Splits the content into unique terms based on a delimiter.
      * 
@@ -60,6 +264,26 @@ namespace indexer {
         }
     }
 
+    /**
+     * @brief Turns the term counts of a document into term frequencies.
+     * 
+     * @param counts The terms with their number of occurrences.
+     * @return std::vector<std::pair<std::string, float>> The terms without whitespace, with their frequency relative to the number of unique terms.
+     */
+    std::vector<std::pair<std::string, float>> Indexer::termFrequencies(const std::unordered_map<std::string, int>& counts) {
+        std::vector<std::pair<std::string, float>> frequencies;
+        frequencies.reserve(counts.size());
+        for (const auto& pair : counts) {
+            std::string term = pair.first;
+            removeWhitespace(term);
+
+            // Calculate term frequency (TF) for the current term in the document
+            float tf = static_cast<float>(pair.second) / counts.size();
+            frequencies.emplace_back(std::move(term), tf);
+        }
+        return frequencies;
+    }
+
     /**
      * @brief Removes whitespace from a string.
      * 
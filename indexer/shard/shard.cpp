@@ -0,0 +1,49 @@
+#include <shard/shard.hpp>
+
+namespace shard {
+
+    /**
+     * @brief Hashes a string with 64 bit FNV-1a.
+     *
+     * @param value The string to hash.
+     * @return std::uint64_t The hash.
+     */
+    std::uint64_t stableHash(const std::string& value) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : value) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Returns the shard a document belongs to.
+     *
+     * @param url The URL of the document.
+     * @param shards The number of shards.
+     * @return std::size_t The shard, in [0, shards).
+     */
+    std::size_t shardOf(const std::string& url, std::size_t shards) {
+        if (shards <= 1) {
+            return 0;
+        }
+        return static_cast<std::size_t>(stableHash(url) % shards);
+    }
+
+    /**
+     * @brief Returns the name of a sharded collection.
+     *
+     * @param base The collection name, e.g. "index".
+     * @param shard The shard.
+     * @param shards The number of shards.
+     * @return std::string The base name if shards is 1, otherwise base + "_" + shard.
+     */
+    std::string collectionName(const std::string& base, std::size_t shard, std::size_t shards) {
+        if (shards <= 1) {
+            return base;
+        }
+        return base + "_" + std::to_string(shard);
+    }
+
+}
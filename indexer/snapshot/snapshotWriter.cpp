@@ -0,0 +1,297 @@
+#include "snapshot/snapshotWriter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <unistd.h>
+
+namespace snapshot {
+
+    namespace {
+
+        void putVarint(std::string& out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        std::size_t varintLength(std::uint64_t value) {
+            std::size_t length = 1;
+            while (value >= 0x80) {
+                value >>= 7;
+                length++;
+            }
+            return length;
+        }
+
+        /**
+         * @brief Returns the length of the scheme and host of a URL, up to the first '/' of the path.
+         *
+         * @param url The URL.
+         * @return std::size_t The length of the prefix; 0 if the URL has no scheme.
+         */
+        std::size_t hostLength(std::string_view url) {
+            std::size_t scheme = url.find("://");
+            if (scheme == std::string_view::npos) {
+                return 0;
+            }
+            std::size_t path = url.find('/', scheme + 3);
+            return path == std::string_view::npos ? url.size() : path;
+        }
+    }
+
+    /**
+     * @brief Constructor for the SnapshotWriter class; creates the temporary file.
+     *
+     * @param path The path of the snapshot.
+     * @param stats The corpus statistics the impacts were computed with.
+     * @param shard The shard the snapshot is exported from.
+     * @param shards The number of shards of the index.
+     * @param createdMs Milliseconds since the epoch when the export started.
+     * @throws std::runtime_error If the file cannot be created.
+     */
+    SnapshotWriter::SnapshotWriter(const std::string& path, const impact::CorpusStats& stats, std::uint32_t shard, std::uint32_t shards, std::int64_t createdMs) : path(path) {
+        this->file = std::fopen((path + ".tmp").c_str(), "wb");
+        if (!this->file) {
+            throw std::runtime_error("cannot create " + path + ".tmp: " + std::strerror(errno));
+        }
+
+        std::memcpy(this->header.magic, MAGIC, sizeof(MAGIC));
+        this->header.formatVersion = FORMAT_VERSION;
+        this->header.headerSize = sizeof(SnapshotHeader);
+        this->header.shard = shard;
+        this->header.shards = shards;
+        this->header.createdMs = createdMs;
+        this->header.statsVersion = stats.version;
+        this->header.totalDocuments = stats.totalDocuments;
+        this->header.avgDocLength = stats.avgDocLength;
+
+        // Room for the header, which is only known at the end
+        SnapshotHeader empty{};
+        if (std::fwrite(&empty, sizeof(empty), 1, this->file) != 1) {
+            throw std::runtime_error("cannot write " + path + ".tmp");
+        }
+        this->offset = sizeof(SnapshotHeader);
+        this->header.postingsOffset = this->offset;
+    }
+
+    /**
+     * @brief Destructor; removes the temporary file if finish() was not called.
+     */
+    SnapshotWriter::~SnapshotWriter() {
+        if (this->file) {
+            std::fclose(this->file);
+            std::remove((this->path + ".tmp").c_str());
+        }
+    }
+
+    /**
+     * @brief Adds the postings of a term.
+     *
+     * @param term The term; every term may be added once.
+     * @param postings The impact-ordered postings of the term.
+     * @throws std::runtime_error On write errors.
+     */
+    void SnapshotWriter::addTerm(const std::string& term, const std::vector<impact::ImpactPosting>& postings) {
+        std::vector<std::uint32_t> docIds;
+        std::vector<std::uint16_t> impacts;
+        docIds.reserve(postings.size());
+        impacts.reserve(postings.size());
+        for (const impact::ImpactPosting& posting : postings) {
+            auto it = this->ids.find(posting.url);
+            if (it == this->ids.end()) {
+                it = this->ids.emplace(posting.url, static_cast<std::uint32_t>(this->urls.size())).first;
+                this->urls.push_back(posting.url);
+            }
+            docIds.push_back(it->second);
+            impacts.push_back(posting.impact);
+        }
+
+        TermEntry entry{};
+        entry.nameLength = static_cast<std::uint32_t>(term.size());
+        entry.postingCount = static_cast<std::uint32_t>(postings.size());
+        entry.postingsOffset = this->offset;
+        entry.maxImpact = impacts.empty() ? 0 : impacts.front();
+        this->terms.emplace_back(term, entry);
+
+        this->write(docIds.data(), docIds.size() * sizeof(std::uint32_t));
+        this->write(impacts.data(), impacts.size() * sizeof(std::uint16_t));
+        this->pad();
+        this->header.postingCount += postings.size();
+    }
+
+    /**
+     * @brief Writes the document table, the term dictionary and the header, then publishes the file.
+     *
+     * The data is flushed to disk before the rename, so after a crash the path holds either
+     * the previous or the new snapshot.
+     *
+     * @return SnapshotHeader The header of the written snapshot.
+     * @throws std::runtime_error On write errors.
+     */
+    SnapshotHeader SnapshotWriter::finish() {
+        this->header.documentsOffset = this->offset;
+        this->header.documentCount = this->urls.size();
+        this->writeUrlTable();
+
+        // Term dictionary, sorted for binary search
+        std::sort(this->terms.begin(), this->terms.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        this->header.termsOffset = this->offset;
+        this->header.termCount = this->terms.size();
+        std::uint64_t nameBytes = 0;
+        for (auto& term : this->terms) {
+            term.second.nameOffset = nameBytes;
+            nameBytes += term.first.size();
+        }
+        for (const auto& term : this->terms) {
+            this->write(&term.second, sizeof(TermEntry));
+        }
+        for (const auto& term : this->terms) {
+            this->write(term.first.data(), term.first.size());
+        }
+        this->pad();
+
+        this->header.fileSize = this->offset;
+        this->header.checksum = this->crc;
+        if (std::fseek(this->file, 0, SEEK_SET) != 0 ||
+            std::fwrite(&this->header, sizeof(SnapshotHeader), 1, this->file) != 1 ||
+            std::fflush(this->file) != 0 ||
+            fsync(fileno(this->file)) != 0) {
+            throw std::runtime_error("cannot write " + this->path + ".tmp: " + std::strerror(errno));
+        }
+        std::fclose(this->file);
+        this->file = nullptr;
+
+        if (std::rename((this->path + ".tmp").c_str(), this->path.c_str()) != 0) {
+            throw std::runtime_error("cannot rename " + this->path + ".tmp: " + std::strerror(errno));
+        }
+        return this->header;
+    }
+
+    /**
+     * @brief Writes the document table as a front-coded URL table.
+     *
+     * The URLs are sorted, so neighbours share their scheme, host and leading path segments,
+     * and every URL after the first of a block stores only what differs from its predecessor.
+     * The document ids keep the order they were assigned in by addTerm; positions maps them
+     * to the rank of their URL. The block heads refer to a host dictionary when that is
+     * smaller than spelling out their hosts.
+     *
+     * @throws std::runtime_error On write errors.
+     */
+    void SnapshotWriter::writeUrlTable() {
+        std::vector<std::uint32_t> order(this->urls.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) { return this->urls[a] < this->urls[b]; });
+        std::vector<std::uint32_t> positions(this->urls.size());
+        for (std::uint32_t rank = 0; rank < order.size(); rank++) {
+            positions[order[rank]] = rank;
+        }
+
+        // Hosts of the block heads; the heads are sorted, so equal hosts are adjacent
+        std::vector<std::string_view> hosts;
+        std::uint64_t plainHeads = 0;
+        std::uint64_t hostHeads = 0;
+        for (std::size_t rank = 0; rank < order.size(); rank += URL_BLOCK_SIZE) {
+            std::string_view url = this->urls[order[rank]];
+            std::string_view host = url.substr(0, hostLength(url));
+            if (hosts.empty() || hosts.back() != host) {
+                hosts.push_back(host);
+                hostHeads += host.size() + sizeof(std::uint64_t);
+            }
+            plainHeads += varintLength(url.size()) + url.size();
+            hostHeads += varintLength(hosts.size() - 1) + varintLength(url.size() - host.size()) + url.size() - host.size();
+        }
+        bool useHosts = !hosts.empty() && hostHeads + sizeof(std::uint64_t) < plainHeads;
+
+        UrlTableHeader table{};
+        table.blockSize = URL_BLOCK_SIZE;
+        table.flags = useHosts ? URL_HOST_DICTIONARY : 0;
+        table.blockCount = (order.size() + URL_BLOCK_SIZE - 1) / URL_BLOCK_SIZE;
+        table.hostCount = useHosts ? hosts.size() : 0;
+
+        std::string blocks;
+        std::vector<std::uint64_t> blockOffsets;
+        blockOffsets.reserve(table.blockCount + 1);
+        std::size_t host = 0;
+        for (std::size_t rank = 0; rank < order.size(); rank++) {
+            const std::string& url = this->urls[order[rank]];
+            if (rank % URL_BLOCK_SIZE == 0) {
+                blockOffsets.push_back(blocks.size());
+                std::size_t prefix = 0;
+                if (useHosts) {
+                    prefix = hostLength(url);
+                    while (hosts[host] != std::string_view(url).substr(0, prefix)) {
+                        host++;
+                    }
+                    putVarint(blocks, host);
+                }
+                putVarint(blocks, url.size() - prefix);
+                blocks.append(url, prefix, std::string::npos);
+                continue;
+            }
+            const std::string& previous = this->urls[order[rank - 1]];
+            std::size_t shared = 0;
+            std::size_t limit = std::min(previous.size(), url.size());
+            while (shared < limit && previous[shared] == url[shared]) {
+                shared++;
+            }
+            putVarint(blocks, shared);
+            putVarint(blocks, url.size() - shared);
+            blocks.append(url, shared, std::string::npos);
+        }
+        blockOffsets.push_back(blocks.size());
+        table.blockBytes = blocks.size();
+
+        this->write(&table, sizeof(table));
+        this->write(positions.data(), positions.size() * sizeof(std::uint32_t));
+        this->pad();
+        this->write(blockOffsets.data(), blockOffsets.size() * sizeof(std::uint64_t));
+        if (useHosts) {
+            std::vector<std::uint64_t> hostOffsets;
+            hostOffsets.reserve(hosts.size() + 1);
+            std::uint64_t hostBytes = 0;
+            for (std::string_view name : hosts) {
+                hostOffsets.push_back(hostBytes);
+                hostBytes += name.size();
+            }
+            hostOffsets.push_back(hostBytes);
+            this->write(hostOffsets.data(), hostOffsets.size() * sizeof(std::uint64_t));
+            for (std::string_view name : hosts) {
+                this->write(name.data(), name.size());
+            }
+            this->pad();
+        }
+        this->write(blocks.data(), blocks.size());
+        this->pad();
+    }
+
+    /**
+     * @brief Appends bytes to the file and the checksum.
+     *
+     * @param data The bytes.
+     * @param size The number of bytes.
+     */
+    void SnapshotWriter::write(const void* data, std::size_t size) {
+        if (size == 0) {
+            return;
+        }
+        if (std::fwrite(data, 1, size, this->file) != size) {
+            throw std::runtime_error("cannot write " + this->path + ".tmp: " + std::strerror(errno));
+        }
+        this->crc = checksum(this->crc, data, size);
+        this->offset += size;
+    }
+
+    /**
+     * @brief Appends zero bytes up to the next 8 byte boundary.
+     */
+    void SnapshotWriter::pad() {
+        static const char zeros[8] = {};
+        this->write(zeros, align8(this->offset) - this->offset);
+    }
+
+}
@@ -0,0 +1,140 @@
+#include <admission/admissionController.hpp>
+#include <http/httpResponse.hpp>
+#include <string>
+
+namespace admission {
+
+    /**
+     * @brief Constructor for the AdmissionController class.
+     * 
+     * @param options The limits and shedding parameters.
+     */
+    AdmissionController::AdmissionController(const AdmissionOptions& options) : options(options) {
+    }
+
+    /**
+     * @brief Waits (bounded) for an execution slot.
+     * 
+     * A request is admitted immediately if a slot is free and nobody is queued. Otherwise it
+     * joins the queue, unless the queue is full, and waits for maxQueueWait, or only for the
+     * CoDel target while the route is overloaded.
+     * 
+     * @return bool True if the request was admitted, false if it was shed.
+     */
+    bool AdmissionController::acquire() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        Clock::time_point enqueued = Clock::now();
+
+        if (this->inFlight < this->options.maxConcurrent && this->queued == 0) {
+            this->inFlight++;
+            this->admitted++;
+            this->observeDelay(Clock::duration::zero(), enqueued);
+            return true;
+        }
+
+        if (this->queued >= this->options.maxQueue) {
+            this->shedQueueFull++;
+            return false;
+        }
+
+        // Under sustained overload waiting any longer than the target only adds latency
+        Clock::duration wait = this->overloaded(enqueued) ? Clock::duration(this->options.target) : Clock::duration(this->options.maxQueueWait);
+
+        this->queued++;
+        bool gotSlot = this->slotFreed.wait_until(lock, enqueued + wait, [this]() {
+            return this->inFlight < this->options.maxConcurrent;
+        });
+        this->queued--;
+
+        Clock::time_point now = Clock::now();
+        this->observeDelay(now - enqueued, now);
+        if (!gotSlot) {
+            this->shedTimeout++;
+            return false;
+        }
+
+        this->inFlight++;
+        this->admitted++;
+        return true;
+    }
+
+    /**
+     * @brief Frees the execution slot of an admitted request and wakes one waiter.
+     */
+    void AdmissionController::release() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->inFlight--;
+        }
+        this->slotFreed.notify_one();
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters.
+     * 
+     * @return AdmissionStats The current counters.
+     */
+    AdmissionStats AdmissionController::stats() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        AdmissionStats s;
+        s.inFlight = this->inFlight;
+        s.queued = this->queued;
+        s.admitted = this->admitted;
+        s.shedQueueFull = this->shedQueueFull;
+        s.shedTimeout = this->shedTimeout;
+        s.overloaded = this->overloaded(Clock::now());
+        return s;
+    }
+
+    const AdmissionOptions& AdmissionController::getOptions() const {
+        return this->options;
+    }
+
+    /**
+     * @brief Records the queueing delay of a request and updates the CoDel state.
+     * 
+     * A delay below target resets the state. The first delay above target starts an interval;
+     * if no request gets through below target before it ends, the route becomes overloaded.
+     * 
+     * @param sojourn Time the request spent waiting.
+     * @param now The current time.
+     */
+    void AdmissionController::observeDelay(Clock::duration sojourn, Clock::time_point now) {
+        if (sojourn < this->options.target) {
+            this->firstAboveTime = Clock::time_point{};
+        } else if (this->firstAboveTime == Clock::time_point{}) {
+            this->firstAboveTime = now + this->options.interval;
+        }
+    }
+
+    // The route is overloaded once the delay has stayed above target for a full interval
+    bool AdmissionController::overloaded(Clock::time_point now) const {
+        return this->firstAboveTime != Clock::time_point{} && now >= this->firstAboveTime;
+    }
+
+    /**
+     * @brief Wraps a route handler with admission control.
+     * 
+     * @param controller The controller of the route; must outlive the router.
+     * @param handler The route handler.
+     * @return The guarded handler.
+     */
+    std::function<void(jetpp::Request&, jetpp::Response&)> guard(AdmissionController& controller, std::function<void(jetpp::Request&, jetpp::Response&)> handler) {
+        return [&controller, handler](jetpp::Request& req, jetpp::Response& res) {
+            if (!controller.acquire()) {
+                res.addHeader("Retry-After", std::to_string(controller.getOptions().retryAfterSeconds));
+                http::send(res, 503, "Service Unavailable");
+                return;
+            }
+
+            // Release the slot even if the handler throws
+            struct Slot {
+                AdmissionController& controller;
+                ~Slot() { controller.release(); }
+            } slot{controller};
+
+            handler(req, res);
+        };
+    }
+
+}
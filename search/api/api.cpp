@@ -3,65 +3,830 @@
 #include "jetplusplus/json/jsonConverter.hpp"
 #include "jetplusplus/json/value.hpp"
 #include <searcher/searcher.hpp>
+#include <searcher/singleFlight.hpp>
+#include <serializer/resultSerializer.hpp>
+#include <serializer/jsonWriter.hpp>
+#include <admission/admissionController.hpp>
+#include <cache/resultCache.hpp>
+#include <compression/compression.hpp>
+#include <metrics/metrics.hpp>
+#include <slowlog/slowQueryLog.hpp>
+#include <scoring/scoringKernel.hpp>
+#include <threadpool/threadPool.hpp>
+#include <shard/shardClient.hpp>
+#include <shard/shardCoordinator.hpp>
+#include <snapshot/liveSnapshot.hpp>
+#include <dictionary/termDictionary.hpp>
+#include <dictionary/dictionarySync.hpp>
+#include <suggest/suggester.hpp>
+#include <delta/deltaClient.hpp>
+#include <changes/changeFeed.hpp>
+#include <http/httpResponse.hpp>
+#include <http/queryString.hpp>
+#include <ranking/reranker.hpp>
+#include <db/searchdb.hpp>
 #include <mongocxx/instance.hpp>
 #include <memory>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <thread>
+#include <sstream>
+#include <stdexcept>
+
+// Time budget of a search request without an X-Deadline-Ms header, and the largest budget a client may ask for
+static const long DEFAULT_DEADLINE_MS = 1000;
+static const long MAX_DEADLINE_MS = 10000;
+
+// Least time a coalesced search must have left after waiting for its leader to still run on its own
+static const long MIN_FALLBACK_MS = 100;
+
+/**
+ * @brief Looks up a request header, ignoring the case of its name.
+ * 
+ * @param req The incoming request.
+ * @param name The header name.
+ * @return std::string The header value, or an empty string if the header is missing.
+ */
+static std::string headerValue(jetpp::Request& req, const std::string& name) {
+    for (const auto& header : req.headers) {
+        if (header.first.size() == name.size() &&
+            std::equal(name.begin(), name.end(), header.first.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            })) {
+            return header.second;
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Reads the deadline of a search request from its X-Deadline-Ms header.
+ * 
+ * @param req The incoming request.
+ * @return searcher::Deadline The deadline, clamped to [1, MAX_DEADLINE_MS] milliseconds from now.
+ */
+static searcher::Deadline requestDeadline(jetpp::Request& req) {
+    long budget = DEFAULT_DEADLINE_MS;
+    std::string header = headerValue(req, "X-Deadline-Ms");
+    if (!header.empty()) {
+        try {
+            budget = std::stol(header);
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid X-Deadline-Ms header: " << header << std::endl;
+        }
+    }
+    budget = std::max(1L, std::min(budget, MAX_DEADLINE_MS));
+    return searcher::Deadline::after(std::chrono::milliseconds(budget));
+}
+
+/**
+ * @brief Checks whether the client asked for an inline trace with the X-Trace header.
+ * 
+ * @param req The incoming request.
+ * @return True if X-Trace is present and not "0" or "false".
+ */
+static bool traceRequested(jetpp::Request& req) {
+    std::string header = headerValue(req, "X-Trace");
+    return !header.empty() && header != "0" && header != "false";
+}
+
+/**
+ * @brief Checks whether a search request keeps fuzzy matching of unknown terms enabled.
+ * 
+ * @param req The incoming request.
+ * @return True unless the fuzzy query parameter is "false" or "0".
+ */
+static bool fuzzyRequested(jetpp::Request& req) {
+    std::string value = req.query["fuzzy"];
+    return value != "false" && value != "0";
+}
+
+/**
+ * @brief Reads how a search request ranks its results from the rerank and features query parameters.
+ * 
+ * @param req The incoming request.
+ * @return ranking::RankingOptions The options, the defaults if missing or invalid.
+ */
+static ranking::RankingOptions rankingRequested(jetpp::Request& req) {
+    try {
+        return ranking::RankingOptions::parse(req.query["rerank"], req.query["features"]);
+    } catch (const std::exception& e) {
+        std::cerr << "Ignoring invalid ranking parameters: " << e.what() << std::endl;
+        return ranking::RankingOptions();
+    }
+}
+
+/**
+ * @brief Reads the number of suggestions requested with the limit query parameter.
+ * 
+ * @param req The incoming request.
+ * @return std::size_t The limit, 10 if missing or invalid, at most shard::MAX_SHARD_SUGGESTIONS.
+ */
+static std::size_t suggestionLimit(jetpp::Request& req) {
+    std::size_t limit = 10;
+    std::string value = req.query["limit"];
+    if (!value.empty()) {
+        try {
+            limit = static_cast<std::size_t>(std::max(1L, std::stol(value)));
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid suggestion limit: " << value << std::endl;
+        }
+    }
+    return std::min<std::size_t>(limit, shard::MAX_SHARD_SUGGESTIONS);
+}
+
+/**
+ * @brief Reads the slow-query log configuration from the environment.
+ * 
+ * SEARCH_SLOW_QUERY_MS sets the threshold and SEARCH_SLOW_QUERY_LOG the file; everything else keeps its default.
+ * 
+ * @return slowlog::SlowQueryLogOptions The options of the slow-query log.
+ */
+static slowlog::SlowQueryLogOptions slowQueryOptions() {
+    slowlog::SlowQueryLogOptions options;
+    if (const char* threshold = std::getenv("SEARCH_SLOW_QUERY_MS")) {
+        try {
+            options.threshold = std::chrono::milliseconds(std::stol(threshold));
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid SEARCH_SLOW_QUERY_MS: " << threshold << std::endl;
+        }
+    }
+    if (const char* path = std::getenv("SEARCH_SLOW_QUERY_LOG")) {
+        options.path = path;
+    }
+    return options;
+}
+
+/**
+ * @brief Reads the number of scoring pool workers from SEARCH_SCORING_THREADS.
+ * 
+ * Defaults to one worker per hardware thread; the request thread of a parallel query takes part as well.
+ * 
+ * @return std::size_t The number of workers.
+ */
+static std::size_t scoringThreads() {
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    if (const char* configured = std::getenv("SEARCH_SCORING_THREADS")) {
+        try {
+            threads = static_cast<std::size_t>(std::max(1L, std::stol(configured)));
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid SEARCH_SCORING_THREADS: " << configured << std::endl;
+        }
+    }
+    return threads;
+}
+
+/**
+ * @brief Reads the database connection budget of the searches from SEARCH_DB_CONNECTIONS.
+ * 
+ * Every search query runs on one of the fetch pool's clients, so this is both the number of
+ * fetch workers and of connections. Defaults to one connection per concurrently executing
+ * search, as many as the searches held with a client each before.
+ * 
+ * @param concurrentSearches The admission limit of concurrently executing searches.
+ * @return std::size_t The number of connections.
+ */
+static std::size_t dbConnections(std::size_t concurrentSearches) {
+    std::size_t connections = std::max<std::size_t>(1, concurrentSearches);
+    if (const char* configured = std::getenv("SEARCH_DB_CONNECTIONS")) {
+        try {
+            connections = static_cast<std::size_t>(std::max(1L, std::stol(configured)));
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid SEARCH_DB_CONNECTIONS: " << configured << std::endl;
+        }
+    }
+    return connections;
+}
+
+/**
+ * @brief Reads the number of shard request workers of a coordinator from SEARCH_SHARD_THREADS.
+ * 
+ * The workers only wait on shard round-trips. Defaults to enough of them for every
+ * concurrently executing search to reach all shards at once; the request thread of a search
+ * sends one of the requests itself.
+ * 
+ * @param shards The number of shards.
+ * @param concurrentSearches The admission limit of concurrently executing searches.
+ * @return std::size_t The number of workers.
+ */
+static std::size_t shardThreads(std::size_t shards, std::size_t concurrentSearches) {
+    std::size_t threads = std::max<std::size_t>(1, (shards - 1) * concurrentSearches);
+    if (const char* configured = std::getenv("SEARCH_SHARD_THREADS")) {
+        try {
+            threads = static_cast<std::size_t>(std::max(1L, std::stol(configured)));
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid SEARCH_SHARD_THREADS: " << configured << std::endl;
+        }
+    }
+    return threads;
+}
+
+/**
+ * @brief Sends a JSON body in the best encoding the client accepts.
+ * 
+ * Compressed bodies hold NUL bytes, which Jet++'s Response::send would cut off, so the body
+ * is written with http::send.
+ * 
+ * @param res The response.
+ * @param result The cached or freshly serialized response body.
+ * @param encoding The negotiated encoding.
+ */
+static void sendEncoded(jetpp::Response& res, cache::CachedResult& result, compression::Encoding encoding) {
+    std::string body = result.encoded(encoding);
+    res.addHeader("Content-Type", "application/json");
+    res.addHeader("Vary", "Accept-Encoding");
+    if (encoding != compression::Encoding::Identity) {
+        res.addHeader("Content-Encoding", compression::encodingName(encoding));
+    }
+    http::send(res, 200, body);
+}
+
+/**
+ * @brief Looks up the indexer's recent postings of a query, if a delta index is configured.
+ * 
+ * The lookup gets at most 50 ms of the request's time; without an answer, the search runs on
+ * the persisted index alone.
+ * 
+ * @param client The delta client; may be null.
+ * @param query The normalized search query string.
+ * @param deadline The deadline of the search request.
+ * @param view Receives the recent postings.
+ * @return const delta::DeltaView* The view, or null if there is no delta to merge.
+ */
+static const delta::DeltaView* fetchDelta(delta::DeltaClient* client, const std::string& query, const searcher::Deadline& deadline, delta::DeltaView& view) {
+    if (!client || query.empty()) {
+        return nullptr;
+    }
+    std::chrono::milliseconds timeout = std::min(deadline.remaining(), std::chrono::milliseconds(50));
+    return client->fetch(query, timeout, view) ? &view : nullptr;
+}
+
+/**
+ * @brief Wraps a route handler with request count and latency metrics.
+ * 
+ * @param route The route label, e.g. "/search".
+ * @param handler The route handler.
+ * @return The instrumented handler.
+ */
+static std::function<void(jetpp::Request&, jetpp::Response&)> instrumented(const std::string& route, std::function<void(jetpp::Request&, jetpp::Response&)> handler) {
+    metrics::Registry& registry = metrics::Registry::instance();
+    std::string labels = "route=\"" + route + "\"";
+    metrics::Counter& requests = registry.counter("http_requests_total", "HTTP requests received", labels);
+    metrics::Histogram& latency = registry.histogram("http_request_duration_seconds", "HTTP request latency including queueing", labels);
+
+    return [&requests, &latency, handler](jetpp::Request& req, jetpp::Response& res) {
+        requests.add();
+        metrics::ScopedTimer timer(latency);
+        handler(req, res);
+    };
+}
+
+/**
+ * @struct ServerOptions
+ * @brief Command line options of the search service.
+ */
+struct ServerOptions {
+    int port = 7002;                                ///< Port to listen on.
+    std::size_t shard = 0;                          ///< Shard served by this process.
+    std::size_t shards = 1;                         ///< Number of shards; 1 serves the unsharded index.
+    std::vector<shard::Endpoint> shardEndpoints;    ///< Shard searchers; non-empty makes this process the coordinator.
+    std::string snapshot;                           ///< Index snapshot loaded at startup; empty reads everything from the database.
+    std::string deltaEndpoint;                      ///< Indexer whose delta index is merged into every search; empty searches the database only.
+    bool changeStream = false;                      ///< Whether caches and statistics follow the database's change stream instead of expiring.
+};
+
+/**
+ * @brief Parses the command line.
+ * 
+ * --port P, --shard I --shards N to serve one shard, --shard-endpoints host:port,... to coordinate,
+ * --snapshot FILE to serve from an index snapshot exported by the indexer, --delta host:port to
+ * merge the documents the indexer has not persisted yet into every search, --change-stream on
+ * to invalidate cached results precisely (needs a replica set).
+ * 
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return ServerOptions The options.
+ * @throws std::invalid_argument On unknown options or invalid values.
+ */
+static ServerOptions parseOptions(int argc, char** argv) {
+    ServerOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("missing value for " + option);
+        }
+        std::string value = argv[++i];
+        if (option == "--port") {
+            options.port = std::stoi(value);
+        } else if (option == "--shard") {
+            options.shard = static_cast<std::size_t>(std::stoul(value));
+        } else if (option == "--shards") {
+            options.shards = std::max<std::size_t>(1, static_cast<std::size_t>(std::stoul(value)));
+        } else if (option == "--shard-endpoints") {
+            std::istringstream endpoints(value);
+            std::string endpoint;
+            while (std::getline(endpoints, endpoint, ',')) {
+                if (!endpoint.empty()) options.shardEndpoints.push_back(shard::Endpoint::parse(endpoint));
+            }
+        } else if (option == "--snapshot") {
+            options.snapshot = value;
+        } else if (option == "--change-stream") {
+            if (value != "on" && value != "off") {
+                throw std::invalid_argument("--change-stream must be on or off");
+            }
+            options.changeStream = value == "on";
+        } else if (option == "--delta") {
+            shard::Endpoint::parse(value);
+            options.deltaEndpoint = value;
+        } else {
+            throw std::invalid_argument("unknown option " + option);
+        }
+    }
+    if (options.shard >= options.shards) {
+        throw std::invalid_argument("--shard must be below --shards");
+    }
+    return options;
+}
 
 /**
  * @brief Main function to set up and start the server.
  * 
+ * @param argc The number of arguments.
+ * @param argv The arguments, see parseOptions.
  * @return int Exit status of the application.
  */
-int main() {
+int main(int argc, char** argv) {
+
+    ServerOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid arguments: " << e.what() << '\n'
+                  << "Usage: Search [--port P] [--shard I --shards N] [--shard-endpoints host:port,...] [--snapshot FILE] [--delta host:port] [--change-stream on|off]" << std::endl;
+        return 1;
+    }
+
+    // A shard searcher reads the collections of its own hash partition of the documents
+    searcher_db::SearcherDB::useShard(options.shard, options.shards);
 
     // Create a Router object to handle HTTP routes
     jetpp::Router router;
     // Initialize MongoDB instance (required for MongoDB operations)
     mongocxx::instance instance{};
     
+    // Concurrent requests for the same normalized query share one evaluation (bounded wait of 2 seconds)
+    searcher::SingleFlight<searcher::SearchResponse> coalescer(std::chrono::milliseconds(2000), std::chrono::milliseconds(MIN_FALLBACK_MS));
+
+    // Serialized responses of recent queries, kept with their compressed variants; invalidated by the change stream if enabled
+    cache::ResultCache resultCache(10000, options.changeStream ? std::chrono::seconds(600) : std::chrono::seconds(30));
+
+    // Bound the concurrently executing searches and shed the excess with 503 before it queues up
+    admission::AdmissionOptions searchLimits;
+    searchLimits.maxConcurrent = 32;
+    searchLimits.maxQueue = 128;
+    admission::AdmissionController searchAdmission(searchLimits);
+
+    // Requests over the threshold are written, with their stage breakdown, to a rotating log file
+    slowlog::SlowQueryLog slowQueries(slowQueryOptions());
+
+    // Long queries are split into document partitions that are evaluated on this shared pool
+    threadpool::ThreadPool scoringPool(scoringThreads());
+
+    // Every database query of a search runs on one of these workers, each with its own persistent client, so their number bounds the connections
+    searcher::FetchPool fetchPool(dbConnections(searchLimits.maxConcurrent), std::chrono::milliseconds(MAX_DEADLINE_MS));
+
+    // Postings of terms not updated since the export are read from the mapped snapshot, checked for updates every second
+    std::unique_ptr<snapshot::LiveSnapshot> indexSnapshot;
+    if (!options.snapshot.empty()) {
+        try {
+            indexSnapshot = std::make_unique<snapshot::LiveSnapshot>(options.snapshot, std::chrono::milliseconds(1000));
+        } catch (const std::exception& e) {
+            std::cerr << "Error loading snapshot: " << e.what() << std::endl;
+            return 1;
+        }
+        snapshot::SnapshotInfo loaded = indexSnapshot->info();
+        if (loaded.shard != options.shard || loaded.shards != options.shards) {
+            std::cerr << "Snapshot " << loaded.path << " holds shard " << loaded.shard << " of " << loaded.shards
+                      << ", this process serves shard " << options.shard << " of " << options.shards << std::endl;
+            return 1;
+        }
+        std::cerr << "Loaded snapshot " << loaded.path << ": " << loaded.terms << " terms, " << loaded.documents << " documents, "
+                  << loaded.postings << " postings" << std::endl;
+    }
+
+    // As coordinator, /search fans out to the shard searchers instead of reading the index itself; the
+    // shard requests block on the network, so they run on their own pool and never hold up scoring
+    std::unique_ptr<threadpool::ThreadPool> shardPool;
+    std::unique_ptr<shard::ShardCoordinator> coordinator;
+    if (!options.shardEndpoints.empty()) {
+        shardPool = std::make_unique<threadpool::ThreadPool>(shardThreads(options.shardEndpoints.size(), searchLimits.maxConcurrent));
+        coordinator = std::make_unique<shard::ShardCoordinator>(options.shardEndpoints, *shardPool);
+    }
+
+    // Every term of this shard, loaded in the background and refreshed every second; rules out absent query terms
+    dictionary::TermDictionary termDictionary;
+    std::unique_ptr<dictionary::DictionarySync> dictionarySync;
+    // Prefix completions over the same terms, rebuilt at most every 10 seconds once the dictionary has changed
+    std::unique_ptr<suggest::Suggester> suggester;
+    if (!coordinator) {
+        dictionarySync = std::make_unique<dictionary::DictionarySync>(termDictionary, std::chrono::milliseconds(1000));
+        suggester = std::make_unique<suggest::Suggester>(termDictionary, std::chrono::milliseconds(10000));
+    }
+
+    // Changed terms and statistics invalidate exactly the cached results and snapshot terms they affect
+    std::unique_ptr<changes::ChangeFeed> changeFeed;
+    if (options.changeStream) {
+        changeFeed = std::make_unique<changes::ChangeFeed>(coordinator != nullptr, &resultCache, indexSnapshot.get());
+    }
+
+    // Documents indexed in the last moments are only in the indexer's memory until they are persisted
+    std::unique_ptr<delta::DeltaClient> deltaClient;
+    if (!options.deltaEndpoint.empty() && !coordinator) {
+        deltaClient = std::make_unique<delta::DeltaClient>(shard::Endpoint::parse(options.deltaEndpoint), options.shard);
+    }
+
+    // Export the counters of the request path components
+    metrics::Registry& registry = metrics::Registry::instance();
+    metrics::Counter& searchErrors = registry.counter("http_request_errors_total", "HTTP requests answered with 500", "route=\"/search\"");
+    registry.counter("search_coalesced_total", "Searches by coalescing role", "role=\"leader\"", [&]() { return static_cast<double>(coalescer.stats().leaders); });
+    registry.counter("search_coalesced_total", "Searches by coalescing role", "role=\"follower\"", [&]() { return static_cast<double>(coalescer.stats().followers); });
+    registry.counter("search_coalesced_total", "Searches by coalescing role", "role=\"timeout\"", [&]() { return static_cast<double>(coalescer.stats().timeouts); });
+    registry.counter("search_coalesced_total", "Searches by coalescing role", "role=\"abandoned\"", [&]() { return static_cast<double>(coalescer.stats().abandoned); });
+    registry.counter("search_result_cache_total", "Result cache lookups", "outcome=\"hit\"", [&]() { return static_cast<double>(resultCache.stats().hits); });
+    registry.counter("search_result_cache_total", "Result cache lookups", "outcome=\"miss\"", [&]() { return static_cast<double>(resultCache.stats().misses); });
+    registry.gauge("search_result_cache_entries", "Entries in the result cache", "", [&]() { return static_cast<double>(resultCache.stats().entries); });
+    registry.gauge("admission_in_flight", "Requests executing", "route=\"/search\"", [&]() { return static_cast<double>(searchAdmission.stats().inFlight); });
+    registry.gauge("admission_queue_depth", "Requests waiting for a slot", "route=\"/search\"", [&]() { return static_cast<double>(searchAdmission.stats().queued); });
+    registry.counter("admission_shed_total", "Requests rejected with 503", "route=\"/search\",reason=\"queue_full\"", [&]() { return static_cast<double>(searchAdmission.stats().shedQueueFull); });
+    registry.counter("admission_shed_total", "Requests rejected with 503", "route=\"/search\",reason=\"timeout\"", [&]() { return static_cast<double>(searchAdmission.stats().shedTimeout); });
+    registry.counter("search_slow_queries_total", "Slow-query log entries", "outcome=\"written\"", [&]() { return static_cast<double>(slowQueries.stats().written); });
+    registry.counter("search_slow_queries_total", "Slow-query log entries", "outcome=\"dropped\"", [&]() { return static_cast<double>(slowQueries.stats().dropped); });
+    registry.gauge("scoring_pool_queued", "Tasks waiting in the scoring pool", "", [&]() { return static_cast<double>(scoringPool.stats().queued); });
+    registry.counter("scoring_pool_tasks_total", "Tasks run by the scoring pool workers", "", [&]() { return static_cast<double>(scoringPool.stats().executed); });
+    registry.counter("scoring_pool_steals_total", "Tasks taken from another worker's queue", "", [&]() { return static_cast<double>(scoringPool.stats().stolen); });
+    registry.gauge("fetch_pool_queued", "Posting fetches waiting for a fetch pool worker", "", [&]() { return static_cast<double>(fetchPool.stats().queued); });
+    registry.counter("fetch_pool_fetches_total", "Posting fetches run by the fetch pool", "outcome=\"fetched\"", [&]() { return static_cast<double>(fetchPool.stats().fetched); });
+    registry.counter("fetch_pool_fetches_total", "Posting fetches run by the fetch pool", "outcome=\"expired\"", [&]() { return static_cast<double>(fetchPool.stats().expired); });
+    registry.counter("fetch_pool_fetches_total", "Posting fetches run by the fetch pool", "outcome=\"failed\"", [&]() { return static_cast<double>(fetchPool.stats().failed); });
+    if (indexSnapshot) {
+        registry.counter("search_snapshot_lookups_total", "Term lookups against the index snapshot", "outcome=\"hit\"", [&]() { return static_cast<double>(indexSnapshot->info().hits); });
+        registry.counter("search_snapshot_lookups_total", "Term lookups against the index snapshot", "outcome=\"stale\"", [&]() { return static_cast<double>(indexSnapshot->info().misses); });
+        registry.gauge("search_snapshot_stale_terms", "Terms updated since the snapshot export", "", [&]() { return static_cast<double>(indexSnapshot->info().staleTerms); });
+    }
+    registry.gauge("search_dictionary_terms", "Terms in the term dictionary", "", [&]() { return static_cast<double>(termDictionary.stats().terms); });
+    registry.gauge("search_dictionary_bytes", "Approximate memory footprint of the term dictionary", "", [&]() { return static_cast<double>(termDictionary.stats().bytes); });
+    if (suggester) {
+        registry.counter("suggest_index_builds_total", "Completion indexes built", "", [&]() { return static_cast<double>(suggester->stats().builds); });
+        registry.gauge("suggest_index_bytes", "Memory footprint of the completion index", "", [&]() { return static_cast<double>(suggester->stats().bytes); });
+    }
+    if (changeFeed) {
+        registry.gauge("search_change_stream_current", "Whether the change stream is followed", "", [&]() { return changeFeed->current() ? 1.0 : 0.0; });
+        registry.counter("search_change_events_total", "Change stream events processed", "", [&]() { return static_cast<double>(changeFeed->stats().events); });
+        registry.counter("search_change_stream_failures_total", "Change streams that failed and were reopened", "", [&]() { return static_cast<double>(changeFeed->stats().failures); });
+        registry.counter("search_result_cache_invalidated_total", "Cached results dropped because their terms or the statistics changed", "", [&]() { return static_cast<double>(resultCache.stats().invalidated); });
+        registry.gauge("search_corpus_documents", "Documents in the corpus, counted from the change stream", "", [&]() { return static_cast<double>(changeFeed->stats().documents); });
+    }
+    if (deltaClient) {
+        registry.counter("search_delta_lookups_total", "Lookups of the indexer's delta index", "outcome=\"ok\"", [&]() { delta::DeltaClientStats delta = deltaClient->stats(); return static_cast<double>(delta.requests - delta.failures); });
+        registry.counter("search_delta_lookups_total", "Lookups of the indexer's delta index", "outcome=\"failed\"", [&]() { return static_cast<double>(deltaClient->stats().failures); });
+    }
+    if (coordinator) {
+        registry.counter("search_shard_failures_total", "Shard requests that failed or timed out", "", [&]() { return static_cast<double>(coordinator->stats().shardFailures); });
+    }
+
     // Define a POST route for searching
-    router.post("/search", [&](jetpp::Request& req, jetpp::Response& res) {
+    router.post("/search", instrumented("/search", admission::guard(searchAdmission, [&](jetpp::Request& req, jetpp::Response& res) {
         try {
-            std::shared_ptr<searcher::Searcher> searcher;
-            try {
-                // Initialize the Searcher object
-                searcher = std::make_shared<searcher::Searcher>();
-            } catch(const std::exception& e) {
-                std::cerr << "Error initializing searcher: " << e.what() << '\n';
-                res.status(500).send("Internal Server Error");
+            auto started = std::chrono::steady_clock::now();
+
+            // Extract and normalize the query parameter from the request
+            std::string query = searcher::Searcher::normalizeQuery(req.query["q"]);
+
+            bool details = req.query["details"] == "true";
+            bool fuzzy = fuzzyRequested(req);
+            ranking::RankingOptions ranking = rankingRequested(req);
+            bool traced = traceRequested(req);
+            compression::Encoding encoding = compression::negotiate(headerValue(req, "Accept-Encoding"));
+
+            // Completes the trace of this request, logs it if slow and returns the inline variant if requested
+            auto finishTrace = [&](searcher::QueryTrace& trace, const std::string& body) {
+                trace.total = std::chrono::steady_clock::now() - started;
+                bool slow = slowQueries.slow(trace.total);
+                if (!slow && !traced) {
+                    return std::string();
+                }
+                serializer::JsonWriter line(256);
+                serializer::writeTrace(line, trace);
+                if (slow) {
+                    slowQueries.record(line.release());
+                }
+                return traced ? serializer::serializeTraced(body, trace) : std::string();
+            };
+
+            // Serve repeated queries from the cache, already compressed if a client asked for this encoding before
+            std::string searchKey = fuzzy ? query : query + "#exact";
+            if (!ranking.standard()) {
+                searchKey += "#" + ranking.parameters();
+            }
+            std::string cacheKey = details ? searchKey + "#details" : searchKey;
+            std::shared_ptr<cache::CachedResult> cached = resultCache.get(cacheKey);
+            if (cached) {
+                searcher::QueryTrace trace;
+                trace.query = query;
+                trace.cache = "hit";
+                std::string tracedBody = finishTrace(trace, cached->body());
+                if (traced) {
+                    cache::CachedResult tracedResult(std::move(tracedBody));
+                    sendEncoded(res, tracedResult, encoding);
+                    return;
+                }
+                sendEncoded(res, *cached, encoding);
                 return;
             }
 
-            // Extract the query parameter from the request
-            std::string query = req.query["q"];
-            // Perform the search and get the list of URLs
-            std::vector<std::string> urls = searcher->search(query);
+            searcher::Deadline deadline = requestDeadline(req);
+
+            // Perform the search, or attach to an identical search that is already running
+            bool evaluated = false;
+            bool abandoned = false;
+            std::uint64_t generation = 0;
+            searcher::SearchResponse response = coalescer.execute(searchKey, [&query, &deadline, &fuzzy, &ranking, &evaluated, &generation, &resultCache, &scoringPool, &fetchPool, &indexSnapshot, &termDictionary, &coordinator, &deltaClient, &changeFeed]() {
+                evaluated = true;
+                generation = resultCache.generation();
+                if (coordinator) {
+                    return coordinator->search(query, deadline, fuzzy, ranking);
+                }
+                std::shared_ptr<searcher::Searcher> searcher;
+                try {
+                    // Initialize the Searcher object
+                    searcher = std::make_shared<searcher::Searcher>(deadline, &scoringPool, indexSnapshot.get(), &termDictionary);
+                } catch(const std::exception& e) {
+                    std::cerr << "Error initializing searcher: " << e.what() << '\n';
+                    throw;
+                }
+                searcher->setFuzzy(fuzzy);
+                searcher->setRanking(ranking);
+                searcher->setFetchPool(&fetchPool);
+                impact::CorpusStats stats;
+                if (changeFeed && changeFeed->corpusStats(stats)) {
+                    searcher->setCorpusStats(stats);
+                }
+                delta::DeltaView recent;
+                searcher->setDelta(fetchDelta(deltaClient.get(), query, deadline, recent));
+                return searcher->searchResults(query);
+            }, deadline.remaining(), [&query, &abandoned]() {
+                // The leader is slow and the deadline nearly spent, answer without results instead of searching again
+                abandoned = true;
+                searcher::SearchResponse partial;
+                partial.trace.query = query;
+                partial.partial = partial.trace.partial = true;
+                return partial;
+            });
+
+            // A shared result carries the stages of the leader's evaluation
+            searcher::QueryTrace& trace = response.trace;
+            trace.cache = evaluated ? "miss" : abandoned ? "abandoned" : "coalesced";
 
-            // Create a JSON array to hold the search results
-            jetpp::JsonValue result;
-            result.setArray({});
+            // Serialize the results directly into the response body, with scores if requested
+            auto serializeStart = std::chrono::steady_clock::now();
+            std::string body = serializer::serializeResults(response.results, details);
+            trace.serialize = std::chrono::steady_clock::now() - serializeStart;
 
-            // Add each URL to the JSON array
-            for(const std::string& url: urls){
-                jetpp::JsonValue val;
-                val.setString(url);
-                result.asArray.push_back(val);
+            std::string tracedBody = finishTrace(trace, body);
+            if (response.partial) {
+                res.addHeader("X-Search-Partial", "true");
             }
 
-            // Send the JSON response
-            res.json(result);
+            // Following the change stream, an entry is tagged with its terms and only stored if none of them changed during the search
+            auto store = [&](std::string body) {
+                if (!changeFeed) {
+                    return resultCache.put(cacheKey, std::move(body));
+                }
+                if (!evaluated || !changeFeed->current()) {
+                    return std::make_shared<cache::CachedResult>(std::move(body));
+                }
+                std::vector<std::string> terms;
+                std::istringstream segments(query);
+                std::string term;
+                while (std::getline(segments, term, '+')) {
+                    terms.push_back(term);
+                }
+                return resultCache.put(cacheKey, std::move(body), terms, generation);
+            };
+
+            // Traced and partial responses are never cached; the plain body of a complete search is
+            if (traced) {
+                if (!response.partial) {
+                    store(std::move(body));
+                }
+                cache::CachedResult tracedResult(std::move(tracedBody));
+                sendEncoded(res, tracedResult, encoding);
+                return;
+            }
+            if (response.partial) {
+                cache::CachedResult partial(std::move(body));
+                sendEncoded(res, partial, encoding);
+                return;
+            }
+            sendEncoded(res, *store(std::move(body)), encoding);
         } catch (const std::exception& e) {
             std::cerr << "Error processing search request: " << e.what() << std::endl;
-            res.status(500).send("Internal Server Error");
+            searchErrors.add();
+            http::send(res, 500, "Internal Server Error");
+        }
+    })));
+
+    // First phase of a sharded search: the posting count of every query term in this shard
+    router.post("/shard/terms", instrumented("/shard/terms", [&](jetpp::Request& req, jetpp::Response& res) {
+        try {
+            std::string query = searcher::Searcher::normalizeQuery(http::decodeTerms(req.query["q"]));
+            searcher::Searcher searcher(requestDeadline(req), nullptr, nullptr, &termDictionary);
+            searcher.setFetchPool(&fetchPool);
+            std::string body = serializer::serializeTermCounts(searcher.countPostings(query));
+            res.addHeader("Content-Type", "application/json");
+            res.send(body);
+        } catch (const std::exception& e) {
+            std::cerr << "Error counting postings: " << e.what() << std::endl;
+            http::send(res, 500, "Internal Server Error");
         }
+    }));
+
+    // Second phase: the top-k of this shard, scored with the corpus-wide posting counts of the coordinator
+    router.post("/shard/search", instrumented("/shard/search", admission::guard(searchAdmission, [&](jetpp::Request& req, jetpp::Response& res) {
+        try {
+            std::string query = searcher::Searcher::normalizeQuery(http::decodeTerms(req.query["q"]));
+            std::vector<std::int64_t> globalPostings;
+            std::istringstream counts(req.query["df"]);
+            std::string count;
+            while (std::getline(counts, count, '+')) {
+                globalPostings.push_back(std::stoll(count));
+            }
+
+            searcher::Deadline deadline = requestDeadline(req);
+            searcher::Searcher searcher(deadline, &scoringPool, indexSnapshot.get(), &termDictionary);
+            searcher.setFuzzy(fuzzyRequested(req));
+            searcher.setRanking(rankingRequested(req));
+            searcher.setFetchPool(&fetchPool);
+            impact::CorpusStats stats;
+            if (changeFeed && changeFeed->corpusStats(stats)) {
+                searcher.setCorpusStats(stats);
+            }
+            delta::DeltaView recent;
+            searcher.setDelta(fetchDelta(deltaClient.get(), query, deadline, recent));
+            std::string body = serializer::serializeShardResponse(searcher.searchResults(query, globalPostings));
+            res.addHeader("Content-Type", "application/json");
+            res.send(body);
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing shard search request: " << e.what() << std::endl;
+            http::send(res, 500, "Internal Server Error");
+        }
+    })));
+
+    // Completions of a prefix, heaviest terms first; the coordinator merges those of its shards
+    auto suggestHandler = [&](jetpp::Request& req, jetpp::Response& res) {
+        try {
+            std::string prefix = http::urlDecode(req.query["prefix"]);
+            std::size_t limit = suggestionLimit(req);
+            std::vector<suggest::Suggestion> suggestions = coordinator
+                ? coordinator->suggest(prefix, limit, requestDeadline(req))
+                : suggester->suggest(prefix, limit);
+            res.addHeader("Content-Type", "application/json");
+            res.send(serializer::serializeSuggestions(prefix, suggestions));
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing suggest request: " << e.what() << std::endl;
+            http::send(res, 500, "Internal Server Error");
+        }
+    };
+    router.get("/suggest", instrumented("/suggest", suggestHandler));
+    router.post("/shard/suggest", instrumented("/shard/suggest", suggestHandler));
+
+    // Define a GET route exposing the service counters
+    router.get("/stats", [&](jetpp::Request& req, jetpp::Response& res) {
+        searcher::SingleFlightStats coalescing = coalescer.stats();
+        admission::AdmissionStats search = searchAdmission.stats();
+        cache::CacheStats results = resultCache.stats();
+        slowlog::SlowQueryLogStats slow = slowQueries.stats();
+        threadpool::ThreadPoolStats pool = scoringPool.stats();
+        searcher::FetchPoolStats fetches = fetchPool.stats();
+        snapshot::SnapshotInfo loaded = indexSnapshot ? indexSnapshot->info() : snapshot::SnapshotInfo();
+        dictionary::DictionaryStats terms = termDictionary.stats();
+        suggest::SuggesterStats completions = suggester ? suggester->stats() : suggest::SuggesterStats();
+        changes::ChangeFeedStats feed = changeFeed ? changeFeed->stats() : changes::ChangeFeedStats();
+
+        serializer::JsonWriter writer(512);
+        writer.beginObject()
+            .key("scoringKernel").value(scoring::isaName(scoring::detectIsa()))
+            .key("shard").beginObject()
+                .key("shard").value(static_cast<std::int64_t>(options.shard))
+                .key("shards").value(static_cast<std::int64_t>(options.shards))
+                .key("coordinator").value(coordinator != nullptr)
+                .key("shardFailures").value(static_cast<std::int64_t>(coordinator ? coordinator->stats().shardFailures : 0))
+            .endObject()
+            .key("snapshot").beginObject()
+                .key("loaded").value(indexSnapshot != nullptr)
+                .key("path").value(loaded.path)
+                .key("createdMs").value(loaded.createdMs)
+                .key("statsVersion").value(loaded.statsVersion)
+                .key("terms").value(static_cast<std::int64_t>(loaded.terms))
+                .key("documents").value(static_cast<std::int64_t>(loaded.documents))
+                .key("postings").value(static_cast<std::int64_t>(loaded.postings))
+                .key("staleTerms").value(static_cast<std::int64_t>(loaded.staleTerms))
+                .key("outdated").value(loaded.outdated)
+                .key("lastPollMs").value(loaded.lastPollMs)
+                .key("hits").value(static_cast<std::int64_t>(loaded.hits))
+                .key("misses").value(static_cast<std::int64_t>(loaded.misses))
+            .endObject()
+            .key("dictionary").beginObject()
+                .key("ready").value(terms.ready)
+                .key("terms").value(static_cast<std::int64_t>(terms.terms))
+                .key("pending").value(static_cast<std::int64_t>(terms.pending))
+                .key("bytes").value(static_cast<std::int64_t>(terms.bytes))
+                .key("lookups").value(static_cast<std::int64_t>(terms.lookups))
+                .key("absent").value(static_cast<std::int64_t>(terms.absent))
+                .key("bloomRejects").value(static_cast<std::int64_t>(terms.bloomRejects))
+                .key("compactions").value(static_cast<std::int64_t>(terms.compactions))
+            .endObject()
+            .key("suggest").beginObject()
+                .key("terms").value(static_cast<std::int64_t>(completions.terms))
+                .key("bytes").value(static_cast<std::int64_t>(completions.bytes))
+                .key("builds").value(static_cast<std::int64_t>(completions.builds))
+                .key("queries").value(static_cast<std::int64_t>(completions.queries))
+                .key("lastBuildSeconds").value(completions.lastBuildSeconds)
+            .endObject()
+            .key("coalescing").beginObject()
+                .key("leaders").value(static_cast<std::int64_t>(coalescing.leaders))
+                .key("followers").value(static_cast<std::int64_t>(coalescing.followers))
+                .key("timeouts").value(static_cast<std::int64_t>(coalescing.timeouts))
+                .key("abandoned").value(static_cast<std::int64_t>(coalescing.abandoned))
+                .key("inFlight").value(static_cast<std::int64_t>(coalescing.inFlight))
+            .endObject()
+            .key("resultCache").beginObject()
+                .key("hits").value(static_cast<std::int64_t>(results.hits))
+                .key("misses").value(static_cast<std::int64_t>(results.misses))
+                .key("entries").value(static_cast<std::int64_t>(results.entries))
+                .key("invalidated").value(static_cast<std::int64_t>(results.invalidated))
+                .key("rejected").value(static_cast<std::int64_t>(results.rejected))
+            .endObject()
+            .key("changeStream").beginObject()
+                .key("enabled").value(changeFeed != nullptr)
+                .key("current").value(feed.current)
+                .key("documents").value(feed.documents)
+                .key("statsVersion").value(feed.statsVersion)
+                .key("events").value(static_cast<std::int64_t>(feed.events))
+                .key("termChanges").value(static_cast<std::int64_t>(feed.termChanges))
+                .key("resets").value(static_cast<std::int64_t>(feed.resets))
+                .key("failures").value(static_cast<std::int64_t>(feed.failures))
+                .key("lastEventMs").value(feed.lastEventMs)
+            .endObject()
+            .key("scoringPool").beginObject()
+                .key("workers").value(static_cast<std::int64_t>(pool.workers))
+                .key("queued").value(static_cast<std::int64_t>(pool.queued))
+                .key("executed").value(static_cast<std::int64_t>(pool.executed))
+                .key("stolen").value(static_cast<std::int64_t>(pool.stolen))
+            .endObject()
+            .key("fetchPool").beginObject()
+                .key("workers").value(static_cast<std::int64_t>(fetches.workers))
+                .key("queued").value(static_cast<std::int64_t>(fetches.queued))
+                .key("fetched").value(static_cast<std::int64_t>(fetches.fetched))
+                .key("expired").value(static_cast<std::int64_t>(fetches.expired))
+                .key("failed").value(static_cast<std::int64_t>(fetches.failed))
+            .endObject()
+            .key("slowQueries").beginObject()
+                .key("written").value(static_cast<std::int64_t>(slow.written))
+                .key("dropped").value(static_cast<std::int64_t>(slow.dropped))
+                .key("rotations").value(static_cast<std::int64_t>(slow.rotations))
+            .endObject()
+            .key("admission").beginObject()
+                .key("search").beginObject()
+                    .key("inFlight").value(static_cast<std::int64_t>(search.inFlight))
+                    .key("queued").value(static_cast<std::int64_t>(search.queued))
+                    .key("admitted").value(static_cast<std::int64_t>(search.admitted))
+                    .key("shedQueueFull").value(static_cast<std::int64_t>(search.shedQueueFull))
+                    .key("shedTimeout").value(static_cast<std::int64_t>(search.shedTimeout))
+                    .key("overloaded").value(search.overloaded)
+                .endObject()
+            .endObject()
+        .endObject();
+
+        res.addHeader("Content-Type", "application/json");
+        res.send(writer.release());
+    });
+
+    // Define a GET route exposing all metrics in the Prometheus text format
+    router.get("/metrics", [&](jetpp::Request& req, jetpp::Response& res) {
+        res.addHeader("Content-Type", "text/plain; version=0.0.4");
+        res.send(registry.render());
     });
 
-    // Create a Server object with the defined router and start it on port 7002
+    // Create a Server object with the defined router and start it on the configured port (7002 by default)
     jetpp::Server server(router);
     try {
-        server.start(7002);
+        server.start(options.port);
     } catch (const std::exception& e) {
         std::cerr << "Error starting server: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,242 @@
+#include <cache/resultCache.hpp>
+#include <algorithm>
+
+namespace cache {
+
+    /**
+     * @brief Constructor for the CachedResult class.
+     * 
+     * @param body The serialized, uncompressed response body.
+     */
+    CachedResult::CachedResult(std::string body) : identity(std::move(body)) {
+    }
+
+    /**
+     * @brief Returns the body in the requested encoding, compressing it on first use.
+     * 
+     * @param encoding The requested encoding; set to the encoding actually used.
+     * @return std::string The encoded body.
+     */
+    std::string CachedResult::encoded(compression::Encoding& encoding) {
+        if (encoding == compression::Encoding::Identity || this->identity.size() < compression::MIN_COMPRESS_SIZE) {
+            encoding = compression::Encoding::Identity;
+            return this->identity;
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->variants.find(encoding);
+        if (it == this->variants.end()) {
+            it = this->variants.emplace(encoding, compression::compress(this->identity, encoding)).first;
+        }
+        return it->second;
+    }
+
+    const std::string& CachedResult::body() const {
+        return this->identity;
+    }
+
+    /**
+     * @brief Constructor for the ResultCache class.
+     * 
+     * @param capacity Maximum number of entries.
+     * @param ttl Time after which an entry is considered stale.
+     */
+    ResultCache::ResultCache(std::size_t capacity, std::chrono::seconds ttl) : capacity(capacity), ttl(ttl) {
+    }
+
+    /**
+     * @brief Looks up a cached response and marks it as recently used.
+     * 
+     * @param key The cache key.
+     * @return The cached response, or nullptr on a miss or an expired entry.
+     */
+    std::shared_ptr<CachedResult> ResultCache::get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->entries.find(key);
+        if (it == this->entries.end()) {
+            this->misses++;
+            return nullptr;
+        }
+        if (Clock::now() >= it->second.expiry) {
+            this->erase(it);
+            this->misses++;
+            return nullptr;
+        }
+
+        this->lru.splice(this->lru.begin(), this->lru, it->second.lru);
+        this->hits++;
+        return it->second.result;
+    }
+
+    /**
+     * @brief Stores a serialized response, evicting the least recently used entry if full.
+     * 
+     * @param key The cache key.
+     * @param body The serialized, uncompressed response body.
+     * @return The stored entry.
+     */
+    std::shared_ptr<CachedResult> ResultCache::put(const std::string& key, std::string body) {
+        auto result = std::make_shared<CachedResult>(std::move(body));
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->insert(key, result, std::vector<std::string>());
+        return result;
+    }
+
+    /**
+     * @brief Stores a serialized response tagged with the terms it depends on.
+     * 
+     * @param key The cache key.
+     * @param body The serialized, uncompressed response body.
+     * @param terms The terms the response was computed from.
+     * @param generation The generation read before the response was computed.
+     * @return The entry; not stored if one of the terms was invalidated since the generation.
+     */
+    std::shared_ptr<CachedResult> ResultCache::put(const std::string& key, std::string body, const std::vector<std::string>& terms, std::uint64_t generation) {
+        auto result = std::make_shared<CachedResult>(std::move(body));
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->outdated(terms, generation)) {
+            this->rejected++;
+            return result;
+        }
+        this->insert(key, result, terms);
+        return result;
+    }
+
+    /**
+     * @brief Drops every entry tagged with a term and remembers the invalidation.
+     * 
+     * @param term The changed term.
+     */
+    void ResultCache::invalidate(const std::string& term) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->currentGeneration++;
+        this->recent.emplace_back(this->currentGeneration, term);
+        if (this->recent.size() > RECENT_INVALIDATIONS) {
+            this->recent.pop_front();
+        }
+
+        auto tagged = this->keysByTerm.find(term);
+        if (tagged == this->keysByTerm.end()) {
+            return;
+        }
+        std::unordered_set<std::string> keys = std::move(tagged->second);
+        this->keysByTerm.erase(tagged);
+        for (const std::string& key : keys) {
+            auto it = this->entries.find(key);
+            if (it != this->entries.end()) {
+                this->erase(it);
+                this->invalidated++;
+            }
+        }
+    }
+
+    /**
+     * @brief Drops every entry; responses computed before are not stored anymore.
+     */
+    void ResultCache::clear() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->currentGeneration++;
+        this->clearedGeneration = this->currentGeneration;
+        this->recent.clear();
+        this->invalidated += this->entries.size();
+        this->entries.clear();
+        this->lru.clear();
+        this->keysByTerm.clear();
+    }
+
+    /**
+     * @brief Returns the current generation, to be passed to put.
+     * 
+     * @return std::uint64_t The number of invalidations so far.
+     */
+    std::uint64_t ResultCache::generation() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->currentGeneration;
+    }
+
+    CacheStats ResultCache::stats() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        CacheStats s;
+        s.hits = this->hits;
+        s.misses = this->misses;
+        s.entries = this->entries.size();
+        s.invalidated = this->invalidated;
+        s.rejected = this->rejected;
+        return s;
+    }
+
+    /**
+     * @brief Removes an entry and its tags; the mutex must be held.
+     * 
+     * @param it The entry.
+     */
+    void ResultCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+        for (const std::string& term : it->second.terms) {
+            auto tagged = this->keysByTerm.find(term);
+            if (tagged == this->keysByTerm.end()) {
+                continue;
+            }
+            tagged->second.erase(it->first);
+            if (tagged->second.empty()) {
+                this->keysByTerm.erase(tagged);
+            }
+        }
+        this->lru.erase(it->second.lru);
+        this->entries.erase(it);
+    }
+
+    /**
+     * @brief Stores an entry, evicting the least recently used ones if full; the mutex must be held.
+     * 
+     * @param key The cache key.
+     * @param result The response.
+     * @param terms The terms the entry is tagged with.
+     */
+    void ResultCache::insert(const std::string& key, std::shared_ptr<CachedResult> result, std::vector<std::string> terms) {
+        auto it = this->entries.find(key);
+        if (it != this->entries.end()) {
+            this->erase(it);
+        }
+
+        while (!this->lru.empty() && this->entries.size() >= this->capacity) {
+            this->erase(this->entries.find(this->lru.back()));
+        }
+
+        for (const std::string& term : terms) {
+            this->keysByTerm[term].insert(key);
+        }
+        this->lru.push_front(key);
+        this->entries[key] = Entry{std::move(result), Clock::now() + this->ttl, this->lru.begin(), std::move(terms)};
+    }
+
+    /**
+     * @brief Checks whether a term was invalidated after a generation; the mutex must be held.
+     * 
+     * Once the remembered invalidations no longer reach back to the generation, any of the
+     * forgotten ones may have hit the terms, so the response counts as outdated.
+     * 
+     * @param terms The terms.
+     * @param generation The generation.
+     * @return True if a response computed at that generation may be outdated.
+     */
+    bool ResultCache::outdated(const std::vector<std::string>& terms, std::uint64_t generation) const {
+        if (generation == this->currentGeneration) {
+            return false;
+        }
+        if (generation < this->clearedGeneration) {
+            return true;
+        }
+        if (this->recent.empty() || this->recent.front().first > generation + 1) {
+            return true;
+        }
+        for (auto it = this->recent.rbegin(); it != this->recent.rend() && it->first > generation; ++it) {
+            if (std::find(terms.begin(), terms.end(), it->second) != terms.end()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
@@ -0,0 +1,240 @@
+#include <changes/changeFeed.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace changes {
+
+    namespace {
+        // How long an iteration of the stream waits for events before checking for shutdown
+        const std::chrono::milliseconds AWAIT_INTERVAL(1000);
+
+        // Longest pause before a failed stream is reopened
+        const std::chrono::milliseconds MAX_BACKOFF(30000);
+
+        std::int64_t nowMs() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    /**
+     * @brief Constructor for the ChangeFeed class; starts the thread.
+     *
+     * @param allShards Whether the terms of all shards are followed or only those of this shard.
+     * @param results The result cache to invalidate; may be null.
+     * @param snapshot The snapshot to invalidate; may be null.
+     */
+    ChangeFeed::ChangeFeed(bool allShards, cache::ResultCache* results, snapshot::LiveSnapshot* snapshot)
+        : allShards(allShards), results(results), snapshot(snapshot) {
+        this->follower = std::thread(&ChangeFeed::run, this);
+    }
+
+    /**
+     * @brief Destructor; stops the thread after its current wait for events.
+     */
+    ChangeFeed::~ChangeFeed() {
+        {
+            std::lock_guard<std::mutex> lock(this->stopMutex);
+            this->stopping = true;
+        }
+        this->stopSignal.notify_all();
+        this->follower.join();
+    }
+
+    /**
+     * @brief Gets the current corpus statistics without a database query.
+     *
+     * Before the first impact refresh there are no stored statistics; like the database
+     * fallback, they are the document count with an unknown average length.
+     *
+     * @param stats Receives the statistics.
+     * @return True if the feed is current and the statistics were returned.
+     */
+    bool ChangeFeed::corpusStats(impact::CorpusStats& stats) const {
+        if (!this->following.load()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(this->stateMutex);
+        if (this->refreshed) {
+            stats = this->corpus;
+        } else {
+            stats = impact::CorpusStats();
+            stats.totalDocuments = this->documents;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks whether the stream is open and the state follows it.
+     *
+     * @return True if changes are being followed.
+     */
+    bool ChangeFeed::current() const {
+        return this->following.load();
+    }
+
+    /**
+     * @brief Returns the state and counters.
+     *
+     * @return ChangeFeedStats The current state.
+     */
+    ChangeFeedStats ChangeFeed::stats() const {
+        ChangeFeedStats stats;
+        stats.current = this->following.load();
+        {
+            std::lock_guard<std::mutex> lock(this->stateMutex);
+            stats.documents = this->documents;
+            stats.statsVersion = this->corpus.version;
+        }
+        stats.events = this->events.load();
+        stats.termChanges = this->termChanges.load();
+        stats.resets = this->resets.load();
+        stats.failures = this->failures.load();
+        stats.lastEventMs = this->lastEventMs.load();
+        return stats;
+    }
+
+    /**
+     * @brief Follower loop: opens the stream, reloads the state if needed and applies events.
+     *
+     * The stream is opened before the reload, so every change after the reload is seen. A
+     * failed stream is resumed from the last processed event once; if that fails as well, the
+     * events may be gone and the next stream starts over with a reload.
+     */
+    void ChangeFeed::run() {
+        std::size_t attempts = 0;
+        while (!this->stopRequested()) {
+            try {
+                searcher_db::SearcherDB db;
+                mongocxx::change_stream stream = db.watchChanges(this->allShards, this->resumeToken, AWAIT_INTERVAL);
+                if (this->resumeToken.empty()) {
+                    this->reset(db);
+                }
+                this->following = true;
+                this->follow(db, stream);
+                attempts = 0;
+            } catch (const std::exception& e) {
+                std::cerr << "Error following the change stream: " << e.what() << std::endl;
+                this->failures++;
+                if (++attempts >= 2) {
+                    this->resumeToken.clear();
+                }
+            }
+
+            // Nothing cached while the stream was down can be invalidated
+            this->following = false;
+            if (this->results) {
+                this->results->clear();
+            }
+            if (attempts > 0) {
+                std::chrono::milliseconds backoff = std::min(MAX_BACKOFF, AWAIT_INTERVAL * (1 << std::min<std::size_t>(attempts - 1, 5)));
+                std::unique_lock<std::mutex> lock(this->stopMutex);
+                this->stopSignal.wait_for(lock, backoff, [this]() { return this->stopping; });
+            }
+        }
+    }
+
+    /**
+     * @brief Reads one stream until it fails, closes or the feed stops.
+     *
+     * @param db The database the stream was opened on.
+     * @param stream The stream.
+     */
+    void ChangeFeed::follow(searcher_db::SearcherDB& db, mongocxx::change_stream& stream) {
+        while (!this->stopRequested()) {
+            // Every pass waits up to AWAIT_INTERVAL for the next batch
+            for (bsoncxx::document::view event : stream) {
+                searcher_db::ChangeEvent change = searcher_db::SearcherDB::decodeChange(event);
+                this->apply(db, change);
+                this->resumeToken = change.resumeToken;
+                if (change.closed) {
+                    this->resumeToken.clear();
+                    return;
+                }
+                if (this->stopRequested()) {
+                    return;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Applies one change.
+     *
+     * Until the first impact refresh the document count is the statistics every ranking
+     * depends on, so added and removed documents drop every cached result.
+     *
+     * @param db The database, for reloads.
+     * @param change The change.
+     */
+    void ChangeFeed::apply(searcher_db::SearcherDB& db, const searcher_db::ChangeEvent& change) {
+        this->events++;
+        this->lastEventMs = nowMs();
+
+        switch (change.kind) {
+            case searcher_db::ChangeEvent::Kind::Term:
+                this->termChanges++;
+                if (this->results) this->results->invalidate(change.term);
+                if (this->snapshot) this->snapshot->invalidate(change.term);
+                break;
+            case searcher_db::ChangeEvent::Kind::Stats:
+                {
+                    std::lock_guard<std::mutex> lock(this->stateMutex);
+                    this->corpus = change.stats;
+                    this->refreshed = true;
+                }
+                if (this->results) this->results->clear();
+                if (this->snapshot) this->snapshot->statsChanged(change.stats.version);
+                break;
+            case searcher_db::ChangeEvent::Kind::DocumentAdded:
+            case searcher_db::ChangeEvent::Kind::DocumentRemoved:
+                {
+                    bool rankingsChanged;
+                    {
+                        std::lock_guard<std::mutex> lock(this->stateMutex);
+                        this->documents += change.kind == searcher_db::ChangeEvent::Kind::DocumentAdded ? 1 : -1;
+                        this->documents = std::max<std::int64_t>(0, this->documents);
+                        rankingsChanged = !this->refreshed;
+                    }
+                    if (rankingsChanged && this->results) this->results->clear();
+                }
+                break;
+            case searcher_db::ChangeEvent::Kind::Reset:
+                this->reset(db);
+                break;
+            case searcher_db::ChangeEvent::Kind::Ignored:
+                break;
+        }
+    }
+
+    /**
+     * @brief Reloads the statistics and the document count and drops every cached result.
+     *
+     * @param db The database.
+     */
+    void ChangeFeed::reset(searcher_db::SearcherDB& db) {
+        impact::CorpusStats stats = db.getCorpusStats();
+        bool refreshed = stats.version > 0;
+        std::int64_t documents = refreshed ? db.getTotalNumberDocuments() : stats.totalDocuments;
+        {
+            std::lock_guard<std::mutex> lock(this->stateMutex);
+            this->corpus = stats;
+            this->refreshed = refreshed;
+            this->documents = documents;
+        }
+        this->resets++;
+        if (this->results) this->results->clear();
+        if (this->snapshot) this->snapshot->statsChanged(stats.version);
+        std::cerr << "Following changes from corpus statistics version " << stats.version << " with " << documents << " documents" << std::endl;
+    }
+
+    /**
+     * @brief Checks whether the destructor has asked the thread to stop.
+     *
+     * @return True if stopping.
+     */
+    bool ChangeFeed::stopRequested() {
+        std::lock_guard<std::mutex> lock(this->stopMutex);
+        return this->stopping;
+    }
+
+}
@@ -0,0 +1,157 @@
+#include <compression/compression.hpp>
+#include <zlib.h>
+#include <stdexcept>
+#include <sstream>
+#include <cctype>
+#include <cstdlib>
+#ifdef ASURA_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace compression {
+
+    namespace {
+
+        // Compression level trading a little ratio for speed on the request path
+        const int ZLIB_LEVEL = 6;
+
+        /**
+         * @brief Compresses with zlib using either a gzip or a zlib (deflate) wrapper.
+         * 
+         * @param body The uncompressed body.
+         * @param windowBits 15 + 16 for gzip, 15 for deflate.
+         * @return std::string The compressed body.
+         */
+        std::string zlibCompress(const std::string& body, int windowBits) {
+            z_stream stream{};
+            if (deflateInit2(&stream, ZLIB_LEVEL, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("deflateInit2 failed");
+            }
+
+            std::string out;
+            out.resize(deflateBound(&stream, static_cast<uLong>(body.size())) + 18);
+
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+            stream.avail_in = static_cast<uInt>(body.size());
+            stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+            stream.avail_out = static_cast<uInt>(out.size());
+
+            int status = deflate(&stream, Z_FINISH);
+            deflateEnd(&stream);
+            if (status != Z_STREAM_END) {
+                throw std::runtime_error("deflate failed");
+            }
+
+            out.resize(stream.total_out);
+            return out;
+        }
+
+        // Preference when several codings have the same q-value
+        int preference(Encoding encoding) {
+            switch (encoding) {
+                case Encoding::Zstd: return 3;
+                case Encoding::Gzip: return 2;
+                case Encoding::Deflate: return 1;
+                default: return 0;
+            }
+        }
+
+        std::string trim(const std::string& str) {
+            std::size_t begin = 0, end = str.size();
+            while (begin < end && std::isspace(static_cast<unsigned char>(str[begin]))) begin++;
+            while (end > begin && std::isspace(static_cast<unsigned char>(str[end - 1]))) end--;
+            return str.substr(begin, end - begin);
+        }
+    }
+
+    /**
+     * @brief Picks the best supported encoding from an Accept-Encoding header.
+     * 
+     * @param acceptEncoding The value of the Accept-Encoding request header.
+     * @return Encoding The negotiated encoding.
+     */
+    Encoding negotiate(const std::string& acceptEncoding) {
+        Encoding supported[] = {
+#ifdef ASURA_WITH_ZSTD
+            Encoding::Zstd,
+#endif
+            Encoding::Gzip,
+            Encoding::Deflate
+        };
+
+        Encoding best = Encoding::Identity;
+        double bestQ = 0;
+        double wildcardQ = -1;
+        double explicitQ[4] = {-1, -1, -1, -1};
+
+        std::istringstream isstream(acceptEncoding);
+        std::string item;
+        while (std::getline(isstream, item, ',')) {
+            std::string coding = trim(item.substr(0, item.find(';')));
+            double q = 1;
+            std::size_t qPos = item.find("q=");
+            if (qPos != std::string::npos) {
+                q = std::atof(item.c_str() + qPos + 2);
+            }
+            for (char& c : coding) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+            if (coding == "*") wildcardQ = q;
+            else if (coding == "gzip" || coding == "x-gzip") explicitQ[static_cast<int>(Encoding::Gzip)] = q;
+            else if (coding == "deflate") explicitQ[static_cast<int>(Encoding::Deflate)] = q;
+            else if (coding == "zstd") explicitQ[static_cast<int>(Encoding::Zstd)] = q;
+        }
+
+        for (Encoding encoding : supported) {
+            double q = explicitQ[static_cast<int>(encoding)];
+            if (q < 0) q = wildcardQ;
+            if (q <= 0) continue;
+            if (q > bestQ || (q == bestQ && preference(encoding) > preference(best))) {
+                best = encoding;
+                bestQ = q;
+            }
+        }
+        return best;
+    }
+
+    const char* encodingName(Encoding encoding) {
+        switch (encoding) {
+            case Encoding::Gzip: return "gzip";
+            case Encoding::Deflate: return "deflate";
+            case Encoding::Zstd: return "zstd";
+            default: return "identity";
+        }
+    }
+
+    /**
+     * @brief Compresses a body with the given encoding.
+     * 
+     * @param body The uncompressed body.
+     * @param encoding The encoding to apply.
+     * @return std::string The encoded body.
+     */
+    std::string compress(const std::string& body, Encoding encoding) {
+        switch (encoding) {
+            case Encoding::Gzip:
+                return zlibCompress(body, 15 + 16);
+            case Encoding::Deflate:
+                return zlibCompress(body, 15);
+            case Encoding::Zstd: {
+#ifdef ASURA_WITH_ZSTD
+                std::string out;
+                out.resize(ZSTD_compressBound(body.size()));
+                std::size_t size = ZSTD_compress(&out[0], out.size(), body.data(), body.size(), 3);
+                if (ZSTD_isError(size)) {
+                    throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(size));
+                }
+                out.resize(size);
+                return out;
+#else
+                throw std::runtime_error("zstd support is not compiled in");
+#endif
+            }
+            default:
+                return body;
+        }
+    }
+
+}
@@ -0,0 +1,176 @@
+#include <delta/deltaClient.hpp>
+#include <http/queryString.hpp>
+#include "jetplusplus/json/jsonConverter.hpp"
+#include "jetplusplus/json/value.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace delta {
+
+    /**
+     * @brief Constructor for the DeltaClient class.
+     *
+     * @param indexer The address of the indexer.
+     * @param shard The shard whose documents are looked up.
+     */
+    DeltaClient::DeltaClient(shard::Endpoint indexer, std::size_t shard) : indexer(std::move(indexer)), shard(shard) {
+    }
+
+    /**
+     * @brief Looks up the delta postings of a query.
+     *
+     * Asks for the changes since the newest kept version of the shadowed documents. If that
+     * version was evicted by the time the answer arrives, the whole set is requested once more.
+     *
+     * @param query The normalized search query string.
+     * @param timeout The time the indexer has to answer.
+     * @param view Receives the delta postings.
+     * @return True if the indexer answered.
+     */
+    bool DeltaClient::fetch(const std::string& query, std::chrono::milliseconds timeout, DeltaView& view) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            std::uint64_t epoch = 0;
+            std::uint64_t since = 0;
+            if (attempt == 0) {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (!this->versions.empty()) {
+                    epoch = this->epoch;
+                    since = this->versions.back().version;
+                }
+            }
+
+            this->requests++;
+            std::string target = "/delta/postings?q=" + http::encodeTerms(query) + "&shard=" + std::to_string(this->shard) + "&epoch=" + std::to_string(epoch) + "&since=" + std::to_string(since);
+            shard::Reply reply = shard::post(this->indexer, target, timeout);
+            view = DeltaView();
+            ShadowUpdate update;
+            if (reply.status != 200 || !parse(reply.body, view, update)) {
+                this->failures++;
+                std::cerr << "Delta lookup failed: " << (reply.error.empty() ? "status " + std::to_string(reply.status) : reply.error) << std::endl;
+                return false;
+            }
+            if (this->apply(update, since, view)) {
+                return true;
+            }
+        }
+        this->failures++;
+        return false;
+    }
+
+    /**
+     * @brief Parses a /delta/postings response.
+     *
+     * A response without "full" is from an indexer that always sends the whole set.
+     *
+     * @param body {"sequence", "epoch", "shadowVersion", "full", "shadowed": [url], "unshadowed": [url], "terms": [{"term", "postings": [{"url", "tf", "docLength"}]}]}.
+     * @param view Receives the delta postings.
+     * @param update Receives the shadowed documents, or the changes to them.
+     * @return True if the body is a valid response.
+     */
+    bool DeltaClient::parse(const std::string& body, DeltaView& view, ShadowUpdate& update) {
+        try {
+            jetpp::JsonConverter converter;
+            jetpp::JsonValue json = converter.stringToJson(body);
+            if (json.type != jetpp::JsonValue::OBJECT || json.asObject["terms"].type != jetpp::JsonValue::ARRAY || json.asObject["shadowed"].type != jetpp::JsonValue::ARRAY) {
+                return false;
+            }
+            view.sequence = static_cast<std::uint64_t>(json.asObject["sequence"].asNumber);
+            update.full = json.asObject["full"].type != jetpp::JsonValue::BOOLEAN || json.asObject["full"].asBoolean;
+            update.epoch = json.asObject["epoch"].type == jetpp::JsonValue::NUMBER ? static_cast<std::uint64_t>(json.asObject["epoch"].asNumber) : 0;
+            update.version = json.asObject["shadowVersion"].type == jetpp::JsonValue::NUMBER ? static_cast<std::uint64_t>(json.asObject["shadowVersion"].asNumber) : 0;
+            for (jetpp::JsonValue& url : json.asObject["shadowed"].asArray) {
+                update.shadowed.push_back(url.asString);
+            }
+            if (!update.full && json.asObject["unshadowed"].type == jetpp::JsonValue::ARRAY) {
+                for (jetpp::JsonValue& url : json.asObject["unshadowed"].asArray) {
+                    update.unshadowed.push_back(url.asString);
+                }
+            }
+            for (jetpp::JsonValue& term : json.asObject["terms"].asArray) {
+                std::vector<searcher_db::IndexDocument>& postings = view.terms[term.asObject["term"].asString];
+                for (jetpp::JsonValue& posting : term.asObject["postings"].asArray) {
+                    postings.push_back(searcher_db::IndexDocument{posting.asObject["url"].asString, static_cast<float>(posting.asObject["tf"].asNumber), static_cast<int>(posting.asObject["docLength"].asNumber)});
+                }
+            }
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing delta response: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    /**
+     * @brief Builds the shadowed documents of a response and keeps them as a version.
+     *
+     * A full response of another epoch replaces the kept versions. An incremental one is
+     * applied to a copy of the version it was asked from, outside the lock. The set of an
+     * older indexer without epochs is used for its own lookup only.
+     *
+     * @param update The parsed shadowed documents.
+     * @param since The version the lookup asked from.
+     * @param view Receives the shadowed documents.
+     * @return False if the response is incremental but its base version is no longer kept.
+     */
+    bool DeltaClient::apply(ShadowUpdate& update, std::uint64_t since, DeltaView& view) {
+        std::shared_ptr<const std::unordered_set<std::string>> base;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (update.epoch == this->epoch) {
+                for (const ShadowSet& kept : this->versions) {
+                    if (kept.version == update.version) {
+                        view.shadowed = kept.urls;
+                        return true;
+                    }
+                    if (!update.full && kept.version == since) {
+                        base = kept.urls;
+                    }
+                }
+            }
+            if (!update.full && !base) {
+                return false;
+            }
+        }
+
+        std::shared_ptr<std::unordered_set<std::string>> urls;
+        if (update.full) {
+            urls = std::make_shared<std::unordered_set<std::string>>(update.shadowed.begin(), update.shadowed.end());
+        } else {
+            urls = std::make_shared<std::unordered_set<std::string>>(*base);
+            for (const std::string& url : update.unshadowed) {
+                urls->erase(url);
+            }
+            urls->insert(update.shadowed.begin(), update.shadowed.end());
+        }
+        view.shadowed = urls;
+        if (update.epoch == 0) {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (update.epoch != this->epoch) {
+            this->epoch = update.epoch;
+            this->versions.clear();
+        }
+        auto position = std::find_if(this->versions.begin(), this->versions.end(), [&](const ShadowSet& kept) { return kept.version >= update.version; });
+        if (position == this->versions.end() || position->version != update.version) {
+            this->versions.insert(position, ShadowSet{update.version, urls});
+            if (this->versions.size() > SHADOW_VERSIONS) {
+                this->versions.pop_front();
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the counters.
+     *
+     * @return DeltaClientStats The current counters.
+     */
+    DeltaClientStats DeltaClient::stats() const {
+        DeltaClientStats stats;
+        stats.requests = this->requests.load();
+        stats.failures = this->failures.load();
+        return stats;
+    }
+
+}
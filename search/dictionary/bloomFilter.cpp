@@ -0,0 +1,75 @@
+#include <dictionary/bloomFilter.hpp>
+#include <algorithm>
+#include <functional>
+
+namespace dictionary {
+
+    namespace {
+        const std::size_t BITS_PER_KEY = 10;
+        const std::size_t PROBES = 7;
+        const std::size_t WORDS_PER_BLOCK = 8;
+
+        // Finalizer of splitmix64; derives the independent probe bits from the key hash
+        std::uint64_t mix(std::uint64_t x) {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+    }
+
+    /**
+     * @brief Constructor for the BloomFilter class.
+     *
+     * @param capacity The number of keys the false positive rate is sized for.
+     */
+    BloomFilter::BloomFilter(std::size_t capacity) {
+        std::size_t bits = std::max<std::size_t>(1, capacity) * BITS_PER_KEY;
+        this->blocks = (bits + WORDS_PER_BLOCK * 64 - 1) / (WORDS_PER_BLOCK * 64);
+        this->words.assign(this->blocks * WORDS_PER_BLOCK, 0);
+    }
+
+    /**
+     * @brief Adds a key.
+     *
+     * @param key The key.
+     */
+    void BloomFilter::add(std::string_view key) {
+        std::uint64_t hash = std::hash<std::string_view>()(key);
+        std::uint64_t* block = &this->words[(hash % this->blocks) * WORDS_PER_BLOCK];
+        std::uint64_t probes = mix(hash);
+        for (std::size_t i = 0; i < PROBES; i++, probes >>= 9) {
+            block[(probes >> 6) & 7] |= std::uint64_t(1) << (probes & 63);
+        }
+    }
+
+    /**
+     * @brief Checks whether a key may have been added.
+     *
+     * @param key The key.
+     * @return False if the key was certainly never added.
+     */
+    bool BloomFilter::mayContain(std::string_view key) const {
+        std::uint64_t hash = std::hash<std::string_view>()(key);
+        const std::uint64_t* block = &this->words[(hash % this->blocks) * WORDS_PER_BLOCK];
+        std::uint64_t probes = mix(hash);
+        for (std::size_t i = 0; i < PROBES; i++, probes >>= 9) {
+            if (!(block[(probes >> 6) & 7] & (std::uint64_t(1) << (probes & 63)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the size of the bit array.
+     *
+     * @return std::size_t The size in bytes.
+     */
+    std::size_t BloomFilter::bytes() const {
+        return this->words.size() * sizeof(std::uint64_t);
+    }
+
+}
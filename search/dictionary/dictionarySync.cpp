@@ -0,0 +1,76 @@
+#include <dictionary/dictionarySync.hpp>
+#include <db/searchdb.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace dictionary {
+
+    /**
+     * @brief Constructor for the DictionarySync class; starts the thread.
+     *
+     * @param dictionary The dictionary to fill; must outlive the DictionarySync.
+     * @param pollInterval The time between two polls for updated terms.
+     */
+    DictionarySync::DictionarySync(TermDictionary& dictionary, std::chrono::milliseconds pollInterval)
+        : dictionary(dictionary), pollInterval(pollInterval) {
+        this->poller = std::thread(&DictionarySync::run, this);
+    }
+
+    /**
+     * @brief Destructor; stops the thread.
+     */
+    DictionarySync::~DictionarySync() {
+        {
+            std::lock_guard<std::mutex> lock(this->stopMutex);
+            this->stopping = true;
+        }
+        this->stopSignal.notify_all();
+        this->poller.join();
+    }
+
+    /**
+     * @brief Poller loop: loads right away, then polls every pollInterval until the destructor runs.
+     */
+    void DictionarySync::run() {
+        std::unique_lock<std::mutex> lock(this->stopMutex);
+        while (!this->stopping) {
+            lock.unlock();
+            this->poll();
+            lock.lock();
+            this->stopSignal.wait_for(lock, this->pollInterval, [this]() { return this->stopping; });
+        }
+    }
+
+    /**
+     * @brief Loads every term, or the updated ones once loaded.
+     *
+     * After the full listing, polling starts UPDATE_SKEW before the earlier of the listing's
+     * start and the newest stamp it saw, so terms written while the listing ran are fetched
+     * again even if the cursor passed them before the write.
+     */
+    void DictionarySync::poll() {
+        try {
+            searcher_db::SearcherDB db;
+            if (this->sinceMs < 0) {
+                std::int64_t startedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                std::int64_t newestMs = 0;
+                std::vector<TermUpdate> terms = db.getTermUpdates(-1, newestMs);
+                std::size_t count = terms.size();
+                this->dictionary.load(std::move(terms));
+                this->sinceMs = std::max<std::int64_t>(0, (newestMs > 0 ? std::min(startedMs, newestMs) : startedMs) - searcher_db::UPDATE_SKEW.count());
+                std::cerr << "Loaded term dictionary: " << count << " terms" << std::endl;
+                return;
+            }
+
+            std::int64_t newestMs = this->sinceMs + searcher_db::UPDATE_SKEW.count();
+            std::vector<TermUpdate> updated = db.getTermUpdates(this->sinceMs, newestMs);
+            if (!updated.empty()) {
+                this->dictionary.update(updated);
+            }
+            this->sinceMs = newestMs - searcher_db::UPDATE_SKEW.count();
+        } catch (const std::exception& e) {
+            std::cerr << "Error synchronizing the term dictionary: " << e.what() << std::endl;
+        }
+    }
+
+}
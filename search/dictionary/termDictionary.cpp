@@ -0,0 +1,418 @@
+#include <dictionary/termDictionary.hpp>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace dictionary {
+
+    namespace {
+        // Pending terms that trigger a rebuild: a sixteenth of the table, at least this many
+        const std::size_t MIN_PENDING = 4096;
+    }
+
+    /**
+     * @brief Finds a term by binary search.
+     *
+     * @param term The term.
+     * @return const TermInfo* Its information, or null if the table does not hold it.
+     */
+    const TermInfo* TermDictionary::Table::find(std::string_view term) const {
+        std::size_t index = this->lowerBound(term, 0, this->size());
+        if (index < this->size() && this->name(index) == term) {
+            return &this->infos[index];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Finds the first term not less than a key by binary search.
+     *
+     * @param term The key.
+     * @param low The first index searched.
+     * @param high The end of the searched range.
+     * @return std::size_t The index of the first term >= key in [low, high), or high if there is none.
+     */
+    std::size_t TermDictionary::Table::lowerBound(std::string_view term, std::size_t low, std::size_t high) const {
+        while (low < high) {
+            std::size_t middle = low + (high - low) / 2;
+            if (this->name(middle) < term) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    /**
+     * @brief Finds the first term not less than a key at or after a position.
+     *
+     * Gallops ahead from the position before the binary search, so a target a few entries
+     * away costs a few comparisons on nearby memory instead of a search over the whole table.
+     *
+     * @param term The key, not less than the term before from.
+     * @param from The first index searched.
+     * @return std::size_t The index of the first term >= key, or size() if there is none.
+     */
+    std::size_t TermDictionary::Table::seek(std::string_view term, std::size_t from) const {
+        std::size_t low = from, step = 1;
+        while (low + step < this->size() && this->name(low + step - 1) < term) {
+            low += step;
+            step *= 2;
+        }
+        return this->lowerBound(term, low, std::min(this->size(), low + step));
+    }
+
+    /**
+     * @brief Constructor for the TermDictionary class; the dictionary is empty and not ready.
+     */
+    TermDictionary::TermDictionary() : table(std::make_shared<const Table>(Table{std::string(), {0}, {}})) {
+    }
+
+    /**
+     * @brief Replaces the contents with a full list of terms and marks the dictionary ready.
+     *
+     * @param terms Every term of the shard; duplicates keep the last entry.
+     */
+    void TermDictionary::load(std::vector<TermUpdate> terms) {
+        std::stable_sort(terms.begin(), terms.end(), [](const TermUpdate& a, const TermUpdate& b) { return a.term < b.term; });
+        std::vector<TermUpdate> unique;
+        unique.reserve(terms.size());
+        for (TermUpdate& term : terms) {
+            if (!unique.empty() && unique.back().term == term.term) {
+                unique.back() = std::move(term);
+            } else {
+                unique.push_back(std::move(term));
+            }
+        }
+
+        std::shared_ptr<const Table> built = build(unique);
+        BloomFilter filter = filterFor(*built);
+        {
+            std::unique_lock<std::shared_mutex> lock(this->mutex);
+            this->table = std::move(built);
+            this->filter = std::move(filter);
+            this->pending.clear();
+        }
+        this->loaded = true;
+        this->changes++;
+    }
+
+    /**
+     * @brief Adds new terms and updates the information of known ones.
+     *
+     * Once the pending terms outgrow MIN_PENDING and a sixteenth of the table, a merged table
+     * is built without holding the lock; only the swap blocks lookups.
+     *
+     * @param updates The updated terms.
+     */
+    void TermDictionary::update(const std::vector<TermUpdate>& updates) {
+        if (updates.empty()) {
+            return;
+        }
+        this->changes++;
+
+        std::shared_ptr<const Table> current;
+        std::vector<TermUpdate> merged;
+        {
+            std::unique_lock<std::shared_mutex> lock(this->mutex);
+            for (const TermUpdate& update : updates) {
+                this->pending[update.term] = update.info;
+                this->filter.add(update.term);
+            }
+            if (this->pending.size() < std::max(MIN_PENDING, this->table->size() / 16)) {
+                return;
+            }
+            current = this->table;
+            merged.reserve(this->pending.size());
+            for (const auto& entry : this->pending) {
+                merged.push_back(TermUpdate{entry.first, entry.second});
+            }
+        }
+
+        // Merge the sorted table with the sorted pending terms; the pending ones are newer
+        std::sort(merged.begin(), merged.end(), [](const TermUpdate& a, const TermUpdate& b) { return a.term < b.term; });
+        std::vector<TermUpdate> terms;
+        terms.reserve(current->size() + merged.size());
+        std::size_t i = 0, j = 0;
+        while (i < current->size() || j < merged.size()) {
+            if (j == merged.size() || (i < current->size() && current->name(i) < merged[j].term)) {
+                terms.push_back(TermUpdate{std::string(current->name(i)), current->infos[i]});
+                i++;
+            } else {
+                if (i < current->size() && current->name(i) == merged[j].term) i++;
+                terms.push_back(std::move(merged[j]));
+                j++;
+            }
+        }
+
+        std::shared_ptr<const Table> built = build(terms);
+        BloomFilter filter = filterFor(*built);
+        std::unique_lock<std::shared_mutex> lock(this->mutex);
+        this->table = std::move(built);
+        this->filter = std::move(filter);
+        this->pending.clear();
+        this->compactions++;
+    }
+
+    /**
+     * @brief Checks whether the initial load has completed.
+     *
+     * @return True once load has been called.
+     */
+    bool TermDictionary::ready() const {
+        return this->loaded.load();
+    }
+
+    /**
+     * @brief Checks whether a term is certainly not in the shard.
+     *
+     * @param term The term.
+     * @return True if the dictionary is ready and does not hold the term; false if the term may exist.
+     */
+    bool TermDictionary::knownAbsent(const std::string& term) {
+        if (!this->ready()) {
+            return false;
+        }
+        this->lookups++;
+
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        if (!this->filter.mayContain(term)) {
+            this->absent++;
+            this->bloomRejects++;
+            return true;
+        }
+        if (this->pending.count(term) > 0 || this->table->find(term) != nullptr) {
+            return false;
+        }
+        this->absent++;
+        return true;
+    }
+
+    /**
+     * @brief Looks up the information of a term.
+     *
+     * @param term The term.
+     * @param info Receives the information.
+     * @return True if the dictionary holds the term.
+     */
+    bool TermDictionary::lookup(const std::string& term, TermInfo& info) const {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        auto it = this->pending.find(term);
+        if (it != this->pending.end()) {
+            info = it->second;
+            return true;
+        }
+        const TermInfo* found = this->table->find(term);
+        if (found) {
+            info = *found;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Finds the terms accepted by a Levenshtein automaton, other than the exact term.
+     *
+     * rows holds the state after every prefix of the last visited term; valid of them are
+     * still correct for the next term. When the state after term[0, d] is dead, no term with
+     * that prefix can match and the walk continues at the first term above the prefix. A
+     * prefix ending in 0xff bytes has no successor of the same length, so those bytes are
+     * dropped before incrementing. The pending terms are few and checked one by one.
+     *
+     * @param automaton The automaton of the query term.
+     * @param limit The maximum number of matches.
+     * @return std::vector<FuzzyMatch> The closest matches, most frequent first within a distance.
+     */
+    std::vector<FuzzyMatch> TermDictionary::expand(const fuzzy::LevenshteinAutomaton& automaton, std::size_t limit) const {
+        std::vector<FuzzyMatch> matches;
+        std::shared_ptr<const Table> current;
+        {
+            std::shared_lock<std::shared_mutex> lock(this->mutex);
+            current = this->table;
+            for (const auto& entry : this->pending) {
+                unsigned distance = automaton.match(entry.first);
+                if (distance >= 1 && distance <= automaton.maxEdits()) {
+                    matches.push_back(FuzzyMatch{entry.first, distance, entry.second});
+                }
+            }
+        }
+        std::size_t fromPending = matches.size();
+
+        const std::size_t width = automaton.width();
+        std::vector<std::uint8_t> rows(width * (fuzzy::MAX_TERM_LENGTH + fuzzy::MAX_EDITS + 2));
+        automaton.start(rows.data());
+        std::string_view previous;
+        std::size_t valid = 0;
+        std::size_t i = 0;
+        while (i < current->size()) {
+            std::string_view name = current->name(i);
+            std::size_t depth = 0;
+            std::size_t shared = std::min(valid, std::min(previous.size(), name.size()));
+            while (depth < shared && previous[depth] == name[depth]) depth++;
+
+            // Extend the states past the shared prefix until the term ends or a state dies
+            bool dead = false;
+            for (; depth < name.size(); depth++) {
+                if ((depth + 2) * width > rows.size()) {
+                    dead = true;
+                    break;
+                }
+                if (!automaton.step(&rows[depth * width], name[depth], &rows[(depth + 1) * width])) {
+                    dead = true;
+                    break;
+                }
+            }
+            previous = name;
+            if (!dead) {
+                valid = name.size();
+                unsigned distance = automaton.distance(&rows[name.size() * width]);
+                if (distance >= 1 && distance <= automaton.maxEdits()) {
+                    matches.push_back(FuzzyMatch{std::string(name), distance, current->infos[i]});
+                }
+                i++;
+                continue;
+            }
+
+            // Seek past every term starting with the dead prefix name[0, depth]
+            valid = depth;
+            std::string successor(name.substr(0, depth + 1));
+            while (!successor.empty() && static_cast<unsigned char>(successor.back()) == 0xff) {
+                successor.pop_back();
+            }
+            if (successor.empty()) {
+                break;
+            }
+            successor.back() = static_cast<char>(static_cast<unsigned char>(successor.back()) + 1);
+            i = current->seek(successor, i + 1);
+        }
+
+        // A pending entry replaces the table entry of the same term
+        if (fromPending > 0) {
+            std::sort(matches.begin(), matches.begin() + fromPending, [](const FuzzyMatch& a, const FuzzyMatch& b) { return a.term < b.term; });
+            matches.erase(std::remove_if(matches.begin() + fromPending, matches.end(), [&](const FuzzyMatch& match) {
+                return std::binary_search(matches.begin(), matches.begin() + fromPending, match, [](const FuzzyMatch& a, const FuzzyMatch& b) { return a.term < b.term; });
+            }), matches.end());
+        }
+
+        auto closer = [](const FuzzyMatch& a, const FuzzyMatch& b) {
+            if (a.distance != b.distance) return a.distance < b.distance;
+            if (a.info.documents != b.info.documents) return a.info.documents > b.info.documents;
+            return a.term < b.term;
+        };
+        if (matches.size() > limit) {
+            std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), closer);
+            matches.resize(limit);
+        } else {
+            std::sort(matches.begin(), matches.end(), closer);
+        }
+        return matches;
+    }
+
+    /**
+     * @brief Returns a counter that changes whenever terms are loaded or updated.
+     *
+     * @return std::uint64_t The version of the contents.
+     */
+    std::uint64_t TermDictionary::version() const {
+        return this->changes.load();
+    }
+
+    /**
+     * @brief Visits every term in ascending order.
+     *
+     * The table and the sorted pending terms are merged on the fly; a pending entry replaces
+     * the table entry of the same term.
+     *
+     * @param visit Called with every term and its information.
+     */
+    void TermDictionary::forEach(const std::function<void(std::string_view, const TermInfo&)>& visit) const {
+        std::shared_ptr<const Table> current;
+        std::vector<std::pair<std::string, TermInfo>> updated;
+        {
+            std::shared_lock<std::shared_mutex> lock(this->mutex);
+            current = this->table;
+            updated.assign(this->pending.begin(), this->pending.end());
+        }
+        std::sort(updated.begin(), updated.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::size_t i = 0, j = 0;
+        while (i < current->size() || j < updated.size()) {
+            if (j == updated.size() || (i < current->size() && current->name(i) < updated[j].first)) {
+                visit(current->name(i), current->infos[i]);
+                i++;
+            } else {
+                if (i < current->size() && current->name(i) == updated[j].first) i++;
+                visit(updated[j].first, updated[j].second);
+                j++;
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the state and counters.
+     *
+     * @return DictionaryStats The current state.
+     */
+    DictionaryStats TermDictionary::stats() const {
+        DictionaryStats stats;
+        stats.ready = this->ready();
+        stats.lookups = this->lookups.load();
+        stats.absent = this->absent.load();
+        stats.bloomRejects = this->bloomRejects.load();
+
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        std::size_t added = 0;
+        for (const auto& entry : this->pending) {
+            if (!this->table->find(entry.first)) added++;
+        }
+        stats.terms = this->table->size() + added;
+        stats.pending = this->pending.size();
+        stats.bytes = this->table->bytes() + this->filter.bytes() + this->pending.size() * (sizeof(TermInfo) + 64);
+        stats.compactions = this->compactions;
+        return stats;
+    }
+
+    /**
+     * @brief Builds a sorted table from terms.
+     *
+     * @param terms The terms, sorted and unique.
+     * @return std::shared_ptr<const Table> The table.
+     * @throws std::length_error If the term bytes exceed 4 GiB.
+     */
+    std::shared_ptr<const TermDictionary::Table> TermDictionary::build(const std::vector<TermUpdate>& terms) {
+        auto table = std::make_shared<Table>();
+        std::size_t bytes = 0;
+        for (const TermUpdate& term : terms) {
+            bytes += term.term.size();
+        }
+        if (bytes > UINT32_MAX) {
+            throw std::length_error("term dictionary exceeds 4 GiB of term bytes");
+        }
+        table->names.reserve(bytes);
+        table->offsets.reserve(terms.size() + 1);
+        table->infos.reserve(terms.size());
+        for (const TermUpdate& term : terms) {
+            table->offsets.push_back(static_cast<std::uint32_t>(table->names.size()));
+            table->names += term.term;
+            table->infos.push_back(term.info);
+        }
+        table->offsets.push_back(static_cast<std::uint32_t>(table->names.size()));
+        return table;
+    }
+
+    /**
+     * @brief Builds a filter sized with room for growth until the next rebuild.
+     *
+     * @param table The table the filter covers.
+     * @return BloomFilter The filter.
+     */
+    BloomFilter TermDictionary::filterFor(const Table& table) {
+        BloomFilter filter(table.size() + std::max(MIN_PENDING, table.size() / 16));
+        for (std::size_t i = 0; i < table.size(); i++) {
+            filter.add(table.name(i));
+        }
+        return filter;
+    }
+
+}
@@ -0,0 +1,88 @@
+#include <fuzzy/levenshtein.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace fuzzy {
+
+    /**
+     * @brief Constructor for the LevenshteinAutomaton class.
+     *
+     * @param term The term, at most MAX_TERM_LENGTH bytes.
+     * @param maxEdits The largest accepted distance, at most MAX_EDITS.
+     * @throws std::invalid_argument If the term is too long or the distance too large.
+     */
+    LevenshteinAutomaton::LevenshteinAutomaton(std::string term, unsigned maxEdits) : term(std::move(term)), edits(maxEdits) {
+        if (this->term.size() > MAX_TERM_LENGTH) {
+            throw std::invalid_argument("term too long for a Levenshtein automaton");
+        }
+        if (maxEdits > MAX_EDITS) {
+            throw std::invalid_argument("unsupported edit distance");
+        }
+    }
+
+    /**
+     * @brief Returns the edit distance a term of a given length is expanded with.
+     *
+     * @param length The length of the term in bytes.
+     * @return unsigned The edit distance, 0 for terms that are matched exactly.
+     */
+    unsigned LevenshteinAutomaton::editsFor(std::size_t length) {
+        if (length < 3 || length > MAX_TERM_LENGTH) return 0;
+        if (length < 6) return 1;
+        return 2;
+    }
+
+    /**
+     * @brief Writes the state before any input: reaching term[0, i) takes i deletions.
+     *
+     * @param state Receives width() bytes.
+     */
+    void LevenshteinAutomaton::start(std::uint8_t* state) const {
+        std::uint8_t cap = static_cast<std::uint8_t>(this->edits + 1);
+        for (std::size_t i = 0; i < this->width(); i++) {
+            state[i] = static_cast<std::uint8_t>(std::min<std::size_t>(i, cap));
+        }
+    }
+
+    /**
+     * @brief Reads one byte: the next row of the edit distance matrix, capped at maxEdits + 1.
+     *
+     * @param state The current state.
+     * @param c The input byte.
+     * @param next Receives the following state, width() bytes; must not alias state.
+     * @return True if some entry of next is within the bound.
+     */
+    bool LevenshteinAutomaton::step(const std::uint8_t* state, char c, std::uint8_t* next) const {
+        std::uint8_t cap = static_cast<std::uint8_t>(this->edits + 1);
+        std::uint8_t best = next[0] = std::min<std::uint8_t>(state[0] + 1, cap);
+        for (std::size_t i = 1; i < this->width(); i++) {
+            std::uint8_t substitute = state[i - 1] + (this->term[i - 1] == c ? 0 : 1);
+            std::uint8_t insert = state[i] + 1;
+            std::uint8_t remove = next[i - 1] + 1;
+            next[i] = std::min<std::uint8_t>(std::min(substitute, std::min(insert, remove)), cap);
+            best = std::min(best, next[i]);
+        }
+        return best < cap;
+    }
+
+    /**
+     * @brief Computes the distance of a whole string, stopping at the first dead state.
+     *
+     * @param input The string.
+     * @return unsigned The edit distance, or maxEdits() + 1 if it exceeds the bound.
+     */
+    unsigned LevenshteinAutomaton::match(std::string_view input) const {
+        if (input.size() > this->term.size() + this->edits || input.size() + this->edits < this->term.size()) {
+            return this->edits + 1;
+        }
+        std::uint8_t rows[2][MAX_TERM_LENGTH + 1];
+        this->start(rows[0]);
+        for (std::size_t i = 0; i < input.size(); i++) {
+            if (!this->step(rows[i & 1], input[i], rows[(i + 1) & 1])) {
+                return this->edits + 1;
+            }
+        }
+        return this->distance(rows[input.size() & 1]);
+    }
+
+}
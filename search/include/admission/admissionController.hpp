@@ -0,0 +1,130 @@
+#ifndef ADMISSIONCONTROLLER_HPP
+#define ADMISSIONCONTROLLER_HPP
+
+#include "jetplusplus/server/request.hpp"
+#include "jetplusplus/server/response.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace admission {
+
+    /**
+     * @struct AdmissionOptions
+     * @brief Limits and shedding parameters of a single route.
+     */
+    struct AdmissionOptions {
+        std::size_t maxConcurrent = 16;                 ///< Requests executing the handler at the same time.
+        std::size_t maxQueue = 64;                      ///< Requests allowed to wait for a free slot.
+        std::chrono::milliseconds target{5};            ///< CoDel target: acceptable queueing delay.
+        std::chrono::milliseconds interval{100};        ///< CoDel interval: how long the delay may stay above target.
+        std::chrono::milliseconds maxQueueWait{500};    ///< Longest wait for a slot while the route is healthy.
+        int retryAfterSeconds = 1;                      ///< Value of the Retry-After header on shed requests.
+    };
+
+    /**
+     * @struct AdmissionStats
+     * @brief Snapshot of the counters of an AdmissionController.
+     */
+    struct AdmissionStats {
+        std::size_t inFlight = 0;           ///< Requests currently executing.
+        std::size_t queued = 0;             ///< Requests currently waiting for a slot.
+        std::uint64_t admitted = 0;         ///< Requests that were executed.
+        std::uint64_t shedQueueFull = 0;    ///< Requests rejected because the wait queue was full.
+        std::uint64_t shedTimeout = 0;      ///< Requests rejected because no slot freed up in time.
+        bool overloaded = false;            ///< Whether the queueing delay has been above target for a full interval.
+    };
+
+    /**
+     * @class AdmissionController
+     * @brief Bounds the concurrency of a route and sheds excess load early.
+     * 
+     * At most maxConcurrent requests execute at once; up to maxQueue more wait for a slot.
+     * Queueing delay is tracked CoDel-style: once every admitted request has waited longer
+     * than the target for a whole interval the route counts as overloaded, and waiting
+     * requests only get the target (instead of maxQueueWait) before they are rejected.
+     * A rejected request costs a 503 instead of a slot, which keeps latency bounded for
+     * the requests that are accepted.
+     */
+    class AdmissionController {
+    public:
+        /**
+         * @brief Constructor for the AdmissionController class.
+         * 
+         * @param options The limits and shedding parameters.
+         */
+        explicit AdmissionController(const AdmissionOptions& options);
+
+        /**
+         * @brief Waits (bounded) for an execution slot.
+         * 
+         * @return True if the request was admitted and must call release(), false if it was shed.
+         */
+        bool acquire();
+
+        /**
+         * @brief Frees the execution slot of an admitted request.
+         */
+        void release();
+
+        /**
+         * @brief Returns a snapshot of the counters.
+         * 
+         * @return AdmissionStats The current counters.
+         */
+        AdmissionStats stats();
+
+        /**
+         * @brief Returns the configured limits.
+         * 
+         * @return const AdmissionOptions& The options.
+         */
+        const AdmissionOptions& getOptions() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        AdmissionOptions options;               ///< Limits and shedding parameters.
+        std::mutex mutex;                       ///< Guards all state below.
+        std::condition_variable slotFreed;      ///< Signalled when an execution slot is released.
+        std::size_t inFlight = 0;               ///< Requests executing.
+        std::size_t queued = 0;                 ///< Requests waiting.
+        std::uint64_t admitted = 0;             ///< Requests executed.
+        std::uint64_t shedQueueFull = 0;        ///< Requests rejected on a full queue.
+        std::uint64_t shedTimeout = 0;          ///< Requests rejected after waiting.
+        Clock::time_point firstAboveTime{};     ///< When the delay will have been above target for a full interval (epoch if below).
+
+        /**
+         * @brief Records the queueing delay of a request and updates the CoDel state.
+         * 
+         * @param sojourn Time the request spent waiting.
+         * @param now The current time.
+         */
+        void observeDelay(Clock::duration sojourn, Clock::time_point now);
+
+        /**
+         * @brief Checks whether the route is in the overloaded (dropping) state.
+         * 
+         * @param now The current time.
+         * @return True if the delay has been above target for at least one interval.
+         */
+        bool overloaded(Clock::time_point now) const;
+    };
+
+    /**
+     * @brief Wraps a route handler with admission control.
+     * 
+     * Shed requests are answered with 503 Service Unavailable and a Retry-After header
+     * without running the handler.
+     * 
+     * @param controller The controller of the route; must outlive the router.
+     * @param handler The route handler.
+     * @return The guarded handler.
+     */
+    std::function<void(jetpp::Request&, jetpp::Response&)> guard(AdmissionController& controller, std::function<void(jetpp::Request&, jetpp::Response&)> handler);
+
+}
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include <compression/compression.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace cache {
+
+    /// Invalidated terms remembered for puts that started before the invalidation.
+    const std::size_t RECENT_INVALIDATIONS = 4096;
+
+    /**
+     * @class CachedResult
+     * @brief A serialized search response together with its compressed variants.
+     * 
+     * The uncompressed body is stored on insertion; each compressed variant is produced the
+     * first time a client asks for it and kept, so repeated hits are served without compressing again.
+     */
+    class CachedResult {
+    public:
+        /**
+         * @brief Constructor for the CachedResult class.
+         * 
+         * @param body The serialized, uncompressed response body.
+         */
+        explicit CachedResult(std::string body);
+
+        /**
+         * @brief Returns the body in the requested encoding.
+         * 
+         * Bodies below compression::MIN_COMPRESS_SIZE are always returned uncompressed.
+         * 
+         * @param encoding The requested encoding; set to the encoding actually used.
+         * @return std::string The encoded body.
+         */
+        std::string encoded(compression::Encoding& encoding);
+
+        /**
+         * @brief Returns the uncompressed body.
+         * 
+         * @return const std::string& The body.
+         */
+        const std::string& body() const;
+
+    private:
+        const std::string identity;                                 ///< Uncompressed body.
+        std::mutex mutex;                                           ///< Guards variants.
+        std::map<compression::Encoding, std::string> variants;      ///< Compressed bodies by encoding.
+    };
+
+    /**
+     * @struct CacheStats
+     * @brief Snapshot of the counters of a ResultCache.
+     */
+    struct CacheStats {
+        std::uint64_t hits = 0;     ///< Lookups answered from the cache.
+        std::uint64_t misses = 0;   ///< Lookups that found nothing (or an expired entry).
+        std::size_t entries = 0;    ///< Entries currently stored.
+        std::uint64_t invalidated = 0;  ///< Entries dropped because a term of theirs changed or the cache was cleared.
+        std::uint64_t rejected = 0;     ///< Puts dropped because the response was computed before an invalidation.
+    };
+
+    /**
+     * @class ResultCache
+     * @brief A thread-safe LRU cache of serialized search responses with a time-to-live.
+     * 
+     * Entries can be tagged with the terms their response depends on and are then dropped as
+     * soon as one of them changes. Every invalidation advances a generation; a response that
+     * was computed before an invalidation of one of its terms is not stored.
+     */
+    class ResultCache {
+    public:
+        /**
+         * @brief Constructor for the ResultCache class.
+         * 
+         * @param capacity Maximum number of entries; the least recently used entry is evicted beyond it.
+         * @param ttl Time after which an entry is considered stale.
+         */
+        ResultCache(std::size_t capacity, std::chrono::seconds ttl);
+
+        /**
+         * @brief Looks up a cached response.
+         * 
+         * @param key The cache key.
+         * @return The cached response, or nullptr on a miss.
+         */
+        std::shared_ptr<CachedResult> get(const std::string& key);
+
+        /**
+         * @brief Stores a serialized response.
+         * 
+         * @param key The cache key.
+         * @param body The serialized, uncompressed response body.
+         * @return The stored entry.
+         */
+        std::shared_ptr<CachedResult> put(const std::string& key, std::string body);
+
+        /**
+         * @brief Stores a serialized response tagged with the terms it depends on.
+         * 
+         * @param key The cache key.
+         * @param body The serialized, uncompressed response body.
+         * @param terms The terms the response was computed from.
+         * @param generation The generation read before the response was computed.
+         * @return The entry; not stored if one of the terms was invalidated since the generation.
+         */
+        std::shared_ptr<CachedResult> put(const std::string& key, std::string body, const std::vector<std::string>& terms, std::uint64_t generation);
+
+        /**
+         * @brief Drops every entry tagged with a term.
+         * 
+         * @param term The changed term.
+         */
+        void invalidate(const std::string& term);
+
+        /**
+         * @brief Drops every entry.
+         */
+        void clear();
+
+        /**
+         * @brief Returns the current generation, to be passed to put.
+         * 
+         * @return std::uint64_t The number of invalidations so far.
+         */
+        std::uint64_t generation();
+
+        /**
+         * @brief Returns a snapshot of the counters.
+         * 
+         * @return CacheStats The current counters.
+         */
+        CacheStats stats();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry {
+            std::shared_ptr<CachedResult> result;   ///< The cached response.
+            Clock::time_point expiry;               ///< When the entry goes stale.
+            std::list<std::string>::iterator lru;   ///< Position in the LRU list.
+            std::vector<std::string> terms;         ///< Terms the entry is tagged with.
+        };
+
+        std::size_t capacity;                           ///< Maximum number of entries.
+        std::chrono::seconds ttl;                       ///< Time-to-live of an entry.
+        std::mutex mutex;                               ///< Guards all state below.
+        std::list<std::string> lru;                     ///< Keys, most recently used first.
+        std::unordered_map<std::string, Entry> entries; ///< Entries by key.
+        std::uint64_t hits = 0;                         ///< Cache hits.
+        std::uint64_t misses = 0;                       ///< Cache misses.
+        std::unordered_map<std::string, std::unordered_set<std::string>> keysByTerm; ///< Tagged keys by term.
+        std::deque<std::pair<std::uint64_t, std::string>> recent; ///< Last invalidated terms with their generation, oldest first.
+        std::uint64_t currentGeneration = 0;            ///< Invalidations so far.
+        std::uint64_t clearedGeneration = 0;            ///< Generation of the last clear.
+        std::uint64_t invalidated = 0;                  ///< Entries dropped by invalidations.
+        std::uint64_t rejected = 0;                     ///< Puts dropped as outdated.
+
+        /**
+         * @brief Removes an entry and its tags; the mutex must be held.
+         * 
+         * @param it The entry.
+         */
+        void erase(std::unordered_map<std::string, Entry>::iterator it);
+
+        /**
+         * @brief Stores an entry, evicting the least recently used ones if full; the mutex must be held.
+         * 
+         * @param key The cache key.
+         * @param result The response.
+         * @param terms The terms the entry is tagged with.
+         */
+        void insert(const std::string& key, std::shared_ptr<CachedResult> result, std::vector<std::string> terms);
+
+        /**
+         * @brief Checks whether a term was invalidated after a generation; the mutex must be held.
+         * 
+         * @param terms The terms.
+         * @param generation The generation.
+         * @return True if a response computed at that generation may be outdated.
+         */
+        bool outdated(const std::vector<std::string>& terms, std::uint64_t generation) const;
+    };
+
+}
+
+#endif
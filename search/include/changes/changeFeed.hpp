@@ -0,0 +1,147 @@
+#ifndef CHANGEFEED_HPP
+#define CHANGEFEED_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <cache/resultCache.hpp>
+#include <db/searchdb.hpp>
+#include <impact/impact.hpp>
+#include <snapshot/liveSnapshot.hpp>
+
+namespace changes {
+
+    /**
+     * @struct ChangeFeedStats
+     * @brief Snapshot of the state and counters of a ChangeFeed.
+     */
+    struct ChangeFeedStats {
+        bool current = false;               ///< Whether the stream is open and the state follows it.
+        std::int64_t documents = 0;         ///< Documents in the "websites" collection, counted incrementally.
+        std::int64_t statsVersion = 0;      ///< Version of the followed corpus statistics.
+        std::uint64_t events = 0;           ///< Change events processed.
+        std::uint64_t termChanges = 0;      ///< Term changes passed on to the caches.
+        std::uint64_t resets = 0;           ///< Full reloads of the followed state.
+        std::uint64_t failures = 0;         ///< Streams that failed and were reopened.
+        std::int64_t lastEventMs = 0;       ///< When the last event was processed (0 before the first).
+    };
+
+    /**
+     * @class ChangeFeed
+     * @brief Follows the database's change stream and keeps the caches and corpus statistics of a searcher current.
+     *
+     * A background thread tails a change stream on the "index" collection, the corpus
+     * statistics and the "websites" collection. A changed term drops exactly the cached
+     * results that contain it and marks it stale in the snapshot; new corpus statistics
+     * replace the followed ones and drop every cached result. Documents added to or
+     * removed from "websites" adjust the document count, which stands in for the statistics
+     * until the first impact refresh, so no search has to count the documents.
+     *
+     * After a failure the stream is resumed from the last processed event; until then the
+     * feed is not current and the result cache is cleared, so nothing stale survives a gap.
+     * Change streams need a replica set; a single-node one is enough.
+     */
+    class ChangeFeed {
+    public:
+        /**
+         * @brief Constructor for the ChangeFeed class; starts the thread.
+         *
+         * @param allShards Whether the terms of all shards are followed (for a coordinator) or only those of this shard.
+         * @param results The result cache to invalidate; may be null.
+         * @param snapshot The snapshot to invalidate; may be null.
+         */
+        ChangeFeed(bool allShards, cache::ResultCache* results, snapshot::LiveSnapshot* snapshot);
+
+        /**
+         * @brief Destructor; stops the thread.
+         */
+        ~ChangeFeed();
+
+        ChangeFeed(const ChangeFeed&) = delete;
+        ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+        /**
+         * @brief Gets the current corpus statistics without a database query.
+         *
+         * @param stats Receives the statistics.
+         * @return True if the feed is current and the statistics were returned.
+         */
+        bool corpusStats(impact::CorpusStats& stats) const;
+
+        /**
+         * @brief Checks whether the stream is open and the state follows it.
+         *
+         * @return True if changes are being followed.
+         */
+        bool current() const;
+
+        /**
+         * @brief Returns the state and counters.
+         *
+         * @return ChangeFeedStats The current state.
+         */
+        ChangeFeedStats stats() const;
+
+    private:
+        bool allShards;                             ///< Whether the terms of all shards are followed.
+        cache::ResultCache* results;                ///< Result cache, not owned; may be null.
+        snapshot::LiveSnapshot* snapshot;           ///< Snapshot, not owned; may be null.
+        mutable std::mutex stateMutex;              ///< Guards the state below.
+        impact::CorpusStats corpus;                 ///< Statistics of the last impact refresh.
+        bool refreshed = false;                     ///< Whether the statistics exist; otherwise documents stands in.
+        std::int64_t documents = 0;                 ///< Documents in "websites".
+        std::atomic<bool> following{false};         ///< Whether the stream is open.
+        std::atomic<std::uint64_t> events{0};       ///< Events processed.
+        std::atomic<std::uint64_t> termChanges{0};  ///< Term changes passed on.
+        std::atomic<std::uint64_t> resets{0};       ///< Full reloads.
+        std::atomic<std::uint64_t> failures{0};     ///< Failed streams.
+        std::atomic<std::int64_t> lastEventMs{0};   ///< When the last event was processed.
+        std::string resumeToken;                    ///< Token of the last processed event, only used by the thread.
+        std::mutex stopMutex;                       ///< Guards stopping.
+        std::condition_variable stopSignal;         ///< Wakes the thread for shutdown.
+        bool stopping = false;                      ///< Set by the destructor.
+        std::thread follower;                       ///< The following thread.
+
+        /**
+         * @brief Follower loop: opens the stream, reloads the state if needed and applies events.
+         */
+        void run();
+
+        /**
+         * @brief Reads one stream until it fails, closes or the feed stops.
+         *
+         * @param db The database the stream was opened on.
+         * @param stream The stream.
+         */
+        void follow(searcher_db::SearcherDB& db, mongocxx::change_stream& stream);
+
+        /**
+         * @brief Applies one change.
+         *
+         * @param db The database, for reloads.
+         * @param change The change.
+         */
+        void apply(searcher_db::SearcherDB& db, const searcher_db::ChangeEvent& change);
+
+        /**
+         * @brief Reloads the statistics and the document count and drops every cached result.
+         *
+         * @param db The database.
+         */
+        void reset(searcher_db::SearcherDB& db);
+
+        /**
+         * @brief Checks whether the destructor has asked the thread to stop.
+         *
+         * @return True if stopping.
+         */
+        bool stopRequested();
+    };
+
+}
+
+#endif
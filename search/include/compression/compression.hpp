@@ -0,0 +1,54 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace compression {
+
+    /**
+     * @enum Encoding
+     * @brief HTTP content codings supported for response bodies.
+     */
+    enum class Encoding {
+        Identity,
+        Gzip,
+        Deflate,
+        Zstd    ///< Only negotiated when built with ASURA_WITH_ZSTD.
+    };
+
+    /// Bodies smaller than this are sent uncompressed; the header overhead and CPU are not worth it.
+    const std::size_t MIN_COMPRESS_SIZE = 1024;
+
+    /**
+     * @brief Picks the best supported encoding from an Accept-Encoding header.
+     * 
+     * Honours q-values (q=0 excludes a coding) and "*". Ties are broken in favour of
+     * zstd, then gzip, then deflate.
+     * 
+     * @param acceptEncoding The value of the Accept-Encoding request header.
+     * @return Encoding The negotiated encoding, Identity if nothing supported is acceptable.
+     */
+    Encoding negotiate(const std::string& acceptEncoding);
+
+    /**
+     * @brief Returns the Content-Encoding token of an encoding.
+     * 
+     * @param encoding The encoding.
+     * @return const char* The token, e.g. "gzip".
+     */
+    const char* encodingName(Encoding encoding);
+
+    /**
+     * @brief Compresses a body with the given encoding.
+     * 
+     * @param body The uncompressed body.
+     * @param encoding The encoding to apply; Identity returns the body unchanged.
+     * @return std::string The encoded body.
+     * @throws std::runtime_error If the compressor fails.
+     */
+    std::string compress(const std::string& body, Encoding encoding);
+
+}
+
+#endif
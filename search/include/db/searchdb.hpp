@@ -5,9 +5,20 @@
 #include <mongocxx/client.hpp>
 #include <memory>
 #include <vector>
+#include <chrono>
+#include <impact/impact.hpp>
+#include <scoring/postingArrays.hpp>
+#include <dictionary/termDictionary.hpp>
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <mongocxx/change_stream.hpp>
+#include <mongocxx/stdx.hpp>
 
 namespace searcher_db {
 
+    /// Pollers of the "updatedMs" term stamps re-read this far back, covering clock skew between indexer and searcher.
+    const std::chrono::milliseconds UPDATE_SKEW{5000};
+
     /**
      * @struct IndexDocument
      * @brief Structure to represent an indexed document.
@@ -21,6 +32,40 @@ namespace searcher_db {
         int docLength;      ///< Length of the document.
     };
 
+    /**
+     * @struct FetchTiming
+     * @brief Time spent in a posting list fetch, split into the database round-trip and BSON decoding.
+     */
+    struct FetchTiming {
+        std::chrono::nanoseconds fetch{0};  ///< Time waiting for the database.
+        std::chrono::nanoseconds decode{0}; ///< Time converting the BSON postings.
+    };
+
+    /**
+     * @struct ChangeEvent
+     * @brief A change to the index, the corpus statistics or the document list, decoded from a change stream.
+     */
+    struct ChangeEvent {
+        /**
+         * @enum Kind
+         * @brief What changed.
+         */
+        enum class Kind {
+            Term,               ///< The postings of term changed.
+            Stats,              ///< The corpus statistics were replaced by stats.
+            DocumentAdded,      ///< A document was added to the "websites" collection.
+            DocumentRemoved,    ///< A document was removed from the "websites" collection.
+            Ignored,            ///< Nothing a searcher depends on changed.
+            Reset               ///< Something changed that cannot be followed incrementally, e.g. a dropped collection.
+        };
+
+        Kind kind = Kind::Ignored;  ///< What changed.
+        std::string term;           ///< The changed term, for Term.
+        impact::CorpusStats stats;  ///< The new statistics, for Stats.
+        std::string resumeToken;    ///< Resume token of the event, as extended JSON.
+        bool closed = false;        ///< Whether the stream ended with this event and has to be reopened from scratch.
+    };
+
     /**
      * @class SearcherDB
      * @brief A class to interact with the search database.
@@ -37,23 +82,138 @@ namespace searcher_db {
          */
         SearcherDB();
 
+        /**
+         * @brief Constructor for the SearcherDB class with a bounded driver socket timeout.
+         * 
+         * @param socketTimeout The socket and server selection timeout of the MongoDB client.
+         */
+        explicit SearcherDB(std::chrono::milliseconds socketTimeout);
+
         /**
          * @brief Retrieves documents that contain a specific term.
          * 
          * @param term The search term.
+         * @param maxTime The server-side time limit of the query (zero for no limit).
+         * @param timing If not null, the time spent fetching and decoding is added to it.
          * @return A vector of IndexDocument structures containing documents that include the term.
          */
-        std::vector<IndexDocument> getDocumentsByTerm(std::string term);
+        std::vector<IndexDocument> getDocumentsByTerm(std::string term, std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero(), FetchTiming* timing = nullptr);
+
+        /**
+         * @brief Retrieves the postings of a term in structure-of-arrays layout.
+         * 
+         * @param term The search term.
+         * @param maxTime The server-side time limit of the query (zero for no limit).
+         * @param postings Receives the postings; their document ids are left unassigned.
+         * @param timing If not null, the time spent fetching and decoding is added to it.
+         */
+        void getPostingArrays(const std::string& term, std::chrono::milliseconds maxTime, scoring::PostingArrays& postings, FetchTiming* timing = nullptr);
+
+        /**
+         * @brief Retrieves the precomputed impact-ordered postings of a term.
+         * 
+         * @param term The search term.
+         * @param maxTime The server-side time limit of the query (zero for no limit).
+         * @param postings Receives the postings, highest impact first.
+         * @param timing If not null, the time spent fetching and decoding is added to it.
+         * @return True if impacts were stored for the term, false if they still have to be computed.
+         */
+        bool getImpactsByTerm(const std::string& term, std::chrono::milliseconds maxTime, std::vector<impact::ImpactPosting>& postings, FetchTiming* timing = nullptr);
+
+        /**
+         * @brief Gets the corpus statistics the stored impacts were computed with.
+         * 
+         * Before the first impact refresh only the number of documents is known; it is counted directly.
+         * 
+         * @param maxTime The server-side time limit of the queries (zero for no limit).
+         * @return The corpus statistics.
+         */
+        impact::CorpusStats getCorpusStats(std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero());
 
         /**
          * @brief Gets the total number of documents in the database.
          * 
+         * @param maxTime The server-side time limit of the query (zero for no limit).
          * @return The total number of documents.
          */
-        int getTotalNumberDocuments();
+        int getTotalNumberDocuments(std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero());
+
+        /**
+         * @brief Counts the postings of a term without fetching them.
+         * 
+         * @param term The search term.
+         * @param maxTime The server-side time limit of the query (zero for no limit).
+         * @return The number of documents of this shard containing the term.
+         */
+        std::int64_t getPostingCount(const std::string& term, std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero());
+
+        /**
+         * @brief Lists the terms of this shard whose postings changed since a point in time.
+         * 
+         * @param sinceMs Milliseconds since the epoch; terms updated at or after it are returned.
+         * @param newestMs Raised to the newest update time seen, if later.
+         * @return The updated terms.
+         */
+        std::vector<std::string> getUpdatedTerms(std::int64_t sinceMs, std::int64_t& newestMs);
+
+        /**
+         * @brief Lists the terms of this shard with their document frequency and largest impact.
+         * 
+         * @param sinceMs Milliseconds since the epoch; only terms updated at or after it are listed. Negative lists every term.
+         * @param newestMs Raised to the newest update time seen, if later.
+         * @return The terms.
+         */
+        std::vector<dictionary::TermUpdate> getTermUpdates(std::int64_t sinceMs, std::int64_t& newestMs);
+
+        /**
+         * @brief Opens a change stream on the "index" collection, the corpus statistics and the "websites" collection.
+         * 
+         * Needs a replica set. Iterating the stream waits up to maxAwait for new events.
+         * 
+         * @param allShards Whether the "index" collections of all shards are watched, or only the one of this shard.
+         * @param resumeToken The resume token of the last processed event; empty starts at the current time.
+         * @param maxAwait How long an iteration waits for new events.
+         * @return The change stream; valid as long as this object.
+         */
+        mongocxx::change_stream watchChanges(bool allShards, const std::string& resumeToken, std::chrono::milliseconds maxAwait);
+
+        /**
+         * @brief Decodes an event of a stream opened by watchChanges.
+         * 
+         * @param event The change event.
+         * @return The decoded change.
+         */
+        static ChangeEvent decodeChange(bsoncxx::document::view event);
+
+        /**
+         * @brief Selects the shard whose "index" and "impacts" collections every SearcherDB reads.
+         * 
+         * Called once at startup, before any search runs. The corpus statistics stay global.
+         * 
+         * @param shard The shard of this process.
+         * @param shards The number of shards; 1 reads the unsharded collections.
+         */
+        static void useShard(std::size_t shard, std::size_t shards);
 
     private:
         std::shared_ptr<mongocxx::client> client; ///< Shared pointer to the MongoDB client.
+
+        /**
+         * @brief Fetches the term document holding the postings of a term.
+         * 
+         * @param term The search term.
+         * @param maxTime The server-side time limit of the query (zero for no limit).
+         * @param timing If not null, the time spent fetching is added to it.
+         * @return The term document, or nothing if the term is not indexed.
+         */
+        mongocxx::stdx::optional<bsoncxx::document::value> findTermDocument(const std::string& term, std::chrono::milliseconds maxTime, FetchTiming* timing);
+
+        /**
+         * @brief Connects the MongoDB client.
+         * 
+         * @param uri The MongoDB connection URI.
+         */
+        void connect(const std::string& uri);
     };
 
 }
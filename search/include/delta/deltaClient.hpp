@@ -0,0 +1,135 @@
+#ifndef DELTACLIENT_HPP
+#define DELTACLIENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <db/searchdb.hpp>
+#include <shard/shardClient.hpp>
+
+namespace delta {
+
+    /// Versions of the set of shadowed documents a client keeps as bases for incremental lookups.
+    const std::size_t SHADOW_VERSIONS = 8;
+
+    /**
+     * @struct DeltaView
+     * @brief The indexer's not yet persisted postings of the terms of one query.
+     */
+    struct DeltaView {
+        std::uint64_t sequence = 0;                                                         ///< Last sequence number of the delta at lookup time.
+        std::shared_ptr<const std::unordered_set<std::string>> shadowed;                    ///< Documents whose persisted postings are outdated, shared between lookups; may be null.
+        std::unordered_map<std::string, std::vector<searcher_db::IndexDocument>> terms;     ///< Recent postings by term.
+    };
+
+    /**
+     * @struct ShadowUpdate
+     * @brief The shadowed documents of a /delta/postings response.
+     */
+    struct ShadowUpdate {
+        std::uint64_t epoch = 0;                ///< Identity of the indexer's delta index.
+        std::uint64_t version = 0;              ///< Shadow version of the response.
+        bool full = true;                       ///< Whether shadowed is the whole set rather than the changes since the requested version.
+        std::vector<std::string> shadowed;      ///< Documents in the delta, or those that entered it since.
+        std::vector<std::string> unshadowed;    ///< Documents that left the delta since.
+    };
+
+    /**
+     * @struct DeltaClientStats
+     * @brief Counters of a DeltaClient.
+     */
+    struct DeltaClientStats {
+        std::uint64_t requests = 0;     ///< Lookups sent to the indexer.
+        std::uint64_t failures = 0;     ///< Lookups that failed or timed out.
+    };
+
+    /**
+     * @class DeltaClient
+     * @brief Looks up the indexer's delta index for the shard this searcher serves.
+     *
+     * Documents indexed or deleted in the last moments are only in the indexer's memory. A
+     * search merges the delta's postings with the persisted ones and drops the persisted
+     * postings of every document in the delta, so new, updated and deleted documents are
+     * reflected before they reach the database.
+     *
+     * The set of shadowed documents is kept between lookups, by shadow version, so the indexer
+     * only sends the documents that entered or left its delta since the newest version held.
+     * A lookup applies the changes to a copy of the version it asked from; the versions are
+     * immutable and shared with the views of running searches.
+     */
+    class DeltaClient {
+    public:
+        /**
+         * @brief Constructor for the DeltaClient class.
+         *
+         * @param indexer The address of the indexer.
+         * @param shard The shard whose documents are looked up.
+         */
+        DeltaClient(shard::Endpoint indexer, std::size_t shard);
+
+        /**
+         * @brief Looks up the delta postings of a query.
+         *
+         * @param query The normalized search query string.
+         * @param timeout The time the indexer has to answer.
+         * @param view Receives the delta postings.
+         * @return True if the indexer answered.
+         */
+        bool fetch(const std::string& query, std::chrono::milliseconds timeout, DeltaView& view);
+
+        /**
+         * @brief Parses a /delta/postings response.
+         *
+         * @param body The response body.
+         * @param view Receives the delta postings.
+         * @param update Receives the shadowed documents, or the changes to them.
+         * @return True if the body is a valid response.
+         */
+        static bool parse(const std::string& body, DeltaView& view, ShadowUpdate& update);
+
+        /**
+         * @brief Returns the counters.
+         *
+         * @return DeltaClientStats The current counters.
+         */
+        DeltaClientStats stats() const;
+
+    private:
+        /**
+         * @struct ShadowSet
+         * @brief A version of the shard's shadowed documents.
+         */
+        struct ShadowSet {
+            std::uint64_t version;                                      ///< Shadow version.
+            std::shared_ptr<const std::unordered_set<std::string>> urls; ///< The documents.
+        };
+
+        shard::Endpoint indexer;                ///< Address of the indexer.
+        std::size_t shard;                      ///< Shard whose documents are looked up.
+        std::atomic<std::uint64_t> requests{0}; ///< Lookups sent.
+        std::atomic<std::uint64_t> failures{0}; ///< Lookups that failed.
+        mutable std::mutex mutex;               ///< Guards epoch and versions.
+        std::uint64_t epoch = 0;                ///< Epoch of the kept versions; 0 before the first lookup.
+        std::deque<ShadowSet> versions;         ///< The last SHADOW_VERSIONS versions, oldest first.
+
+        /**
+         * @brief Builds the shadowed documents of a response and keeps them as a version.
+         *
+         * @param update The parsed shadowed documents.
+         * @param since The version the lookup asked from.
+         * @param view Receives the shadowed documents.
+         * @return False if the response is incremental but its base version is no longer kept.
+         */
+        bool apply(ShadowUpdate& update, std::uint64_t since, DeltaView& view);
+    };
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace dictionary {
+
+    /**
+     * @class BloomFilter
+     * @brief A cache-line blocked Bloom filter over strings.
+     *
+     * All probe bits of a key lie in one 512 bit block, so a lookup costs a single cache miss.
+     * With 10 bits per key and 7 probes about 1% of the absent keys are reported as present;
+     * present keys are never reported absent.
+     */
+    class BloomFilter {
+    public:
+        /**
+         * @brief Constructor for the BloomFilter class.
+         *
+         * @param capacity The number of keys the false positive rate is sized for.
+         */
+        explicit BloomFilter(std::size_t capacity = 0);
+
+        /**
+         * @brief Adds a key.
+         *
+         * @param key The key.
+         */
+        void add(std::string_view key);
+
+        /**
+         * @brief Checks whether a key may have been added.
+         *
+         * @param key The key.
+         * @return False if the key was certainly never added.
+         */
+        bool mayContain(std::string_view key) const;
+
+        /**
+         * @brief Returns the size of the bit array.
+         *
+         * @return std::size_t The size in bytes.
+         */
+        std::size_t bytes() const;
+
+    private:
+        std::vector<std::uint64_t> words;   ///< The bit array, 8 words per block.
+        std::size_t blocks = 0;             ///< Number of 512 bit blocks.
+    };
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef DICTIONARYSYNC_HPP
+#define DICTIONARYSYNC_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <dictionary/termDictionary.hpp>
+
+namespace dictionary {
+
+    /**
+     * @class DictionarySync
+     * @brief Loads a TermDictionary from the database and keeps it up to date.
+     *
+     * A background thread lists every term of the shard once, then polls for the terms the
+     * indexer has stamped as updated since. Until the first load has completed the dictionary
+     * is not ready and every term is looked up in the database.
+     */
+    class DictionarySync {
+    public:
+        /**
+         * @brief Constructor for the DictionarySync class; starts the thread.
+         *
+         * @param dictionary The dictionary to fill; must outlive the DictionarySync.
+         * @param pollInterval The time between two polls for updated terms.
+         */
+        DictionarySync(TermDictionary& dictionary, std::chrono::milliseconds pollInterval);
+
+        /**
+         * @brief Destructor; stops the thread.
+         */
+        ~DictionarySync();
+
+        DictionarySync(const DictionarySync&) = delete;
+        DictionarySync& operator=(const DictionarySync&) = delete;
+
+    private:
+        TermDictionary& dictionary;                 ///< The dictionary kept up to date.
+        std::chrono::milliseconds pollInterval;     ///< Time between polls.
+        std::int64_t sinceMs = -1;                  ///< Poll position; negative until the first full load.
+        std::mutex stopMutex;                       ///< Guards stopping.
+        std::condition_variable stopSignal;         ///< Wakes the thread for shutdown.
+        bool stopping = false;                      ///< Set by the destructor.
+        std::thread poller;                         ///< The polling thread.
+
+        /**
+         * @brief Poller loop.
+         */
+        void run();
+
+        /**
+         * @brief Loads every term, or the updated ones once loaded.
+         */
+        void poll();
+    };
+
+}
+
+#endif
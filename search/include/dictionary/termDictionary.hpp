@@ -0,0 +1,203 @@
+#ifndef TERMDICTIONARY_HPP
+#define TERMDICTIONARY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <dictionary/bloomFilter.hpp>
+#include <fuzzy/levenshtein.hpp>
+
+namespace dictionary {
+
+    /**
+     * @struct TermInfo
+     * @brief What the dictionary knows about a term of this shard.
+     */
+    struct TermInfo {
+        std::uint32_t documents = 0;    ///< Document frequency.
+        std::uint16_t maxImpact = 0;    ///< Largest impact of a posting, an upper bound of the term's score; 0 before the first impact refresh.
+    };
+
+    /**
+     * @struct TermUpdate
+     * @brief A term with its current information.
+     */
+    struct TermUpdate {
+        std::string term;   ///< The term.
+        TermInfo info;      ///< Its information.
+    };
+
+    /**
+     * @struct FuzzyMatch
+     * @brief A term within the edit distance of a query term.
+     */
+    struct FuzzyMatch {
+        std::string term;       ///< The term.
+        unsigned distance = 0;  ///< Its edit distance from the query term, at least 1.
+        TermInfo info;          ///< Its information.
+    };
+
+    /**
+     * @struct DictionaryStats
+     * @brief Snapshot of the state and counters of a TermDictionary.
+     */
+    struct DictionaryStats {
+        bool ready = false;             ///< Whether the initial load has completed.
+        std::size_t terms = 0;          ///< Terms held.
+        std::size_t pending = 0;        ///< Terms updated since the last compaction.
+        std::size_t bytes = 0;          ///< Approximate memory footprint.
+        std::uint64_t lookups = 0;      ///< Terms checked by knownAbsent.
+        std::uint64_t absent = 0;       ///< Terms reported absent.
+        std::uint64_t bloomRejects = 0; ///< Absent terms rejected by the Bloom filter alone.
+        std::uint64_t compactions = 0;  ///< Merges of the pending terms into the sorted table.
+    };
+
+    /**
+     * @class TermDictionary
+     * @brief The terms of this shard with their document frequency and impact bound.
+     *
+     * The terms are kept in one sorted, contiguous table, with a hash map in front for the
+     * terms updated since the table was last rebuilt, and a Bloom filter over both. Most
+     * absent terms are rejected by the filter with a single cache miss; the rest by the map
+     * and a binary search. Once the map has grown to a fraction of the table, the two are
+     * merged into a new table outside the lock and swapped in.
+     *
+     * Lookups may run concurrently; load and update must come from one thread.
+     */
+    class TermDictionary {
+    public:
+        /**
+         * @brief Constructor for the TermDictionary class; the dictionary is empty and not ready.
+         */
+        TermDictionary();
+
+        /**
+         * @brief Replaces the contents with a full list of terms and marks the dictionary ready.
+         *
+         * @param terms Every term of the shard; duplicates keep the last entry.
+         */
+        void load(std::vector<TermUpdate> terms);
+
+        /**
+         * @brief Adds new terms and updates the information of known ones.
+         *
+         * @param updates The updated terms.
+         */
+        void update(const std::vector<TermUpdate>& updates);
+
+        /**
+         * @brief Checks whether the initial load has completed.
+         *
+         * @return True once load has been called.
+         */
+        bool ready() const;
+
+        /**
+         * @brief Checks whether a term is certainly not in the shard.
+         *
+         * @param term The term.
+         * @return True if the dictionary is ready and does not hold the term; false if the term may exist.
+         */
+        bool knownAbsent(const std::string& term);
+
+        /**
+         * @brief Looks up the information of a term.
+         *
+         * @param term The term.
+         * @param info Receives the information.
+         * @return True if the dictionary holds the term.
+         */
+        bool lookup(const std::string& term, TermInfo& info) const;
+
+        /**
+         * @brief Finds the terms accepted by a Levenshtein automaton, other than the exact term.
+         *
+         * The sorted table is walked as an implicit trie: the automaton states of the current
+         * term's prefixes are reused by the next term, and once a prefix is dead the walk seeks
+         * past every term that starts with it.
+         *
+         * @param automaton The automaton of the query term.
+         * @param limit The maximum number of matches.
+         * @return std::vector<FuzzyMatch> The closest matches, most frequent first within a distance.
+         */
+        std::vector<FuzzyMatch> expand(const fuzzy::LevenshteinAutomaton& automaton, std::size_t limit) const;
+
+        /**
+         * @brief Returns a counter that changes whenever terms are loaded or updated.
+         *
+         * @return std::uint64_t The version of the contents.
+         */
+        std::uint64_t version() const;
+
+        /**
+         * @brief Visits every term in ascending order.
+         *
+         * Works on a copy of the pending terms and a reference to the current table, so
+         * lookups and updates are not blocked while the visitor runs.
+         *
+         * @param visit Called with every term and its information.
+         */
+        void forEach(const std::function<void(std::string_view, const TermInfo&)>& visit) const;
+
+        /**
+         * @brief Returns the state and counters.
+         *
+         * @return DictionaryStats The current state.
+         */
+        DictionaryStats stats() const;
+
+    private:
+        /**
+         * @struct Table
+         * @brief Immutable sorted term table.
+         */
+        struct Table {
+            std::string names;                  ///< Term bytes, concatenated in order.
+            std::vector<std::uint32_t> offsets; ///< Start of every term in names, plus the end.
+            std::vector<TermInfo> infos;        ///< Information of every term.
+
+            std::size_t size() const { return this->infos.size(); }
+            std::string_view name(std::size_t i) const { return std::string_view(this->names).substr(this->offsets[i], this->offsets[i + 1] - this->offsets[i]); }
+            const TermInfo* find(std::string_view term) const;
+            std::size_t lowerBound(std::string_view term, std::size_t low, std::size_t high) const;
+            std::size_t seek(std::string_view term, std::size_t from) const;
+            std::size_t bytes() const { return this->names.capacity() + this->offsets.capacity() * sizeof(std::uint32_t) + this->infos.capacity() * sizeof(TermInfo); }
+        };
+
+        mutable std::shared_mutex mutex;                    ///< Guards table, pending and filter.
+        std::shared_ptr<const Table> table;                 ///< Sorted terms.
+        std::unordered_map<std::string, TermInfo> pending;  ///< Terms updated since the table was built.
+        BloomFilter filter;                                 ///< Filter over the table and the pending terms.
+        std::atomic<bool> loaded{false};                    ///< Set by load.
+        std::atomic<std::uint64_t> lookups{0};              ///< knownAbsent calls.
+        std::atomic<std::uint64_t> absent{0};               ///< knownAbsent hits.
+        std::atomic<std::uint64_t> bloomRejects{0};         ///< Hits decided by the filter.
+        std::uint64_t compactions = 0;                      ///< Table rebuilds, guarded by mutex.
+        std::atomic<std::uint64_t> changes{0};              ///< Incremented by load and every non-empty update.
+
+        /**
+         * @brief Builds a sorted table from terms.
+         *
+         * @param terms The terms, sorted and unique.
+         * @return std::shared_ptr<const Table> The table.
+         */
+        static std::shared_ptr<const Table> build(const std::vector<TermUpdate>& terms);
+
+        /**
+         * @brief Builds a filter sized with room for growth until the next rebuild.
+         *
+         * @param table The table the filter covers.
+         * @return BloomFilter The filter.
+         */
+        static BloomFilter filterFor(const Table& table);
+    };
+
+}
+
+#endif
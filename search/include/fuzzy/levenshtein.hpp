@@ -0,0 +1,104 @@
+#ifndef LEVENSHTEIN_HPP
+#define LEVENSHTEIN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace fuzzy {
+
+    /// Longest term, in bytes, an automaton is compiled for; longer terms are matched exactly.
+    const std::size_t MAX_TERM_LENGTH = 64;
+
+    /// Largest supported edit distance.
+    const unsigned MAX_EDITS = 2;
+
+    /**
+     * @class LevenshteinAutomaton
+     * @brief Accepts the strings within a bounded edit distance of a term.
+     *
+     * A state is one row of the edit distance matrix of the term against the input read so
+     * far, with every entry capped at maxEdits + 1. The caller owns the states, so a walk over
+     * sorted strings keeps one row per prefix byte and resumes from the longest prefix shared
+     * with the previous string. A state from which no accepted string can be reached is dead,
+     * which lets the walk skip every string below that prefix.
+     *
+     * Distances are counted in bytes: insertions, deletions and substitutions, no transpositions.
+     */
+    class LevenshteinAutomaton {
+    public:
+        /**
+         * @brief Constructor for the LevenshteinAutomaton class.
+         *
+         * @param term The term, at most MAX_TERM_LENGTH bytes.
+         * @param maxEdits The largest accepted distance, at most MAX_EDITS.
+         */
+        LevenshteinAutomaton(std::string term, unsigned maxEdits);
+
+        /**
+         * @brief Returns the edit distance a term of a given length is expanded with.
+         *
+         * Short terms have too many neighbours to expand usefully: no edits below 3 bytes,
+         * one up to 5 bytes and two from 6 bytes.
+         *
+         * @param length The length of the term in bytes.
+         * @return unsigned The edit distance, 0 for terms that are matched exactly.
+         */
+        static unsigned editsFor(std::size_t length);
+
+        /**
+         * @brief Returns the number of bytes of a state.
+         *
+         * @return std::size_t The length of the term plus one.
+         */
+        std::size_t width() const { return this->term.size() + 1; }
+
+        /**
+         * @brief Returns the largest accepted distance.
+         *
+         * @return unsigned The distance the automaton was compiled with.
+         */
+        unsigned maxEdits() const { return this->edits; }
+
+        /**
+         * @brief Writes the state before any input.
+         *
+         * @param state Receives width() bytes.
+         */
+        void start(std::uint8_t* state) const;
+
+        /**
+         * @brief Reads one byte.
+         *
+         * @param state The current state.
+         * @param c The input byte.
+         * @param next Receives the following state, width() bytes; must not alias state.
+         * @return True if next can still reach an accepted string.
+         */
+        bool step(const std::uint8_t* state, char c, std::uint8_t* next) const;
+
+        /**
+         * @brief Returns the distance of the input read so far.
+         *
+         * @param state The state after the input.
+         * @return unsigned The edit distance, or maxEdits() + 1 if the input is not accepted.
+         */
+        unsigned distance(const std::uint8_t* state) const { return state[this->term.size()]; }
+
+        /**
+         * @brief Computes the distance of a whole string, stopping at the first dead state.
+         *
+         * @param input The string.
+         * @return unsigned The edit distance, or maxEdits() + 1 if it exceeds the bound.
+         */
+        unsigned match(std::string_view input) const;
+
+    private:
+        std::string term;   ///< The term the automaton accepts neighbours of.
+        unsigned edits;     ///< The largest accepted distance.
+    };
+
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef RERANKER_HPP
+#define RERANKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ranking {
+
+    /// Candidates the first phase selects for re-ranking unless a request asks for another number.
+    const std::size_t DEFAULT_CANDIDATES = 100;
+
+    /// Largest number of candidates a request can ask for.
+    const std::size_t MAX_CANDIDATES = 1000;
+
+    /**
+     * @enum Feature
+     * @brief Document features of the second phase, each in [0, 1].
+     */
+    enum class Feature : unsigned {
+        Coverage = 0,   ///< Fraction of the query terms whose postings contain the document.
+        Depth,          ///< 1 / (1 + path segments of the URL): shallow pages score higher.
+        Length,         ///< 1 / (1 + URL length / 64): short URLs score higher.
+        UrlMatch        ///< Fraction of the query terms that occur in the URL.
+    };
+
+    /// Number of features.
+    const std::size_t FEATURE_COUNT = 4;
+
+    /// Bit mask with every feature enabled.
+    const unsigned ALL_FEATURES = (1u << FEATURE_COUNT) - 1;
+
+    /// Feature values, indexed by Feature.
+    using FeatureVector = std::array<float, FEATURE_COUNT>;
+
+    /**
+     * @struct Candidate
+     * @brief A document selected by the first phase.
+     */
+    struct Candidate {
+        std::string url;                ///< URL of the document.
+        float score;                    ///< First-phase score: the sum of the document's impacts.
+        std::size_t matchedTerms = 0;   ///< Query terms whose postings contain the document.
+    };
+
+    /**
+     * @struct RankingOptions
+     * @brief How a search ranks its results: the number of candidates and the features of the second phase.
+     */
+    struct RankingOptions {
+        std::size_t candidates = DEFAULT_CANDIDATES;    ///< Candidates re-ranked; 0 ranks by the first-phase score alone.
+        unsigned features = ALL_FEATURES;               ///< Bit f enables Feature f.
+
+        /**
+         * @brief Checks whether the second phase runs.
+         *
+         * @return True if candidates are re-ranked with at least one feature.
+         */
+        bool reranked() const { return this->candidates > 0 && this->features != 0; }
+
+        /**
+         * @brief Checks whether the options are the defaults.
+         *
+         * @return True if a request without ranking parameters ranks the same way.
+         */
+        bool standard() const;
+
+        /**
+         * @brief Formats the options as query parameters, the inverse of parse.
+         *
+         * @return std::string "rerank=N&features=a,b", with "none" for an empty feature set.
+         */
+        std::string parameters() const;
+
+        /**
+         * @brief Parses the rerank and features query parameters.
+         *
+         * @param candidates The number of candidates; empty for the default, capped at MAX_CANDIDATES.
+         * @param features Comma-separated feature names (coverage, depth, length, url) or "none"; empty for all.
+         * @return RankingOptions The options.
+         */
+        static RankingOptions parse(const std::string& candidates, const std::string& features);
+    };
+
+    /**
+     * @brief Computes the features of a candidate.
+     *
+     * @param candidate The candidate.
+     * @param terms The query terms.
+     * @param features The enabled features; disabled ones stay 0.
+     * @return FeatureVector The feature values.
+     */
+    FeatureVector extractFeatures(const Candidate& candidate, const std::vector<std::string>& terms, unsigned features);
+
+    /**
+     * @class Scorer
+     * @brief The model of the second phase.
+     *
+     * The final score must only depend on the first-phase score and the document's own
+     * features, so that the re-ranked top-k lists of different shards can still be merged.
+     */
+    class Scorer {
+    public:
+        virtual ~Scorer() = default;
+
+        /**
+         * @brief Scores a candidate.
+         *
+         * @param score The first-phase score.
+         * @param features The feature values; disabled features are 0.
+         * @return float The final score.
+         */
+        virtual float score(float score, const FeatureVector& features) const = 0;
+    };
+
+    /**
+     * @class LinearScorer
+     * @brief Boosts the first-phase score by a weighted sum of the features.
+     *
+     * The final score is score * (1 + sum of weight * feature), so the features reorder
+     * documents of similar relevance without overriding the text match.
+     */
+    class LinearScorer : public Scorer {
+    public:
+        /**
+         * @brief Constructor for the LinearScorer class.
+         *
+         * @param weights The weight of every feature.
+         */
+        explicit LinearScorer(const FeatureVector& weights);
+
+        /**
+         * @brief Scores a candidate.
+         *
+         * @param score The first-phase score.
+         * @param features The feature values.
+         * @return float The boosted score.
+         */
+        float score(float score, const FeatureVector& features) const override;
+
+        /**
+         * @brief Returns the scorer with the default weights.
+         *
+         * @return const LinearScorer& The shared default scorer.
+         */
+        static const LinearScorer& standard();
+
+    private:
+        FeatureVector weights; ///< Weight of every feature.
+    };
+
+    /**
+     * @brief Re-ranks the candidates of the first phase.
+     *
+     * @param candidates The candidates, in any order.
+     * @param terms The query terms.
+     * @param features The enabled features.
+     * @param scorer The model.
+     * @param limit The number of results kept.
+     * @return std::vector<Candidate> The best candidates by final score, ties broken by URL.
+     */
+    std::vector<Candidate> rerank(std::vector<Candidate> candidates, const std::vector<std::string>& terms, unsigned features, const Scorer& scorer, std::size_t limit);
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef POSTINGARRAYS_HPP
+#define POSTINGARRAYS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scoring {
+
+    /// Alignment of the posting arrays: a cache line, which also covers a 512 bit vector.
+    const std::size_t POSTING_ALIGNMENT = 64;
+
+    /**
+     * @class AlignedAllocator
+     * @brief Allocator handing out POSTING_ALIGNMENT aligned storage for the posting arrays.
+     *
+     * @tparam T The element type.
+     */
+    template <typename T>
+    class AlignedAllocator {
+    public:
+        using value_type = T;
+
+        AlignedAllocator() = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U>&) {}
+
+        T* allocate(std::size_t n) {
+            std::size_t bytes = (n * sizeof(T) + POSTING_ALIGNMENT - 1) / POSTING_ALIGNMENT * POSTING_ALIGNMENT;
+            void* memory = std::aligned_alloc(POSTING_ALIGNMENT, bytes == 0 ? POSTING_ALIGNMENT : bytes);
+            if (!memory) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(memory);
+        }
+
+        void deallocate(T* memory, std::size_t) {
+            std::free(memory);
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U>&) const { return true; }
+
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U>&) const { return false; }
+    };
+
+    template <typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    /**
+     * @struct PostingArrays
+     * @brief The postings of a term in structure-of-arrays layout.
+     *
+     * The scoring kernel streams over tfs and docLengths; docIds index the score array of
+     * the query and are only assigned once the postings are added to a DocumentTable.
+     */
+    struct PostingArrays {
+        std::vector<std::string> urls;      ///< URL of every posting.
+        AlignedVector<std::uint32_t> docIds; ///< Query-local document id of every posting.
+        AlignedVector<float> tfs;           ///< Term frequency of every posting.
+        AlignedVector<float> docLengths;    ///< Document length of every posting, as float for the kernel.
+
+        /**
+         * @brief Returns the number of postings.
+         *
+         * @return The number of postings.
+         */
+        std::size_t size() const { return this->tfs.size(); }
+
+        /**
+         * @brief Reserves room for a number of postings.
+         *
+         * @param count The expected number of postings.
+         */
+        void reserve(std::size_t count) {
+            this->urls.reserve(count);
+            this->tfs.reserve(count);
+            this->docLengths.reserve(count);
+        }
+
+        /**
+         * @brief Appends a posting.
+         *
+         * @param url The URL of the document.
+         * @param tf The term frequency.
+         * @param docLength The document length.
+         */
+        void add(std::string url, float tf, int docLength) {
+            this->urls.push_back(std::move(url));
+            this->tfs.push_back(tf);
+            this->docLengths.push_back(static_cast<float>(docLength));
+        }
+    };
+
+    /**
+     * @class DocumentTable
+     * @brief Assigns dense, query-local document ids to URLs.
+     *
+     * The ids index a plain score array, so the kernel accumulates without hashing.
+     */
+    class DocumentTable {
+    public:
+        DocumentTable() = default;
+        DocumentTable(DocumentTable&&) = default;
+        DocumentTable& operator=(DocumentTable&&) = default;
+
+        // A copy would keep viewing the URLs of the original
+        DocumentTable(const DocumentTable&) = delete;
+        DocumentTable& operator=(const DocumentTable&) = delete;
+
+        /**
+         * @brief Assigns the document ids of a term's postings, creating ids for new URLs.
+         *
+         * @param postings The postings; their docIds are filled in.
+         */
+        void assign(PostingArrays& postings) {
+            postings.docIds.resize(postings.size());
+            for (std::size_t i = 0; i < postings.size(); i++) {
+                auto it = this->ids.find(postings.urls[i]);
+                if (it == this->ids.end()) {
+                    // The deque never moves its elements, so the key can view the stored URL
+                    this->urls.push_back(postings.urls[i]);
+                    it = this->ids.emplace(this->urls.back(), static_cast<std::uint32_t>(this->urls.size() - 1)).first;
+                }
+                postings.docIds[i] = it->second;
+            }
+        }
+
+        /**
+         * @brief Returns the number of distinct documents.
+         *
+         * @return The number of assigned ids.
+         */
+        std::size_t size() const { return this->urls.size(); }
+
+        /**
+         * @brief Returns the URL of a document id.
+         *
+         * @param id The document id.
+         * @return The URL.
+         */
+        const std::string& url(std::uint32_t id) const { return this->urls[id]; }
+
+    private:
+        std::unordered_map<std::string_view, std::uint32_t> ids; ///< Document id by URL (views into urls).
+        std::deque<std::string> urls;                           ///< URL by document id.
+    };
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef SCORINGKERNEL_HPP
+#define SCORINGKERNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace scoring {
+
+    /**
+     * @enum Isa
+     * @brief Instruction sets the scoring kernel is implemented for.
+     */
+    enum class Isa {
+        Scalar,     ///< Portable C++.
+        Neon,       ///< 4 floats per step (AArch64).
+        Avx2,       ///< 8 floats per step with FMA.
+        Avx512      ///< 16 floats per step, with gather/scatter accumulation.
+    };
+
+    /**
+     * @struct TermWeights
+     * @brief Per-term constants of the combined TF-IDF/BM25 score.
+     *
+     * The score of a posting reduces to tf * (tfIdf + bm25 / (tf + lengthBase + lengthScale * docLength)),
+     * so the kernel needs one fused multiply-add, one division and two multiply-adds per posting.
+     */
+    struct TermWeights {
+        float tfIdf = 0;        ///< Weighted IDF of the TF-IDF component.
+        float bm25 = 0;         ///< Weighted IDF * (k1 + 1) of the BM25 component.
+        float lengthBase = 0;   ///< k1 * (1 - b).
+        float lengthScale = 0;  ///< k1 * b / avgDocLength.
+
+        /**
+         * @brief Computes the constants of a term.
+         *
+         * @param idf The IDF score of the term.
+         * @param avgDocLength The average document length; values below 1 disable length normalization.
+         * @return TermWeights The constants.
+         */
+        static TermWeights make(float idf, float avgDocLength);
+    };
+
+    /**
+     * @brief Returns the best instruction set supported by the running CPU.
+     *
+     * @return Isa The instruction set, detected once.
+     */
+    Isa detectIsa();
+
+    /**
+     * @brief Checks whether the running CPU supports an instruction set.
+     *
+     * @param isa The instruction set.
+     * @return True if the kernel can run with it.
+     */
+    bool supported(Isa isa);
+
+    /**
+     * @brief Returns the name of an instruction set, e.g. "avx2".
+     *
+     * @param isa The instruction set.
+     * @return const char* The name.
+     */
+    const char* isaName(Isa isa);
+
+    /**
+     * @brief Computes the score of every posting.
+     *
+     * @param tfs The term frequencies.
+     * @param docLengths The document lengths.
+     * @param count The number of postings.
+     * @param weights The constants of the term.
+     * @param scores Receives count scores.
+     */
+    void computeScores(const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores);
+
+    /**
+     * @brief Computes the score of every posting and adds it to the score of its document.
+     *
+     * The document ids of a single call have to be distinct, which holds for the postings of one term.
+     *
+     * @param docIds The document ids, indexes into scores.
+     * @param tfs The term frequencies.
+     * @param docLengths The document lengths.
+     * @param count The number of postings.
+     * @param weights The constants of the term.
+     * @param scores The score array of the query.
+     */
+    void accumulateScores(const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores);
+
+    /**
+     * @brief computeScores with an explicit instruction set, which has to be supported.
+     */
+    void computeScores(Isa isa, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores);
+
+    /**
+     * @brief accumulateScores with an explicit instruction set, which has to be supported.
+     */
+    void accumulateScores(Isa isa, const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores);
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef DEADLINE_HPP
+#define DEADLINE_HPP
+
+#include <chrono>
+
+namespace searcher {
+
+    /**
+     * @class Deadline
+     * @brief A point in time by which a search request has to be answered.
+     *
+     * The deadline is propagated from the request handler into the database layer
+     * (driver socket timeouts and per-operation max_time) and into the scoring loop.
+     */
+    class Deadline {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Constructs a deadline that never expires.
+         */
+        Deadline() : expiry(Clock::time_point::max()) {}
+
+        /**
+         * @brief Creates a deadline that expires after the given budget.
+         *
+         * @param budget The time budget, starting now.
+         * @return Deadline The deadline.
+         */
+        static Deadline after(std::chrono::milliseconds budget) {
+            Deadline deadline;
+            deadline.expiry = Clock::now() + budget;
+            return deadline;
+        }
+
+        /**
+         * @brief Checks whether the deadline is bounded at all.
+         *
+         * @return True if the deadline expires at some point.
+         */
+        bool bounded() const {
+            return this->expiry != Clock::time_point::max();
+        }
+
+        /**
+         * @brief Checks whether the deadline has passed.
+         *
+         * @return True if no time is left.
+         */
+        bool expired() const {
+            return bounded() && Clock::now() >= this->expiry;
+        }
+
+        /**
+         * @brief Returns the time left until the deadline, at least 1 ms while bounded.
+         *
+         * Drivers treat a zero timeout as "no timeout", so the remaining time is clamped to 1 ms.
+         *
+         * @return The remaining time, or milliseconds::max() for an unbounded deadline.
+         */
+        std::chrono::milliseconds remaining() const {
+            if (!bounded()) {
+                return std::chrono::milliseconds::max();
+            }
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(this->expiry - Clock::now());
+            return left.count() > 0 ? left : std::chrono::milliseconds(1);
+        }
+
+        /**
+         * @brief Returns the moment the deadline expires.
+         *
+         * @return The expiry, or Clock::time_point::max() for an unbounded deadline.
+         */
+        Clock::time_point at() const {
+            return this->expiry;
+        }
+
+    private:
+        Clock::time_point expiry; ///< The moment the deadline expires.
+    };
+
+}
+
+#endif
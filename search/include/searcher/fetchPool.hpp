@@ -0,0 +1,156 @@
+#ifndef FETCHPOOL_HPP
+#define FETCHPOOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <db/searchdb.hpp>
+#include <impact/impact.hpp>
+#include <scoring/postingArrays.hpp>
+#include <searcher/deadline.hpp>
+
+namespace searcher {
+
+    /**
+     * @struct FetchedPostings
+     * @brief The postings of a term as read from the database by a FetchPool worker.
+     */
+    struct FetchedPostings {
+        bool hasImpacts = false;                    ///< Whether the term has stored impacts.
+        std::vector<impact::ImpactPosting> impacts; ///< The stored impacts, highest first.
+        scoring::PostingArrays documents;           ///< The raw postings of a term without stored impacts.
+        searcher_db::FetchTiming timing;            ///< Time spent waiting for the database and decoding.
+    };
+
+    /**
+     * @struct FetchPoolStats
+     * @brief Snapshot of the counters of a FetchPool.
+     */
+    struct FetchPoolStats {
+        std::size_t workers = 0;        ///< Worker threads.
+        std::size_t queued = 0;         ///< Queries waiting for a worker.
+        std::uint64_t fetched = 0;      ///< Queries completed.
+        std::uint64_t expired = 0;      ///< Queries dropped because their deadline passed while queued.
+        std::uint64_t failed = 0;       ///< Queries that threw.
+    };
+
+    /**
+     * @class FetchPool
+     * @brief Worker threads that run the database queries of searches on persistent clients.
+     *
+     * A search hands the fetches of all its terms to the pool at once and collects them as
+     * futures, so their round-trips overlap instead of adding up. Every worker keeps its own
+     * database client for its lifetime, since a client must not be shared between threads,
+     * and the connections are reused across searches. The workers are the only connections
+     * searches use, so the pool size is the connection budget of the searcher. A query whose
+     * deadline passes while it is queued is dropped without a round-trip.
+     */
+    class FetchPool {
+    public:
+        /**
+         * @brief Constructor for the FetchPool class; starts the workers and connects their clients.
+         *
+         * @param workers The number of worker threads and database connections (at least one).
+         * @param socketTimeout The socket timeout of the workers' clients, an upper bound of every fetch.
+         */
+        FetchPool(std::size_t workers, std::chrono::milliseconds socketTimeout);
+
+        /**
+         * @brief Destructor; completes the queued queries and joins the workers.
+         */
+        ~FetchPool();
+
+        FetchPool(const FetchPool&) = delete;
+        FetchPool& operator=(const FetchPool&) = delete;
+
+        /**
+         * @brief Queues the fetch of a term's postings.
+         *
+         * @param term The term.
+         * @param maxTime The server-side time limit of the query (zero for no limit).
+         * @param deadline The deadline of the search; the fetch is dropped if it passes first.
+         * @return std::future<FetchedPostings> The postings, or the exception of the fetch.
+         */
+        std::future<FetchedPostings> fetch(const std::string& term, std::chrono::milliseconds maxTime, const Deadline& deadline);
+
+        /**
+         * @brief Queues any query on a worker's client.
+         *
+         * @param description What the query reads, for the error of a dropped query.
+         * @param deadline The deadline of the search; the query is dropped if it passes first.
+         * @param query Runs the query with the worker's client.
+         * @return std::future<Result> The result, or the exception of the query.
+         */
+        template<typename Result>
+        std::future<Result> submit(const std::string& description, const Deadline& deadline, std::function<Result(searcher_db::SearcherDB&)> query) {
+            std::shared_ptr<std::promise<Result>> result = std::make_shared<std::promise<Result>>();
+            Task task;
+            task.description = description;
+            task.deadline = deadline;
+            task.run = [result, query](searcher_db::SearcherDB& db) { result->set_value(query(db)); };
+            task.fail = [result](std::exception_ptr error) { result->set_exception(error); };
+            this->enqueue(std::move(task));
+            return result->get_future();
+        }
+
+        /**
+         * @brief Returns the number of worker threads.
+         *
+         * @return The number of workers.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Returns a snapshot of the counters.
+         *
+         * @return FetchPoolStats The current counters.
+         */
+        FetchPoolStats stats() const;
+
+    private:
+        /**
+         * @struct Task
+         * @brief A queued query.
+         */
+        struct Task {
+            std::string description;                                ///< What the query reads.
+            Deadline deadline;                                      ///< Deadline of the search.
+            std::function<void(searcher_db::SearcherDB&)> run;      ///< Runs the query and sets its result.
+            std::function<void(std::exception_ptr)> fail;           ///< Sets the exception of the query.
+        };
+
+        std::chrono::milliseconds socketTimeout;    ///< Socket timeout of the workers' clients.
+        mutable std::mutex mutex;                   ///< Guards tasks and stopping.
+        std::condition_variable available;          ///< Signals queued tasks or stop.
+        std::deque<Task> tasks;                     ///< Queries waiting for a worker.
+        bool stopping = false;                      ///< Set by the destructor.
+        std::atomic<std::uint64_t> fetched{0};      ///< Queries completed.
+        std::atomic<std::uint64_t> expired{0};      ///< Queries dropped at their deadline.
+        std::atomic<std::uint64_t> failed{0};       ///< Queries that threw.
+        std::vector<std::thread> workers;           ///< The worker threads.
+
+        /**
+         * @brief Queues a task and wakes a worker.
+         *
+         * @param task The task.
+         */
+        void enqueue(Task&& task);
+
+        /**
+         * @brief Worker loop: runs queries with the worker's own client until stopped.
+         */
+        void run();
+    };
+
+}
+
+#endif
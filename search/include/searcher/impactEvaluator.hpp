@@ -0,0 +1,131 @@
+#ifndef IMPACTEVALUATOR_HPP
+#define IMPACTEVALUATOR_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <impact/impact.hpp>
+#include <ranking/reranker.hpp>
+#include <searcher/deadline.hpp>
+#include <searcher/searcher.hpp>
+#include <threadpool/threadPool.hpp>
+
+namespace searcher {
+
+    /**
+     * @struct ImpactEvaluation
+     * @brief Counters of a single impact-ordered query evaluation.
+     */
+    struct ImpactEvaluation {
+        std::size_t scored = 0;         ///< Postings added to an accumulator.
+        std::size_t skipped = 0;        ///< Postings never looked at because the top-k was already settled.
+        bool terminatedEarly = false;   ///< Whether the evaluation stopped before the end of the lists.
+        bool partial = false;           ///< Whether the deadline expired during the evaluation.
+    };
+
+    /**
+     * @class ImpactEvaluator
+     * @brief Evaluates a disjunctive query over impact-ordered posting lists.
+     *
+     * Postings of all terms are consumed in decreasing impact order (score-at-a-time) and
+     * added up as integers. The highest unread impact of every list bounds what any document
+     * can still gain, so once no document outside the current top-k can reach the k-th score
+     * the candidates are fixed: the rest of the lists is only scanned for the candidates'
+     * missing terms, without creating new accumulators. The result is the exact top-k of the
+     * quantized scores.
+     */
+    class ImpactEvaluator {
+    public:
+        /**
+         * @brief Constructor for the ImpactEvaluator class.
+         *
+         * @param deadline The deadline of the search; checked every 256 postings.
+         */
+        explicit ImpactEvaluator(const Deadline& deadline);
+
+        /**
+         * @brief Adds the postings of a query term.
+         *
+         * @param postings The postings, sorted by impact with impact::sortByImpact.
+         */
+        void addTerm(std::vector<impact::ImpactPosting> postings);
+
+        /**
+         * @brief Accumulates the postings until the top-k is settled or the lists are exhausted.
+         *
+         * @param limit The number of results (k).
+         * @return ImpactEvaluation The evaluation counters.
+         */
+        ImpactEvaluation accumulate(std::size_t limit);
+
+        /**
+         * @brief Selects the best accumulated documents.
+         *
+         * @param limit The maximum number of results.
+         * @return std::vector<SearchResult> The results ranked by score, ties broken by URL.
+         */
+        std::vector<SearchResult> results(std::size_t limit) const;
+
+        /**
+         * @brief Selects the best accumulated documents with the number of terms they matched.
+         *
+         * @param limit The maximum number of candidates.
+         * @return std::vector<ranking::Candidate> The candidates ranked by score, ties broken by URL.
+         */
+        std::vector<ranking::Candidate> candidates(std::size_t limit) const;
+
+        /**
+         * @brief Evaluates a query split into document partitions, one ImpactEvaluator per partition.
+         *
+         * Documents are assigned to partitions by ranges of their URL hash, so every partition
+         * holds a disjoint set of documents and sees the full impact order of its postings. Each
+         * partition settles its own top-k on the pool; since a document's score lives in exactly
+         * one partition, the best of the per-partition top-k lists is the exact global top-k.
+         *
+         * @param lists The impact-ordered postings per term; the postings are moved out.
+         * @param partitions The number of partitions (1 to 255).
+         * @param limit The number of results (k).
+         * @param deadline The deadline of the search.
+         * @param pool The pool the partitions run on; the calling thread takes part.
+         * @param evaluation Receives the evaluation counters summed over the partitions.
+         * @return std::vector<ranking::Candidate> The candidates ranked by score, ties broken by URL.
+         */
+        static std::vector<ranking::Candidate> evaluatePartitioned(std::vector<std::vector<impact::ImpactPosting>>& lists, std::size_t partitions, std::size_t limit, const Deadline& deadline, threadpool::ThreadPool& pool, ImpactEvaluation& evaluation);
+
+    private:
+        /**
+         * @struct Accumulator
+         * @brief Running score of a document and the terms already added to it.
+         */
+        struct Accumulator {
+            std::uint32_t score = 0;    ///< Sum of the impacts added so far.
+            std::uint64_t terms = 0;    ///< Bit t is set once term t has been added.
+        };
+
+        std::vector<std::vector<impact::ImpactPosting>> lists;          ///< Impact-ordered postings per term.
+        std::vector<std::size_t> cursors;                               ///< Next unread posting per term.
+        std::unordered_map<std::string_view, Accumulator> accumulators; ///< Scores by URL (views into lists).
+        Deadline deadline;                                              ///< Deadline of the search.
+
+        /**
+         * @brief Checks whether the top-k is settled and returns the k-th score.
+         *
+         * @param limit The number of results (k).
+         * @param threshold Receives the current k-th score.
+         * @return True if no document below the threshold can still reach it.
+         */
+        bool settled(std::size_t limit, std::uint32_t& threshold) const;
+
+        /**
+         * @brief Upper bound of what a document can still gain from the terms it has not seen.
+         *
+         * @param terms The terms already added to the document.
+         * @return std::uint64_t The sum of the highest unread impacts of the missing terms.
+         */
+        std::uint64_t remainingBound(std::uint64_t terms) const;
+    };
+
+}
+
+#endif
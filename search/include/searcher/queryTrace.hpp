@@ -0,0 +1,48 @@
+#ifndef QUERYTRACE_HPP
+#define QUERYTRACE_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+namespace searcher {
+
+    /**
+     * @struct TermTrace
+     * @brief Posting list size of a single query term.
+     */
+    struct TermTrace {
+        std::string term;         ///< The query term.
+        std::size_t postings = 0; ///< Number of postings fetched for the term.
+        std::size_t expansions = 0; ///< Similar terms an unknown term was replaced with (fuzzy matching).
+    };
+
+    /**
+     * @struct QueryTrace
+     * @brief Breakdown of where the time of a single search request went.
+     *
+     * The searcher fills in the query, the per-term posting sizes and the pipeline stages;
+     * the request handler adds the cache state, the serialization time and the total.
+     */
+    struct QueryTrace {
+        std::string query;                        ///< The normalized query.
+        std::vector<TermTrace> terms;             ///< Posting list size per term, in evaluation order.
+        std::size_t documentsScored = 0;          ///< Postings scored across all terms.
+        std::size_t partitions = 1;               ///< Document partitions evaluated in parallel (1: single-threaded).
+        std::size_t candidates = 0;               ///< Documents re-ranked by the second phase (0: not re-ranked).
+        std::chrono::nanoseconds statsFetch{0};   ///< Time fetching the corpus statistics.
+        std::chrono::nanoseconds postingFetch{0}; ///< Time waiting for posting lists from the database.
+        std::chrono::nanoseconds decode{0};       ///< Time decoding the BSON posting lists.
+        std::chrono::nanoseconds score{0};        ///< Time scoring postings.
+        std::chrono::nanoseconds select{0};       ///< Time selecting the top-k results.
+        std::chrono::nanoseconds rerank{0};       ///< Time re-ranking the candidates.
+        std::chrono::nanoseconds serialize{0};    ///< Time serializing the response body.
+        std::chrono::nanoseconds total{0};        ///< Time from the start of the handler to the response.
+        std::string cache = "miss";               ///< Result cache state: "hit", "miss", "coalesced" or "abandoned".
+        bool partial = false;                     ///< Whether the search was cut short by its deadline.
+    };
+
+}
+
+#endif
@@ -4,23 +4,57 @@
 #include <string>
 #include <vector>
 #include <db/searchdb.hpp>
+#include <searcher/deadline.hpp>
+#include <searcher/fetchPool.hpp>
+#include <searcher/queryTrace.hpp>
+#include <scoring/postingArrays.hpp>
+#include <impact/impact.hpp>
+#include <threadpool/threadPool.hpp>
+#include <snapshot/liveSnapshot.hpp>
+#include <dictionary/termDictionary.hpp>
+#include <delta/deltaClient.hpp>
+#include <ranking/reranker.hpp>
 #include <algorithm>
-#include <unordered_map>
+#include <future>
 #include <memory>
 
 namespace searcher {
 
+    /// Number of results returned by a search.
+    const std::size_t MAX_RESULTS = 26;
+
+    /// Queries with fewer postings in total are evaluated on the request thread alone.
+    const std::size_t PARALLEL_MIN_POSTINGS = 65536;
+
+    /// Postings per partition of a parallel evaluation; bounds the split overhead per partition.
+    const std::size_t POSTINGS_PER_PARTITION = 32768;
+
+    /// Dictionary terms an unknown query term is expanded to at most.
+    const std::size_t MAX_EXPANSIONS = 4;
+
+    /// Impact factor per edit of an expanded term: 0.5 at distance 1, 0.25 at distance 2.
+    const float FUZZY_PENALTY = 0.5f;
+
+    /**
+     * @struct SearchResult
+     * @brief Structure to represent a single ranked search result.
+     */
+    struct SearchResult {
+        std::string url;    ///< URL of the document.
+        float score;        ///< Combined total score of the document.
+    };
+
     /**
-     * @struct DocumentScores
-     * @brief Structure to hold various scoring metrics for a document.
+     * @struct SearchResponse
+     * @brief Structure to hold the ranked results of a search.
      * 
-     * This structure holds the TF-IDF score, BM25 score, and the total combined score
-     * for a document.
+     * If the deadline expired before every posting was scored, the results are the best
+     * top-k found so far and the response is flagged as partial.
      */
-    struct DocumentScores {
-        float td_idf = 0;    ///< Term Frequency-Inverse Document Frequency score
-        float bm25 = 0;      ///< BM25 score
-        float totalScore;    ///< Combined total score
+    struct SearchResponse {
+        std::vector<SearchResult> results; ///< Ranked results.
+        bool partial = false;              ///< Whether the search was cut short by its deadline.
+        QueryTrace trace;                  ///< Per-stage breakdown of the search.
     };
 
     /**
@@ -39,6 +73,73 @@ namespace searcher {
          */
         Searcher();
 
+        /**
+         * @brief Constructor for the Searcher class with a time budget.
+         * 
+         * The deadline bounds the driver socket timeout, every database query and the scoring loop.
+         * A client of its own is only connected if the search runs without a fetch pool.
+         * 
+         * @param deadline The deadline of the search request.
+         * @param pool The pool long queries are evaluated on in parallel; null keeps every query on the calling thread.
+         * @param snapshot The loaded index snapshot postings are read from while current; null reads everything from the database.
+         * @param dictionary The term dictionary that rules out absent terms before any lookup; may be null.
+         */
+        explicit Searcher(const Deadline& deadline, threadpool::ThreadPool* pool = nullptr, snapshot::LiveSnapshot* snapshot = nullptr, dictionary::TermDictionary* dictionary = nullptr);
+
+        /**
+         * @brief Constructor for the Searcher class with an existing database object.
+         * 
+         * @param db The database object; may be null if every term is served by the snapshot or the delta.
+         * @param deadline The deadline of the search request.
+         * @param pool The pool long queries are evaluated on in parallel; null keeps every query on the calling thread.
+         * @param snapshot The loaded index snapshot postings are read from while current; null reads everything from the database.
+         * @param dictionary The term dictionary that rules out absent terms before any lookup; may be null.
+         */
+        Searcher(std::shared_ptr<searcher_db::SearcherDB> db, const Deadline& deadline, threadpool::ThreadPool* pool = nullptr, snapshot::LiveSnapshot* snapshot = nullptr, dictionary::TermDictionary* dictionary = nullptr);
+
+        /**
+         * @brief Enables or disables the expansion of unknown terms to similar dictionary terms.
+         * 
+         * Fuzzy matching is enabled by default; it needs a ready term dictionary.
+         * 
+         * @param enabled Whether unknown terms are expanded.
+         */
+        void setFuzzy(bool enabled);
+
+        /**
+         * @brief Sets the indexer's recent postings of the query, merged with the persisted ones.
+         * 
+         * @param delta The delta postings of this shard, not owned; null searches the persisted index only.
+         */
+        void setDelta(const delta::DeltaView* delta);
+
+        /**
+         * @brief Sets the corpus statistics, so that the search does not read them from the snapshot or the database.
+         * 
+         * @param stats The current corpus statistics.
+         */
+        void setCorpusStats(const impact::CorpusStats& stats);
+
+        /**
+         * @brief Sets how the results are ranked.
+         * 
+         * By default, the best ranking::DEFAULT_CANDIDATES documents by impact are re-ranked
+         * with every feature by ranking::LinearScorer::standard().
+         * 
+         * @param options The number of candidates and the features of the second phase.
+         * @param scorer The model of the second phase, not owned; null uses the default linear model.
+         */
+        void setRanking(const ranking::RankingOptions& options, const ranking::Scorer* scorer = nullptr);
+
+        /**
+         * @brief Sets the pool the postings of queries with several terms are fetched on concurrently.
+         * 
+         * Every database query of the search then runs on a client of the pool.
+         * 
+         * @param fetchPool The shared fetch pool, not owned; null fetches one term after the other on the calling thread.
+         */
+        void setFetchPool(FetchPool* fetchPool);
+
         /**
          * @brief Searches for documents matching the query string.
          * 
@@ -47,18 +148,53 @@ namespace searcher {
          */
         std::vector<std::string> search(std::string query);
 
-    private:
-        std::unordered_map<std::string, DocumentScores> rank; ///< Map to hold document URLs and their scores.
-        std::shared_ptr<searcher_db::SearcherDB> db; ///< Shared pointer to the database object.
+        /**
+         * @brief Searches for documents matching the query string and keeps their scores.
+         * 
+         * @param query The search query string.
+         * @return The results (URL and score) ranked by relevance, flagged as partial if the deadline expired.
+         */
+        SearchResponse searchResults(std::string query);
 
         /**
-         * @brief Splits the query string into segments based on a delimiter.
+         * @brief Searches one shard of a sharded index with the document frequencies of the whole corpus.
          * 
-         * @param str The query string to be split.
-         * @param segments The vector to store the split segments.
-         * @param delimiter The character used to split the string.
+         * @param query The normalized search query string.
+         * @param globalPostings The posting count of every term across all shards, in query order; empty to use the local counts.
+         * @return The results of this shard, with scores comparable across shards.
+         */
+        SearchResponse searchResults(std::string query, const std::vector<std::int64_t>& globalPostings);
+
+        /**
+         * @brief Counts the postings of every term of a query in this shard.
+         * 
+         * The first phase of a sharded search: the coordinator adds up the counts of all shards.
+         * 
+         * @param query The normalized search query string.
+         * @return The posting count of every term, in query order.
+         */
+        std::vector<TermTrace> countPostings(std::string query);
+
+        /**
+         * @brief Normalizes a query so that equivalent queries map to the same key.
+         * 
+         * Empty segments are dropped and the terms are sorted, since ranking does not depend on term order.
+         * 
+         * @param query The raw search query string.
+         * @return The normalized query string.
          */
-        void splitQuery(const std::string& str, std::vector<std::string>& segments, char delimiter);
+        static std::string normalizeQuery(const std::string& query);
+
+        /**
+         * @brief Computes the impact-ordered postings of a term with the SIMD kernel.
+         * 
+         * Matches impact::computeImpacts up to float rounding at quantization boundaries.
+         * 
+         * @param postings The postings of the term.
+         * @param stats The corpus statistics.
+         * @return The postings with their impacts, highest first.
+         */
+        static std::vector<impact::ImpactPosting> quantizePostings(const scoring::PostingArrays& postings, const impact::CorpusStats& stats);
 
         /**
          * @brief Combines TF-IDF and BM25 scores into a total score.
@@ -67,7 +203,7 @@ namespace searcher {
          * @param bm25 The BM25 score.
          * @return The combined total score.
          */
-        float combineScores(float td_idf, float bm25);
+        static float combineScores(float td_idf, float bm25);
 
         /**
          * @brief Calculates the IDF (Inverse Document Frequency) score.
@@ -76,7 +212,7 @@ namespace searcher {
          * @param appearances The number of documents in which the term appears.
          * @return The IDF score.
          */
-        float calculateIDF_Score(int totalDocuments, int appearances);
+        static float calculateIDF_Score(int totalDocuments, int appearances);
 
         /**
          * @brief Calculates the BM25 score for a term in a document.
@@ -89,16 +225,115 @@ namespace searcher {
          * @param b The BM25 b parameter.
          * @return The BM25 score.
          */
-        float calculateBM25_Score(int doc_length, int avg_doc_length, float idf, float tf, float k1, float b);
+        static float calculateBM25_Score(int doc_length, int avg_doc_length, float idf, float tf, float k1, float b);
+
+    private:
+        std::shared_ptr<searcher_db::SearcherDB> db; ///< Own database client, connected on first use without a fetch pool; may be null.
+        Deadline deadline; ///< Deadline of the current search.
+        threadpool::ThreadPool* pool = nullptr; ///< Shared scoring pool, not owned; may be null.
+        snapshot::LiveSnapshot* snapshot = nullptr; ///< Loaded index snapshot, not owned; may be null.
+        dictionary::TermDictionary* dictionary = nullptr; ///< Term dictionary of the shard, not owned; may be null.
+        bool fuzzy = true; ///< Whether unknown terms are expanded to similar dictionary terms.
+        const delta::DeltaView* delta = nullptr; ///< Recent postings of the query, not owned; may be null.
+        impact::CorpusStats corpusStats; ///< Corpus statistics set by setCorpusStats.
+        bool statsKnown = false; ///< Whether corpusStats is set.
+        ranking::RankingOptions ranking; ///< Candidates and features of the second ranking phase.
+        const ranking::Scorer* scorer = nullptr; ///< Model of the second ranking phase, not owned; null for the default.
+        FetchPool* fetchPool = nullptr; ///< Shared fetch pool, not owned; may be null.
 
         /**
-         * @brief Comparator function to sort documents based on their scores.
+         * @struct PendingFetch
+         * @brief The postings of a term, requested before the term is evaluated.
+         */
+        struct PendingFetch {
+            bool started = false;                           ///< Whether the fetch was started.
+            bool fromSnapshot = false;                      ///< Whether the postings came from the snapshot.
+            std::vector<impact::ImpactPosting> postings;    ///< The snapshot postings.
+            std::future<FetchedPostings> database;          ///< The database fetch on the fetch pool.
+        };
+
+        /**
+         * @brief Returns the search's own database client, connecting it on first use.
+         * 
+         * @return The client.
+         */
+        searcher_db::SearcherDB& database();
+
+        /**
+         * @brief Waits for a query on the fetch pool until the deadline and takes its result.
          * 
-         * @param a The first document and its scores.
-         * @param b The second document and its scores.
-         * @return True if the score of document a is greater than the score of document b.
+         * @param pending The queued query.
+         * @return The result of the query.
+         * @throws std::runtime_error If the deadline passes first; the exception of the query if it failed.
+         */
+        template<typename Result>
+        Result awaitQuery(std::future<Result>& pending);
+
+        /**
+         * @brief Returns the time limit for the next database query.
+         * 
+         * @return The remaining time of the deadline, or zero if the search is unbounded.
+         */
+        std::chrono::milliseconds queryTimeLimit() const;
+
+        /**
+         * @brief Reads the impact-ordered postings of a term from the snapshot or the database.
+         * 
+         * @param term The term.
+         * @param stats The corpus statistics, used to quantize terms without stored impacts.
+         * @param postings Receives the postings, highest impact first.
+         * @param trace The trace the fetch and decode times are added to.
+         */
+        void fetchPostings(const std::string& term, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings, QueryTrace& trace);
+
+        /**
+         * @brief Reads a term's postings from the snapshot, or starts fetching them on the fetch pool.
+         * 
+         * @param term The term.
+         * @return PendingFetch The started fetch.
+         */
+        PendingFetch startFetch(const std::string& term);
+
+        /**
+         * @brief Waits for a started fetch until the deadline and takes its postings.
+         * 
+         * @param fetch The started fetch.
+         * @param stats The corpus statistics, used to quantize terms without stored impacts.
+         * @param postings Receives the postings, highest impact first.
+         * @param trace The trace the fetch and decode times are added to.
+         * @throws std::runtime_error If the deadline passes first; the exception of the fetch if it failed.
+         */
+        void awaitPostings(PendingFetch& fetch, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings, QueryTrace& trace);
+
+        /**
+         * @brief Drops the outdated postings of a term and adds its recent postings from the delta.
+         * 
+         * @param term The term.
+         * @param stats The corpus statistics the recent postings are quantized with.
+         * @param postings The persisted postings, highest impact first; receives the merged postings.
+         * @return The number of recent postings added.
+         */
+        std::size_t mergeDelta(const std::string& term, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings) const;
+
+        /**
+         * @brief Replaces an unknown term with the dictionary terms within its edit distance.
+         * 
+         * @param term The unknown term.
+         * @param stats The corpus statistics.
+         * @param postings Receives the merged postings of the expansions, highest impact first.
+         * @param trace The trace the fetch and decode times are added to.
+         * @return The number of expansions that contributed postings.
+         */
+        std::size_t expandTerm(const std::string& term, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings, QueryTrace& trace);
+
+        /**
+         * @brief Splits the query string into segments based on a delimiter.
+         * 
+         * @param str The query string to be split.
+         * @param segments The vector to store the split segments.
+         * @param delimiter The character used to split the string.
          */
-        static bool cmp(const std::pair<std::string, DocumentScores>& a, const std::pair<std::string, DocumentScores>& b);
+        static void splitQuery(const std::string& str, std::vector<std::string>& segments, char delimiter);
     };
 
 }
@@ -0,0 +1,167 @@
+#ifndef SINGLEFLIGHT_HPP
+#define SINGLEFLIGHT_HPP
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+namespace searcher {
+
+    /**
+     * @struct SingleFlightStats
+     * @brief Snapshot of the coalescing counters of a SingleFlight group.
+     */
+    struct SingleFlightStats {
+        std::uint64_t leaders = 0;     ///< Evaluations actually executed.
+        std::uint64_t followers = 0;   ///< Requests that attached to an in-flight evaluation and shared its result.
+        std::uint64_t timeouts = 0;    ///< Followers that gave up waiting and evaluated on their own.
+        std::uint64_t abandoned = 0;   ///< Followers that gave up waiting with too little time left to evaluate.
+        std::size_t inFlight = 0;      ///< Evaluations currently running.
+    };
+
+    /**
+     * @class SingleFlight
+     * @brief Coalesces concurrent evaluations of the same key into a single execution.
+     *
+     * The first caller for a key (the leader) runs the evaluation; callers arriving while it
+     * is still running (followers) wait for the leader's result instead of evaluating again.
+     * Followers wait at most maxWait and then fall back to evaluating on their own, so a stuck
+     * leader cannot hold every request hostage. A follower that is left with less than
+     * minFallback of its own wait does not evaluate, but returns the result of its giveUp
+     * function: with its deadline nearly spent, it could only add load while the leader is
+     * already slow. Exceptions thrown by the leader are rethrown in every follower.
+     *
+     * @tparam Result The type of the shared result. It is handed out as a copy.
+     */
+    template <typename Result>
+    class SingleFlight {
+    public:
+        /**
+         * @brief Constructs a SingleFlight group.
+         *
+         * @param maxWait Maximum time a follower waits for the leader.
+         * @param minFallback Least time a follower must have left after its wait to evaluate on its own.
+         */
+        explicit SingleFlight(std::chrono::milliseconds maxWait, std::chrono::milliseconds minFallback = std::chrono::milliseconds(0))
+            : maxWait(maxWait), minFallback(minFallback) {}
+
+        /**
+         * @brief Runs evaluate for key, or shares the result of an identical in-flight evaluation.
+         *
+         * @param key The normalized key identifying the evaluation.
+         * @param evaluate The function producing the result.
+         * @return Result The (possibly shared) result.
+         */
+        Result execute(const std::string& key, const std::function<Result()>& evaluate) {
+            return execute(key, evaluate, this->maxWait);
+        }
+
+        /**
+         * @brief Runs evaluate for key with a per-call bound on the follower wait.
+         *
+         * @param key The normalized key identifying the evaluation.
+         * @param evaluate The function producing the result.
+         * @param wait Maximum time to wait for an in-flight evaluation, capped at the group's maxWait.
+         * @return Result The (possibly shared) result.
+         */
+        Result execute(const std::string& key, const std::function<Result()>& evaluate, std::chrono::milliseconds wait) {
+            return execute(key, evaluate, wait, std::function<Result()>());
+        }
+
+        /**
+         * @brief Runs evaluate for key with a per-call wait, giving up instead of evaluating late.
+         *
+         * @param key The normalized key identifying the evaluation.
+         * @param evaluate The function producing the result.
+         * @param wait The caller's remaining time; it waits at most this long, capped at the group's maxWait.
+         * @param giveUp Produces the result of a follower left with less than minFallback of wait; empty to always evaluate.
+         * @return Result The (possibly shared) result.
+         */
+        Result execute(const std::string& key, const std::function<Result()>& evaluate, std::chrono::milliseconds wait, const std::function<Result()>& giveUp) {
+            std::shared_ptr<std::promise<Result>> promise;
+            std::shared_future<Result> future;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                auto it = this->flights.find(key);
+                if (it != this->flights.end()) {
+                    future = it->second;
+                } else {
+                    promise = std::make_shared<std::promise<Result>>();
+                    future = promise->get_future().share();
+                    this->flights.emplace(key, future);
+                }
+            }
+
+            // Follower: attach to the leader with a bounded wait
+            if (!promise) {
+                auto started = std::chrono::steady_clock::now();
+                if (future.wait_for(std::min(wait, this->maxWait)) == std::future_status::ready) {
+                    this->followers++;
+                    return future.get();
+                }
+                auto left = wait - std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+                if (giveUp && left < this->minFallback) {
+                    this->abandoned++;
+                    return giveUp();
+                }
+                this->timeouts++;
+                return evaluate();
+            }
+
+            // Leader: evaluate and publish the result (or the failure) to all followers
+            this->leaders++;
+            try {
+                Result result = evaluate();
+                promise->set_value(result);
+                this->finish(key);
+                return result;
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+                this->finish(key);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Returns a snapshot of the coalescing counters.
+         *
+         * @return SingleFlightStats The current counters.
+         */
+        SingleFlightStats stats() {
+            SingleFlightStats s;
+            s.leaders = this->leaders.load();
+            s.followers = this->followers.load();
+            s.timeouts = this->timeouts.load();
+            s.abandoned = this->abandoned.load();
+            std::lock_guard<std::mutex> lock(this->mutex);
+            s.inFlight = this->flights.size();
+            return s;
+        }
+
+    private:
+        std::chrono::milliseconds maxWait;                                   ///< Maximum follower wait.
+        std::chrono::milliseconds minFallback;                               ///< Least time left for a follower to evaluate.
+        std::mutex mutex;                                                    ///< Guards the flights map.
+        std::unordered_map<std::string, std::shared_future<Result>> flights; ///< In-flight evaluations by key.
+        std::atomic<std::uint64_t> leaders{0};                               ///< Executed evaluations.
+        std::atomic<std::uint64_t> followers{0};                             ///< Shared results.
+        std::atomic<std::uint64_t> timeouts{0};                              ///< Followers that stopped waiting.
+        std::atomic<std::uint64_t> abandoned{0};                             ///< Followers that stopped waiting without evaluating.
+
+        // Removes a finished flight so that later requests start a fresh evaluation
+        void finish(const std::string& key) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->flights.erase(key);
+        }
+    };
+
+}
+
+#endif
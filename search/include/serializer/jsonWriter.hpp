@@ -0,0 +1,98 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace serializer {
+
+    /**
+     * @class JsonWriter
+     * @brief A streaming JSON writer that appends directly into a single output buffer.
+     *
+     * Unlike jetpp::JsonValue, no intermediate DOM is built: every call appends its tokens
+     * to the buffer immediately and commas are inserted automatically. String escaping scans
+     * 16 bytes at a time with SSE2/NEON where available, so clean runs are copied with a
+     * single append. The finished buffer can be moved out and handed to jetpp::Response::send.
+     */
+    class JsonWriter {
+    public:
+        /**
+         * @brief Constructs a writer with an empty buffer.
+         *
+         * @param reserve Number of bytes to reserve up front (0 for none).
+         */
+        explicit JsonWriter(std::size_t reserve = 0);
+
+        /**
+         * @brief Constructs a writer that reuses an existing (pre-sized) buffer.
+         *
+         * The buffer is cleared but keeps its capacity.
+         *
+         * @param buffer The buffer to write into.
+         */
+        explicit JsonWriter(std::string&& buffer);
+
+        JsonWriter& beginObject();
+        JsonWriter& endObject();
+        JsonWriter& beginArray();
+        JsonWriter& endArray();
+
+        /**
+         * @brief Writes an object key. Must be followed by exactly one value.
+         *
+         * @param name The key name.
+         */
+        JsonWriter& key(std::string_view name);
+
+        JsonWriter& value(std::string_view str);
+        JsonWriter& value(const char* str);
+        JsonWriter& value(double number);
+        JsonWriter& value(std::int64_t number);
+        JsonWriter& value(int number);
+        JsonWriter& value(bool boolean);
+        JsonWriter& null();
+
+        /**
+         * @brief Appends an already serialized JSON fragment as a value.
+         *
+         * @param json The raw JSON text, written as is.
+         */
+        JsonWriter& raw(std::string_view json);
+
+        /**
+         * @brief Gives read access to the serialized output.
+         *
+         * @return The buffer written so far.
+         */
+        const std::string& str() const;
+
+        /**
+         * @brief Moves the serialized output out of the writer.
+         *
+         * @return The buffer; the writer is empty afterwards.
+         */
+        std::string release();
+
+    private:
+        std::string buffer; ///< Output buffer.
+        bool needComma;     ///< Whether the next value or key must be preceded by a comma.
+
+        /**
+         * @brief Writes a comma if a previous sibling exists.
+         */
+        void separate();
+
+        /**
+         * @brief Appends a quoted, escaped JSON string.
+         *
+         * @param str The raw string.
+         */
+        void writeString(std::string_view str);
+    };
+
+}
+
+#endif
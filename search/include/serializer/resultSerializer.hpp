@@ -0,0 +1,69 @@
+#ifndef RESULTSERIALIZER_HPP
+#define RESULTSERIALIZER_HPP
+
+#include <string>
+#include <vector>
+#include <searcher/searcher.hpp>
+#include <searcher/queryTrace.hpp>
+#include <serializer/jsonWriter.hpp>
+#include <suggest/completionIndex.hpp>
+
+namespace serializer {
+
+    /**
+     * @brief Serializes ranked search results straight into a JSON buffer.
+     * 
+     * Without details the output is the plain array of URLs the /search route has always returned.
+     * With details every entry becomes an object holding the URL and its score.
+     * 
+     * @param results The ranked search results.
+     * @param details Whether to emit result objects instead of bare URLs.
+     * @return std::string The serialized JSON array, sized in a single allocation.
+     */
+    std::string serializeResults(const std::vector<searcher::SearchResult>& results, bool details);
+
+    /**
+     * @brief Writes a query trace as a JSON object, with stage times in milliseconds.
+     * 
+     * @param writer The writer receiving the object.
+     * @param trace The trace of a search request.
+     */
+    void writeTrace(JsonWriter& writer, const searcher::QueryTrace& trace);
+
+    /**
+     * @brief Wraps serialized results and their trace into a single response body.
+     * 
+     * @param results The serialized results, as returned by serializeResults.
+     * @param trace The trace of the search request.
+     * @return std::string The JSON object {"results": ..., "trace": {...}}.
+     */
+    std::string serializeTraced(const std::string& results, const searcher::QueryTrace& trace);
+
+    /**
+     * @brief Serializes the posting counts of a shard, the first phase of a sharded search.
+     * 
+     * @param counts The posting count of every query term.
+     * @return std::string The JSON object {"terms": [{"term": ..., "postings": ...}, ...]}.
+     */
+    std::string serializeTermCounts(const std::vector<searcher::TermTrace>& counts);
+
+    /**
+     * @brief Serializes the top-k of a shard, the second phase of a sharded search.
+     * 
+     * @param response The search response of the shard.
+     * @return std::string The JSON object {"partial": ..., "documentsScored": ..., "results": [{"url": ..., "score": ...}, ...]}.
+     */
+    std::string serializeShardResponse(const searcher::SearchResponse& response);
+
+    /**
+     * @brief Serializes the completions of a prefix.
+     * 
+     * @param prefix The completed prefix.
+     * @param suggestions The suggestions, heaviest first.
+     * @return std::string The JSON object {"prefix": ..., "suggestions": [{"term": ..., "weight": ...}, ...]}.
+     */
+    std::string serializeSuggestions(const std::string& prefix, const std::vector<suggest::Suggestion>& suggestions);
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SHARDCLIENT_HPP
+#define SHARDCLIENT_HPP
+
+#include <chrono>
+#include <string>
+
+namespace shard {
+
+    /**
+     * @struct Endpoint
+     * @brief Address of a shard searcher.
+     */
+    struct Endpoint {
+        std::string host = "127.0.0.1";   ///< IPv4 address or host name.
+        int port = 0;                     ///< TCP port.
+
+        /**
+         * @brief Parses "host:port".
+         *
+         * @param address The address string.
+         * @return Endpoint The parsed endpoint.
+         * @throws std::invalid_argument If the port is missing or invalid.
+         */
+        static Endpoint parse(const std::string& address);
+    };
+
+    /**
+     * @struct Reply
+     * @brief Response of a shard searcher.
+     */
+    struct Reply {
+        int status = 0;         ///< HTTP status code, 0 if the exchange failed.
+        std::string body;       ///< Response body.
+        std::string error;      ///< Transport error, empty on success.
+    };
+
+    /**
+     * @brief Sends a POST request to a shard on a fresh connection and reads the response until the shard closes it.
+     *
+     * The remaining time is forwarded as X-Deadline-Ms, so the shard stops at the same deadline.
+     *
+     * @param endpoint The shard address.
+     * @param target The request target including the query string.
+     * @param timeout Socket timeout and deadline of the request.
+     * @return Reply The response.
+     */
+    Reply post(const Endpoint& endpoint, const std::string& target, std::chrono::milliseconds timeout);
+
+}
+
+#endif
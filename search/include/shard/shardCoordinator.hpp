@@ -0,0 +1,134 @@
+#ifndef SHARDCOORDINATOR_HPP
+#define SHARDCOORDINATOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <searcher/deadline.hpp>
+#include <searcher/queryTrace.hpp>
+#include <searcher/searcher.hpp>
+#include <ranking/reranker.hpp>
+#include <shard/shardClient.hpp>
+#include <suggest/completionIndex.hpp>
+#include <threadpool/threadPool.hpp>
+
+namespace shard {
+
+    /// Suggestions requested from every shard per suggestion returned, so that terms heavy in sum are rarely missed.
+    const std::size_t SUGGEST_OVERFETCH = 4;
+
+    /// Suggestions a shard returns at most.
+    const std::size_t MAX_SHARD_SUGGESTIONS = 100;
+
+    /**
+     * @struct CoordinatorStats
+     * @brief Counters of a ShardCoordinator.
+     */
+    struct CoordinatorStats {
+        std::size_t shards = 0;             ///< Configured shards.
+        std::uint64_t queries = 0;          ///< Queries fanned out.
+        std::uint64_t shardFailures = 0;    ///< Shard requests that failed or timed out.
+    };
+
+    /**
+     * @class ShardCoordinator
+     * @brief Scatter-gather search over shard searchers, each serving a hash partition of the documents.
+     *
+     * A query runs in two phases. First every shard reports the posting count of each query
+     * term; the sums are the document frequencies of the whole corpus. Then every shard
+     * evaluates the query with those frequencies, so the scores of all shards use the same
+     * IDF, and returns its top-k. The coordinator merges the top-k lists. A shard that fails
+     * or misses the deadline is left out and the response is flagged as partial.
+     */
+    class ShardCoordinator {
+    public:
+        /**
+         * @brief Constructor for the ShardCoordinator class.
+         *
+         * @param shards The shard searchers, in shard order.
+         * @param pool The pool the shard requests are sent from, reserved for blocking I/O; the calling thread takes part.
+         */
+        ShardCoordinator(std::vector<Endpoint> shards, threadpool::ThreadPool& pool);
+
+        /**
+         * @brief Searches all shards and merges their results.
+         *
+         * @param query The normalized search query string.
+         * @param deadline The deadline of the search request, forwarded to the shards.
+         * @param fuzzy Whether the shards expand terms unknown to all of them to similar terms.
+         * @param ranking How the shards rank their results; every shard re-ranks its own candidates.
+         * @return searcher::SearchResponse The merged top-k, flagged as partial if a shard is missing.
+         * @throws std::runtime_error If no shard answered.
+         */
+        searcher::SearchResponse search(const std::string& query, const searcher::Deadline& deadline, bool fuzzy = true, const ranking::RankingOptions& ranking = ranking::RankingOptions());
+
+        /**
+         * @brief Completes a prefix on all shards and merges the suggestions.
+         *
+         * Every shard weights its terms by its own document frequency; the weights of a term
+         * are added up across shards. Every shard is asked for SUGGEST_OVERFETCH times the
+         * limit, so the result is approximate: a term outside the top suggestions of every
+         * shard is still missed, and the weight of a term is too low where a shard did not
+         * return it.
+         *
+         * @param prefix The prefix.
+         * @param limit The maximum number of suggestions.
+         * @param deadline The deadline of the request, forwarded to the shards.
+         * @return std::vector<suggest::Suggestion> The suggestions, heaviest first.
+         * @throws std::runtime_error If no shard answered.
+         */
+        std::vector<suggest::Suggestion> suggest(const std::string& prefix, std::size_t limit, const searcher::Deadline& deadline);
+
+        /**
+         * @brief Returns the counters.
+         *
+         * @return CoordinatorStats The current counters.
+         */
+        CoordinatorStats stats() const;
+
+        /**
+         * @brief Parses the posting counts returned by a shard.
+         *
+         * @param body The response body of /shard/terms.
+         * @param counts Receives the count of every term, in query order.
+         * @return True if the body was well-formed.
+         */
+        static bool parseTermCounts(const std::string& body, std::vector<searcher::TermTrace>& counts);
+
+        /**
+         * @brief Parses the top-k returned by a shard.
+         *
+         * @param body The response body of /shard/search.
+         * @param response Receives the results, the partial flag and the scored postings.
+         * @return True if the body was well-formed.
+         */
+        static bool parseShardResponse(const std::string& body, searcher::SearchResponse& response);
+
+        /**
+         * @brief Parses the suggestions returned by a shard.
+         *
+         * @param body The response body of /shard/suggest.
+         * @param suggestions Receives the suggestions.
+         * @return True if the body was well-formed.
+         */
+        static bool parseSuggestions(const std::string& body, std::vector<suggest::Suggestion>& suggestions);
+
+    private:
+        std::vector<Endpoint> shards;                   ///< The shard searchers.
+        threadpool::ThreadPool& pool;                   ///< I/O pool the shard requests run on.
+        std::atomic<std::uint64_t> queries{0};          ///< Queries fanned out.
+        std::atomic<std::uint64_t> shardFailures{0};    ///< Failed shard requests.
+
+        /**
+         * @brief Returns the time the shards get for a request.
+         *
+         * @param deadline The deadline of the search request.
+         * @return std::chrono::milliseconds The remaining time, capped for unbounded deadlines.
+         */
+        static std::chrono::milliseconds shardTimeout(const searcher::Deadline& deadline);
+    };
+
+}
+
+#endif
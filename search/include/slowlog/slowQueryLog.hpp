@@ -0,0 +1,114 @@
+#ifndef SLOWQUERYLOG_HPP
+#define SLOWQUERYLOG_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace slowlog {
+
+    /**
+     * @struct SlowQueryLogOptions
+     * @brief Threshold, file location and rotation limits of a slow-query log.
+     */
+    struct SlowQueryLogOptions {
+        std::string path = "slow_queries.log";          ///< File the entries are appended to.
+        std::chrono::milliseconds threshold{100};       ///< Requests at least this slow are logged.
+        std::size_t maxFileBytes = 64 * 1024 * 1024;    ///< Size at which the file is rotated.
+        std::size_t maxFiles = 5;                       ///< Rotated files kept (path.1 ... path.N).
+        std::size_t maxPending = 1024;                  ///< Entries buffered for the writer before new ones are dropped.
+    };
+
+    /**
+     * @struct SlowQueryLogStats
+     * @brief Snapshot of the counters of a SlowQueryLog.
+     */
+    struct SlowQueryLogStats {
+        std::uint64_t written = 0;  ///< Entries written to the file.
+        std::uint64_t dropped = 0;  ///< Entries dropped because the writer fell behind.
+        std::uint64_t rotations = 0; ///< Times the file was rotated.
+    };
+
+    /**
+     * @class SlowQueryLog
+     * @brief Appends one JSON line per slow request to a size-rotated file.
+     *
+     * Request threads only format the entry and hand it to a background writer; they never
+     * touch the file. If the writer falls more than maxPending entries behind, new entries
+     * are dropped (and counted) rather than blocking the request path.
+     */
+    class SlowQueryLog {
+    public:
+        /**
+         * @brief Constructor for the SlowQueryLog class; opens the file and starts the writer.
+         *
+         * @param options The threshold, file location and rotation limits.
+         */
+        explicit SlowQueryLog(const SlowQueryLogOptions& options);
+
+        /**
+         * @brief Destructor; writes the pending entries and stops the writer.
+         */
+        ~SlowQueryLog();
+
+        SlowQueryLog(const SlowQueryLog&) = delete;
+        SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+        /**
+         * @brief Checks whether a request took long enough to be logged.
+         *
+         * @param elapsed The total time of the request.
+         * @return True if elapsed is at or above the threshold.
+         */
+        bool slow(std::chrono::nanoseconds elapsed) const;
+
+        /**
+         * @brief Queues an entry for the writer.
+         *
+         * @param line The entry, a single line of JSON without the trailing newline.
+         * @return True if the entry was queued, false if it was dropped.
+         */
+        bool record(std::string line);
+
+        /**
+         * @brief Returns a snapshot of the counters.
+         *
+         * @return SlowQueryLogStats The current counters.
+         */
+        SlowQueryLogStats stats();
+
+    private:
+        SlowQueryLogOptions options;            ///< Threshold, file location and rotation limits.
+        std::ofstream out;                      ///< The current log file.
+        std::size_t fileBytes = 0;              ///< Bytes in the current log file.
+        std::mutex mutex;                       ///< Guards pending, stopping and the counters.
+        std::condition_variable wake;           ///< Signals new entries or shutdown to the writer.
+        std::deque<std::string> pending;        ///< Entries waiting for the writer.
+        bool stopping = false;                  ///< Set by the destructor.
+        SlowQueryLogStats counters;             ///< Written, dropped and rotation counters.
+        std::thread writer;                     ///< Background writer thread.
+
+        /**
+         * @brief Writer loop: drains the pending entries into the file in batches.
+         */
+        void run();
+
+        /**
+         * @brief Opens the log file for appending and picks up its current size.
+         */
+        void open();
+
+        /**
+         * @brief Shifts path.(N-1) to path.N, ..., path to path.1 and starts a fresh file.
+         */
+        void rotate();
+    };
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef LIVESNAPSHOT_HPP
+#define LIVESNAPSHOT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <impact/impact.hpp>
+#include <snapshot/snapshot.hpp>
+
+namespace snapshot {
+
+    /**
+     * @struct SnapshotInfo
+     * @brief State of a LiveSnapshot, for /stats.
+     */
+    struct SnapshotInfo {
+        std::string path;                   ///< Path of the snapshot file.
+        std::int64_t createdMs = 0;         ///< When the export started.
+        std::uint32_t shard = 0;            ///< Shard the snapshot was exported from.
+        std::uint32_t shards = 1;           ///< Number of shards of the exported index.
+        std::int64_t statsVersion = 0;      ///< Corpus statistics version of the snapshot.
+        std::uint64_t terms = 0;            ///< Terms in the snapshot.
+        std::uint64_t documents = 0;        ///< Documents in the snapshot.
+        std::uint64_t postings = 0;         ///< Postings in the snapshot.
+        std::size_t staleTerms = 0;         ///< Terms updated since the export, read from the database.
+        bool outdated = false;              ///< Whether the corpus statistics changed, so nothing is read from the snapshot.
+        std::int64_t lastPollMs = 0;        ///< When the last successful poll finished (0 before the first).
+        std::uint64_t hits = 0;             ///< Term lookups answered by the snapshot.
+        std::uint64_t misses = 0;           ///< Term lookups left to the database.
+    };
+
+    /**
+     * @class LiveSnapshot
+     * @brief A loaded snapshot kept consistent with the database by polling for updates.
+     *
+     * The snapshot serves as soon as it is mapped. A background thread asks the database
+     * for the terms written since the export and marks them stale; lookups of stale terms
+     * fail, so the searcher reads them from the database. Once the corpus statistics move
+     * to a new version, every stored impact is recomputed and the whole snapshot is
+     * bypassed until a newer one is loaded at the next restart.
+     */
+    class LiveSnapshot {
+    public:
+        /**
+         * @brief Constructor for the LiveSnapshot class; maps the snapshot and starts polling.
+         *
+         * @param path The path of the snapshot file.
+         * @param pollInterval The time between two polls for updated terms.
+         * @throws std::runtime_error If the snapshot cannot be opened.
+         */
+        LiveSnapshot(const std::string& path, std::chrono::milliseconds pollInterval);
+
+        /**
+         * @brief Destructor; stops the poller.
+         */
+        ~LiveSnapshot();
+
+        LiveSnapshot(const LiveSnapshot&) = delete;
+        LiveSnapshot& operator=(const LiveSnapshot&) = delete;
+
+        /**
+         * @brief Gets the corpus statistics of the snapshot, unless the database has moved to newer ones.
+         *
+         * @param stats Receives the statistics.
+         * @return True if the snapshot is current and its statistics were returned.
+         */
+        bool stats(impact::CorpusStats& stats) const;
+
+        /**
+         * @brief Gets the impact-ordered postings of a term, unless it changed since the export.
+         *
+         * @param term The term.
+         * @param postings Receives the postings, highest impact first.
+         * @return True if the snapshot answered; false if the term has to be read from the database.
+         */
+        bool postings(const std::string& term, std::vector<impact::ImpactPosting>& postings);
+
+        /**
+         * @brief Marks a term as changed since the export, ahead of the next poll.
+         *
+         * @param term The term.
+         */
+        void invalidate(const std::string& term);
+
+        /**
+         * @brief Bypasses the whole snapshot if the corpus statistics moved to another version, ahead of the next poll.
+         *
+         * @param version The current version of the corpus statistics.
+         */
+        void statsChanged(std::int64_t version);
+
+        /**
+         * @brief Returns the state of the snapshot.
+         *
+         * @return SnapshotInfo The current state.
+         */
+        SnapshotInfo info() const;
+
+    private:
+        std::string path;                               ///< Path of the snapshot file.
+        std::unique_ptr<Snapshot> snapshot;             ///< The mapped snapshot.
+        std::chrono::milliseconds pollInterval;         ///< Time between polls.
+        mutable std::shared_mutex staleMutex;           ///< Guards stale.
+        std::unordered_set<std::string> stale;          ///< Terms updated since the export.
+        std::atomic<bool> outdated{false};              ///< Set once the corpus statistics changed.
+        std::atomic<std::int64_t> lastPollMs{0};        ///< When the last successful poll finished.
+        std::atomic<std::uint64_t> hits{0};             ///< Lookups answered.
+        std::atomic<std::uint64_t> misses{0};           ///< Lookups left to the database.
+        std::int64_t sinceMs = 0;                       ///< Poll position, only used by the poller.
+        std::mutex stopMutex;                           ///< Guards stopping.
+        std::condition_variable stopSignal;             ///< Wakes the poller for shutdown.
+        bool stopping = false;                          ///< Set by the destructor.
+        std::thread poller;                             ///< The polling thread.
+
+        /**
+         * @brief Poller loop.
+         */
+        void run();
+
+        /**
+         * @brief Fetches the updated terms and the corpus statistics once.
+         */
+        void poll();
+    };
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <impact/impact.hpp>
+#include <snapshot/snapshotFormat.hpp>
+#include <snapshot/urlTable.hpp>
+
+namespace snapshot {
+
+    /**
+     * @class Snapshot
+     * @brief A read-only, memory-mapped index snapshot written by the indexer.
+     *
+     * Opening validates the header, the section bounds and the checksum once; afterwards
+     * lookups read the mapping directly, so the pages are loaded on first use and shared
+     * with the page cache instead of being parsed into heap structures.
+     */
+    class Snapshot {
+    public:
+        /**
+         * @brief Maps and validates a snapshot file.
+         *
+         * @param path The path of the snapshot.
+         * @return std::unique_ptr<Snapshot> The opened snapshot.
+         * @throws std::runtime_error If the file cannot be mapped or is not a valid snapshot.
+         */
+        static std::unique_ptr<Snapshot> open(const std::string& path);
+
+        /**
+         * @brief Destructor; unmaps the file.
+         */
+        ~Snapshot();
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        /**
+         * @brief Returns the header of the snapshot.
+         *
+         * @return const SnapshotHeader& The header.
+         */
+        const SnapshotHeader& header() const;
+
+        /**
+         * @brief Returns the corpus statistics the impacts of the snapshot were computed with.
+         *
+         * @return impact::CorpusStats The statistics.
+         */
+        impact::CorpusStats stats() const;
+
+        /**
+         * @brief Looks up the impact-ordered postings of a term.
+         *
+         * @param term The term.
+         * @param postings Receives the postings, highest impact first; empty for an unknown term.
+         * @return True if the term is in the snapshot.
+         */
+        bool find(const std::string& term, std::vector<impact::ImpactPosting>& postings) const;
+
+        /**
+         * @brief Returns the URL of a document id.
+         *
+         * @param id The document id, below header().documentCount.
+         * @return std::string The URL, decoded from the document table.
+         */
+        std::string url(std::uint32_t id) const;
+
+    private:
+        const unsigned char* data = nullptr;    ///< Start of the mapping.
+        std::size_t size = 0;                   ///< Size of the mapping.
+        const SnapshotHeader* head = nullptr;   ///< The header.
+        const TermEntry* terms = nullptr;       ///< The term dictionary.
+        const char* termNames = nullptr;        ///< Term bytes, indexed by TermEntry::nameOffset.
+        UrlTable documents;                     ///< The front-coded document table.
+
+        Snapshot() = default;
+
+        /**
+         * @brief Returns the name of a dictionary entry.
+         *
+         * @param entry The entry.
+         * @return std::string_view The term, viewing the mapping.
+         */
+        std::string_view name(const TermEntry& entry) const;
+
+        /**
+         * @brief Checks the header, the section bounds and the checksum.
+         *
+         * @param path The path of the snapshot, for error messages.
+         * @throws std::runtime_error If the snapshot is invalid.
+         */
+        void validate(const std::string& path);
+    };
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef URLTABLE_HPP
+#define URLTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <snapshot/snapshotFormat.hpp>
+
+namespace snapshot {
+
+    /// Largest block size a reader accepts.
+    const std::uint32_t MAX_URL_BLOCK_SIZE = 64;
+
+    /**
+     * @class UrlTable
+     * @brief The front-coded document table of a snapshot, read in place from the mapping.
+     *
+     * A URL is found through the rank of its document id: the block holding that rank is
+     * scanned from its head up to the URL, at most URL_BLOCK_SIZE - 1 pairs of lengths, and
+     * the URL is assembled from the suffixes it is made of.
+     */
+    class UrlTable {
+    public:
+        UrlTable() = default;
+
+        /**
+         * @brief Views and validates the table.
+         *
+         * Every block is decoded once, so lookups afterwards need no bounds checks.
+         *
+         * @param section Start of the document table in the mapping, 8 byte aligned.
+         * @param size Size of the section.
+         * @param count Number of documents.
+         * @return True if the table is well-formed.
+         */
+        bool open(const unsigned char* section, std::uint64_t size, std::uint64_t count);
+
+        /**
+         * @brief Returns the number of documents.
+         *
+         * @return std::uint64_t The number of document ids.
+         */
+        std::uint64_t size() const { return this->count; }
+
+        /**
+         * @brief Decodes the URL of a document id.
+         *
+         * @param id The document id, below size().
+         * @param url Receives the URL.
+         */
+        void url(std::uint32_t id, std::string& url) const;
+
+        /**
+         * @brief Decodes the URLs of many document ids.
+         *
+         * @param ids The document ids, each below size().
+         * @param count The number of ids.
+         * @param urls Receives the URL of every id, in the order of the ids.
+         */
+        void urls(const std::uint32_t* ids, std::size_t count, std::vector<std::string>& urls) const;
+
+    private:
+        const UrlTableHeader* head = nullptr;       ///< The table header.
+        const std::uint32_t* positions = nullptr;   ///< Rank of every document id.
+        const std::uint64_t* blockOffsets = nullptr; ///< Block offsets into blocks.
+        const std::uint64_t* hostOffsets = nullptr; ///< Host offsets into hostBytes; null without a host dictionary.
+        const char* hostBytes = nullptr;            ///< Host names.
+        const unsigned char* blocks = nullptr;      ///< Block data.
+        std::uint64_t count = 0;                    ///< Number of documents.
+    };
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef COMPLETIONINDEX_HPP
+#define COMPLETIONINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace suggest {
+
+    /// Terms per front-coded block; the first term of a block is stored in full.
+    const std::size_t BLOCK_SIZE = 16;
+
+    /**
+     * @struct Suggestion
+     * @brief A completion of a prefix.
+     */
+    struct Suggestion {
+        std::string term;       ///< The completed term.
+        std::uint32_t weight;   ///< Its weight, the document frequency.
+    };
+
+    /**
+     * @class CompletionIndex
+     * @brief Immutable, compact index returning the heaviest terms with a given prefix.
+     *
+     * The terms are sorted and front-coded in blocks of BLOCK_SIZE: every term after the
+     * first of a block stores only the length of the prefix it shares with its predecessor
+     * and the remaining bytes. A prefix maps to a contiguous range of terms, found by binary
+     * search over the block heads. A max-tree over the block weights then yields the top-k
+     * of the range best-first, touching O(k log n) nodes and decoding only the blocks that
+     * hold results.
+     */
+    class CompletionIndex {
+    public:
+        /**
+         * @class Builder
+         * @brief Builds a CompletionIndex from terms in ascending order.
+         */
+        class Builder {
+        public:
+            Builder();
+
+            /**
+             * @brief Appends a term.
+             *
+             * @param term The term; terms have to be added in strictly ascending order.
+             * @param weight The weight of the term.
+             * @throws std::invalid_argument If the term is not greater than the previous one.
+             */
+            void add(std::string_view term, std::uint32_t weight);
+
+            /**
+             * @brief Completes the index.
+             *
+             * @return std::shared_ptr<const CompletionIndex> The index; the builder is empty afterwards.
+             */
+            std::shared_ptr<const CompletionIndex> finish();
+
+        private:
+            std::unique_ptr<CompletionIndex> index;     ///< The index being built.
+            std::string previous;                       ///< The last term added.
+        };
+
+        /**
+         * @brief Returns the heaviest terms starting with a prefix.
+         *
+         * @param prefix The prefix; empty matches every term.
+         * @param limit The maximum number of suggestions.
+         * @return std::vector<Suggestion> The suggestions by weight, heaviest first, ties in term order.
+         */
+        std::vector<Suggestion> complete(std::string_view prefix, std::size_t limit) const;
+
+        /**
+         * @brief Returns the number of terms.
+         *
+         * @return std::size_t The number of terms.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Returns the memory footprint.
+         *
+         * @return std::size_t The size of the arrays in bytes.
+         */
+        std::size_t bytes() const;
+
+    private:
+        std::string data;                       ///< Front-coded blocks.
+        std::vector<std::uint64_t> blockOffsets; ///< Start of every block in data.
+        std::vector<std::uint32_t> weights;     ///< Weight of every term.
+        std::vector<std::uint32_t> tree;        ///< Max-tree over the block weights; leaves start at index leaves.
+        std::size_t leaves = 1;                 ///< Number of leaves of the tree, a power of two.
+
+        CompletionIndex() = default;
+
+        /**
+         * @brief Returns the first term of a block.
+         *
+         * @param block The block.
+         * @return std::string_view The term, viewing data.
+         */
+        std::string_view head(std::size_t block) const;
+
+        /**
+         * @brief Decodes the terms of a block.
+         *
+         * @param block The block.
+         * @param terms Receives the terms.
+         */
+        void decode(std::size_t block, std::vector<std::string>& terms) const;
+
+        /**
+         * @brief Returns the index of the first term not less than a key.
+         *
+         * @param key The key.
+         * @return std::size_t The index, size() if every term is less.
+         */
+        std::size_t lowerBound(std::string_view key) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SUGGESTER_HPP
+#define SUGGESTER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dictionary/termDictionary.hpp>
+#include <suggest/completionIndex.hpp>
+
+namespace suggest {
+
+    /**
+     * @struct SuggesterStats
+     * @brief Snapshot of the state and counters of a Suggester.
+     */
+    struct SuggesterStats {
+        std::size_t terms = 0;          ///< Terms of the current index.
+        std::size_t bytes = 0;          ///< Memory footprint of the current index.
+        std::uint64_t builds = 0;       ///< Indexes built.
+        std::uint64_t queries = 0;      ///< Completions served.
+        double lastBuildSeconds = 0;    ///< Duration of the last build.
+    };
+
+    /**
+     * @class Suggester
+     * @brief Prefix completion over the terms of a TermDictionary, weighted by document frequency.
+     *
+     * A background thread rebuilds the CompletionIndex whenever the dictionary has changed,
+     * at most once per rebuild interval, and swaps it in atomically; queries keep using the
+     * index they started with.
+     */
+    class Suggester {
+    public:
+        /**
+         * @brief Constructor for the Suggester class; starts the rebuild thread.
+         *
+         * @param dictionary The dictionary the terms come from; must outlive the Suggester.
+         * @param rebuildInterval The minimum time between two builds.
+         */
+        Suggester(const dictionary::TermDictionary& dictionary, std::chrono::milliseconds rebuildInterval);
+
+        /**
+         * @brief Destructor; stops the rebuild thread.
+         */
+        ~Suggester();
+
+        Suggester(const Suggester&) = delete;
+        Suggester& operator=(const Suggester&) = delete;
+
+        /**
+         * @brief Returns the heaviest terms starting with a prefix.
+         *
+         * @param prefix The prefix.
+         * @param limit The maximum number of suggestions.
+         * @return std::vector<Suggestion> The suggestions, heaviest first; empty until the first build.
+         */
+        std::vector<Suggestion> suggest(const std::string& prefix, std::size_t limit);
+
+        /**
+         * @brief Returns the state and counters.
+         *
+         * @return SuggesterStats The current state.
+         */
+        SuggesterStats stats() const;
+
+    private:
+        const dictionary::TermDictionary& dictionary;   ///< Source of the terms.
+        std::chrono::milliseconds rebuildInterval;      ///< Minimum time between builds.
+        std::shared_ptr<const CompletionIndex> index;   ///< Current index; accessed with std::atomic_load/std::atomic_store.
+        std::uint64_t builtVersion = 0;                 ///< Dictionary version of the current index, only used by the thread.
+        std::atomic<std::uint64_t> builds{0};           ///< Indexes built.
+        std::atomic<std::uint64_t> queries{0};          ///< Completions served.
+        std::atomic<std::int64_t> lastBuildMicros{0};   ///< Duration of the last build.
+        std::mutex stopMutex;                           ///< Guards stopping.
+        std::condition_variable stopSignal;             ///< Wakes the thread for shutdown.
+        bool stopping = false;                          ///< Set by the destructor.
+        std::thread builder;                            ///< The rebuild thread.
+
+        /**
+         * @brief Rebuild loop.
+         */
+        void run();
+
+        /**
+         * @brief Builds a new index if the dictionary has changed since the last build.
+         */
+        void rebuild();
+    };
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace threadpool {
+
+    /**
+     * @struct ThreadPoolStats
+     * @brief Snapshot of the counters of a ThreadPool.
+     */
+    struct ThreadPoolStats {
+        std::size_t workers = 0;        ///< Worker threads.
+        std::size_t queued = 0;         ///< Tasks waiting in the worker queues.
+        std::uint64_t executed = 0;     ///< Tasks run by the workers.
+        std::uint64_t stolen = 0;       ///< Tasks a worker took from another worker's queue.
+    };
+
+    /**
+     * @class ThreadPool
+     * @brief A fixed set of worker threads with per-worker queues and work stealing.
+     *
+     * Every worker pops from the back of its own queue (the most recently pushed, still
+     * cache-warm task) and, once that is empty, steals from the front of the other queues.
+     * Tasks submitted from outside the pool are spread over the queues round-robin; tasks
+     * submitted by a worker go to its own queue.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * @brief Constructor for the ThreadPool class; starts the workers.
+         *
+         * @param workers The number of worker threads (at least one).
+         */
+        explicit ThreadPool(std::size_t workers);
+
+        /**
+         * @brief Destructor; runs the queued tasks and joins the workers.
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Returns the number of worker threads.
+         *
+         * @return The number of workers.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Queues a task.
+         *
+         * @param task The task; it must not throw.
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * @brief Runs body(0) ... body(count - 1) on the pool and the calling thread, and waits for all of them.
+         *
+         * The calling thread claims indexes as well, so the call completes even when every worker
+         * is busy, and it never blocks a worker that calls it. The first exception thrown by
+         * body is rethrown once all indexes have finished.
+         *
+         * @param count The number of indexes.
+         * @param body The function run for every index.
+         */
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+        /**
+         * @brief Returns a snapshot of the counters.
+         *
+         * @return ThreadPoolStats The current counters.
+         */
+        ThreadPoolStats stats();
+
+    private:
+        /**
+         * @struct Queue
+         * @brief The task queue of one worker.
+         */
+        struct Queue {
+            std::mutex mutex;                           ///< Guards tasks.
+            std::deque<std::function<void()>> tasks;    ///< Queued tasks; the owner uses the back, thieves the front.
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;     ///< One queue per worker.
+        std::vector<std::thread> workers;               ///< The worker threads.
+        std::mutex sleepMutex;                          ///< Guards sleeping on wake.
+        std::condition_variable wake;                   ///< Signals queued tasks or shutdown.
+        std::atomic<std::size_t> pending{0};            ///< Tasks queued and not yet taken.
+        std::atomic<std::size_t> nextQueue{0};          ///< Round-robin position for external submissions.
+        std::atomic<std::uint64_t> executed{0};         ///< Tasks run.
+        std::atomic<std::uint64_t> stolen{0};           ///< Tasks stolen.
+        bool stopping = false;                          ///< Set by the destructor, guarded by sleepMutex.
+
+        /**
+         * @brief Worker loop.
+         *
+         * @param index The index of the worker and its queue.
+         */
+        void run(std::size_t index);
+
+        /**
+         * @brief Takes a task from the worker's own queue, or steals one from another queue.
+         *
+         * @param index The index of the worker.
+         * @param task Receives the task.
+         * @return True if a task was taken.
+         */
+        bool take(std::size_t index, std::function<void()>& task);
+    };
+
+}
+
+#endif
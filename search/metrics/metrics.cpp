@@ -0,0 +1,199 @@
+#include <metrics/metrics.hpp>
+#include <cstdio>
+#include <stdexcept>
+
+namespace metrics {
+
+    namespace {
+
+        // Bucket boundaries exported to Prometheus, in seconds; finer HDR buckets are folded into them
+        const double EXPORTED_BOUNDS[] = {
+            0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005,
+            0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+            0.1, 0.25, 0.5, 1, 2.5, 5, 10
+        };
+
+        std::string formatDouble(double value) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+            return buffer;
+        }
+
+        // Builds "name{labels}" or "name{labels,extra}", leaving out empty braces
+        std::string series(const std::string& name, const std::string& labels, const std::string& extra = "") {
+            std::string joined = labels;
+            if (!extra.empty()) {
+                joined += joined.empty() ? extra : "," + extra;
+            }
+            return joined.empty() ? name : name + "{" + joined + "}";
+        }
+    }
+
+    /**
+     * @brief Returns the stripe used by the calling thread.
+     * 
+     * @return std::size_t The stripe index in [0, STRIPES).
+     */
+    std::size_t threadStripe() {
+        static std::atomic<std::size_t> nextStripe{0};
+        thread_local std::size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return stripe;
+    }
+
+    std::uint64_t Counter::value() const {
+        std::uint64_t total = 0;
+        for (const Stripe& stripe : this->stripes) {
+            total += stripe.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Maps a value to its bucket.
+     * 
+     * Values below 8 get one bucket each; above that the bucket is given by the position of
+     * the highest set bit and the next SUB_BUCKET_BITS bits below it.
+     * 
+     * @param nanos The value in nanoseconds.
+     * @return int The bucket index.
+     */
+    int Histogram::bucketIndex(std::uint64_t nanos) {
+        const std::uint64_t subBuckets = 1u << SUB_BUCKET_BITS;
+        if (nanos < subBuckets) {
+            return static_cast<int>(nanos);
+        }
+        int exponent = 63 - __builtin_clzll(nanos);
+        int sub = static_cast<int>((nanos >> (exponent - SUB_BUCKET_BITS)) & (subBuckets - 1));
+        int index = (exponent - SUB_BUCKET_BITS + 1) * static_cast<int>(subBuckets) + sub;
+        return index < BUCKETS ? index : BUCKETS - 1;
+    }
+
+    /**
+     * @brief Returns the largest value that falls into a bucket.
+     * 
+     * @param index The bucket index.
+     * @return std::uint64_t The inclusive upper bound in nanoseconds.
+     */
+    std::uint64_t Histogram::bucketUpperBound(int index) {
+        const int subBuckets = 1 << SUB_BUCKET_BITS;
+        if (index < subBuckets) {
+            return static_cast<std::uint64_t>(index);
+        }
+        int exponent = index / subBuckets + SUB_BUCKET_BITS - 1;
+        std::uint64_t sub = static_cast<std::uint64_t>(index % subBuckets);
+        std::uint64_t width = 1ull << (exponent - SUB_BUCKET_BITS);
+        return ((subBuckets + sub) << (exponent - SUB_BUCKET_BITS)) + width - 1;
+    }
+
+    /**
+     * @brief Sums all stripes into a single bucket array.
+     * 
+     * The snapshot is not atomic across buckets, which is fine for monitoring purposes.
+     */
+    void Histogram::snapshot(std::array<std::uint64_t, BUCKETS>& buckets, std::uint64_t& count, std::uint64_t& sum) const {
+        buckets.fill(0);
+        count = 0;
+        sum = 0;
+        for (const Stripe& stripe : this->stripes) {
+            for (int i = 0; i < BUCKETS; i++) {
+                std::uint64_t n = stripe.buckets[i].load(std::memory_order_relaxed);
+                buckets[i] += n;
+                count += n;
+            }
+            sum += stripe.sum.load(std::memory_order_relaxed);
+        }
+    }
+
+    Registry& Registry::instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    Registry::Family& Registry::family(const std::string& name, const std::string& help, const std::string& type) {
+        Family& family = this->families[name];
+        if (family.type.empty()) {
+            family.help = help;
+            family.type = type;
+        } else if (family.type != type) {
+            throw std::logic_error("metric " + name + " is already registered as a " + family.type);
+        }
+        return family;
+    }
+
+    Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::unique_ptr<Counter>& counter = this->family(name, help, "counter").counters[labels];
+        if (!counter) {
+            counter = std::make_unique<Counter>();
+        }
+        return *counter;
+    }
+
+    Histogram& Registry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::unique_ptr<Histogram>& histogram = this->family(name, help, "histogram").histograms[labels];
+        if (!histogram) {
+            histogram = std::make_unique<Histogram>();
+        }
+        return *histogram;
+    }
+
+    void Registry::gauge(const std::string& name, const std::string& help, const std::string& labels, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->family(name, help, "gauge").callbacks[labels] = std::move(read);
+    }
+
+    void Registry::counter(const std::string& name, const std::string& help, const std::string& labels, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->family(name, help, "counter").callbacks[labels] = std::move(read);
+    }
+
+    /**
+     * @brief Renders all metrics in the Prometheus text exposition format.
+     * 
+     * Histograms are exported with fixed boundaries from 10 us to 10 s; the fine-grained
+     * HDR buckets are folded into the largest boundary they fit under.
+     * 
+     * @return std::string The exposition text.
+     */
+    std::string Registry::render() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::string out;
+        out.reserve(16384);
+
+        for (const auto& entry : this->families) {
+            const std::string& name = entry.first;
+            const Family& family = entry.second;
+            out += "# HELP " + name + " " + family.help + "\n";
+            out += "# TYPE " + name + " " + family.type + "\n";
+
+            for (const auto& counter : family.counters) {
+                out += series(name, counter.first) + " " + std::to_string(counter.second->value()) + "\n";
+            }
+            for (const auto& callback : family.callbacks) {
+                out += series(name, callback.first) + " " + formatDouble(callback.second()) + "\n";
+            }
+            for (const auto& histogram : family.histograms) {
+                std::array<std::uint64_t, Histogram::BUCKETS> buckets;
+                std::uint64_t count, sum;
+                histogram.second->snapshot(buckets, count, sum);
+
+                std::uint64_t cumulative = 0;
+                int bucket = 0;
+                for (double bound : EXPORTED_BOUNDS) {
+                    double boundNanos = bound * 1e9;
+                    while (bucket < Histogram::BUCKETS && static_cast<double>(Histogram::bucketUpperBound(bucket)) <= boundNanos) {
+                        cumulative += buckets[bucket];
+                        bucket++;
+                    }
+                    out += series(name + "_bucket", histogram.first, "le=\"" + formatDouble(bound) + "\"") + " " + std::to_string(cumulative) + "\n";
+                }
+                out += series(name + "_bucket", histogram.first, "le=\"+Inf\"") + " " + std::to_string(count) + "\n";
+                out += series(name + "_sum", histogram.first) + " " + formatDouble(static_cast<double>(sum) / 1e9) + "\n";
+                out += series(name + "_count", histogram.first) + " " + std::to_string(count) + "\n";
+            }
+        }
+        return out;
+    }
+
+}
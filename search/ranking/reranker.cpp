@@ -0,0 +1,180 @@
+#include <ranking/reranker.hpp>
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+
+namespace ranking {
+
+    namespace {
+        // Names of the features in the features query parameter, indexed by Feature
+        const char* const FEATURE_NAMES[FEATURE_COUNT] = {"coverage", "depth", "length", "url"};
+
+        // URL length at which the length feature is 0.5
+        const float LENGTH_SCALE = 64.0f;
+    }
+
+    /**
+     * @brief Checks whether the options are the defaults.
+     *
+     * @return True if a request without ranking parameters ranks the same way.
+     */
+    bool RankingOptions::standard() const {
+        return this->candidates == DEFAULT_CANDIDATES && this->features == ALL_FEATURES;
+    }
+
+    /**
+     * @brief Formats the options as query parameters, the inverse of parse.
+     *
+     * @return std::string "rerank=N&features=a,b", with "none" for an empty feature set.
+     */
+    std::string RankingOptions::parameters() const {
+        std::string names;
+        for (std::size_t f = 0; f < FEATURE_COUNT; f++) {
+            if (this->features & (1u << f)) {
+                if (!names.empty()) names.push_back(',');
+                names += FEATURE_NAMES[f];
+            }
+        }
+        return "rerank=" + std::to_string(this->candidates) + "&features=" + (names.empty() ? "none" : names);
+    }
+
+    /**
+     * @brief Parses the rerank and features query parameters.
+     *
+     * @param candidates The number of candidates; empty for the default, capped at MAX_CANDIDATES.
+     * @param features Comma-separated feature names or "none"; empty for all.
+     * @return RankingOptions The options.
+     * @throws std::invalid_argument If a value is not a number or an unknown feature is named.
+     */
+    RankingOptions RankingOptions::parse(const std::string& candidates, const std::string& features) {
+        RankingOptions options;
+        if (!candidates.empty()) {
+            if (!std::all_of(candidates.begin(), candidates.end(), [](unsigned char c) { return std::isdigit(c); })) {
+                throw std::invalid_argument("rerank must be a number of candidates");
+            }
+            options.candidates = candidates.size() > 4 ? MAX_CANDIDATES : std::min<std::size_t>(std::stoul(candidates), MAX_CANDIDATES);
+        }
+        if (!features.empty()) {
+            options.features = 0;
+            if (features == "none") {
+                return options;
+            }
+            std::istringstream names(features);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                const char* const* found = std::find(std::begin(FEATURE_NAMES), std::end(FEATURE_NAMES), name);
+                if (found == std::end(FEATURE_NAMES)) {
+                    throw std::invalid_argument("unknown ranking feature " + name);
+                }
+                options.features |= 1u << (found - std::begin(FEATURE_NAMES));
+            }
+        }
+        return options;
+    }
+
+    /**
+     * @brief Computes the features of a candidate.
+     *
+     * The URL features look at the part after the scheme; the depth counts the non-empty
+     * path segments before any query string or fragment.
+     *
+     * @param candidate The candidate.
+     * @param terms The query terms.
+     * @param features The enabled features; disabled ones stay 0.
+     * @return FeatureVector The feature values.
+     */
+    FeatureVector extractFeatures(const Candidate& candidate, const std::vector<std::string>& terms, unsigned features) {
+        FeatureVector values{};
+        auto enabled = [features](Feature feature) { return (features & (1u << static_cast<unsigned>(feature))) != 0; };
+        const std::string& url = candidate.url;
+
+        if (enabled(Feature::Coverage) && !terms.empty()) {
+            values[static_cast<std::size_t>(Feature::Coverage)] = std::min(1.0f, static_cast<float>(candidate.matchedTerms) / static_cast<float>(terms.size()));
+        }
+
+        std::size_t begin = url.find("://");
+        begin = begin == std::string::npos ? 0 : begin + 3;
+        if (enabled(Feature::Depth)) {
+            std::size_t end = std::min(url.find_first_of("?#", begin), url.size());
+            std::size_t path = std::min(url.find('/', begin), end);
+            std::size_t segments = 0;
+            for (std::size_t i = path; i < end; i++) {
+                if (url[i] == '/' && i + 1 < end && url[i + 1] != '/') segments++;
+            }
+            values[static_cast<std::size_t>(Feature::Depth)] = 1.0f / (1.0f + static_cast<float>(segments));
+        }
+        if (enabled(Feature::Length)) {
+            values[static_cast<std::size_t>(Feature::Length)] = 1.0f / (1.0f + static_cast<float>(url.size() - begin) / LENGTH_SCALE);
+        }
+        if (enabled(Feature::UrlMatch) && !terms.empty()) {
+            std::string lowered(url, begin);
+            std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            std::size_t found = 0;
+            for (const std::string& term : terms) {
+                if (!term.empty() && lowered.find(term) != std::string::npos) found++;
+            }
+            values[static_cast<std::size_t>(Feature::UrlMatch)] = static_cast<float>(found) / static_cast<float>(terms.size());
+        }
+        return values;
+    }
+
+    /**
+     * @brief Constructor for the LinearScorer class.
+     *
+     * @param weights The weight of every feature.
+     */
+    LinearScorer::LinearScorer(const FeatureVector& weights) : weights(weights) {
+    }
+
+    /**
+     * @brief Scores a candidate: the first-phase score boosted by the weighted features.
+     *
+     * @param score The first-phase score.
+     * @param features The feature values.
+     * @return float The boosted score.
+     */
+    float LinearScorer::score(float score, const FeatureVector& features) const {
+        float boost = 1.0f;
+        for (std::size_t f = 0; f < FEATURE_COUNT; f++) {
+            boost += this->weights[f] * features[f];
+        }
+        return score * std::max(boost, 0.0f);
+    }
+
+    /**
+     * @brief Returns the scorer with the default weights.
+     *
+     * Matching every query term counts most, then query terms in the URL; shallow and short
+     * URLs only break near-ties.
+     *
+     * @return const LinearScorer& The shared default scorer.
+     */
+    const LinearScorer& LinearScorer::standard() {
+        static const LinearScorer instance(FeatureVector{0.4f, 0.15f, 0.05f, 0.25f});
+        return instance;
+    }
+
+    /**
+     * @brief Re-ranks the candidates of the first phase.
+     *
+     * @param candidates The candidates, in any order.
+     * @param terms The query terms.
+     * @param features The enabled features.
+     * @param scorer The model.
+     * @param limit The number of results kept.
+     * @return std::vector<Candidate> The best candidates by final score, ties broken by URL.
+     */
+    std::vector<Candidate> rerank(std::vector<Candidate> candidates, const std::vector<std::string>& terms, unsigned features, const Scorer& scorer, std::size_t limit) {
+        for (Candidate& candidate : candidates) {
+            candidate.score = scorer.score(candidate.score, extractFeatures(candidate, terms, features));
+        }
+        std::size_t count = std::min(limit, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.score != b.score ? a.score > b.score : a.url < b.url;
+        });
+        candidates.resize(count);
+        return candidates;
+    }
+
+}
@@ -0,0 +1,283 @@
+#include <scoring/scoringKernel.hpp>
+#include <impact/impact.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ASURA_KERNEL_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define ASURA_KERNEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace scoring {
+
+    /**
+     * @brief Computes the constants of a term.
+     *
+     * Both components are linear in their weights, so the weights of impact::combine are
+     * folded into the constants by combining the unweighted parts.
+     *
+     * @param idf The IDF score of the term.
+     * @param avgDocLength The average document length; values below 1 disable length normalization.
+     * @return TermWeights The constants.
+     */
+    TermWeights TermWeights::make(float idf, float avgDocLength) {
+        TermWeights weights;
+        weights.tfIdf = impact::combine(idf, 0);
+        weights.bm25 = impact::combine(0, idf * (impact::K1 + 1));
+        if (avgDocLength >= 1) {
+            weights.lengthBase = impact::K1 * (1 - impact::B);
+            weights.lengthScale = impact::K1 * impact::B / avgDocLength;
+        } else {
+            weights.lengthBase = impact::K1;
+            weights.lengthScale = 0;
+        }
+        return weights;
+    }
+
+    namespace {
+
+        inline float scoreOne(float tf, float docLength, const TermWeights& w) {
+            return tf * (w.tfIdf + w.bm25 / (tf + w.lengthBase + w.lengthScale * docLength));
+        }
+
+        void computeScalar(const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            for (std::size_t i = 0; i < count; i++) {
+                scores[i] = scoreOne(tfs[i], docLengths[i], w);
+            }
+        }
+
+        void accumulateScalar(const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            for (std::size_t i = 0; i < count; i++) {
+                scores[docIds[i]] += scoreOne(tfs[i], docLengths[i], w);
+            }
+        }
+
+#if defined(ASURA_KERNEL_X86)
+
+        __attribute__((target("avx2,fma")))
+        inline __m256 scoreAvx2(const float* tfs, const float* docLengths, __m256 tfIdf, __m256 bm25, __m256 base, __m256 scale) {
+            __m256 tf = _mm256_loadu_ps(tfs);
+            __m256 denominator = _mm256_add_ps(tf, _mm256_fmadd_ps(scale, _mm256_loadu_ps(docLengths), base));
+            return _mm256_mul_ps(tf, _mm256_add_ps(tfIdf, _mm256_div_ps(bm25, denominator)));
+        }
+
+        __attribute__((target("avx2,fma")))
+        void computeAvx2(const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            const __m256 tfIdf = _mm256_set1_ps(w.tfIdf), bm25 = _mm256_set1_ps(w.bm25);
+            const __m256 base = _mm256_set1_ps(w.lengthBase), scale = _mm256_set1_ps(w.lengthScale);
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(scores + i, scoreAvx2(tfs + i, docLengths + i, tfIdf, bm25, base, scale));
+            }
+            computeScalar(tfs + i, docLengths + i, count - i, w, scores + i);
+        }
+
+        // AVX2 has gathers but no scatter, so the sums are written back lane by lane
+        __attribute__((target("avx2,fma")))
+        void accumulateAvx2(const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            const __m256 tfIdf = _mm256_set1_ps(w.tfIdf), bm25 = _mm256_set1_ps(w.bm25);
+            const __m256 base = _mm256_set1_ps(w.lengthBase), scale = _mm256_set1_ps(w.lengthScale);
+            alignas(32) float block[8];
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_store_ps(block, scoreAvx2(tfs + i, docLengths + i, tfIdf, bm25, base, scale));
+                for (int lane = 0; lane < 8; lane++) {
+                    scores[docIds[i + lane]] += block[lane];
+                }
+            }
+            accumulateScalar(docIds + i, tfs + i, docLengths + i, count - i, w, scores);
+        }
+
+        __attribute__((target("avx512f")))
+        inline __m512 scoreAvx512(const float* tfs, const float* docLengths, __m512 tfIdf, __m512 bm25, __m512 base, __m512 scale) {
+            __m512 tf = _mm512_loadu_ps(tfs);
+            __m512 denominator = _mm512_add_ps(tf, _mm512_fmadd_ps(scale, _mm512_loadu_ps(docLengths), base));
+            return _mm512_mul_ps(tf, _mm512_add_ps(tfIdf, _mm512_div_ps(bm25, denominator)));
+        }
+
+        __attribute__((target("avx512f")))
+        void computeAvx512(const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            const __m512 tfIdf = _mm512_set1_ps(w.tfIdf), bm25 = _mm512_set1_ps(w.bm25);
+            const __m512 base = _mm512_set1_ps(w.lengthBase), scale = _mm512_set1_ps(w.lengthScale);
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                _mm512_storeu_ps(scores + i, scoreAvx512(tfs + i, docLengths + i, tfIdf, bm25, base, scale));
+            }
+            computeScalar(tfs + i, docLengths + i, count - i, w, scores + i);
+        }
+
+        // The ids of one call are distinct, so a gather-add-scatter cannot lose a conflicting lane
+        __attribute__((target("avx512f")))
+        void accumulateAvx512(const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            const __m512 tfIdf = _mm512_set1_ps(w.tfIdf), bm25 = _mm512_set1_ps(w.bm25);
+            const __m512 base = _mm512_set1_ps(w.lengthBase), scale = _mm512_set1_ps(w.lengthScale);
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                __m512i ids = _mm512_loadu_si512(docIds + i);
+                __m512 sums = _mm512_add_ps(_mm512_i32gather_ps(ids, scores, 4), scoreAvx512(tfs + i, docLengths + i, tfIdf, bm25, base, scale));
+                _mm512_i32scatter_ps(scores, ids, sums, 4);
+            }
+            accumulateScalar(docIds + i, tfs + i, docLengths + i, count - i, w, scores);
+        }
+
+#elif defined(ASURA_KERNEL_NEON)
+
+        inline float32x4_t scoreNeon(const float* tfs, const float* docLengths, float32x4_t tfIdf, float32x4_t bm25, float32x4_t base, float32x4_t scale) {
+            float32x4_t tf = vld1q_f32(tfs);
+            float32x4_t denominator = vaddq_f32(tf, vfmaq_f32(base, scale, vld1q_f32(docLengths)));
+            return vmulq_f32(tf, vaddq_f32(tfIdf, vdivq_f32(bm25, denominator)));
+        }
+
+        void computeNeon(const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            const float32x4_t tfIdf = vdupq_n_f32(w.tfIdf), bm25 = vdupq_n_f32(w.bm25);
+            const float32x4_t base = vdupq_n_f32(w.lengthBase), scale = vdupq_n_f32(w.lengthScale);
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(scores + i, scoreNeon(tfs + i, docLengths + i, tfIdf, bm25, base, scale));
+            }
+            computeScalar(tfs + i, docLengths + i, count - i, w, scores + i);
+        }
+
+        void accumulateNeon(const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& w, float* scores) {
+            const float32x4_t tfIdf = vdupq_n_f32(w.tfIdf), bm25 = vdupq_n_f32(w.bm25);
+            const float32x4_t base = vdupq_n_f32(w.lengthBase), scale = vdupq_n_f32(w.lengthScale);
+            float block[4];
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(block, scoreNeon(tfs + i, docLengths + i, tfIdf, bm25, base, scale));
+                for (int lane = 0; lane < 4; lane++) {
+                    scores[docIds[i + lane]] += block[lane];
+                }
+            }
+            accumulateScalar(docIds + i, tfs + i, docLengths + i, count - i, w, scores);
+        }
+
+#endif
+
+        /**
+         * @struct Kernel
+         * @brief The entry points of one instruction set.
+         */
+        struct Kernel {
+            void (*compute)(const float*, const float*, std::size_t, const TermWeights&, float*);
+            void (*accumulate)(const std::uint32_t*, const float*, const float*, std::size_t, const TermWeights&, float*);
+        };
+
+        const Kernel& kernelFor(Isa isa) {
+            static const Kernel scalar{computeScalar, accumulateScalar};
+#if defined(ASURA_KERNEL_X86)
+            static const Kernel avx2{computeAvx2, accumulateAvx2};
+            static const Kernel avx512{computeAvx512, accumulateAvx512};
+            if (isa == Isa::Avx512) return avx512;
+            if (isa == Isa::Avx2) return avx2;
+#elif defined(ASURA_KERNEL_NEON)
+            static const Kernel neon{computeNeon, accumulateNeon};
+            if (isa == Isa::Neon) return neon;
+#endif
+            return scalar;
+        }
+
+        // The kernel of the running CPU, resolved on first use
+        const Kernel& bestKernel() {
+            static const Kernel& kernel = kernelFor(detectIsa());
+            return kernel;
+        }
+    }
+
+    /**
+     * @brief Returns the best instruction set supported by the running CPU.
+     *
+     * @return Isa The instruction set, detected once.
+     */
+    Isa detectIsa() {
+        static const Isa isa = supported(Isa::Avx512) ? Isa::Avx512
+                             : supported(Isa::Avx2) ? Isa::Avx2
+                             : supported(Isa::Neon) ? Isa::Neon
+                             : Isa::Scalar;
+        return isa;
+    }
+
+    /**
+     * @brief Checks whether the running CPU supports an instruction set.
+     *
+     * @param isa The instruction set.
+     * @return True if the kernel can run with it.
+     */
+    bool supported(Isa isa) {
+        switch (isa) {
+            case Isa::Scalar:
+                return true;
+#if defined(ASURA_KERNEL_X86)
+            case Isa::Avx2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            case Isa::Avx512:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx512f");
+#elif defined(ASURA_KERNEL_NEON)
+            case Isa::Neon:
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Returns the name of an instruction set, e.g. "avx2".
+     *
+     * @param isa The instruction set.
+     * @return const char* The name.
+     */
+    const char* isaName(Isa isa) {
+        switch (isa) {
+            case Isa::Neon: return "neon";
+            case Isa::Avx2: return "avx2";
+            case Isa::Avx512: return "avx512";
+            default: return "scalar";
+        }
+    }
+
+    /**
+     * @brief Computes the score of every posting with the best supported kernel.
+     *
+     * @param tfs The term frequencies.
+     * @param docLengths The document lengths.
+     * @param count The number of postings.
+     * @param weights The constants of the term.
+     * @param scores Receives count scores.
+     */
+    void computeScores(const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores) {
+        bestKernel().compute(tfs, docLengths, count, weights, scores);
+    }
+
+    /**
+     * @brief Scores every posting with the best supported kernel and adds it to its document.
+     *
+     * @param docIds The document ids, distinct within the call.
+     * @param tfs The term frequencies.
+     * @param docLengths The document lengths.
+     * @param count The number of postings.
+     * @param weights The constants of the term.
+     * @param scores The score array of the query.
+     */
+    void accumulateScores(const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores) {
+        bestKernel().accumulate(docIds, tfs, docLengths, count, weights, scores);
+    }
+
+    /**
+     * @brief computeScores with an explicit instruction set.
+     */
+    void computeScores(Isa isa, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores) {
+        kernelFor(isa).compute(tfs, docLengths, count, weights, scores);
+    }
+
+    /**
+     * @brief accumulateScores with an explicit instruction set.
+     */
+    void accumulateScores(Isa isa, const std::uint32_t* docIds, const float* tfs, const float* docLengths, std::size_t count, const TermWeights& weights, float* scores) {
+        kernelFor(isa).accumulate(docIds, tfs, docLengths, count, weights, scores);
+    }
+
+}
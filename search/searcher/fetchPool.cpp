@@ -0,0 +1,131 @@
+#include <searcher/fetchPool.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace searcher {
+
+    /**
+     * @brief Constructor for the FetchPool class; starts the workers and connects their clients.
+     *
+     * @param workers The number of worker threads and database connections (at least one).
+     * @param socketTimeout The socket timeout of the workers' clients, an upper bound of every fetch.
+     */
+    FetchPool::FetchPool(std::size_t workers, std::chrono::milliseconds socketTimeout) : socketTimeout(socketTimeout) {
+        workers = std::max<std::size_t>(1, workers);
+        this->workers.reserve(workers);
+        for (std::size_t i = 0; i < workers; i++) {
+            this->workers.emplace_back(&FetchPool::run, this);
+        }
+    }
+
+    /**
+     * @brief Destructor; completes the queued queries and joins the workers.
+     */
+    FetchPool::~FetchPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->available.notify_all();
+        for (std::thread& worker : this->workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    /**
+     * @brief Queues the fetch of a term's postings.
+     *
+     * @param term The term.
+     * @param maxTime The server-side time limit of the query (zero for no limit).
+     * @param deadline The deadline of the search; the fetch is dropped if it passes first.
+     * @return std::future<FetchedPostings> The postings, or the exception of the fetch.
+     */
+    std::future<FetchedPostings> FetchPool::fetch(const std::string& term, std::chrono::milliseconds maxTime, const Deadline& deadline) {
+        return this->submit<FetchedPostings>("fetching " + term, deadline, [term, maxTime](searcher_db::SearcherDB& db) {
+            FetchedPostings postings;
+            postings.hasImpacts = db.getImpactsByTerm(term, maxTime, postings.impacts, &postings.timing);
+            if (!postings.hasImpacts) {
+                db.getPostingArrays(term, maxTime, postings.documents, &postings.timing);
+            }
+            return postings;
+        });
+    }
+
+    /**
+     * @brief Queues a task and wakes a worker.
+     *
+     * @param task The task.
+     */
+    void FetchPool::enqueue(Task&& task) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->tasks.push_back(std::move(task));
+        }
+        this->available.notify_one();
+    }
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return The number of workers.
+     */
+    std::size_t FetchPool::size() const {
+        return this->workers.size();
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters.
+     *
+     * @return FetchPoolStats The current counters.
+     */
+    FetchPoolStats FetchPool::stats() const {
+        FetchPoolStats stats;
+        stats.workers = this->workers.size();
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            stats.queued = this->tasks.size();
+        }
+        stats.fetched = this->fetched.load();
+        stats.expired = this->expired.load();
+        stats.failed = this->failed.load();
+        return stats;
+    }
+
+    /**
+     * @brief Worker loop: runs queries with the worker's own client until stopped.
+     *
+     * Terms with stored impacts are read from the impacts collection; the others come back as
+     * raw postings, which the search quantizes with its corpus statistics.
+     */
+    void FetchPool::run() {
+        searcher_db::SearcherDB db(this->socketTimeout);
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->available.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+                if (this->tasks.empty()) {
+                    return;
+                }
+                task = std::move(this->tasks.front());
+                this->tasks.pop_front();
+            }
+
+            if (task.deadline.expired()) {
+                this->expired++;
+                task.fail(std::make_exception_ptr(std::runtime_error("deadline expired before " + task.description)));
+                continue;
+            }
+            try {
+                task.run(db);
+                this->fetched++;
+            } catch (...) {
+                this->failed++;
+                task.fail(std::current_exception());
+            }
+        }
+    }
+
+}
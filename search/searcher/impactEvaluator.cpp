@@ -0,0 +1,307 @@
+#include <searcher/impactEvaluator.hpp>
+#include <algorithm>
+#include <bitset>
+#include <functional>
+#include <string>
+
+namespace searcher {
+
+    namespace {
+        // Terms beyond the width of the term mask are always counted as missing, which keeps the bound safe
+        const std::size_t MASK_BITS = 64;
+
+        // Postings whose partition is computed by one task when splitting the lists
+        const std::size_t PARTITION_CHUNK = 16384;
+    }
+
+    /**
+     * @brief Constructor for the ImpactEvaluator class.
+     *
+     * @param deadline The deadline of the search; checked every 256 postings.
+     */
+    ImpactEvaluator::ImpactEvaluator(const Deadline& deadline) : deadline(deadline) {
+    }
+
+    /**
+     * @brief Adds the postings of a query term.
+     *
+     * @param postings The postings, sorted by impact with impact::sortByImpact.
+     */
+    void ImpactEvaluator::addTerm(std::vector<impact::ImpactPosting> postings) {
+        this->lists.push_back(std::move(postings));
+        this->cursors.push_back(0);
+    }
+
+    /**
+     * @brief Accumulates the postings until the top-k is settled or the lists are exhausted.
+     *
+     * The settle check costs a pass over the accumulators, so it runs after a number of
+     * postings proportional to their count, which keeps its cost constant per posting.
+     *
+     * @param limit The number of results (k).
+     * @return ImpactEvaluation The evaluation counters.
+     */
+    ImpactEvaluation ImpactEvaluator::accumulate(std::size_t limit) {
+        ImpactEvaluation evaluation;
+        if (limit == 0) {
+            return evaluation;
+        }
+
+        // Every posting may start a new accumulator; sizing the table up front avoids rehashing
+        std::size_t postings = 0;
+        for (const std::vector<impact::ImpactPosting>& list : this->lists) {
+            postings += list.size();
+        }
+        this->accumulators.reserve(postings);
+
+        std::size_t nextCheck = std::max<std::size_t>(limit, 256);
+        std::uint32_t threshold = 0;
+        bool settledTopK = false;
+        while (true) {
+            // Take the highest unread impact across all terms
+            std::size_t best = this->lists.size();
+            std::uint16_t bestImpact = 0;
+            for (std::size_t t = 0; t < this->lists.size(); t++) {
+                if (this->cursors[t] < this->lists[t].size() &&
+                    (best == this->lists.size() || this->lists[t][this->cursors[t]].impact > bestImpact)) {
+                    best = t;
+                    bestImpact = this->lists[t][this->cursors[t]].impact;
+                }
+            }
+            if (best == this->lists.size()) {
+                break;
+            }
+
+            const impact::ImpactPosting& posting = this->lists[best][this->cursors[best]++];
+            Accumulator& accumulator = this->accumulators[posting.url];
+            accumulator.score += posting.impact;
+            if (best < MASK_BITS) {
+                accumulator.terms |= std::uint64_t(1) << best;
+            }
+            evaluation.scored++;
+
+            if ((evaluation.scored & 255) == 0 && this->deadline.expired()) {
+                evaluation.partial = true;
+                return evaluation;
+            }
+            if (evaluation.scored >= nextCheck) {
+                if (this->settled(limit, threshold)) {
+                    settledTopK = true;
+                    break;
+                }
+                nextCheck = evaluation.scored + std::max<std::size_t>(256, this->accumulators.size() / 4);
+            }
+        }
+
+        if (!settledTopK) {
+            return evaluation;
+        }
+
+        // The candidates are fixed; complete their scores and skip everything else
+        evaluation.terminatedEarly = true;
+        std::size_t scanned = 0;
+        for (std::size_t t = 0; t < this->lists.size(); t++) {
+            const std::vector<impact::ImpactPosting>& list = this->lists[t];
+            for (; this->cursors[t] < list.size(); this->cursors[t]++) {
+                if ((++scanned & 255) == 0 && this->deadline.expired()) {
+                    evaluation.partial = true;
+                    return evaluation;
+                }
+                const impact::ImpactPosting& posting = list[this->cursors[t]];
+                auto it = this->accumulators.find(posting.url);
+                if (it == this->accumulators.end() || it->second.score < threshold) {
+                    evaluation.skipped++;
+                    continue;
+                }
+                it->second.score += posting.impact;
+                if (t < MASK_BITS) {
+                    it->second.terms |= std::uint64_t(1) << t;
+                }
+                evaluation.scored++;
+            }
+        }
+        return evaluation;
+    }
+
+    /**
+     * @brief Selects the best accumulated documents.
+     *
+     * @param limit The maximum number of results.
+     * @return std::vector<SearchResult> The results ranked by score, ties broken by URL.
+     */
+    std::vector<SearchResult> ImpactEvaluator::results(std::size_t limit) const {
+        std::vector<SearchResult> results;
+        for (ranking::Candidate& candidate : this->candidates(limit)) {
+            results.push_back(SearchResult{std::move(candidate.url), candidate.score});
+        }
+        return results;
+    }
+
+    /**
+     * @brief Selects the best accumulated documents with the number of terms they matched.
+     *
+     * The term masks of the selected documents are complete, since the scan after settling
+     * the top-k still adds every missing term of a document at or above the threshold.
+     *
+     * @param limit The maximum number of candidates.
+     * @return std::vector<ranking::Candidate> The candidates ranked by score, ties broken by URL.
+     */
+    std::vector<ranking::Candidate> ImpactEvaluator::candidates(std::size_t limit) const {
+        std::vector<std::pair<std::string_view, const Accumulator*>> ranked;
+        ranked.reserve(this->accumulators.size());
+        for (const auto& entry : this->accumulators) {
+            ranked.emplace_back(entry.first, &entry.second);
+        }
+        auto byScore = [](const std::pair<std::string_view, const Accumulator*>& a, const std::pair<std::string_view, const Accumulator*>& b) {
+            return a.second->score != b.second->score ? a.second->score > b.second->score : a.first < b.first;
+        };
+
+        std::size_t count = std::min(limit, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), byScore);
+
+        std::vector<ranking::Candidate> candidates;
+        candidates.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            const Accumulator& accumulator = *ranked[i].second;
+            candidates.push_back(ranking::Candidate{std::string(ranked[i].first), impact::dequantize(accumulator.score), std::bitset<MASK_BITS>(accumulator.terms).count()});
+        }
+        return candidates;
+    }
+
+    /**
+     * @brief Checks whether the top-k is settled and returns the k-th score.
+     *
+     * Settled means that neither an unseen document nor an accumulated document below the
+     * k-th score can reach it with the impacts still unread.
+     *
+     * @param limit The number of results (k).
+     * @param threshold Receives the current k-th score.
+     * @return True if no document below the threshold can still reach it.
+     */
+    bool ImpactEvaluator::settled(std::size_t limit, std::uint32_t& threshold) const {
+        if (this->accumulators.size() < limit) {
+            return false;
+        }
+
+        std::vector<std::uint32_t> scores;
+        scores.reserve(this->accumulators.size());
+        for (const auto& entry : this->accumulators) {
+            scores.push_back(entry.second.score);
+        }
+        std::nth_element(scores.begin(), scores.begin() + (limit - 1), scores.end(), std::greater<std::uint32_t>());
+        threshold = scores[limit - 1];
+        if (threshold == 0 || this->remainingBound(0) >= threshold) {
+            return false;
+        }
+
+        for (const auto& entry : this->accumulators) {
+            const Accumulator& accumulator = entry.second;
+            if (accumulator.score < threshold && accumulator.score + this->remainingBound(accumulator.terms) >= threshold) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Upper bound of what a document can still gain from the terms it has not seen.
+     *
+     * @param terms The terms already added to the document.
+     * @return std::uint64_t The sum of the highest unread impacts of the missing terms.
+     */
+    std::uint64_t ImpactEvaluator::remainingBound(std::uint64_t terms) const {
+        std::uint64_t bound = 0;
+        for (std::size_t t = 0; t < this->lists.size(); t++) {
+            if (t < MASK_BITS && (terms & (std::uint64_t(1) << t))) {
+                continue;
+            }
+            if (this->cursors[t] < this->lists[t].size()) {
+                bound += this->lists[t][this->cursors[t]].impact;
+            }
+        }
+        return bound;
+    }
+
+    /**
+     * @brief Evaluates a query split into document partitions, one ImpactEvaluator per partition.
+     *
+     * The lists are split in two parallel passes: the first computes the partition of every
+     * posting in chunks, the second lets every partition move its postings out in list order,
+     * which keeps them impact-ordered. The partitions then evaluate independently and their
+     * top-k lists are merged.
+     *
+     * @param lists The impact-ordered postings per term; the postings are moved out.
+     * @param partitions The number of partitions (1 to 255).
+     * @param limit The number of results (k).
+     * @param deadline The deadline of the search.
+     * @param pool The pool the partitions run on; the calling thread takes part.
+     * @param evaluation Receives the evaluation counters summed over the partitions.
+     * @return std::vector<ranking::Candidate> The candidates ranked by score, ties broken by URL.
+     */
+    std::vector<ranking::Candidate> ImpactEvaluator::evaluatePartitioned(std::vector<std::vector<impact::ImpactPosting>>& lists, std::size_t partitions, std::size_t limit, const Deadline& deadline, threadpool::ThreadPool& pool, ImpactEvaluation& evaluation) {
+        partitions = std::min<std::size_t>(std::max<std::size_t>(partitions, 1), 255);
+
+        // Partition of every posting: the range of the URL hash, folded to 32 bits, it falls into
+        struct Chunk {
+            std::size_t list;
+            std::size_t begin;
+            std::size_t end;
+        };
+        std::vector<Chunk> chunks;
+        std::vector<std::vector<std::uint8_t>> owners(lists.size());
+        for (std::size_t t = 0; t < lists.size(); t++) {
+            owners[t].resize(lists[t].size());
+            for (std::size_t begin = 0; begin < lists[t].size(); begin += PARTITION_CHUNK) {
+                chunks.push_back(Chunk{t, begin, std::min(begin + PARTITION_CHUNK, lists[t].size())});
+            }
+        }
+        pool.parallelFor(chunks.size(), [&](std::size_t c) {
+            const Chunk& chunk = chunks[c];
+            std::hash<std::string> hash;
+            for (std::size_t i = chunk.begin; i < chunk.end; i++) {
+                std::uint64_t full = hash(lists[chunk.list][i].url);
+                std::uint64_t folded = (full ^ (full >> 32)) & 0xffffffffu;
+                owners[chunk.list][i] = static_cast<std::uint8_t>((folded * partitions) >> 32);
+            }
+        });
+
+        // Evaluate every partition on its own postings
+        std::vector<std::vector<ranking::Candidate>> partitionResults(partitions);
+        std::vector<ImpactEvaluation> evaluations(partitions);
+        pool.parallelFor(partitions, [&](std::size_t p) {
+            ImpactEvaluator evaluator(deadline);
+            for (std::size_t t = 0; t < lists.size(); t++) {
+                std::vector<impact::ImpactPosting> postings;
+                postings.reserve(lists[t].size() / partitions + lists[t].size() / (partitions * 8) + 16);
+                for (std::size_t i = 0; i < lists[t].size(); i++) {
+                    if (owners[t][i] == p) {
+                        postings.push_back(std::move(lists[t][i]));
+                    }
+                }
+                // An empty list still takes its term slot, so the term masks mean the same in every partition
+                evaluator.addTerm(std::move(postings));
+            }
+            evaluations[p] = evaluator.accumulate(limit);
+            partitionResults[p] = evaluator.candidates(limit);
+        });
+
+        // Merge the per-partition top-k lists
+        std::vector<ranking::Candidate> merged;
+        for (std::size_t p = 0; p < partitions; p++) {
+            evaluation.scored += evaluations[p].scored;
+            evaluation.skipped += evaluations[p].skipped;
+            evaluation.terminatedEarly = evaluation.terminatedEarly || evaluations[p].terminatedEarly;
+            evaluation.partial = evaluation.partial || evaluations[p].partial;
+            for (ranking::Candidate& candidate : partitionResults[p]) {
+                merged.push_back(std::move(candidate));
+            }
+        }
+        std::size_t count = std::min(limit, merged.size());
+        std::partial_sort(merged.begin(), merged.begin() + count, merged.end(), [](const ranking::Candidate& a, const ranking::Candidate& b) {
+            return a.score != b.score ? a.score > b.score : a.url < b.url;
+        });
+        merged.resize(count);
+        return merged;
+    }
+
+}
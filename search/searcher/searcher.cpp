@@ -3,10 +3,100 @@
 #include <bsoncxx/builder/stream/document.hpp>
 #include <mongocxx/options/find.hpp>
 #include <bsoncxx/builder/basic/document.hpp>
+#include <metrics/metrics.hpp>
+#include <searcher/impactEvaluator.hpp>
+#include <impact/impact.hpp>
+#include <scoring/scoringKernel.hpp>
+#include <fuzzy/levenshtein.hpp>
 #include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace searcher{
 
+    namespace {
+
+        /**
+         * @struct SearchMetrics
+         * @brief Histograms and counters of the search pipeline, created once per process.
+         */
+        struct SearchMetrics {
+            metrics::Histogram& total;
+            metrics::Histogram& statsFetch;
+            metrics::Histogram& postingFetch;
+            metrics::Histogram& decode;
+            metrics::Histogram& score;
+            metrics::Histogram& sort;
+            metrics::Histogram& fuzzyExpand;
+            metrics::Histogram& rerank;
+            metrics::Counter& postingsScored;
+            metrics::Counter& partialResults;
+            metrics::Counter& postingsSkipped;
+            metrics::Counter& earlyTerminations;
+            metrics::Counter& impactsComputed;
+            metrics::Counter& parallelQueries;
+            metrics::Counter& absentTerms;
+            metrics::Counter& fuzzyTerms;
+            metrics::Counter& deltaTerms;
+            metrics::Counter& reranked;
+            metrics::Counter& concurrentFetches;
+        };
+
+        SearchMetrics& searchMetrics(){
+            static const std::string stageHelp = "Time spent in each stage of Searcher::search";
+            static metrics::Registry& registry = metrics::Registry::instance();
+            static SearchMetrics instance{
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"total\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"stats_fetch\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"posting_fetch\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"decode\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"score\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"sort\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"fuzzy_expand\""),
+                registry.histogram("search_stage_seconds", stageHelp, "stage=\"rerank\""),
+                registry.counter("search_postings_scored_total", "Postings scored by Searcher::search"),
+                registry.counter("search_partial_results_total", "Searches cut short by their deadline"),
+                registry.counter("search_postings_skipped_total", "Postings skipped once the top-k was settled"),
+                registry.counter("search_early_terminations_total", "Searches that settled their top-k before the end of the posting lists"),
+                registry.counter("search_impacts_computed_total", "Terms without stored impacts, quantized at query time"),
+                registry.counter("search_parallel_queries_total", "Searches evaluated in document partitions on the scoring pool"),
+                registry.counter("search_absent_terms_total", "Query terms the term dictionary ruled out without a database lookup"),
+                registry.counter("search_fuzzy_terms_total", "Unknown query terms replaced with dictionary terms within their edit distance"),
+                registry.counter("search_delta_terms_total", "Query terms with recent postings from the indexer's delta index"),
+                registry.counter("search_reranked_total", "Searches whose first-phase candidates were re-ranked"),
+                registry.counter("search_concurrent_fetches_total", "Posting fetches started on the fetch pool together with the other terms of their query")
+            };
+            return instance;
+        }
+
+        std::uint64_t nanos(std::chrono::nanoseconds duration){
+            return static_cast<std::uint64_t>(duration.count());
+        }
+
+        /**
+         * @class StageTimer
+         * @brief Records the duration of a scope into a stage histogram and adds it to a trace field.
+         */
+        class StageTimer {
+        public:
+            StageTimer(metrics::Histogram& histogram, std::chrono::nanoseconds& traced)
+                : histogram(histogram), traced(traced), start(std::chrono::steady_clock::now()) {}
+            ~StageTimer(){
+                std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - this->start;
+                this->traced += elapsed;
+                this->histogram.record(nanos(elapsed));
+            }
+            StageTimer(const StageTimer&) = delete;
+            StageTimer& operator=(const StageTimer&) = delete;
+
+        private:
+            metrics::Histogram& histogram;
+            std::chrono::nanoseconds& traced;
+            std::chrono::steady_clock::time_point start;
+        };
+    }
+
     /**
      * @brief Default constructor for the Searcher class.
      * 
@@ -16,9 +106,81 @@ namespace searcher{
         this->db = std::make_shared<searcher_db::SearcherDB>();
     }
 
-    // Comparator function to sort documents based on their total scores in descending order
-    bool Searcher::cmp(const std::pair<std::string, DocumentScores>& a, const std::pair<std::string, DocumentScores>& b){
-        return a.second.totalScore > b.second.totalScore;
+    /**
+     * @brief Constructor for the Searcher class with an existing database object.
+     * 
+     * @param db The database object.
+     * @param deadline The deadline of the search request.
+     * @param pool The pool long queries are evaluated on in parallel; may be null.
+     * @param snapshot The loaded index snapshot; may be null.
+     * @param dictionary The term dictionary of the shard; may be null.
+     */
+    Searcher::Searcher(std::shared_ptr<searcher_db::SearcherDB> db, const Deadline& deadline, threadpool::ThreadPool* pool, snapshot::LiveSnapshot* snapshot, dictionary::TermDictionary* dictionary) : db(std::move(db)), deadline(deadline), pool(pool), snapshot(snapshot), dictionary(dictionary){
+    }
+
+    /**
+     * @brief Constructor for the Searcher class with a time budget.
+     * 
+     * No client is connected here: with a fetch pool, every query runs on a client of the
+     * pool; without one, a client with a socket timeout matching the remaining budget is
+     * connected on the first query.
+     * 
+     * @param deadline The deadline of the search request.
+     * @param pool The pool long queries are evaluated on in parallel; may be null.
+     * @param snapshot The loaded index snapshot; may be null.
+     * @param dictionary The term dictionary of the shard; may be null.
+     */
+    Searcher::Searcher(const Deadline& deadline, threadpool::ThreadPool* pool, snapshot::LiveSnapshot* snapshot, dictionary::TermDictionary* dictionary) : deadline(deadline), pool(pool), snapshot(snapshot), dictionary(dictionary){
+    }
+
+    /**
+     * @brief Enables or disables the expansion of unknown terms to similar dictionary terms.
+     * 
+     * @param enabled Whether unknown terms are expanded.
+     */
+    void Searcher::setFuzzy(bool enabled){
+        this->fuzzy = enabled;
+    }
+
+    /**
+     * @brief Sets the indexer's recent postings of the query, merged with the persisted ones.
+     * 
+     * @param delta The delta postings of this shard; null searches the persisted index only.
+     */
+    void Searcher::setDelta(const delta::DeltaView* delta){
+        this->delta = delta;
+    }
+
+    /**
+     * @brief Sets the corpus statistics, so that the search does not read them from the snapshot or the database.
+     * 
+     * @param stats The current corpus statistics.
+     */
+    void Searcher::setCorpusStats(const impact::CorpusStats& stats){
+        this->corpusStats = stats;
+        this->statsKnown = true;
+    }
+
+    /**
+     * @brief Sets how the results are ranked.
+     * 
+     * @param options The number of candidates and the features of the second phase.
+     * @param scorer The model of the second phase, not owned; null uses the default linear model.
+     */
+    void Searcher::setRanking(const ranking::RankingOptions& options, const ranking::Scorer* scorer){
+        this->ranking = options;
+        this->scorer = scorer;
+    }
+
+    /**
+     * @brief Sets the pool the postings of queries with several terms are fetched on concurrently.
+     * 
+     * Every database query of the search then runs on a client of the pool.
+     * 
+     * @param fetchPool The shared fetch pool, not owned; null fetches one term after the other on the calling thread.
+     */
+    void Searcher::setFetchPool(FetchPool* fetchPool){
+        this->fetchPool = fetchPool;
     }
 
     /**
@@ -28,50 +190,518 @@ namespace searcher{
      * @return std::vector<std::string> A list of URLs of the top-ranked documents.
      */
     std::vector<std::string> Searcher::search(std::string query){
+        std::vector<std::string> resultUrls;
+        for(SearchResult& result: this->searchResults(query).results){
+            resultUrls.push_back(std::move(result.url));
+        }
+        return resultUrls;
+    }
+
+    /**
+     * @brief Searches the database for documents matching the query and keeps their scores.
+     * 
+     * Every term contributes its impact-ordered postings, precomputed by the indexer or, for
+     * terms that have not been refreshed yet, quantized here with the same corpus statistics.
+     * The ImpactEvaluator then adds up the integer impacts and stops reading postings once
+     * the top results cannot change anymore.
+     * 
+     * Terms the dictionary knows to be absent are never looked up. A term the dictionary
+     * rules out, or without persisted postings, is replaced, unless fuzzy matching is disabled
+     * or the delta holds postings of it, by the most frequent dictionary terms within its edit
+     * distance, with their impacts lowered by FUZZY_PENALTY per edit. Postings the delta
+     * shadows do not make a term unknown.
+     * With a loaded snapshot, the statistics and the postings of every term not updated since
+     * the export are read from the snapshot; the rest comes from the database.
+     * 
+     * Queries with at least PARALLEL_MIN_POSTINGS postings are split into document partitions
+     * that are evaluated on the scoring pool and merged; shorter ones stay on the request thread.
+     * 
+     * Ranking has two phases. The impact evaluation only settles the best candidates by their
+     * summed impacts; the second phase then computes the features of those candidates alone
+     * and re-scores them with the ranking model, so richer features never cost a pass over
+     * the postings.
+     * 
+     * The deadline is checked before every posting fetch and every 256 evaluated postings. Once
+     * it has expired, no further postings are fetched or evaluated and the best documents found
+     * so far are returned as a partial response.
+     * 
+     * @param query The search query string.
+     * @return SearchResponse The top-ranked documents with their total scores.
+     */
+    SearchResponse Searcher::searchResults(std::string query){
+        return this->searchResults(std::move(query), std::vector<std::int64_t>());
+    }
+
+    /**
+     * @brief Searches one shard of a sharded index with the document frequencies of the whole corpus.
+     * 
+     * The impacts of a shard carry the IDF of the shard's own posting count. Every term's
+     * impacts are rescaled to the IDF of its global posting count before evaluation, so the
+     * scores of all shards are comparable and their top-k lists can be merged.
+     * 
+     * @param query The normalized search query string.
+     * @param globalPostings The posting count of every term across all shards, in query order; empty to use the local counts.
+     * @return SearchResponse The top-ranked documents of this shard with their total scores.
+     */
+    SearchResponse Searcher::searchResults(std::string query, const std::vector<std::int64_t>& globalPostings){
+        SearchMetrics& stages = searchMetrics();
+        metrics::ScopedTimer totalTimer(stages.total);
+        SearchResponse response;
+        QueryTrace& trace = response.trace;
+        trace.query = query;
+
         // Split the query into individual terms
         std::vector<std::string> querySegments;
         this->splitQuery(query, querySegments, '+');
 
-        // Get the total number of documents in the database
-        int totalDocuments = this->db->getTotalNumberDocuments();
+        // Get the corpus statistics the impacts are based on
+        impact::CorpusStats stats;
+        try {
+            StageTimer timer(stages.statsFetch, trace.statsFetch);
+            if(this->statsKnown){
+                stats = this->corpusStats;
+            } else if(this->snapshot && this->snapshot->stats(stats)){
+                // Current in the snapshot, no database round-trip
+            } else if(this->fetchPool){
+                std::chrono::milliseconds maxTime = this->queryTimeLimit();
+                std::future<impact::CorpusStats> pending = this->fetchPool->submit<impact::CorpusStats>("reading the corpus statistics", this->deadline, [maxTime](searcher_db::SearcherDB& db){
+                    return db.getCorpusStats(maxTime);
+                });
+                stats = this->awaitQuery(pending);
+            } else {
+                stats = this->database().getCorpusStats(this->queryTimeLimit());
+            }
+        } catch(const std::exception& e) {
+            if(!this->deadline.expired()) throw;
+            stages.partialResults.add();
+            response.partial = trace.partial = true;
+            return response;
+        }
+
+        // Misspelled and unknown terms skip the database round-trip
+        std::vector<bool> absent(querySegments.size(), false);
+        for(std::size_t t = 0; t < querySegments.size(); t++){
+            absent[t] = this->dictionary && this->dictionary->knownAbsent(querySegments[t]);
+        }
+
+        // Request the postings of all terms at once, so their round-trips overlap
+        std::vector<PendingFetch> pending(querySegments.size());
+        if(this->fetchPool && querySegments.size() > 1){
+            for(std::size_t t = 0; t < querySegments.size(); t++){
+                if(!absent[t]) pending[t] = this->startFetch(querySegments[t]);
+            }
+        }
+
+        // Collect the impact-ordered postings of every term
+        std::vector<std::vector<impact::ImpactPosting>> lists;
+        std::size_t totalPostings = 0;
+        for(std::size_t t = 0; t < querySegments.size(); t++){
+            const std::string& term = querySegments[t];
+            if(this->deadline.expired()){
+                response.partial = true;
+                break;
+            }
+
+            std::vector<impact::ImpactPosting> postings;
+            std::size_t expansions = 0;
+            if(absent[t]) stages.absentTerms.add();
+            try {
+                if(pending[t].started){
+                    this->awaitPostings(pending[t], stats, postings, trace);
+                } else if(!absent[t]){
+                    this->fetchPostings(term, stats, postings, trace);
+                }
+                // Decided before the delta shadows postings: a term whose documents were all re-indexed is not misspelled
+                bool unknown = absent[t] || postings.empty();
+                std::size_t recent = this->mergeDelta(term, stats, postings);
+                if(recent > 0) stages.deltaTerms.add();
 
-        // Calculate the score for relevant documents
-        for(std::string& term: querySegments){
-            std::vector<searcher_db::IndexDocument> documents = this->db->getDocumentsByTerm(term);
+                // Unknown in the whole corpus, fall back to the closest dictionary terms
+                unknown = unknown && recent == 0 && (t >= globalPostings.size() || globalPostings[t] == 0);
+                if(unknown && this->fuzzy){
+                    expansions = this->expandTerm(term, stats, postings, trace);
+                }
+            } catch(const std::exception& e) {
+                // A driver timeout at the deadline ends the search with what has been collected so far
+                if(!this->deadline.expired()) throw;
+                response.partial = true;
+                break;
+            }
+            trace.terms.push_back(TermTrace{term, postings.size(), expansions});
 
-            // Tuning parameters for BM25
-            float k1 = 1.2;
-            float b = 0.75;
+            // Unknown term, it contributes nothing
+            if(postings.empty()) continue;
 
-            // Calculate the inverse document frequency (IDF) score
-            float idf = calculateIDF_Score(totalDocuments, documents.size());
+            // Replace the shard-local IDF baked into the impacts with the corpus-wide one
+            if(t < globalPostings.size() && globalPostings[t] > static_cast<std::int64_t>(postings.size())){
+                float localIdf = impact::idf(stats.totalDocuments, static_cast<std::int64_t>(postings.size()));
+                float globalIdf = impact::idf(std::max(stats.totalDocuments, globalPostings[t]), globalPostings[t]);
+                if(localIdf > 0 && std::isfinite(localIdf)){
+                    impact::rescale(postings, globalIdf / localIdf);
+                }
+            }
+            totalPostings += postings.size();
+            lists.push_back(std::move(postings));
+        }
 
-            for(auto doc: documents){
-                // Calculate term frequency-inverse document frequency (TF-IDF) score
-                float td_idf = doc.tf * idf;
-                // Calculate BM25 score
-                float bm25 = calculateBM25_Score(doc.docLength, 0, idf, doc.tf, k1, b);
+        std::size_t partitions = 1;
+        if(this->pool && this->pool->size() > 1 && totalPostings >= PARALLEL_MIN_POSTINGS){
+            partitions = std::min(this->pool->size() + 1, totalPostings / POSTINGS_PER_PARTITION);
+        }
+        trace.partitions = partitions;
 
-                // Update document scores in the ranking map
-                this->rank[doc.url].td_idf += td_idf;
-                this->rank[doc.url].bm25 += bm25;
-                this->rank[doc.url].totalScore += combineScores(this->rank[doc.url].td_idf, this->rank[doc.url].bm25);
+        // Phase one: add up the impacts until the best candidates are settled
+        std::size_t candidateCount = this->ranking.reranked() ? std::max(MAX_RESULTS, this->ranking.candidates) : MAX_RESULTS;
+        std::vector<ranking::Candidate> candidates;
+        ImpactEvaluation evaluation;
+        ImpactEvaluator evaluator(this->deadline);
+        if(partitions > 1){
+            stages.parallelQueries.add();
+            StageTimer scoreTimer(stages.score, trace.score);
+            candidates = ImpactEvaluator::evaluatePartitioned(lists, partitions, candidateCount, this->deadline, *this->pool, evaluation);
+        } else {
+            for(std::vector<impact::ImpactPosting>& postings: lists){
+                evaluator.addTerm(std::move(postings));
             }
+            StageTimer scoreTimer(stages.score, trace.score);
+            evaluation = evaluator.accumulate(candidateCount);
         }
+        stages.postingsScored.add(evaluation.scored);
+        stages.postingsSkipped.add(evaluation.skipped);
+        if(evaluation.terminatedEarly) stages.earlyTerminations.add();
+        trace.documentsScored = evaluation.scored;
+        if(evaluation.partial) response.partial = true;
 
-        // Sort documents by their total scores
-        std::vector<std::pair<std::string, DocumentScores>> sorted_documents(rank.begin(), rank.end());
-        std::sort(sorted_documents.begin(), sorted_documents.end(), cmp);
+        if(response.partial) stages.partialResults.add();
+        trace.partial = response.partial;
 
-        // Prepare the result URLs
-        std::vector<std::string> resultUrls;
-        int counter = 0;
-        for(const auto& it: sorted_documents){
-            if(counter > 25) break;
-            resultUrls.push_back(it.first);
-            counter++;
+        // Select the candidates; the partitioned evaluation has already merged them
+        if(partitions == 1){
+            StageTimer sortTimer(stages.sort, trace.select);
+            candidates = evaluator.candidates(candidateCount);
         }
-        return resultUrls;
+
+        // Phase two: re-score the candidates with their features and keep the best
+        if(this->ranking.reranked() && !candidates.empty()){
+            stages.reranked.add();
+            StageTimer rerankTimer(stages.rerank, trace.rerank);
+            trace.candidates = candidates.size();
+            const ranking::Scorer& scorer = this->scorer ? *this->scorer : ranking::LinearScorer::standard();
+            candidates = ranking::rerank(std::move(candidates), querySegments, this->ranking.features, scorer, MAX_RESULTS);
+        }
+        response.results.reserve(std::min(candidates.size(), MAX_RESULTS));
+        for(std::size_t i = 0; i < candidates.size() && i < MAX_RESULTS; i++){
+            response.results.push_back(SearchResult{std::move(candidates[i].url), candidates[i].score});
+        }
+        return response;
+    }
+
+    /**
+     * @brief Reads the impact-ordered postings of a term from the snapshot or the database.
+     * 
+     * Terms not refreshed since the last corpus change have no stored impacts; their raw
+     * postings are quantized here the same way the indexer would. With a fetch pool, the
+     * database read runs on one of its clients.
+     * 
+     * @param term The term.
+     * @param stats The corpus statistics, used to quantize terms without stored impacts.
+     * @param postings Receives the postings, highest impact first.
+     * @param trace The trace the fetch and decode times are added to.
+     */
+    void Searcher::fetchPostings(const std::string& term, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings, QueryTrace& trace){
+        SearchMetrics& stages = searchMetrics();
+        searcher_db::FetchTiming timing;
+        if(this->snapshot && this->snapshot->postings(term, postings)){
+            // Current in the snapshot, no database round-trip
+        } else if(this->fetchPool){
+            PendingFetch fetch;
+            fetch.started = true;
+            fetch.database = this->fetchPool->fetch(term, this->queryTimeLimit(), this->deadline);
+            this->awaitPostings(fetch, stats, postings, trace);
+            return;
+        } else if(!this->database().getImpactsByTerm(term, this->queryTimeLimit(), postings, &timing)){
+            scoring::PostingArrays documents;
+            this->database().getPostingArrays(term, this->queryTimeLimit(), documents, &timing);
+            StageTimer scoreTimer(stages.score, trace.score);
+            postings = quantizePostings(documents, stats);
+            if(documents.size() > 0) stages.impactsComputed.add();
+        }
+        stages.postingFetch.record(nanos(timing.fetch));
+        stages.decode.record(nanos(timing.decode));
+        trace.postingFetch += timing.fetch;
+        trace.decode += timing.decode;
+    }
+
+    /**
+     * @brief Reads a term's postings from the snapshot, or starts fetching them on the fetch pool.
+     * 
+     * @param term The term.
+     * @return PendingFetch The started fetch.
+     */
+    Searcher::PendingFetch Searcher::startFetch(const std::string& term){
+        PendingFetch fetch;
+        fetch.started = true;
+        if(this->snapshot && this->snapshot->postings(term, fetch.postings)){
+            fetch.fromSnapshot = true;
+        } else {
+            fetch.database = this->fetchPool->fetch(term, this->queryTimeLimit(), this->deadline);
+            searchMetrics().concurrentFetches.add();
+        }
+        return fetch;
+    }
+
+    /**
+     * @brief Waits for a started fetch until the deadline and takes its postings.
+     * 
+     * The fetch and decode times are those the worker measured; with the fetches of the
+     * other terms running alongside, their sum in the trace can exceed the wall time.
+     * 
+     * @param fetch The started fetch.
+     * @param stats The corpus statistics, used to quantize terms without stored impacts.
+     * @param postings Receives the postings, highest impact first.
+     * @param trace The trace the fetch and decode times are added to.
+     * @throws std::runtime_error If the deadline passes first; the exception of the fetch if it failed.
+     */
+    void Searcher::awaitPostings(PendingFetch& fetch, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings, QueryTrace& trace){
+        if(fetch.fromSnapshot){
+            postings = std::move(fetch.postings);
+            return;
+        }
+        if(this->deadline.bounded() && fetch.database.wait_until(this->deadline.at()) != std::future_status::ready){
+            throw std::runtime_error("deadline expired while fetching postings");
+        }
+        FetchedPostings fetched = fetch.database.get();
+        SearchMetrics& stages = searchMetrics();
+        if(fetched.hasImpacts){
+            postings = std::move(fetched.impacts);
+        } else {
+            StageTimer scoreTimer(stages.score, trace.score);
+            postings = quantizePostings(fetched.documents, stats);
+            if(fetched.documents.size() > 0) stages.impactsComputed.add();
+        }
+        stages.postingFetch.record(nanos(fetched.timing.fetch));
+        stages.decode.record(nanos(fetched.timing.decode));
+        trace.postingFetch += fetched.timing.fetch;
+        trace.decode += fetched.timing.decode;
+    }
+
+    /**
+     * @brief Replaces an unknown term with the dictionary terms within its edit distance.
+     * 
+     * The term's Levenshtein automaton is intersected with the dictionary, which yields at most
+     * MAX_EXPANSIONS terms, closest and then most frequent first. Their postings are merged
+     * into one list, keeping the best impact of every document after lowering it by
+     * FUZZY_PENALTY per edit, so the expansions together weigh like a single query term.
+     * Terms shorter than 3 bytes are not expanded.
+     * 
+     * In a sharded search, each shard expands with its own dictionary and its local IDF.
+     * 
+     * @param term The unknown term.
+     * @param stats The corpus statistics.
+     * @param postings Receives the merged postings of the expansions, highest impact first.
+     * @param trace The trace the fetch and decode times are added to.
+     * @return std::size_t The number of expansions that contributed postings.
+     */
+    std::size_t Searcher::expandTerm(const std::string& term, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings, QueryTrace& trace){
+        unsigned edits = fuzzy::LevenshteinAutomaton::editsFor(term.size());
+        if(edits == 0 || !this->dictionary || !this->dictionary->ready()){
+            return 0;
+        }
+        SearchMetrics& stages = searchMetrics();
+        std::vector<dictionary::FuzzyMatch> matches;
+        {
+            metrics::ScopedTimer timer(stages.fuzzyExpand);
+            matches = this->dictionary->expand(fuzzy::LevenshteinAutomaton(term, edits), MAX_EXPANSIONS);
+        }
+
+        std::vector<PendingFetch> pending(matches.size());
+        if(this->fetchPool && matches.size() > 1){
+            for(std::size_t m = 0; m < matches.size(); m++){
+                pending[m] = this->startFetch(matches[m].term);
+            }
+        }
+
+        std::unordered_map<std::string, std::uint16_t> best;
+        std::size_t used = 0;
+        for(std::size_t m = 0; m < matches.size(); m++){
+            const dictionary::FuzzyMatch& match = matches[m];
+            if(this->deadline.expired()) break;
+            std::vector<impact::ImpactPosting> expanded;
+            if(pending[m].started){
+                this->awaitPostings(pending[m], stats, expanded, trace);
+            } else {
+                this->fetchPostings(match.term, stats, expanded, trace);
+            }
+            if(expanded.empty()) continue;
+            used++;
+            impact::rescale(expanded, std::pow(FUZZY_PENALTY, static_cast<float>(match.distance)));
+            for(impact::ImpactPosting& posting: expanded){
+                std::uint16_t& impact = best[posting.url];
+                impact = std::max(impact, posting.impact);
+            }
+        }
+
+        postings.clear();
+        postings.reserve(best.size());
+        for(auto& entry: best){
+            postings.push_back(impact::ImpactPosting{entry.first, entry.second});
+        }
+        impact::sortByImpact(postings);
+        if(used > 0) stages.fuzzyTerms.add();
+        return used;
+    }
+
+    /**
+     * @brief Drops the outdated postings of a term and adds its recent postings from the delta.
+     * 
+     * Every document in the delta has been re-indexed or deleted since it was persisted, so
+     * its persisted postings are dropped. The recent postings are quantized like the indexer
+     * would, with the IDF of the persisted and recent postings together. A term only the
+     * delta knows is not expanded to similar terms.
+     * 
+     * @param term The term.
+     * @param stats The corpus statistics the recent postings are quantized with.
+     * @param postings The persisted postings, highest impact first; receives the merged postings.
+     * @return std::size_t The number of recent postings added.
+     */
+    std::size_t Searcher::mergeDelta(const std::string& term, const impact::CorpusStats& stats, std::vector<impact::ImpactPosting>& postings) const {
+        if(!this->delta) return 0;
+        if(this->delta->shadowed && !this->delta->shadowed->empty()){
+            const std::unordered_set<std::string>& shadowed = *this->delta->shadowed;
+            postings.erase(std::remove_if(postings.begin(), postings.end(), [&](const impact::ImpactPosting& posting){ return shadowed.count(posting.url) > 0; }), postings.end());
+        }
+
+        auto recent = this->delta->terms.find(term);
+        if(recent == this->delta->terms.end() || recent->second.empty()) return 0;
+        const std::vector<searcher_db::IndexDocument>& documents = recent->second;
+
+        float avgDocLength = static_cast<float>(stats.avgDocLength);
+        if(avgDocLength < 1){
+            long long totalLength = 0;
+            for(const searcher_db::IndexDocument& document: documents){
+                totalLength += document.docLength;
+            }
+            avgDocLength = std::max(1.0f, static_cast<float>(totalLength / static_cast<long long>(documents.size())));
+        }
+        std::int64_t appearances = static_cast<std::int64_t>(postings.size() + documents.size());
+        float termIdf = impact::idf(std::max(stats.totalDocuments, appearances), appearances);
+
+        postings.reserve(postings.size() + documents.size());
+        for(const searcher_db::IndexDocument& document: documents){
+            postings.push_back(impact::ImpactPosting{document.url, impact::quantize(impact::postingScore(document.tf, document.docLength, termIdf, avgDocLength))});
+        }
+        impact::sortByImpact(postings);
+        return documents.size();
+    }
+
+    /**
+     * @brief Counts the postings of every term of a query in this shard.
+     * 
+     * @param query The normalized search query string.
+     * @return std::vector<TermTrace> The posting count of every term, in query order.
+     */
+    std::vector<TermTrace> Searcher::countPostings(std::string query){
+        std::vector<std::string> querySegments;
+        this->splitQuery(query, querySegments, '+');
+
+        // With a fetch pool, the counts of all terms are requested at once
+        std::vector<std::future<std::int64_t>> pending(querySegments.size());
+        std::vector<bool> absent(querySegments.size(), false);
+        std::chrono::milliseconds maxTime = this->queryTimeLimit();
+        for(std::size_t t = 0; t < querySegments.size(); t++){
+            const std::string& term = querySegments[t];
+            absent[t] = this->dictionary && this->dictionary->knownAbsent(term);
+            if(!absent[t] && this->fetchPool){
+                pending[t] = this->fetchPool->submit<std::int64_t>("counting " + term, this->deadline, [term, maxTime](searcher_db::SearcherDB& db){
+                    return db.getPostingCount(term, maxTime);
+                });
+            }
+        }
+
+        std::vector<TermTrace> counts;
+        for(std::size_t t = 0; t < querySegments.size(); t++){
+            const std::string& term = querySegments[t];
+            if(absent[t]){
+                searchMetrics().absentTerms.add();
+                counts.push_back(TermTrace{term, 0});
+                continue;
+            }
+            std::int64_t count = pending[t].valid() ? this->awaitQuery(pending[t]) : this->database().getPostingCount(term, this->queryTimeLimit());
+            counts.push_back(TermTrace{term, static_cast<std::size_t>(count)});
+        }
+        return counts;
+    }
+
+    /**
+     * @brief Computes the impact-ordered postings of a term with the SIMD kernel.
+     * 
+     * @param postings The postings of the term.
+     * @param stats The corpus statistics.
+     * @return std::vector<impact::ImpactPosting> The postings with their impacts, highest first.
+     */
+    std::vector<impact::ImpactPosting> Searcher::quantizePostings(const scoring::PostingArrays& postings, const impact::CorpusStats& stats){
+        std::vector<impact::ImpactPosting> impacts;
+        if(postings.size() == 0) return impacts;
+
+        // Without corpus statistics the average length of the term's documents stands in, as in impact::computeImpacts
+        float avgDocLength = static_cast<float>(stats.avgDocLength);
+        if(avgDocLength < 1){
+            long long totalLength = 0;
+            for(float length: postings.docLengths){
+                totalLength += static_cast<long long>(length);
+            }
+            avgDocLength = static_cast<float>(totalLength / static_cast<long long>(postings.size()));
+        }
+
+        float idf = impact::idf(stats.totalDocuments, static_cast<std::int64_t>(postings.size()));
+        scoring::AlignedVector<float> scores(postings.size());
+        scoring::computeScores(postings.tfs.data(), postings.docLengths.data(), postings.size(), scoring::TermWeights::make(idf, avgDocLength), scores.data());
+
+        impacts.reserve(postings.size());
+        for(std::size_t i = 0; i < postings.size(); i++){
+            impacts.push_back(impact::ImpactPosting{postings.urls[i], impact::quantize(scores[i])});
+        }
+        impact::sortByImpact(impacts);
+        return impacts;
+    }
+
+    /**
+     * @brief Returns the search's own database client, connecting it on first use.
+     * 
+     * Only searches without a fetch pool connect a client of their own; its socket timeout
+     * matches the remaining budget.
+     * 
+     * @return searcher_db::SearcherDB& The client.
+     */
+    searcher_db::SearcherDB& Searcher::database(){
+        if(!this->db){
+            if(this->deadline.bounded()){
+                this->db = std::make_shared<searcher_db::SearcherDB>(this->deadline.remaining());
+            } else {
+                this->db = std::make_shared<searcher_db::SearcherDB>();
+            }
+        }
+        return *this->db;
+    }
+
+    /**
+     * @brief Waits for a query on the fetch pool until the deadline and takes its result.
+     * 
+     * @param pending The queued query.
+     * @return Result The result of the query.
+     * @throws std::runtime_error If the deadline passes first; the exception of the query if it failed.
+     */
+    template<typename Result>
+    Result Searcher::awaitQuery(std::future<Result>& pending){
+        if(this->deadline.bounded() && pending.wait_until(this->deadline.at()) != std::future_status::ready){
+            throw std::runtime_error("deadline expired while waiting for the database");
+        }
+        return pending.get();
+    }
+
+    // Returns the remaining time of the deadline, or zero (no limit) for unbounded searches
+    std::chrono::milliseconds Searcher::queryTimeLimit() const{
+        return this->deadline.bounded() ? this->deadline.remaining() : std::chrono::milliseconds::zero();
     }
 
     /**
@@ -89,6 +719,26 @@ namespace searcher{
         }
     }
 
+    /**
+     * @brief Normalizes a query so that equivalent queries map to the same key.
+     * 
+     * @param query The raw search query string.
+     * @return std::string The non-empty terms, sorted and joined with '+'.
+     */
+    std::string Searcher::normalizeQuery(const std::string& query){
+        std::vector<std::string> terms;
+        splitQuery(query, terms, '+');
+        terms.erase(std::remove(terms.begin(), terms.end(), std::string()), terms.end());
+        std::sort(terms.begin(), terms.end());
+
+        std::string normalized;
+        for(const std::string& term: terms){
+            if(!normalized.empty()) normalized.push_back('+');
+            normalized += term;
+        }
+        return normalized;
+    }
+
     /**
      * @brief Calculates the Inverse Document Frequency (IDF) score.
      * 
@@ -97,14 +747,14 @@ namespace searcher{
      * @return float The IDF score.
      */
     float Searcher::calculateIDF_Score(int totalDocuments, int appearances){
-        return static_cast<float>(1 + log(totalDocuments / appearances));
+        return impact::idf(totalDocuments, appearances);
     }
 
     /**
      * @brief Calculates the BM25 score for a document.
      * 
      * @param doc_length The length of the document.
-     * @param avg_doc_length The average length of documents (not used in this implementation).
+     * @param avg_doc_length The average length of documents; values below 1 disable length normalization.
      * @param idf The IDF score of the term.
      * @param tf The term frequency in the document.
      * @param k1 The BM25 k1 parameter.
@@ -112,7 +762,7 @@ namespace searcher{
      * @return float The BM25 score.
      */
     float Searcher::calculateBM25_Score(int doc_length, int avg_doc_length, float idf, float tf, float k1, float b){
-        return idf * ((tf * (k1 + 1)) / (tf + k1 * (1 - b + b * (doc_length / avg_doc_length))));
+        return impact::bm25(doc_length, static_cast<float>(avg_doc_length), idf, tf, k1, b);
     }
 
     /**
@@ -123,10 +773,6 @@ namespace searcher{
      * @return float The combined total score.
      */
     float Searcher::combineScores(float td_idf, float bm25){
-        // Weights for the ranking components
-        float weightTD_IDF = 0.3;
-        float weightBM25 = 0.7;
-
-        return td_idf * weightTD_IDF + bm25 * weightBM25;
+        return impact::combine(td_idf, bm25);
     }
 }
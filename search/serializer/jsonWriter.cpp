@@ -0,0 +1,247 @@
+#include <serializer/jsonWriter.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace serializer {
+
+    namespace {
+
+        const char HEX_DIGITS[] = "0123456789abcdef";
+
+        // Returns true if the byte has to be escaped inside a JSON string
+        inline bool needsEscape(unsigned char c) {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+
+        /**
+         * @brief Finds the first byte that needs escaping.
+         *
+         * @param data Start of the string.
+         * @param size Length of the string.
+         * @return std::size_t Offset of the first byte to escape, or size if the string is clean.
+         */
+        std::size_t findEscape(const char* data, std::size_t size) {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i control = _mm_set1_epi8(0x1F);
+            for (; i + 16 <= size; i += 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                // chunk <= 0x1F (unsigned) <=> max(chunk, 0x1F) == 0x1F
+                __m128i isControl = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control);
+                __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), isControl);
+                int mask = _mm_movemask_epi8(hits);
+                if (mask != 0) {
+                    return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+                }
+            }
+#elif defined(__ARM_NEON)
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t backslash = vdupq_n_u8('\\');
+            const uint8x16_t control = vdupq_n_u8(0x20);
+            for (; i + 16 <= size; i += 16) {
+                uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+                uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)), vcltq_u8(chunk, control));
+                if (vmaxvq_u8(hits) != 0) {
+                    break; // locate the exact byte with the scalar tail below
+                }
+            }
+#endif
+            for (; i < size; i++) {
+                if (needsEscape(static_cast<unsigned char>(data[i]))) {
+                    return i;
+                }
+            }
+            return size;
+        }
+    }
+
+    /**
+     * @brief Constructs a writer with an empty buffer.
+     *
+     * @param reserve Number of bytes to reserve up front (0 for none).
+     */
+    JsonWriter::JsonWriter(std::size_t reserve) : needComma(false) {
+        if (reserve > 0) {
+            this->buffer.reserve(reserve);
+        }
+    }
+
+    /**
+     * @brief Constructs a writer that reuses an existing (pre-sized) buffer.
+     *
+     * @param buffer The buffer to write into; it is cleared but keeps its capacity.
+     */
+    JsonWriter::JsonWriter(std::string&& buffer) : buffer(std::move(buffer)), needComma(false) {
+        this->buffer.clear();
+    }
+
+    JsonWriter& JsonWriter::beginObject() {
+        separate();
+        this->buffer.push_back('{');
+        this->needComma = false;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::endObject() {
+        this->buffer.push_back('}');
+        this->needComma = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::beginArray() {
+        separate();
+        this->buffer.push_back('[');
+        this->needComma = false;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::endArray() {
+        this->buffer.push_back(']');
+        this->needComma = true;
+        return *this;
+    }
+
+    /**
+     * @brief Writes an object key followed by a colon.
+     *
+     * @param name The key name.
+     */
+    JsonWriter& JsonWriter::key(std::string_view name) {
+        separate();
+        writeString(name);
+        this->buffer.push_back(':');
+        this->needComma = false;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(std::string_view str) {
+        separate();
+        writeString(str);
+        this->needComma = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(const char* str) {
+        return value(std::string_view(str));
+    }
+
+    /**
+     * @brief Writes a number. Non-finite values are not representable in JSON and become null.
+     *
+     * @param number The number to write.
+     */
+    JsonWriter& JsonWriter::value(double number) {
+        if (!std::isfinite(number)) {
+            return null();
+        }
+        separate();
+        char tmp[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto end = std::to_chars(tmp, tmp + sizeof(tmp), number).ptr;
+        this->buffer.append(tmp, end);
+#else
+        int len = std::snprintf(tmp, sizeof(tmp), "%.9g", number);
+        this->buffer.append(tmp, static_cast<std::size_t>(len));
+#endif
+        this->needComma = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(std::int64_t number) {
+        separate();
+        char tmp[24];
+        auto end = std::to_chars(tmp, tmp + sizeof(tmp), number).ptr;
+        this->buffer.append(tmp, end);
+        this->needComma = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(int number) {
+        return value(static_cast<std::int64_t>(number));
+    }
+
+    JsonWriter& JsonWriter::value(bool boolean) {
+        separate();
+        this->buffer.append(boolean ? "true" : "false");
+        this->needComma = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::null() {
+        separate();
+        this->buffer.append("null");
+        this->needComma = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::raw(std::string_view json) {
+        separate();
+        this->buffer.append(json);
+        this->needComma = true;
+        return *this;
+    }
+
+    const std::string& JsonWriter::str() const {
+        return this->buffer;
+    }
+
+    std::string JsonWriter::release() {
+        this->needComma = false;
+        return std::move(this->buffer);
+    }
+
+    void JsonWriter::separate() {
+        if (this->needComma) {
+            this->buffer.push_back(',');
+        }
+    }
+
+    /**
+     * @brief Appends a quoted, escaped JSON string.
+     *
+     * Clean runs between escapes are located with the SIMD scanner and copied in one append.
+     *
+     * @param str The raw string.
+     */
+    void JsonWriter::writeString(std::string_view str) {
+        this->buffer.push_back('"');
+        const char* data = str.data();
+        std::size_t remaining = str.size();
+
+        while (remaining > 0) {
+            std::size_t clean = findEscape(data, remaining);
+            this->buffer.append(data, clean);
+            if (clean == remaining) {
+                break;
+            }
+
+            unsigned char c = static_cast<unsigned char>(data[clean]);
+            switch (c) {
+                case '"':  this->buffer.append("\\\""); break;
+                case '\\': this->buffer.append("\\\\"); break;
+                case '\n': this->buffer.append("\\n"); break;
+                case '\r': this->buffer.append("\\r"); break;
+                case '\t': this->buffer.append("\\t"); break;
+                case '\b': this->buffer.append("\\b"); break;
+                case '\f': this->buffer.append("\\f"); break;
+                default: {
+                    char escaped[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                    this->buffer.append(escaped, sizeof(escaped));
+                }
+            }
+            data += clean + 1;
+            remaining -= clean + 1;
+        }
+        this->buffer.push_back('"');
+    }
+
+}
@@ -0,0 +1,159 @@
+#include <serializer/resultSerializer.hpp>
+#include <serializer/jsonWriter.hpp>
+#include <chrono>
+
+namespace serializer {
+
+    /**
+     * @brief Serializes ranked search results straight into a JSON buffer.
+     * 
+     * The buffer is pre-sized from the URL lengths so that the writer never reallocates
+     * for typical (escape-free) URLs.
+     * 
+     * @param results The ranked search results.
+     * @param details Whether to emit result objects instead of bare URLs.
+     * @return std::string The serialized JSON array.
+     */
+    std::string serializeResults(const std::vector<searcher::SearchResult>& results, bool details){
+        // Per entry overhead: quotes and comma, plus keys and the score when details are requested
+        const std::size_t perEntry = details ? 40 : 3;
+        std::size_t estimate = 2;
+        for(const searcher::SearchResult& result: results){
+            estimate += result.url.size() + perEntry;
+        }
+
+        JsonWriter writer(estimate);
+        writer.beginArray();
+        for(const searcher::SearchResult& result: results){
+            if(details){
+                writer.beginObject()
+                    .key("url").value(result.url)
+                    .key("score").value(static_cast<double>(result.score))
+                    .endObject();
+            } else {
+                writer.value(result.url);
+            }
+        }
+        writer.endArray();
+
+        return writer.release();
+    }
+
+    // Converts a stage duration to fractional milliseconds
+    static double millis(std::chrono::nanoseconds duration){
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    /**
+     * @brief Writes a query trace as a JSON object, with stage times in milliseconds.
+     * 
+     * @param writer The writer receiving the object.
+     * @param trace The trace of a search request.
+     */
+    void writeTrace(JsonWriter& writer, const searcher::QueryTrace& trace){
+        writer.beginObject()
+            .key("query").value(trace.query)
+            .key("cache").value(trace.cache)
+            .key("partial").value(trace.partial)
+            .key("documentsScored").value(static_cast<std::int64_t>(trace.documentsScored))
+            .key("partitions").value(static_cast<std::int64_t>(trace.partitions))
+            .key("candidates").value(static_cast<std::int64_t>(trace.candidates))
+            .key("terms").beginArray();
+        for(const searcher::TermTrace& term: trace.terms){
+            writer.beginObject()
+                .key("term").value(term.term)
+                .key("postings").value(static_cast<std::int64_t>(term.postings))
+                .key("expansions").value(static_cast<std::int64_t>(term.expansions))
+                .endObject();
+        }
+        writer.endArray()
+            .key("stagesMs").beginObject()
+                .key("statsFetch").value(millis(trace.statsFetch))
+                .key("postingFetch").value(millis(trace.postingFetch))
+                .key("decode").value(millis(trace.decode))
+                .key("score").value(millis(trace.score))
+                .key("select").value(millis(trace.select))
+                .key("rerank").value(millis(trace.rerank))
+                .key("serialize").value(millis(trace.serialize))
+                .key("total").value(millis(trace.total))
+            .endObject()
+        .endObject();
+    }
+
+    /**
+     * @brief Wraps serialized results and their trace into a single response body.
+     * 
+     * @param results The serialized results, as returned by serializeResults.
+     * @param trace The trace of the search request.
+     * @return std::string The JSON object {"results": ..., "trace": {...}}.
+     */
+    std::string serializeTraced(const std::string& results, const searcher::QueryTrace& trace){
+        JsonWriter writer(results.size() + 512);
+        writer.beginObject().key("results").raw(results).key("trace");
+        writeTrace(writer, trace);
+        writer.endObject();
+        return writer.release();
+    }
+
+    /**
+     * @brief Serializes the posting counts of a shard, the first phase of a sharded search.
+     * 
+     * @param counts The posting count of every query term.
+     * @return std::string The JSON object {"terms": [{"term": ..., "postings": ...}, ...]}.
+     */
+    std::string serializeTermCounts(const std::vector<searcher::TermTrace>& counts){
+        JsonWriter writer(64 + counts.size() * 48);
+        writer.beginObject().key("terms").beginArray();
+        for(const searcher::TermTrace& count: counts){
+            writer.beginObject()
+                .key("term").value(count.term)
+                .key("postings").value(static_cast<std::int64_t>(count.postings))
+                .endObject();
+        }
+        writer.endArray().endObject();
+        return writer.release();
+    }
+
+    /**
+     * @brief Serializes the top-k of a shard, the second phase of a sharded search.
+     * 
+     * The scores are sums of impacts divided by the impact scale, so they survive the
+     * round-trip through JSON exactly and ties between shards are broken the same way.
+     * 
+     * @param response The search response of the shard.
+     * @return std::string The JSON object {"partial": ..., "documentsScored": ..., "results": [{"url": ..., "score": ...}, ...]}.
+     */
+    std::string serializeShardResponse(const searcher::SearchResponse& response){
+        std::string results = serializeResults(response.results, true);
+        JsonWriter writer(results.size() + 64);
+        writer.beginObject()
+            .key("partial").value(response.partial)
+            .key("documentsScored").value(static_cast<std::int64_t>(response.trace.documentsScored))
+            .key("results").raw(results)
+            .endObject();
+        return writer.release();
+    }
+
+    /**
+     * @brief Serializes the completions of a prefix.
+     * 
+     * @param prefix The completed prefix.
+     * @param suggestions The suggestions, heaviest first.
+     * @return std::string The JSON object {"prefix": ..., "suggestions": [{"term": ..., "weight": ...}, ...]}.
+     */
+    std::string serializeSuggestions(const std::string& prefix, const std::vector<suggest::Suggestion>& suggestions){
+        JsonWriter writer(64 + prefix.size() + suggestions.size() * 48);
+        writer.beginObject()
+            .key("prefix").value(prefix)
+            .key("suggestions").beginArray();
+        for(const suggest::Suggestion& suggestion: suggestions){
+            writer.beginObject()
+                .key("term").value(suggestion.term)
+                .key("weight").value(static_cast<std::int64_t>(suggestion.weight))
+                .endObject();
+        }
+        writer.endArray().endObject();
+        return writer.release();
+    }
+
+}
@@ -0,0 +1,132 @@
+#include <shard/shardClient.hpp>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace shard {
+
+    /**
+     * @brief Parses "host:port".
+     *
+     * @param address The address string.
+     * @return Endpoint The parsed endpoint.
+     * @throws std::invalid_argument If the port is missing or invalid.
+     */
+    Endpoint Endpoint::parse(const std::string& address) {
+        std::size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon + 1 == address.size()) {
+            throw std::invalid_argument("expected host:port, got " + address);
+        }
+        Endpoint endpoint;
+        endpoint.host = address.substr(0, colon);
+        endpoint.port = std::stoi(address.substr(colon + 1));
+        return endpoint;
+    }
+
+    namespace {
+
+        // Closes the socket when leaving the scope
+        struct Socket {
+            int fd;
+            ~Socket() { if (fd >= 0) close(fd); }
+        };
+
+        bool sendAll(int fd, const char* data, std::size_t size) {
+            while (size > 0) {
+                ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+                if (sent <= 0) return false;
+                data += sent;
+                size -= static_cast<std::size_t>(sent);
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Sends a POST request to a shard on a fresh connection and reads the response until the shard closes it.
+     *
+     * @param endpoint The shard address.
+     * @param target The request target including the query string.
+     * @param timeout Socket timeout and deadline of the request.
+     * @return Reply The response.
+     */
+    Reply post(const Endpoint& endpoint, const std::string& target, std::chrono::milliseconds timeout) {
+        Reply reply;
+
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(endpoint.host.c_str(), std::to_string(endpoint.port).c_str(), &hints, &addresses) != 0 || !addresses) {
+            reply.error = "cannot resolve " + endpoint.host;
+            return reply;
+        }
+
+        Socket sock{socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol)};
+        if (sock.fd < 0) {
+            freeaddrinfo(addresses);
+            reply.error = std::strerror(errno);
+            return reply;
+        }
+
+        long timeoutMs = std::max<long>(1, static_cast<long>(timeout.count()));
+        timeval socketTimeout{timeoutMs / 1000, static_cast<int>((timeoutMs % 1000) * 1000)};
+        setsockopt(sock.fd, SOL_SOCKET, SO_RCVTIMEO, &socketTimeout, sizeof(socketTimeout));
+        setsockopt(sock.fd, SOL_SOCKET, SO_SNDTIMEO, &socketTimeout, sizeof(socketTimeout));
+        int noDelay = 1;
+        setsockopt(sock.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        int connected = connect(sock.fd, addresses->ai_addr, addresses->ai_addrlen);
+        freeaddrinfo(addresses);
+        if (connected != 0) {
+            reply.error = std::string("connect: ") + std::strerror(errno);
+            return reply;
+        }
+
+        std::string request = "POST " + target + " HTTP/1.1\r\n"
+                              "Host: " + endpoint.host + "\r\n"
+                              "Connection: close\r\n"
+                              "X-Deadline-Ms: " + std::to_string(timeoutMs) + "\r\n"
+                              "Content-Length: 0\r\n\r\n";
+        if (!sendAll(sock.fd, request.data(), request.size())) {
+            reply.error = std::string("send: ") + std::strerror(errno);
+            return reply;
+        }
+
+        std::string response;
+        char buffer[16384];
+        while (true) {
+            ssize_t received = recv(sock.fd, buffer, sizeof(buffer), 0);
+            if (received < 0) {
+                reply.error = std::string("recv: ") + std::strerror(errno);
+                return reply;
+            }
+            if (received == 0) break;
+            response.append(buffer, static_cast<std::size_t>(received));
+        }
+
+        // Status line: HTTP/1.1 200 OK, the body follows the blank line after the headers
+        std::size_t space = response.find(' ');
+        std::size_t headerEnd = response.find("\r\n\r\n");
+        if (response.compare(0, 5, "HTTP/") != 0 || space == std::string::npos || headerEnd == std::string::npos) {
+            reply.error = "malformed response";
+            return reply;
+        }
+        reply.status = std::atoi(response.c_str() + space + 1);
+        reply.body = response.substr(headerEnd + 4);
+        return reply;
+    }
+
+}
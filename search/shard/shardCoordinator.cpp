@@ -0,0 +1,288 @@
+#include <shard/shardCoordinator.hpp>
+#include <http/queryString.hpp>
+#include "jetplusplus/json/jsonConverter.hpp"
+#include "jetplusplus/json/value.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace shard {
+
+    namespace {
+        // Time the shards get when the request itself has no deadline
+        const std::chrono::milliseconds UNBOUNDED_SHARD_TIMEOUT(10000);
+    }
+
+    /**
+     * @brief Constructor for the ShardCoordinator class.
+     *
+     * @param shards The shard searchers, in shard order.
+     * @param pool The pool the shard requests are sent from, reserved for blocking I/O; the calling thread takes part.
+     */
+    ShardCoordinator::ShardCoordinator(std::vector<Endpoint> shards, threadpool::ThreadPool& pool) : shards(std::move(shards)), pool(pool) {
+    }
+
+    /**
+     * @brief Searches all shards and merges their results.
+     *
+     * Both phases send their requests to all shards in parallel. In the trace, statsFetch is
+     * the first phase, postingFetch the second (the slowest shard's search) and select the merge.
+     *
+     * @param query The normalized search query string.
+     * @param deadline The deadline of the search request, forwarded to the shards.
+     * @param fuzzy Whether the shards expand terms unknown to all of them to similar terms.
+     * @param ranking How the shards rank their results; every shard re-ranks its own candidates.
+     * @return searcher::SearchResponse The merged top-k, flagged as partial if a shard is missing.
+     * @throws std::runtime_error If no shard answered.
+     */
+    searcher::SearchResponse ShardCoordinator::search(const std::string& query, const searcher::Deadline& deadline, bool fuzzy, const ranking::RankingOptions& ranking) {
+        this->queries++;
+        searcher::SearchResponse response;
+        searcher::QueryTrace& trace = response.trace;
+        trace.query = query;
+        trace.partitions = this->shards.size();
+        std::string encodedQuery = http::encodeTerms(query);
+
+        // Phase 1: posting counts of every term on every shard
+        auto phaseStart = std::chrono::steady_clock::now();
+        std::vector<std::vector<searcher::TermTrace>> counts(this->shards.size());
+        std::vector<char> counted(this->shards.size(), 0);
+        this->pool.parallelFor(this->shards.size(), [&](std::size_t s) {
+            Reply reply = post(this->shards[s], "/shard/terms?q=" + encodedQuery, shardTimeout(deadline));
+            counted[s] = reply.status == 200 && parseTermCounts(reply.body, counts[s]);
+            if (!counted[s]) {
+                std::cerr << "Shard " << s << " failed to count postings: " << (reply.error.empty() ? "status " + std::to_string(reply.status) : reply.error) << std::endl;
+            }
+        });
+
+        // Document frequency of every term across the shards that answered
+        std::vector<std::int64_t> globalPostings;
+        for (std::size_t s = 0; s < this->shards.size(); s++) {
+            if (!counted[s]) {
+                this->shardFailures++;
+                response.partial = true;
+                continue;
+            }
+            if (globalPostings.empty()) {
+                globalPostings.assign(counts[s].size(), 0);
+                for (const searcher::TermTrace& count : counts[s]) {
+                    trace.terms.push_back(searcher::TermTrace{count.term, 0});
+                }
+            }
+            for (std::size_t t = 0; t < counts[s].size() && t < globalPostings.size(); t++) {
+                globalPostings[t] += static_cast<std::int64_t>(counts[s][t].postings);
+                trace.terms[t].postings += counts[s][t].postings;
+            }
+        }
+        trace.statsFetch = std::chrono::steady_clock::now() - phaseStart;
+
+        // Phase 2: top-k of every shard, scored with the global frequencies
+        std::string target = "/shard/search?q=" + encodedQuery + "&df=";
+        for (std::size_t t = 0; t < globalPostings.size(); t++) {
+            if (t > 0) target.push_back('+');
+            target += std::to_string(globalPostings[t]);
+        }
+        if (!fuzzy) {
+            target += "&fuzzy=false";
+        }
+        if (!ranking.standard()) {
+            target += "&" + ranking.parameters();
+        }
+
+        phaseStart = std::chrono::steady_clock::now();
+        std::vector<searcher::SearchResponse> shardResponses(this->shards.size());
+        std::vector<char> answered(this->shards.size(), 0);
+        this->pool.parallelFor(this->shards.size(), [&](std::size_t s) {
+            if (!counted[s]) return;
+            Reply reply = post(this->shards[s], target, shardTimeout(deadline));
+            answered[s] = reply.status == 200 && parseShardResponse(reply.body, shardResponses[s]);
+            if (!answered[s]) {
+                std::cerr << "Shard " << s << " failed to search: " << (reply.error.empty() ? "status " + std::to_string(reply.status) : reply.error) << std::endl;
+            }
+        });
+        trace.postingFetch = std::chrono::steady_clock::now() - phaseStart;
+
+        // Merge the top-k lists
+        phaseStart = std::chrono::steady_clock::now();
+        bool anyAnswered = false;
+        for (std::size_t s = 0; s < this->shards.size(); s++) {
+            if (!answered[s]) {
+                if (counted[s]) {
+                    this->shardFailures++;
+                    response.partial = true;
+                }
+                continue;
+            }
+            anyAnswered = true;
+            response.partial = response.partial || shardResponses[s].partial;
+            trace.documentsScored += shardResponses[s].trace.documentsScored;
+            for (searcher::SearchResult& result : shardResponses[s].results) {
+                response.results.push_back(std::move(result));
+            }
+        }
+        if (!anyAnswered) {
+            throw std::runtime_error("no shard answered");
+        }
+
+        std::size_t count = std::min(searcher::MAX_RESULTS, response.results.size());
+        std::partial_sort(response.results.begin(), response.results.begin() + count, response.results.end(), [](const searcher::SearchResult& a, const searcher::SearchResult& b) {
+            return a.score != b.score ? a.score > b.score : a.url < b.url;
+        });
+        response.results.resize(count);
+        trace.select = std::chrono::steady_clock::now() - phaseStart;
+        trace.partial = response.partial;
+        return response;
+    }
+
+    /**
+     * @brief Completes a prefix on all shards and merges the suggestions.
+     *
+     * Every shard is asked for more suggestions than returned, so that the sums of terms
+     * ranked lower on single shards are more complete; the merge stays approximate.
+     *
+     * @param prefix The prefix.
+     * @param limit The maximum number of suggestions.
+     * @param deadline The deadline of the request, forwarded to the shards.
+     * @return std::vector<suggest::Suggestion> The suggestions, heaviest first.
+     * @throws std::runtime_error If no shard answered.
+     */
+    std::vector<suggest::Suggestion> ShardCoordinator::suggest(const std::string& prefix, std::size_t limit, const searcher::Deadline& deadline) {
+        std::string target = "/shard/suggest?prefix=" + http::urlEncode(prefix) + "&limit=" + std::to_string(std::min(limit * SUGGEST_OVERFETCH, MAX_SHARD_SUGGESTIONS));
+        std::vector<std::vector<suggest::Suggestion>> shardSuggestions(this->shards.size());
+        std::vector<char> answered(this->shards.size(), 0);
+        this->pool.parallelFor(this->shards.size(), [&](std::size_t s) {
+            Reply reply = post(this->shards[s], target, shardTimeout(deadline));
+            answered[s] = reply.status == 200 && parseSuggestions(reply.body, shardSuggestions[s]);
+            if (!answered[s]) {
+                std::cerr << "Shard " << s << " failed to suggest: " << (reply.error.empty() ? "status " + std::to_string(reply.status) : reply.error) << std::endl;
+            }
+        });
+
+        std::unordered_map<std::string, std::uint64_t> weights;
+        bool anyAnswered = false;
+        for (std::size_t s = 0; s < this->shards.size(); s++) {
+            if (!answered[s]) {
+                this->shardFailures++;
+                continue;
+            }
+            anyAnswered = true;
+            for (const suggest::Suggestion& suggestion : shardSuggestions[s]) {
+                weights[suggestion.term] += suggestion.weight;
+            }
+        }
+        if (!anyAnswered) {
+            throw std::runtime_error("no shard answered");
+        }
+
+        std::vector<suggest::Suggestion> merged;
+        merged.reserve(weights.size());
+        for (const auto& weight : weights) {
+            merged.push_back(suggest::Suggestion{weight.first, static_cast<std::uint32_t>(std::min<std::uint64_t>(weight.second, UINT32_MAX))});
+        }
+        std::size_t count = std::min(limit, merged.size());
+        std::partial_sort(merged.begin(), merged.begin() + count, merged.end(), [](const suggest::Suggestion& a, const suggest::Suggestion& b) {
+            return a.weight != b.weight ? a.weight > b.weight : a.term < b.term;
+        });
+        merged.resize(count);
+        return merged;
+    }
+
+    /**
+     * @brief Returns the counters.
+     *
+     * @return CoordinatorStats The current counters.
+     */
+    CoordinatorStats ShardCoordinator::stats() const {
+        CoordinatorStats stats;
+        stats.shards = this->shards.size();
+        stats.queries = this->queries.load();
+        stats.shardFailures = this->shardFailures.load();
+        return stats;
+    }
+
+    /**
+     * @brief Parses the posting counts returned by a shard.
+     *
+     * @param body The response body of /shard/terms.
+     * @param counts Receives the count of every term, in query order.
+     * @return True if the body was well-formed.
+     */
+    bool ShardCoordinator::parseTermCounts(const std::string& body, std::vector<searcher::TermTrace>& counts) {
+        try {
+            jetpp::JsonConverter converter;
+            jetpp::JsonValue json = converter.stringToJson(body);
+            if (json.type != jetpp::JsonValue::OBJECT || json.asObject["terms"].type != jetpp::JsonValue::ARRAY) {
+                return false;
+            }
+            for (jetpp::JsonValue& term : json.asObject["terms"].asArray) {
+                counts.push_back(searcher::TermTrace{term.asObject["term"].asString, static_cast<std::size_t>(term.asObject["postings"].asNumber)});
+            }
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing shard posting counts: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    /**
+     * @brief Parses the top-k returned by a shard.
+     *
+     * @param body The response body of /shard/search.
+     * @param response Receives the results, the partial flag and the scored postings.
+     * @return True if the body was well-formed.
+     */
+    bool ShardCoordinator::parseShardResponse(const std::string& body, searcher::SearchResponse& response) {
+        try {
+            jetpp::JsonConverter converter;
+            jetpp::JsonValue json = converter.stringToJson(body);
+            if (json.type != jetpp::JsonValue::OBJECT || json.asObject["results"].type != jetpp::JsonValue::ARRAY) {
+                return false;
+            }
+            response.partial = json.asObject["partial"].asBoolean;
+            response.trace.documentsScored = static_cast<std::size_t>(json.asObject["documentsScored"].asNumber);
+            for (jetpp::JsonValue& result : json.asObject["results"].asArray) {
+                response.results.push_back(searcher::SearchResult{result.asObject["url"].asString, static_cast<float>(result.asObject["score"].asNumber)});
+            }
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing shard results: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    /**
+     * @brief Parses the suggestions returned by a shard.
+     *
+     * @param body The response body of /shard/suggest.
+     * @param suggestions Receives the suggestions.
+     * @return True if the body was well-formed.
+     */
+    bool ShardCoordinator::parseSuggestions(const std::string& body, std::vector<suggest::Suggestion>& suggestions) {
+        try {
+            jetpp::JsonConverter converter;
+            jetpp::JsonValue json = converter.stringToJson(body);
+            if (json.type != jetpp::JsonValue::OBJECT || json.asObject["suggestions"].type != jetpp::JsonValue::ARRAY) {
+                return false;
+            }
+            for (jetpp::JsonValue& suggestion : json.asObject["suggestions"].asArray) {
+                suggestions.push_back(suggest::Suggestion{suggestion.asObject["term"].asString, static_cast<std::uint32_t>(suggestion.asObject["weight"].asNumber)});
+            }
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing shard suggestions: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    /**
+     * @brief Returns the time the shards get for a request.
+     *
+     * @param deadline The deadline of the search request.
+     * @return std::chrono::milliseconds The remaining time, capped for unbounded deadlines.
+     */
+    std::chrono::milliseconds ShardCoordinator::shardTimeout(const searcher::Deadline& deadline) {
+        return deadline.bounded() ? deadline.remaining() : UNBOUNDED_SHARD_TIMEOUT;
+    }
+
+}
@@ -0,0 +1,144 @@
+#include <slowlog/slowQueryLog.hpp>
+#include <cstdio>
+#include <iostream>
+
+namespace slowlog {
+
+    /**
+     * @brief Constructor for the SlowQueryLog class; opens the file and starts the writer.
+     *
+     * @param options The threshold, file location and rotation limits.
+     */
+    SlowQueryLog::SlowQueryLog(const SlowQueryLogOptions& options) : options(options) {
+        this->open();
+        this->writer = std::thread(&SlowQueryLog::run, this);
+    }
+
+    /**
+     * @brief Destructor; writes the pending entries and stops the writer.
+     */
+    SlowQueryLog::~SlowQueryLog() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->wake.notify_one();
+        this->writer.join();
+    }
+
+    /**
+     * @brief Checks whether a request took long enough to be logged.
+     *
+     * @param elapsed The total time of the request.
+     * @return True if elapsed is at or above the threshold.
+     */
+    bool SlowQueryLog::slow(std::chrono::nanoseconds elapsed) const {
+        return elapsed >= this->options.threshold;
+    }
+
+    /**
+     * @brief Queues an entry for the writer, dropping it if the writer is too far behind.
+     *
+     * @param line The entry, a single line of JSON without the trailing newline.
+     * @return True if the entry was queued, false if it was dropped.
+     */
+    bool SlowQueryLog::record(std::string line) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->pending.size() >= this->options.maxPending) {
+                this->counters.dropped++;
+                return false;
+            }
+            this->pending.push_back(std::move(line));
+        }
+        this->wake.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters.
+     *
+     * @return SlowQueryLogStats The current counters.
+     */
+    SlowQueryLogStats SlowQueryLog::stats() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->counters;
+    }
+
+    /**
+     * @brief Writer loop: drains the pending entries into the file in batches.
+     *
+     * The queue is swapped out under the lock so that the file I/O happens without it.
+     */
+    void SlowQueryLog::run() {
+        std::deque<std::string> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->wake.wait(lock, [this]() { return this->stopping || !this->pending.empty(); });
+                if (this->pending.empty() && this->stopping) {
+                    return;
+                }
+                batch.swap(this->pending);
+            }
+
+            std::uint64_t written = 0;
+            std::uint64_t rotations = 0;
+            for (const std::string& line : batch) {
+                if (this->fileBytes > 0 && this->fileBytes + line.size() + 1 > this->options.maxFileBytes) {
+                    this->rotate();
+                    rotations++;
+                }
+                if (!this->out) {
+                    continue;
+                }
+                this->out << line << '\n';
+                this->fileBytes += line.size() + 1;
+                written++;
+            }
+            this->out.flush();
+            batch.clear();
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->counters.written += written;
+            this->counters.rotations += rotations;
+        }
+    }
+
+    /**
+     * @brief Opens the log file for appending and picks up its current size.
+     */
+    void SlowQueryLog::open() {
+        this->out.open(this->options.path, std::ios::out | std::ios::app);
+        if (!this->out) {
+            std::cerr << "Error opening slow query log: " << this->options.path << std::endl;
+            this->fileBytes = 0;
+            return;
+        }
+        this->out.seekp(0, std::ios::end);
+        std::streamoff size = this->out.tellp();
+        this->fileBytes = size > 0 ? static_cast<std::size_t>(size) : 0;
+    }
+
+    /**
+     * @brief Shifts path.(N-1) to path.N, ..., path to path.1 and starts a fresh file.
+     *
+     * The oldest file is overwritten by the rename, so at most maxFiles rotated files are kept.
+     */
+    void SlowQueryLog::rotate() {
+        this->out.close();
+        if (this->options.maxFiles == 0) {
+            std::remove(this->options.path.c_str());
+        } else {
+            for (std::size_t i = this->options.maxFiles; i > 1; i--) {
+                std::string from = this->options.path + "." + std::to_string(i - 1);
+                std::string to = this->options.path + "." + std::to_string(i);
+                std::rename(from.c_str(), to.c_str());
+            }
+            std::string first = this->options.path + ".1";
+            std::rename(this->options.path.c_str(), first.c_str());
+        }
+        this->open();
+    }
+
+}
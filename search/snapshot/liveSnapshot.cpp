@@ -0,0 +1,175 @@
+#include <snapshot/liveSnapshot.hpp>
+#include <db/searchdb.hpp>
+#include <iostream>
+
+namespace snapshot {
+
+    namespace {
+        std::int64_t nowMs() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    /**
+     * @brief Constructor for the LiveSnapshot class; maps the snapshot and starts polling.
+     *
+     * Polling starts at the creation time of the snapshot, which the indexer takes before it
+     * reads the first term, so every term written during or after the export is caught.
+     *
+     * @param path The path of the snapshot file.
+     * @param pollInterval The time between two polls for updated terms.
+     * @throws std::runtime_error If the snapshot cannot be opened.
+     */
+    LiveSnapshot::LiveSnapshot(const std::string& path, std::chrono::milliseconds pollInterval)
+        : path(path), snapshot(Snapshot::open(path)), pollInterval(pollInterval) {
+        this->sinceMs = this->snapshot->header().createdMs - searcher_db::UPDATE_SKEW.count();
+        this->poller = std::thread(&LiveSnapshot::run, this);
+    }
+
+    /**
+     * @brief Destructor; stops the poller.
+     */
+    LiveSnapshot::~LiveSnapshot() {
+        {
+            std::lock_guard<std::mutex> lock(this->stopMutex);
+            this->stopping = true;
+        }
+        this->stopSignal.notify_all();
+        this->poller.join();
+    }
+
+    /**
+     * @brief Gets the corpus statistics of the snapshot, unless the database has moved to newer ones.
+     *
+     * @param stats Receives the statistics.
+     * @return True if the snapshot is current and its statistics were returned.
+     */
+    bool LiveSnapshot::stats(impact::CorpusStats& stats) const {
+        if (this->outdated.load()) {
+            return false;
+        }
+        stats = this->snapshot->stats();
+        return true;
+    }
+
+    /**
+     * @brief Gets the impact-ordered postings of a term, unless it changed since the export.
+     *
+     * A term missing from a current snapshot has no postings in this shard, unless it was
+     * added after the export, in which case the poller has marked it stale.
+     *
+     * @param term The term.
+     * @param postings Receives the postings, highest impact first.
+     * @return True if the snapshot answered; false if the term has to be read from the database.
+     */
+    bool LiveSnapshot::postings(const std::string& term, std::vector<impact::ImpactPosting>& postings) {
+        bool fresh = !this->outdated.load();
+        if (fresh) {
+            std::shared_lock<std::shared_mutex> lock(this->staleMutex);
+            fresh = this->stale.count(term) == 0;
+        }
+        if (!fresh) {
+            this->misses++;
+            return false;
+        }
+        this->snapshot->find(term, postings);
+        this->hits++;
+        return true;
+    }
+
+    /**
+     * @brief Marks a term as changed since the export, ahead of the next poll.
+     *
+     * @param term The term.
+     */
+    void LiveSnapshot::invalidate(const std::string& term) {
+        std::unique_lock<std::shared_mutex> lock(this->staleMutex);
+        this->stale.insert(term);
+    }
+
+    /**
+     * @brief Bypasses the whole snapshot if the corpus statistics moved to another version, ahead of the next poll.
+     *
+     * @param version The current version of the corpus statistics.
+     */
+    void LiveSnapshot::statsChanged(std::int64_t version) {
+        if (version != this->snapshot->header().statsVersion && !this->outdated.exchange(true)) {
+            std::cerr << "Snapshot " << this->path << " uses corpus statistics version " << this->snapshot->header().statsVersion
+                      << ", the index is at " << version << "; reading from the database" << std::endl;
+        }
+    }
+
+    /**
+     * @brief Returns the state of the snapshot.
+     *
+     * @return SnapshotInfo The current state.
+     */
+    SnapshotInfo LiveSnapshot::info() const {
+        const SnapshotHeader& header = this->snapshot->header();
+        SnapshotInfo info;
+        info.path = this->path;
+        info.createdMs = header.createdMs;
+        info.shard = header.shard;
+        info.shards = header.shards;
+        info.statsVersion = header.statsVersion;
+        info.terms = header.termCount;
+        info.documents = header.documentCount;
+        info.postings = header.postingCount;
+        {
+            std::shared_lock<std::shared_mutex> lock(this->staleMutex);
+            info.staleTerms = this->stale.size();
+        }
+        info.outdated = this->outdated.load();
+        info.lastPollMs = this->lastPollMs.load();
+        info.hits = this->hits.load();
+        info.misses = this->misses.load();
+        return info;
+    }
+
+    /**
+     * @brief Poller loop: polls right away, then every pollInterval until the destructor runs.
+     */
+    void LiveSnapshot::run() {
+        std::unique_lock<std::mutex> lock(this->stopMutex);
+        while (!this->stopping) {
+            lock.unlock();
+            this->poll();
+            lock.lock();
+            this->stopSignal.wait_for(lock, this->pollInterval, [this]() { return this->stopping; });
+        }
+    }
+
+    /**
+     * @brief Fetches the updated terms and the corpus statistics once.
+     *
+     * The next poll starts UPDATE_SKEW before the newest stamp seen, so a term written by an
+     * indexer whose clock lags behind is not missed; terms seen twice are harmless.
+     */
+    void LiveSnapshot::poll() {
+        if (this->outdated.load()) {
+            return;
+        }
+        try {
+            searcher_db::SearcherDB db;
+            impact::CorpusStats current = db.getCorpusStats();
+            if (current.version != this->snapshot->header().statsVersion) {
+                this->outdated = true;
+                std::cerr << "Snapshot " << this->path << " uses corpus statistics version " << this->snapshot->header().statsVersion
+                          << ", the index is at " << current.version << "; reading from the database" << std::endl;
+                return;
+            }
+
+            std::int64_t newestMs = this->sinceMs + searcher_db::UPDATE_SKEW.count();
+            std::vector<std::string> updated = db.getUpdatedTerms(this->sinceMs, newestMs);
+            if (!updated.empty()) {
+                std::unique_lock<std::shared_mutex> lock(this->staleMutex);
+                this->stale.insert(updated.begin(), updated.end());
+            }
+            this->sinceMs = newestMs - searcher_db::UPDATE_SKEW.count();
+            this->lastPollMs = nowMs();
+        } catch (const std::exception& e) {
+            std::cerr << "Error polling updates for snapshot " << this->path << ": " << e.what() << std::endl;
+        }
+    }
+
+}
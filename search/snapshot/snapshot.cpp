@@ -0,0 +1,189 @@
+#include <snapshot/snapshot.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace snapshot {
+
+    /**
+     * @brief Maps and validates a snapshot file.
+     *
+     * The file descriptor is closed right after mapping; the mapping keeps the file alive,
+     * so the indexer may replace the path with a newer snapshot at any time.
+     *
+     * @param path The path of the snapshot.
+     * @return std::unique_ptr<Snapshot> The opened snapshot.
+     * @throws std::runtime_error If the file cannot be mapped or is not a valid snapshot.
+     */
+    std::unique_ptr<Snapshot> Snapshot::open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open snapshot " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+            ::close(fd);
+            throw std::runtime_error("snapshot " + path + " is truncated");
+        }
+
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("cannot map snapshot " + path + ": " + std::strerror(errno));
+        }
+
+        std::unique_ptr<Snapshot> snapshot(new Snapshot());
+        snapshot->data = static_cast<const unsigned char*>(mapping);
+        snapshot->size = static_cast<std::size_t>(info.st_size);
+        snapshot->validate(path);
+        return snapshot;
+    }
+
+    /**
+     * @brief Destructor; unmaps the file.
+     */
+    Snapshot::~Snapshot() {
+        if (this->data) {
+            munmap(const_cast<unsigned char*>(this->data), this->size);
+        }
+    }
+
+    /**
+     * @brief Returns the header of the snapshot.
+     *
+     * @return const SnapshotHeader& The header.
+     */
+    const SnapshotHeader& Snapshot::header() const {
+        return *this->head;
+    }
+
+    /**
+     * @brief Returns the corpus statistics the impacts of the snapshot were computed with.
+     *
+     * @return impact::CorpusStats The statistics.
+     */
+    impact::CorpusStats Snapshot::stats() const {
+        impact::CorpusStats stats;
+        stats.totalDocuments = this->head->totalDocuments;
+        stats.avgDocLength = this->head->avgDocLength;
+        stats.version = this->head->statsVersion;
+        return stats;
+    }
+
+    /**
+     * @brief Looks up the impact-ordered postings of a term by binary search over the dictionary.
+     *
+     * @param term The term.
+     * @param postings Receives the postings, highest impact first; empty for an unknown term.
+     * @return True if the term is in the snapshot.
+     */
+    bool Snapshot::find(const std::string& term, std::vector<impact::ImpactPosting>& postings) const {
+        postings.clear();
+        const TermEntry* end = this->terms + this->head->termCount;
+        const TermEntry* entry = std::lower_bound(this->terms, end, term, [this](const TermEntry& candidate, const std::string& key) {
+            return this->name(candidate) < key;
+        });
+        if (entry == end || this->name(*entry) != term) {
+            return false;
+        }
+
+        const std::uint32_t* docIds = reinterpret_cast<const std::uint32_t*>(this->data + entry->postingsOffset);
+        const std::uint16_t* impacts = reinterpret_cast<const std::uint16_t*>(docIds + entry->postingCount);
+        std::vector<std::string> urls;
+        this->documents.urls(docIds, entry->postingCount, urls);
+        postings.reserve(entry->postingCount);
+        for (std::uint32_t i = 0; i < entry->postingCount; i++) {
+            postings.push_back(impact::ImpactPosting{std::move(urls[i]), impacts[i]});
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the URL of a document id.
+     *
+     * @param id The document id, below header().documentCount.
+     * @return std::string The URL, decoded from the document table.
+     */
+    std::string Snapshot::url(std::uint32_t id) const {
+        std::string url;
+        this->documents.url(id, url);
+        return url;
+    }
+
+    /**
+     * @brief Returns the name of a dictionary entry.
+     *
+     * @param entry The entry.
+     * @return std::string_view The term, viewing the mapping.
+     */
+    std::string_view Snapshot::name(const TermEntry& entry) const {
+        return std::string_view(this->termNames + entry.nameOffset, entry.nameLength);
+    }
+
+    /**
+     * @brief Checks the header, the section bounds and the checksum.
+     *
+     * Every offset that lookups follow is checked here, so a corrupt or truncated file is
+     * rejected at startup rather than read out of bounds while serving.
+     *
+     * @param path The path of the snapshot, for error messages.
+     * @throws std::runtime_error If the snapshot is invalid.
+     */
+    void Snapshot::validate(const std::string& path) {
+        auto fail = [&path](const std::string& reason) {
+            throw std::runtime_error("invalid snapshot " + path + ": " + reason);
+        };
+
+        this->head = reinterpret_cast<const SnapshotHeader*>(this->data);
+        const SnapshotHeader& h = *this->head;
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) fail("bad magic");
+        if (h.formatVersion != FORMAT_VERSION) fail("unsupported format version " + std::to_string(h.formatVersion));
+        if (h.headerSize != sizeof(SnapshotHeader)) fail("unexpected header size");
+        if (h.fileSize != this->size) fail("file size does not match the header");
+
+        // Sections in file order, each within the file
+        if (h.postingsOffset != sizeof(SnapshotHeader) ||
+            h.documentsOffset < h.postingsOffset ||
+            h.documentsOffset % 8 != 0 ||
+            h.termsOffset < h.documentsOffset ||
+            h.termsOffset > this->size ||
+            h.documentCount >= UINT32_MAX ||
+            h.termCount * sizeof(TermEntry) > this->size - h.termsOffset) {
+            fail("section bounds");
+        }
+
+        if (checksum(0, this->data + sizeof(SnapshotHeader), this->size - sizeof(SnapshotHeader)) != h.checksum) {
+            fail("checksum mismatch");
+        }
+
+        if (!this->documents.open(this->data + h.documentsOffset, h.termsOffset - h.documentsOffset, h.documentCount)) {
+            fail("document table");
+        }
+
+        this->terms = reinterpret_cast<const TermEntry*>(this->data + h.termsOffset);
+        this->termNames = reinterpret_cast<const char*>(this->terms + h.termCount);
+        std::uint64_t nameCapacity = this->size - h.termsOffset - h.termCount * sizeof(TermEntry);
+        for (std::uint64_t i = 0; i < h.termCount; i++) {
+            const TermEntry& entry = this->terms[i];
+            std::uint64_t postingBytes = std::uint64_t(entry.postingCount) * (sizeof(std::uint32_t) + sizeof(std::uint16_t));
+            if (entry.nameOffset + entry.nameLength > nameCapacity ||
+                entry.postingsOffset < h.postingsOffset ||
+                entry.postingsOffset % alignof(std::uint32_t) != 0 ||
+                entry.postingsOffset + postingBytes > h.documentsOffset) {
+                fail("term dictionary");
+            }
+            if (i > 0 && !(this->name(this->terms[i - 1]) < this->name(entry))) fail("term dictionary order");
+
+            const std::uint32_t* docIds = reinterpret_cast<const std::uint32_t*>(this->data + entry.postingsOffset);
+            for (std::uint32_t p = 0; p < entry.postingCount; p++) {
+                if (docIds[p] >= h.documentCount) fail("document id out of range");
+            }
+        }
+    }
+
+}
@@ -0,0 +1,198 @@
+#include <snapshot/urlTable.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace snapshot {
+
+    namespace {
+
+        /**
+         * @brief Reads a varint the table was validated to hold.
+         */
+        inline std::uint64_t readVarint(const unsigned char*& data) {
+            std::uint64_t value = 0;
+            int shift = 0;
+            while (*data & 0x80) {
+                value |= std::uint64_t(*data++ & 0x7F) << shift;
+                shift += 7;
+            }
+            return value | (std::uint64_t(*data++) << shift);
+        }
+
+        /**
+         * @brief Reads a varint within [data, end).
+         *
+         * @return False if the varint is cut off or longer than 64 bits.
+         */
+        bool checkedVarint(const unsigned char*& data, const unsigned char* end, std::uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (data >= end) {
+                    return false;
+                }
+                unsigned char byte = *data++;
+                value |= std::uint64_t(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    /**
+     * @brief Views and validates the table.
+     *
+     * Checks that the positions are a permutation of the ranks, that every offset is within
+     * the section and that every block decodes to exactly its blockSize URLs (fewer for the
+     * last) within its bytes, in byte order.
+     *
+     * @param section Start of the document table in the mapping, 8 byte aligned.
+     * @param size Size of the section.
+     * @param count Number of documents.
+     * @return True if the table is well-formed.
+     */
+    bool UrlTable::open(const unsigned char* section, std::uint64_t size, std::uint64_t count) {
+        if (size < sizeof(UrlTableHeader)) {
+            return false;
+        }
+        this->head = reinterpret_cast<const UrlTableHeader*>(section);
+        this->count = count;
+        const UrlTableHeader& h = *this->head;
+        bool hosts = (h.flags & URL_HOST_DICTIONARY) != 0;
+        if (h.blockSize == 0 || h.blockSize > MAX_URL_BLOCK_SIZE || (h.flags & ~URL_HOST_DICTIONARY) != 0 || h.blockCount != (count + h.blockSize - 1) / h.blockSize || (!hosts && h.hostCount != 0)) {
+            return false;
+        }
+
+        // Section layout, each part within the section
+        std::uint64_t offset = sizeof(UrlTableHeader);
+        std::uint64_t positionsBytes = align8(count * sizeof(std::uint32_t));
+        if (positionsBytes > size - offset) return false;
+        this->positions = reinterpret_cast<const std::uint32_t*>(section + offset);
+        offset += positionsBytes;
+
+        if ((h.blockCount + 1) * sizeof(std::uint64_t) > size - offset) return false;
+        this->blockOffsets = reinterpret_cast<const std::uint64_t*>(section + offset);
+        offset += (h.blockCount + 1) * sizeof(std::uint64_t);
+
+        this->hostOffsets = nullptr;
+        this->hostBytes = nullptr;
+        if (hosts) {
+            if (h.hostCount >= size || (h.hostCount + 1) * sizeof(std::uint64_t) > size - offset) return false;
+            this->hostOffsets = reinterpret_cast<const std::uint64_t*>(section + offset);
+            offset += (h.hostCount + 1) * sizeof(std::uint64_t);
+            this->hostBytes = reinterpret_cast<const char*>(section + offset);
+            for (std::uint64_t i = 0; i < h.hostCount; i++) {
+                if (this->hostOffsets[i] > this->hostOffsets[i + 1]) return false;
+            }
+            if (this->hostOffsets[0] != 0 || this->hostOffsets[h.hostCount] > size - offset) return false;
+            offset += align8(this->hostOffsets[h.hostCount]);
+        }
+
+        if (offset > size || h.blockBytes > size - offset) return false;
+        this->blocks = section + offset;
+
+        std::vector<bool> seen(count, false);
+        for (std::uint64_t id = 0; id < count; id++) {
+            if (this->positions[id] >= count || seen[this->positions[id]]) return false;
+            seen[this->positions[id]] = true;
+        }
+
+        // Decode every block with bounds checks
+        std::string previous;
+        std::string url;
+        for (std::uint64_t block = 0; block < h.blockCount; block++) {
+            if (this->blockOffsets[block] > this->blockOffsets[block + 1] || this->blockOffsets[block + 1] > h.blockBytes) return false;
+            const unsigned char* data = this->blocks + this->blockOffsets[block];
+            const unsigned char* end = this->blocks + this->blockOffsets[block + 1];
+            std::uint64_t urls = std::min<std::uint64_t>(h.blockSize, count - block * h.blockSize);
+            for (std::uint64_t i = 0; i < urls; i++) {
+                std::uint64_t shared = 0;
+                std::uint64_t length;
+                if (i == 0) {
+                    url.clear();
+                    if (hosts) {
+                        std::uint64_t host;
+                        if (!checkedVarint(data, end, host) || host >= h.hostCount) return false;
+                        url.assign(this->hostBytes + this->hostOffsets[host], this->hostOffsets[host + 1] - this->hostOffsets[host]);
+                    }
+                    shared = url.size();
+                } else if (!checkedVarint(data, end, shared) || shared > url.size()) {
+                    return false;
+                }
+                if (!checkedVarint(data, end, length) || length > static_cast<std::uint64_t>(end - data)) return false;
+                url.resize(shared);
+                url.append(reinterpret_cast<const char*>(data), length);
+                data += length;
+                if (block * h.blockSize + i > 0 && !(previous < url)) return false;
+                previous = url;
+            }
+            if (data != end) return false;
+        }
+        return this->blockOffsets[0] == 0 && this->blockOffsets[h.blockCount] == h.blockBytes;
+    }
+
+    /**
+     * @brief Decodes the URL of a document id.
+     *
+     * The block is scanned up to the URL without copying anything, then the URL is filled
+     * in from its back: its own suffix, then whatever part of the shared prefix each earlier
+     * URL's suffix supplied, and finally the host. Every byte is copied once.
+     *
+     * @param id The document id, below size().
+     * @param url Receives the URL.
+     */
+    void UrlTable::url(std::uint32_t id, std::string& url) const {
+        struct Piece {
+            std::uint64_t shared;   // Length of the prefix taken from the previous URL
+            const unsigned char* suffix;
+            std::uint64_t length;
+        };
+        Piece pieces[MAX_URL_BLOCK_SIZE];
+
+        std::uint32_t rank = this->positions[id];
+        std::uint32_t steps = rank % this->head->blockSize;
+        const unsigned char* data = this->blocks + this->blockOffsets[rank / this->head->blockSize];
+        const char* host = nullptr;
+        std::uint64_t hostLength = 0;
+        if (this->hostOffsets) {
+            std::uint64_t entry = readVarint(data);
+            host = this->hostBytes + this->hostOffsets[entry];
+            hostLength = this->hostOffsets[entry + 1] - this->hostOffsets[entry];
+        }
+        for (std::uint32_t i = 0; i <= steps; i++) {
+            pieces[i].shared = i == 0 ? hostLength : readVarint(data);
+            pieces[i].length = readVarint(data);
+            pieces[i].suffix = data;
+            data += pieces[i].length;
+        }
+
+        std::uint64_t limit = pieces[steps].shared + pieces[steps].length;
+        url.resize(limit);
+        char* out = &url[0];
+        for (std::uint32_t i = steps + 1; i-- > 0 && limit > 0;) {
+            if (pieces[i].shared < limit) {
+                std::memcpy(out + pieces[i].shared, pieces[i].suffix, limit - pieces[i].shared);
+                limit = pieces[i].shared;
+            }
+        }
+        if (limit > 0) {
+            std::memcpy(out, host, limit);
+        }
+    }
+
+    /**
+     * @brief Decodes the URLs of many document ids.
+     *
+     * @param ids The document ids, each below size().
+     * @param count The number of ids.
+     * @param urls Receives the URL of every id, in the order of the ids.
+     */
+    void UrlTable::urls(const std::uint32_t* ids, std::size_t count, std::vector<std::string>& urls) const {
+        urls.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            this->url(ids[i], urls[i]);
+        }
+    }
+
+}
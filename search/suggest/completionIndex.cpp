@@ -0,0 +1,264 @@
+#include <suggest/completionIndex.hpp>
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace suggest {
+
+    namespace {
+        void writeVarint(std::string& out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        std::uint64_t readVarint(const char*& in) {
+            std::uint64_t value = 0;
+            for (int shift = 0;; shift += 7) {
+                std::uint8_t byte = static_cast<std::uint8_t>(*in++);
+                value |= std::uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+        }
+
+        /**
+         * @struct Candidate
+         * @brief Entry of the best-first search: a tree node, or a single term.
+         */
+        struct Candidate {
+            std::uint32_t weight;   ///< Weight of the term, or the maximum below the node.
+            bool term;              ///< Whether index is a term rather than a tree node.
+            std::size_t index;      ///< Term index or tree node.
+
+            // Heaviest first; on equal weight, nodes before terms and lower indexes first, so ties come out in term order
+            bool operator<(const Candidate& other) const {
+                if (this->weight != other.weight) return this->weight < other.weight;
+                if (this->term != other.term) return this->term;
+                return this->index > other.index;
+            }
+        };
+    }
+
+    CompletionIndex::Builder::Builder() : index(new CompletionIndex()) {
+    }
+
+    /**
+     * @brief Appends a term, front-coded against the previous term of its block.
+     *
+     * @param term The term; terms have to be added in strictly ascending order.
+     * @param weight The weight of the term.
+     * @throws std::invalid_argument If the term is not greater than the previous one.
+     */
+    void CompletionIndex::Builder::add(std::string_view term, std::uint32_t weight) {
+        CompletionIndex& built = *this->index;
+        if (!built.weights.empty() && !(this->previous < term)) {
+            throw std::invalid_argument("completion terms must be added in ascending order");
+        }
+
+        if (built.weights.size() % BLOCK_SIZE == 0) {
+            built.blockOffsets.push_back(built.data.size());
+            writeVarint(built.data, term.size());
+            built.data.append(term.data(), term.size());
+        } else {
+            std::size_t shared = 0;
+            std::size_t limit = std::min(term.size(), this->previous.size());
+            while (shared < limit && term[shared] == this->previous[shared]) shared++;
+            writeVarint(built.data, shared);
+            writeVarint(built.data, term.size() - shared);
+            built.data.append(term.data() + shared, term.size() - shared);
+        }
+        built.weights.push_back(weight);
+        this->previous.assign(term.data(), term.size());
+    }
+
+    /**
+     * @brief Completes the index by building the max-tree over the blocks.
+     *
+     * @return std::shared_ptr<const CompletionIndex> The index; the builder is empty afterwards.
+     */
+    std::shared_ptr<const CompletionIndex> CompletionIndex::Builder::finish() {
+        std::unique_ptr<CompletionIndex> built = std::move(this->index);
+        this->index.reset(new CompletionIndex());
+        this->previous.clear();
+
+        std::size_t blocks = built->blockOffsets.size();
+        while (built->leaves < blocks) built->leaves *= 2;
+        built->tree.assign(2 * built->leaves, 0);
+        for (std::size_t i = 0; i < built->weights.size(); i++) {
+            std::uint32_t& leaf = built->tree[built->leaves + i / BLOCK_SIZE];
+            leaf = std::max(leaf, built->weights[i]);
+        }
+        for (std::size_t node = built->leaves - 1; node > 0; node--) {
+            built->tree[node] = std::max(built->tree[2 * node], built->tree[2 * node + 1]);
+        }
+        built->data.shrink_to_fit();
+        built->blockOffsets.shrink_to_fit();
+        built->weights.shrink_to_fit();
+        return std::shared_ptr<const CompletionIndex>(built.release());
+    }
+
+    /**
+     * @brief Returns the heaviest terms starting with a prefix.
+     *
+     * The prefix range is split into the partial blocks at its ends, whose terms are queued
+     * individually, and the maximal tree nodes covering the full blocks in between. Popping
+     * the heaviest candidate expands a node into its children, a leaf into its terms, and
+     * emits a term; the first limit terms popped are the result.
+     *
+     * @param prefix The prefix; empty matches every term.
+     * @param limit The maximum number of suggestions.
+     * @return std::vector<Suggestion> The suggestions by weight, heaviest first, ties in term order.
+     */
+    std::vector<Suggestion> CompletionIndex::complete(std::string_view prefix, std::size_t limit) const {
+        std::vector<Suggestion> suggestions;
+        if (limit == 0 || this->weights.empty()) {
+            return suggestions;
+        }
+
+        // [first, last) holds the terms with the prefix; the successor of the prefix bounds it
+        std::size_t first = this->lowerBound(prefix);
+        std::size_t last = this->size();
+        std::string successor(prefix);
+        while (!successor.empty() && static_cast<unsigned char>(successor.back()) == 0xff) successor.pop_back();
+        if (!successor.empty()) {
+            successor.back() = static_cast<char>(successor.back() + 1);
+            last = this->lowerBound(successor);
+        }
+        if (first >= last) {
+            return suggestions;
+        }
+
+        std::priority_queue<Candidate> queue;
+        std::size_t firstBlock = (first + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::size_t lastBlock = last / BLOCK_SIZE;
+        if (firstBlock >= lastBlock) {
+            for (std::size_t i = first; i < last; i++) queue.push(Candidate{this->weights[i], true, i});
+        } else {
+            for (std::size_t i = first; i < firstBlock * BLOCK_SIZE; i++) queue.push(Candidate{this->weights[i], true, i});
+            for (std::size_t i = lastBlock * BLOCK_SIZE; i < last; i++) queue.push(Candidate{this->weights[i], true, i});
+            for (std::size_t low = firstBlock + this->leaves, high = lastBlock + this->leaves; low < high; low /= 2, high /= 2) {
+                if (low & 1) { queue.push(Candidate{this->tree[low], false, low}); low++; }
+                if (high & 1) { high--; queue.push(Candidate{this->tree[high], false, high}); }
+            }
+        }
+
+        std::vector<std::size_t> picked;
+        while (!queue.empty() && picked.size() < limit) {
+            Candidate candidate = queue.top();
+            queue.pop();
+            if (candidate.term) {
+                picked.push_back(candidate.index);
+            } else if (candidate.index < this->leaves) {
+                queue.push(Candidate{this->tree[2 * candidate.index], false, 2 * candidate.index});
+                queue.push(Candidate{this->tree[2 * candidate.index + 1], false, 2 * candidate.index + 1});
+            } else {
+                std::size_t start = (candidate.index - this->leaves) * BLOCK_SIZE;
+                std::size_t end = std::min(start + BLOCK_SIZE, this->size());
+                for (std::size_t i = start; i < end; i++) queue.push(Candidate{this->weights[i], true, i});
+            }
+        }
+
+        // Decode each block holding a result once
+        std::unordered_map<std::size_t, std::vector<std::string>> blocks;
+        suggestions.reserve(picked.size());
+        for (std::size_t index : picked) {
+            auto block = blocks.find(index / BLOCK_SIZE);
+            if (block == blocks.end()) {
+                block = blocks.emplace(index / BLOCK_SIZE, std::vector<std::string>()).first;
+                this->decode(index / BLOCK_SIZE, block->second);
+            }
+            suggestions.push_back(Suggestion{block->second[index % BLOCK_SIZE], this->weights[index]});
+        }
+        return suggestions;
+    }
+
+    /**
+     * @brief Returns the number of terms.
+     *
+     * @return std::size_t The number of terms.
+     */
+    std::size_t CompletionIndex::size() const {
+        return this->weights.size();
+    }
+
+    /**
+     * @brief Returns the memory footprint.
+     *
+     * @return std::size_t The size of the arrays in bytes.
+     */
+    std::size_t CompletionIndex::bytes() const {
+        return this->data.capacity() + this->blockOffsets.capacity() * sizeof(std::uint64_t) +
+               this->weights.capacity() * sizeof(std::uint32_t) + this->tree.capacity() * sizeof(std::uint32_t);
+    }
+
+    /**
+     * @brief Returns the first term of a block.
+     *
+     * @param block The block.
+     * @return std::string_view The term, viewing data.
+     */
+    std::string_view CompletionIndex::head(std::size_t block) const {
+        const char* in = this->data.data() + this->blockOffsets[block];
+        std::size_t length = readVarint(in);
+        return std::string_view(in, length);
+    }
+
+    /**
+     * @brief Decodes the terms of a block.
+     *
+     * @param block The block.
+     * @param terms Receives the terms.
+     */
+    void CompletionIndex::decode(std::size_t block, std::vector<std::string>& terms) const {
+        const char* in = this->data.data() + this->blockOffsets[block];
+        std::size_t count = std::min(BLOCK_SIZE, this->size() - block * BLOCK_SIZE);
+        terms.clear();
+        terms.reserve(count);
+
+        std::size_t length = readVarint(in);
+        terms.emplace_back(in, length);
+        in += length;
+        for (std::size_t i = 1; i < count; i++) {
+            std::size_t shared = readVarint(in);
+            std::size_t suffix = readVarint(in);
+            std::string term = terms.back().substr(0, shared);
+            term.append(in, suffix);
+            in += suffix;
+            terms.push_back(std::move(term));
+        }
+    }
+
+    /**
+     * @brief Returns the index of the first term not less than a key.
+     *
+     * Binary search over the block heads, then a scan through one block.
+     *
+     * @param key The key.
+     * @return std::size_t The index, size() if every term is less.
+     */
+    std::size_t CompletionIndex::lowerBound(std::string_view key) const {
+        // Last block whose head is below the key
+        std::size_t low = 0, high = this->blockOffsets.size();
+        while (low < high) {
+            std::size_t middle = low + (high - low) / 2;
+            if (this->head(middle) < key) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low == 0) {
+            return 0;
+        }
+
+        std::size_t block = low - 1;
+        std::vector<std::string> terms;
+        this->decode(block, terms);
+        std::size_t offset = std::lower_bound(terms.begin(), terms.end(), key, [](const std::string& term, std::string_view k) { return std::string_view(term) < k; }) - terms.begin();
+        return block * BLOCK_SIZE + offset;
+    }
+
+}
@@ -0,0 +1,99 @@
+#include <suggest/suggester.hpp>
+#include <iostream>
+
+namespace suggest {
+
+    /**
+     * @brief Constructor for the Suggester class; starts the rebuild thread.
+     *
+     * @param dictionary The dictionary the terms come from; must outlive the Suggester.
+     * @param rebuildInterval The minimum time between two builds.
+     */
+    Suggester::Suggester(const dictionary::TermDictionary& dictionary, std::chrono::milliseconds rebuildInterval)
+        : dictionary(dictionary), rebuildInterval(rebuildInterval), index(CompletionIndex::Builder().finish()) {
+        this->builder = std::thread(&Suggester::run, this);
+    }
+
+    /**
+     * @brief Destructor; stops the rebuild thread.
+     */
+    Suggester::~Suggester() {
+        {
+            std::lock_guard<std::mutex> lock(this->stopMutex);
+            this->stopping = true;
+        }
+        this->stopSignal.notify_all();
+        this->builder.join();
+    }
+
+    /**
+     * @brief Returns the heaviest terms starting with a prefix.
+     *
+     * @param prefix The prefix.
+     * @param limit The maximum number of suggestions.
+     * @return std::vector<Suggestion> The suggestions, heaviest first; empty until the first build.
+     */
+    std::vector<Suggestion> Suggester::suggest(const std::string& prefix, std::size_t limit) {
+        this->queries++;
+        std::shared_ptr<const CompletionIndex> current = std::atomic_load(&this->index);
+        return current->complete(prefix, limit);
+    }
+
+    /**
+     * @brief Returns the state and counters.
+     *
+     * @return SuggesterStats The current state.
+     */
+    SuggesterStats Suggester::stats() const {
+        std::shared_ptr<const CompletionIndex> current = std::atomic_load(&this->index);
+        SuggesterStats stats;
+        stats.terms = current->size();
+        stats.bytes = current->bytes();
+        stats.builds = this->builds.load();
+        stats.queries = this->queries.load();
+        stats.lastBuildSeconds = this->lastBuildMicros.load() / 1e6;
+        return stats;
+    }
+
+    /**
+     * @brief Rebuild loop: checks for changes every rebuildInterval until the destructor runs.
+     */
+    void Suggester::run() {
+        std::unique_lock<std::mutex> lock(this->stopMutex);
+        while (!this->stopping) {
+            lock.unlock();
+            this->rebuild();
+            lock.lock();
+            this->stopSignal.wait_for(lock, this->rebuildInterval, [this]() { return this->stopping; });
+        }
+    }
+
+    /**
+     * @brief Builds a new index if the dictionary has changed since the last build.
+     *
+     * The dictionary is read in term order, which is the order the builder needs, so the
+     * build is a single streaming pass.
+     */
+    void Suggester::rebuild() {
+        std::uint64_t version = this->dictionary.version();
+        if (version == this->builtVersion) {
+            return;
+        }
+        try {
+            auto started = std::chrono::steady_clock::now();
+            CompletionIndex::Builder builder;
+            this->dictionary.forEach([&builder](std::string_view term, const dictionary::TermInfo& info) {
+                builder.add(term, info.documents);
+            });
+            std::shared_ptr<const CompletionIndex> built = builder.finish();
+            std::atomic_store(&this->index, built);
+
+            this->builtVersion = version;
+            this->builds++;
+            this->lastBuildMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+        } catch (const std::exception& e) {
+            std::cerr << "Error building the completion index: " << e.what() << std::endl;
+        }
+    }
+
+}
@@ -0,0 +1,197 @@
+#include <threadpool/threadPool.hpp>
+#include <algorithm>
+#include <exception>
+
+namespace threadpool {
+
+    namespace {
+        // The pool and queue of the current thread, if it is a worker
+        thread_local ThreadPool* workerPool = nullptr;
+        thread_local std::size_t workerIndex = 0;
+    }
+
+    /**
+     * @brief Constructor for the ThreadPool class; starts the workers.
+     *
+     * @param workers The number of worker threads (at least one).
+     */
+    ThreadPool::ThreadPool(std::size_t workers) {
+        workers = std::max<std::size_t>(1, workers);
+        for (std::size_t i = 0; i < workers; i++) {
+            this->queues.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < workers; i++) {
+            this->workers.emplace_back(&ThreadPool::run, this, i);
+        }
+    }
+
+    /**
+     * @brief Destructor; runs the queued tasks and joins the workers.
+     */
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->sleepMutex);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return std::size_t The number of workers.
+     */
+    std::size_t ThreadPool::size() const {
+        return this->workers.size();
+    }
+
+    /**
+     * @brief Queues a task on the current worker's queue, or round-robin from outside the pool.
+     *
+     * @param task The task; it must not throw.
+     */
+    void ThreadPool::submit(std::function<void()> task) {
+        std::size_t index = workerPool == this ? workerIndex : this->nextQueue++ % this->queues.size();
+        {
+            std::lock_guard<std::mutex> lock(this->queues[index]->mutex);
+            this->queues[index]->tasks.push_back(std::move(task));
+        }
+        this->pending++;
+
+        // Taking the lock orders the increment before a worker's check of its wait predicate
+        { std::lock_guard<std::mutex> lock(this->sleepMutex); }
+        this->wake.notify_one();
+    }
+
+    /**
+     * @brief Runs body(0) ... body(count - 1) on the pool and the calling thread, and waits for all of them.
+     *
+     * Helpers that start after every index has been claimed return immediately; they only
+     * touch the shared state, which outlives the call.
+     *
+     * @param count The number of indexes.
+     * @param body The function run for every index.
+     */
+    void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+        if (count == 0) {
+            return;
+        }
+
+        struct State {
+            std::atomic<std::size_t> next{0};
+            std::mutex mutex;
+            std::condition_variable done;
+            std::size_t finished = 0;
+            std::exception_ptr error;
+        };
+        auto state = std::make_shared<State>();
+        const std::function<void(std::size_t)>* work = &body;
+
+        auto runner = [state, count, work]() {
+            std::size_t index;
+            while ((index = state->next++) < count) {
+                std::exception_ptr error;
+                try {
+                    (*work)(index);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (error && !state->error) {
+                    state->error = error;
+                }
+                if (++state->finished == count) {
+                    state->done.notify_all();
+                }
+            }
+        };
+
+        std::size_t helpers = std::min(count - 1, this->size());
+        for (std::size_t i = 0; i < helpers; i++) {
+            this->submit(runner);
+        }
+        runner();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&]() { return state->finished == count; });
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters.
+     *
+     * @return ThreadPoolStats The current counters.
+     */
+    ThreadPoolStats ThreadPool::stats() {
+        ThreadPoolStats stats;
+        stats.workers = this->size();
+        stats.queued = this->pending.load();
+        stats.executed = this->executed.load();
+        stats.stolen = this->stolen.load();
+        return stats;
+    }
+
+    /**
+     * @brief Worker loop: runs tasks until the pool stops and the queues are empty.
+     *
+     * @param index The index of the worker and its queue.
+     */
+    void ThreadPool::run(std::size_t index) {
+        workerPool = this;
+        workerIndex = index;
+
+        std::function<void()> task;
+        while (true) {
+            if (this->take(index, task)) {
+                task();
+                task = nullptr;
+                this->executed++;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->sleepMutex);
+            this->wake.wait(lock, [this]() { return this->stopping || this->pending.load() > 0; });
+            if (this->stopping && this->pending.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Takes a task from the back of the worker's own queue, or steals one from the front of another queue.
+     *
+     * @param index The index of the worker.
+     * @param task Receives the task.
+     * @return True if a task was taken.
+     */
+    bool ThreadPool::take(std::size_t index, std::function<void()>& task) {
+        {
+            Queue& own = *this->queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                this->pending--;
+                return true;
+            }
+        }
+        for (std::size_t offset = 1; offset < this->queues.size(); offset++) {
+            Queue& victim = *this->queues[(index + offset) % this->queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                this->pending--;
+                this->stolen++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+#include <corpus/corpus.hpp>
+#include <dictionary/termDictionary.hpp>
+#include <fuzzy/levenshtein.hpp>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * @brief Loads a term dictionary with a synthetic vocabulary, weighted by sampled document frequency.
+     * 
+     * @param dictionary The dictionary to load.
+     * @param terms Size of the vocabulary.
+     */
+    void loadDictionary(dictionary::TermDictionary& dictionary, std::size_t terms) {
+        corpus::CorpusGenerator generator(terms, 1.0, 42);
+        std::map<std::string, std::uint32_t> frequencies;
+        for (const std::string& term : generator.vocabulary()) {
+            frequencies[term] = 0;
+        }
+        for (std::size_t i = 0; i < terms * 4; i++) {
+            frequencies[generator.term()]++;
+        }
+
+        std::vector<dictionary::TermUpdate> updates;
+        for (const auto& frequency : frequencies) {
+            updates.push_back(dictionary::TermUpdate{frequency.first, dictionary::TermInfo{frequency.second, 0}});
+        }
+        dictionary.load(std::move(updates));
+    }
+
+    /**
+     * @brief Applies one random substitution, insertion or deletion to a term.
+     * 
+     * @param term The term.
+     * @param random The random source.
+     * @return std::string The misspelled term.
+     */
+    std::string misspell(std::string term, std::mt19937& random) {
+        std::size_t position = random() % (term.size() + 1);
+        char letter = static_cast<char>('a' + random() % 26);
+        switch (random() % 3) {
+            case 0:
+                if (position < term.size()) {
+                    term[position] = letter;
+                    break;
+                }
+                [[fallthrough]];
+            case 1:
+                term.insert(term.begin() + position, letter);
+                break;
+            default:
+                if (!term.empty()) term.erase(std::min(position, term.size() - 1), 1);
+                break;
+        }
+        return term;
+    }
+}
+
+/**
+ * @brief Expands misspelled query terms to the closest dictionary terms, as a fuzzy search does.
+ * 
+ * state.range(0) is the vocabulary size. Every iteration compiles the automaton of one term
+ * and intersects it with the dictionary.
+ */
+static void BM_FuzzyExpand(benchmark::State& state) {
+    dictionary::TermDictionary dictionary;
+    loadDictionary(dictionary, static_cast<std::size_t>(state.range(0)));
+    corpus::CorpusGenerator generator(static_cast<std::size_t>(state.range(0)), 1.0, 7);
+    std::mt19937 random(7);
+
+    std::vector<std::string> queries;
+    for (std::size_t i = 0; i < 1024; i++) {
+        queries.push_back(misspell(generator.term(), random));
+    }
+
+    std::size_t next = 0, matches = 0;
+    for (auto _ : state) {
+        const std::string& term = queries[next++ % queries.size()];
+        fuzzy::LevenshteinAutomaton automaton(term, fuzzy::LevenshteinAutomaton::editsFor(term.size()));
+        std::vector<dictionary::FuzzyMatch> expanded = dictionary.expand(automaton, 4);
+        matches += expanded.size();
+        benchmark::DoNotOptimize(expanded);
+    }
+    state.counters["matchesPerTerm"] = benchmark::Counter(static_cast<double>(matches), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FuzzyExpand)->Arg(50000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
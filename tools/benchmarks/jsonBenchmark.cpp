@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <corpus/corpus.hpp>
+#include "jetplusplus/json/jsonConverter.hpp"
+#include "jetplusplus/json/value.hpp"
+#include <serializer/resultSerializer.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Builds an /index request body around a synthetic page
+    std::string indexRequestBody(std::size_t words) {
+        corpus::CorpusGenerator generator(50000, 1.0, 42);
+        return "{\"url\": \"" + generator.url(1) + "\", \"content\": \"" + generator.document(words) + "\"}";
+    }
+
+    std::vector<searcher::SearchResult> searchResults(std::size_t count) {
+        corpus::CorpusGenerator generator(1000, 1.0, 7);
+        std::vector<searcher::SearchResult> results;
+        for (std::size_t i = 0; i < count; i++) {
+            results.push_back(searcher::SearchResult{generator.url(i), 10.0f / static_cast<float>(i + 1)});
+        }
+        return results;
+    }
+}
+
+/**
+ * @brief Parses an /index request body with jetpp::JsonConverter::stringToJson.
+ */
+static void BM_StringToJson(benchmark::State& state) {
+    std::string body = indexRequestBody(static_cast<std::size_t>(state.range(0)));
+    jetpp::JsonConverter converter;
+
+    for (auto _ : state) {
+        jetpp::JsonValue value = converter.stringToJson(body);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(body.size()));
+}
+BENCHMARK(BM_StringToJson)->Arg(512)->Arg(8192);
+
+/**
+ * @brief Serializes search results the way /search did before: a JsonValue DOM and jsonToString.
+ */
+static void BM_JsonValueResults(benchmark::State& state) {
+    std::vector<searcher::SearchResult> results = searchResults(static_cast<std::size_t>(state.range(0)));
+    jetpp::JsonConverter converter;
+
+    for (auto _ : state) {
+        jetpp::JsonValue array;
+        array.setArray({});
+        for (const searcher::SearchResult& result : results) {
+            jetpp::JsonValue value;
+            value.setString(result.url);
+            array.asArray.push_back(value);
+        }
+        benchmark::DoNotOptimize(converter.jsonToString(array));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_JsonValueResults)->Arg(26)->Arg(1000);
+
+/**
+ * @brief Serializes search results with serializer::serializeResults.
+ */
+static void BM_SerializeResults(benchmark::State& state) {
+    std::vector<searcher::SearchResult> results = searchResults(static_cast<std::size_t>(state.range(0)));
+    const bool details = state.range(1) != 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(serializer::serializeResults(results, details));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_SerializeResults)->Args({26, 0})->Args({1000, 0})->Args({26, 1})->Args({1000, 1});
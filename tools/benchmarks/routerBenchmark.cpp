@@ -0,0 +1,23 @@
+#include <benchmark/benchmark.h>
+#include "jetplusplus/router/router.hpp"
+#include <string>
+
+/**
+ * @brief Looks up a route in a router with a realistic number of registered routes.
+ * 
+ * state.range(0) is the number of routes registered besides /search; the lookup targets
+ * the last route registered, which is the worst case for a linear scan.
+ */
+static void BM_FindRoute(benchmark::State& state) {
+    jetpp::Router router;
+    auto noop = [](jetpp::Request&, jetpp::Response&) {};
+    for (int64_t i = 0; i < state.range(0); i++) {
+        router.get("/api/v1/resource" + std::to_string(i) + "/:id", noop);
+    }
+    router.post("/search", noop);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(router.findRoute("/search", jetpp::Methods::Post, "127.0.0.1"));
+    }
+}
+BENCHMARK(BM_FindRoute)->Arg(4)->Arg(64);
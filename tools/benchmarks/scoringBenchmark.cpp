@@ -0,0 +1,226 @@
+#include <benchmark/benchmark.h>
+#include <corpus/corpus.hpp>
+#include <searcher/searcher.hpp>
+#include <searcher/impactEvaluator.hpp>
+#include <impact/impact.hpp>
+#include <scoring/scoringKernel.hpp>
+#include <scoring/postingArrays.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+
+    /**
+     * @brief Generates the postings of a term with realistic TFs and document lengths.
+     * 
+     * @param count Number of postings.
+     * @return std::vector<searcher_db::IndexDocument> The postings.
+     */
+    std::vector<searcher_db::IndexDocument> makePostings(std::size_t count) {
+        corpus::CorpusGenerator generator(1000, 1.0, 7);
+        std::uniform_real_distribution<float> tf(0.0005f, 0.05f);
+
+        std::vector<searcher_db::IndexDocument> postings;
+        postings.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            postings.push_back(searcher_db::IndexDocument{generator.url(i), tf(generator.random()), static_cast<int>(generator.documentLength() * 6)});
+        }
+        return postings;
+    }
+}
+
+/**
+ * @brief Computes BM25 for every posting of a list (the per-posting arithmetic alone).
+ */
+static void BM_CalculateBM25_Score(benchmark::State& state) {
+    std::vector<searcher_db::IndexDocument> postings = makePostings(static_cast<std::size_t>(state.range(0)));
+    float idf = searcher::Searcher::calculateIDF_Score(1000000, static_cast<int>(postings.size()));
+
+    for (auto _ : state) {
+        float sum = 0;
+        for (const searcher_db::IndexDocument& doc : postings) {
+            sum += searcher::Searcher::calculateBM25_Score(doc.docLength, 3600, idf, doc.tf, 1.2f, 0.75f);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_CalculateBM25_Score)->Arg(1000)->Arg(100000);
+
+/**
+ * @brief Computes TF-IDF, BM25 and the combined score for every posting of a list.
+ */
+static void BM_CombineScores(benchmark::State& state) {
+    std::vector<searcher_db::IndexDocument> postings = makePostings(static_cast<std::size_t>(state.range(0)));
+    float idf = searcher::Searcher::calculateIDF_Score(1000000, static_cast<int>(postings.size()));
+
+    for (auto _ : state) {
+        float sum = 0;
+        for (const searcher_db::IndexDocument& doc : postings) {
+            float bm25 = searcher::Searcher::calculateBM25_Score(doc.docLength, 3600, idf, doc.tf, 1.2f, 0.75f);
+            sum += searcher::Searcher::combineScores(doc.tf * idf, bm25);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_CombineScores)->Arg(1000)->Arg(100000);
+
+/**
+ * @brief Runs Searcher::searchResults on a multi-term query, from the postings to the re-ranked top-k.
+ * 
+ * Every term shares half of its documents with the previous one, as common terms do. The
+ * postings are served as delta postings and the dictionary rules out every database lookup,
+ * so the measured time is the quantization, impact evaluation, selection and re-ranking of
+ * the search path alone.
+ */
+static void BM_SearchResults(benchmark::State& state) {
+    const std::size_t size = static_cast<std::size_t>(state.range(0));
+    const int terms = 3;
+    std::vector<searcher_db::IndexDocument> all = makePostings(size + size * (terms - 1) / 2);
+    delta::DeltaView postings;
+    std::string query;
+    for (int t = 0; t < terms; t++) {
+        std::size_t offset = static_cast<std::size_t>(t) * size / 2;
+        std::string term = "term" + std::to_string(t);
+        postings.terms[term].assign(all.begin() + offset, all.begin() + offset + size);
+        query += (t > 0 ? "+" : "") + term;
+    }
+    impact::CorpusStats stats;
+    stats.totalDocuments = 1000000;
+    stats.avgDocLength = 3600;
+    dictionary::TermDictionary dictionary;
+    dictionary.load(std::vector<dictionary::TermUpdate>());
+
+    for (auto _ : state) {
+        searcher::Searcher searcher(nullptr, searcher::Deadline(), nullptr, nullptr, &dictionary);
+        searcher.setCorpusStats(stats);
+        searcher.setDelta(&postings);
+        searcher.setFuzzy(false);
+        benchmark::DoNotOptimize(searcher.searchResults(query));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * terms * state.range(0));
+}
+BENCHMARK(BM_SearchResults)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Selects the candidates of an evaluated query and re-ranks them, the last two stages of Searcher::searchResults.
+ */
+static void BM_SelectAndRerank(benchmark::State& state) {
+    std::vector<searcher_db::IndexDocument> postings = makePostings(static_cast<std::size_t>(state.range(0)));
+    impact::CorpusStats stats;
+    stats.totalDocuments = 1000000;
+    stats.avgDocLength = 3600;
+    searcher::ImpactEvaluator evaluator{searcher::Deadline()};
+    evaluator.addTerm(impact::computeImpacts(postings, stats));
+    ranking::RankingOptions options;
+    evaluator.accumulate(options.candidates);
+    std::vector<std::string> terms{"term0"};
+
+    for (auto _ : state) {
+        std::vector<ranking::Candidate> candidates = evaluator.candidates(options.candidates);
+        benchmark::DoNotOptimize(ranking::rerank(std::move(candidates), terms, options.features, ranking::LinearScorer::standard(), searcher::MAX_RESULTS));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_SelectAndRerank)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Evaluates the same multi-term query as BM_SearchResults over stored impacts alone.
+ * 
+ * Integer accumulation in impact order, stopping once the top results are settled.
+ */
+static void BM_EvaluateImpacts(benchmark::State& state) {
+    const std::size_t size = static_cast<std::size_t>(state.range(0));
+    const int terms = 3;
+    std::vector<searcher_db::IndexDocument> all = makePostings(size + size * (terms - 1) / 2);
+    impact::CorpusStats stats;
+    stats.totalDocuments = 1000000;
+    stats.avgDocLength = 3600;
+
+    std::vector<std::vector<impact::ImpactPosting>> impacts;
+    for (int t = 0; t < terms; t++) {
+        std::size_t offset = static_cast<std::size_t>(t) * size / 2;
+        std::vector<searcher_db::IndexDocument> list(all.begin() + offset, all.begin() + offset + size);
+        impacts.push_back(impact::computeImpacts(list, stats));
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        searcher::ImpactEvaluator evaluator{searcher::Deadline()};
+        for (const auto& list : impacts) {
+            evaluator.addTerm(list);
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(evaluator.accumulate(searcher::MAX_RESULTS));
+        benchmark::DoNotOptimize(evaluator.results(searcher::MAX_RESULTS));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * terms * state.range(0));
+}
+BENCHMARK(BM_EvaluateImpacts)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Evaluates the BM_EvaluateImpacts query split into document partitions on a thread pool.
+ * 
+ * The second argument is the number of pool workers; the query uses one partition per worker
+ * plus one for the calling thread. Splitting the lists is part of the measured time.
+ */
+static void BM_EvaluateImpactsParallel(benchmark::State& state) {
+    const std::size_t size = static_cast<std::size_t>(state.range(0));
+    const std::size_t workers = static_cast<std::size_t>(state.range(1));
+    const int terms = 3;
+    std::vector<searcher_db::IndexDocument> all = makePostings(size + size * (terms - 1) / 2);
+    impact::CorpusStats stats;
+    stats.totalDocuments = 1000000;
+    stats.avgDocLength = 3600;
+
+    std::vector<std::vector<impact::ImpactPosting>> impacts;
+    for (int t = 0; t < terms; t++) {
+        std::size_t offset = static_cast<std::size_t>(t) * size / 2;
+        std::vector<searcher_db::IndexDocument> list(all.begin() + offset, all.begin() + offset + size);
+        impacts.push_back(impact::computeImpacts(list, stats));
+    }
+
+    threadpool::ThreadPool pool(workers);
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<std::vector<impact::ImpactPosting>> lists = impacts;
+        state.ResumeTiming();
+        searcher::ImpactEvaluation evaluation;
+        benchmark::DoNotOptimize(searcher::ImpactEvaluator::evaluatePartitioned(lists, workers + 1, searcher::MAX_RESULTS, searcher::Deadline(), pool, evaluation));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * terms * state.range(0));
+}
+BENCHMARK(BM_EvaluateImpactsParallel)->Args({100000, 1})->Args({100000, 3})->Args({100000, 7})->Args({1000000, 7})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/**
+ * @brief Scores structure-of-arrays postings into a docId-indexed score array with one kernel.
+ * 
+ * Bytes processed count the three input arrays and the read-modify-write of the scores.
+ */
+static void BM_AccumulateScores(benchmark::State& state, scoring::Isa isa) {
+    if (!scoring::supported(isa)) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    std::vector<searcher_db::IndexDocument> documents = makePostings(static_cast<std::size_t>(state.range(0)));
+    scoring::PostingArrays postings;
+    for (const searcher_db::IndexDocument& doc : documents) {
+        postings.add(doc.url, doc.tf, doc.docLength);
+    }
+    scoring::DocumentTable table;
+    table.assign(postings);
+    std::vector<float> scores(table.size(), 0.0f);
+    scoring::TermWeights weights = scoring::TermWeights::make(2.5f, 3600);
+
+    for (auto _ : state) {
+        scoring::accumulateScores(isa, postings.docIds.data(), postings.tfs.data(), postings.docLengths.data(), postings.size(), weights, scores.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0) * 20);
+}
+BENCHMARK_CAPTURE(BM_AccumulateScores, scalar, scoring::Isa::Scalar)->Arg(1000)->Arg(100000)->Arg(1000000);
+BENCHMARK_CAPTURE(BM_AccumulateScores, neon, scoring::Isa::Neon)->Arg(1000)->Arg(100000)->Arg(1000000);
+BENCHMARK_CAPTURE(BM_AccumulateScores, avx2, scoring::Isa::Avx2)->Arg(1000)->Arg(100000)->Arg(1000000);
+BENCHMARK_CAPTURE(BM_AccumulateScores, avx512, scoring::Isa::Avx512)->Arg(1000)->Arg(100000)->Arg(1000000);
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include <corpus/corpus.hpp>
+#include <snapshot/snapshot.hpp>
+#include <snapshot/snapshotWriter.hpp>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /// Postings per term of the benchmark snapshots.
+    const std::size_t TERM_POSTINGS = 10000;
+
+    /**
+     * @brief Writes a snapshot of synthetic documents and maps it.
+     *
+     * Every TERM_POSTINGS consecutive documents share a term, so the document ids are
+     * assigned in the generator's URL order, which interleaves the hosts like a crawl.
+     *
+     * @param documents Number of documents.
+     * @param rawBytes Receives the URL bytes plus one 64 bit offset per document, the size of a plain table.
+     * @return std::unique_ptr<snapshot::Snapshot> The snapshot; its file is already deleted.
+     */
+    std::unique_ptr<snapshot::Snapshot> makeSnapshot(std::size_t documents, std::uint64_t& rawBytes) {
+        corpus::CorpusGenerator generator(1000, 1.0, 42);
+        std::string path = "snapshotBenchmark-" + std::to_string(documents) + ".snapshot";
+        impact::CorpusStats stats;
+        stats.totalDocuments = static_cast<std::int64_t>(documents);
+        stats.avgDocLength = 500;
+        stats.version = 1;
+
+        rawBytes = 0;
+        snapshot::SnapshotWriter writer(path, stats, 0, 1, 0);
+        std::vector<impact::ImpactPosting> postings;
+        for (std::size_t id = 0; id < documents; id++) {
+            postings.push_back(impact::ImpactPosting{generator.url(id), static_cast<std::uint16_t>(1000 - id % 1000)});
+            rawBytes += postings.back().url.size() + sizeof(std::uint64_t);
+            if (postings.size() == TERM_POSTINGS || id + 1 == documents) {
+                writer.addTerm("t" + std::to_string(id / TERM_POSTINGS), postings);
+                postings.clear();
+            }
+        }
+        writer.finish();
+
+        std::unique_ptr<snapshot::Snapshot> opened = snapshot::Snapshot::open(path);
+        std::remove(path.c_str());
+        return opened;
+    }
+}
+
+/**
+ * @brief Resolves the URL of random document ids, as for the top-k of a query.
+ *
+ * state.range(0) is the number of documents. bytesPerUrl is the size of the front-coded
+ * document table per document, rawBytesPerUrl that of a plain offset table.
+ */
+static void BM_SnapshotUrl(benchmark::State& state) {
+    std::size_t documents = static_cast<std::size_t>(state.range(0));
+    std::uint64_t rawBytes;
+    std::unique_ptr<snapshot::Snapshot> snapshot = makeSnapshot(documents, rawBytes);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::uint32_t> ids(0, static_cast<std::uint32_t>(documents - 1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(snapshot->url(ids(random)));
+    }
+    const snapshot::SnapshotHeader& header = snapshot->header();
+    state.counters["bytesPerUrl"] = static_cast<double>(header.termsOffset - header.documentsOffset) / documents;
+    state.counters["rawBytesPerUrl"] = static_cast<double>(rawBytes) / documents;
+}
+BENCHMARK(BM_SnapshotUrl)->Arg(100000)->Arg(1000000);
+
+/**
+ * @brief Reads the postings of a term, resolving all TERM_POSTINGS URLs in one batch.
+ */
+static void BM_SnapshotFind(benchmark::State& state) {
+    std::uint64_t rawBytes;
+    std::unique_ptr<snapshot::Snapshot> snapshot = makeSnapshot(static_cast<std::size_t>(state.range(0)), rawBytes);
+    std::vector<impact::ImpactPosting> postings;
+
+    for (auto _ : state) {
+        snapshot->find("t1", postings);
+        benchmark::DoNotOptimize(postings.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * TERM_POSTINGS));
+}
+BENCHMARK(BM_SnapshotFind)->Arg(100000);
@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include <corpus/corpus.hpp>
+#include <suggest/completionIndex.hpp>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace {
+
+    /**
+     * @brief Builds a completion index over a synthetic vocabulary, weighted by sampled document frequency.
+     * 
+     * @param terms Size of the vocabulary.
+     * @return std::shared_ptr<const suggest::CompletionIndex> The index.
+     */
+    std::shared_ptr<const suggest::CompletionIndex> makeIndex(std::size_t terms) {
+        corpus::CorpusGenerator generator(terms, 1.0, 42);
+        std::map<std::string, std::uint32_t> weights;
+        for (const std::string& term : generator.vocabulary()) {
+            weights[term] = 0;
+        }
+        for (std::size_t i = 0; i < terms * 4; i++) {
+            weights[generator.term()]++;
+        }
+
+        suggest::CompletionIndex::Builder builder;
+        for (const auto& weight : weights) {
+            builder.add(weight.first, weight.second);
+        }
+        return builder.finish();
+    }
+}
+
+/**
+ * @brief Completes short prefixes, as typed by a user, to the top 10 terms.
+ * 
+ * state.range(0) is the vocabulary size, state.range(1) the prefix length; shorter prefixes
+ * match wider ranges of terms.
+ */
+static void BM_CompletePrefix(benchmark::State& state) {
+    std::shared_ptr<const suggest::CompletionIndex> index = makeIndex(static_cast<std::size_t>(state.range(0)));
+    corpus::CorpusGenerator generator(static_cast<std::size_t>(state.range(0)), 1.0, 7);
+    std::size_t length = static_cast<std::size_t>(state.range(1));
+
+    for (auto _ : state) {
+        const std::string& term = generator.term();
+        benchmark::DoNotOptimize(index->complete(std::string_view(term).substr(0, std::min(length, term.size())), 10));
+    }
+    state.counters["bytesPerTerm"] = static_cast<double>(index->bytes()) / index->size();
+}
+BENCHMARK(BM_CompletePrefix)->Args({50000, 1})->Args({50000, 3})->Args({1000000, 2});
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+#include <corpus/corpus.hpp>
+#include "indexer/indexer.hpp"
+#include "dedup/simHash.hpp"
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Tokenizes a synthetic page of the given number of words with Indexer::splitContentUniqueTerms.
+ */
+static void BM_SplitContentUniqueTerms(benchmark::State& state) {
+    corpus::CorpusGenerator generator(50000, 1.0, 42);
+    std::string content = generator.document(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::unordered_map<std::string, int> terms;
+        indexer::Indexer::splitContentUniqueTerms(content, terms, ' ');
+        benchmark::DoNotOptimize(terms);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(content.size()));
+}
+BENCHMARK(BM_SplitContentUniqueTerms)->Arg(256)->Arg(4096)->Arg(65536);
+
+/**
+ * @brief Strips whitespace from every distinct term of a page, as Indexer::indexDocument does.
+ */
+static void BM_RemoveWhitespace(benchmark::State& state) {
+    corpus::CorpusGenerator generator(50000, 1.0, 42);
+    std::unordered_map<std::string, int> terms;
+    indexer::Indexer::splitContentUniqueTerms(generator.document(4096), terms, ' ');
+
+    for (auto _ : state) {
+        for (const auto& pair : terms) {
+            std::string term = pair.first;
+            indexer::Indexer::removeWhitespace(term);
+            benchmark::DoNotOptimize(term);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(terms.size()));
+}
+BENCHMARK(BM_RemoveWhitespace);
+
+/**
+ * @brief Fingerprints the term frequencies of a page of the given number of words, as Indexer::indexDocument does.
+ */
+static void BM_SimHash(benchmark::State& state) {
+    corpus::CorpusGenerator generator(50000, 1.0, 42);
+    std::unordered_map<std::string, int> terms;
+    indexer::Indexer::splitContentUniqueTerms(generator.document(static_cast<std::size_t>(state.range(0))), terms, ' ');
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dedup::simHash(terms));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(terms.size()));
+}
+BENCHMARK(BM_SimHash)->Arg(256)->Arg(4096);
@@ -0,0 +1,127 @@
+#include <corpus/corpus.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace corpus {
+
+    namespace {
+
+        const char* const SYLLABLES[] = {
+            "ka", "lo", "mi", "ne", "ru", "sa", "te", "vo", "zi", "ba",
+            "do", "fe", "gu", "ha", "ji", "ko", "li", "ma", "no", "pe",
+            "qu", "ri", "so", "tu", "va", "we", "xi", "ya", "zo", "an"
+        };
+        const std::size_t SYLLABLE_COUNT = sizeof(SYLLABLES) / sizeof(SYLLABLES[0]);
+
+        const char* const HOSTS[] = {
+            "news.example.com", "blog.example.org", "shop.example.net", "wiki.example.com",
+            "docs.example.io", "forum.example.org", "www.example.de", "media.example.at"
+        };
+        const std::size_t HOST_COUNT = sizeof(HOSTS) / sizeof(HOSTS[0]);
+
+        // Spells out a number with syllables, so every vocabulary rank gets a unique word
+        std::string word(std::size_t rank) {
+            std::string result;
+            std::size_t value = rank;
+            do {
+                result += SYLLABLES[value % SYLLABLE_COUNT];
+                value /= SYLLABLE_COUNT;
+            } while (value > 0);
+            return result;
+        }
+    }
+
+    /**
+     * @brief Constructor for the ZipfSampler class.
+     * 
+     * @param n Number of ranks.
+     * @param s Zipf exponent.
+     */
+    ZipfSampler::ZipfSampler(std::size_t n, double s) : cdf(n) {
+        double total = 0;
+        for (std::size_t rank = 0; rank < n; rank++) {
+            total += 1.0 / std::pow(static_cast<double>(rank + 1), s);
+            this->cdf[rank] = total;
+        }
+        for (double& p : this->cdf) {
+            p /= total;
+        }
+    }
+
+    std::size_t ZipfSampler::sample(std::mt19937_64& random) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+        auto it = std::lower_bound(this->cdf.begin(), this->cdf.end(), u);
+        return it == this->cdf.end() ? this->cdf.size() - 1 : static_cast<std::size_t>(it - this->cdf.begin());
+    }
+
+    /**
+     * @brief Constructor for the CorpusGenerator class.
+     * 
+     * @param vocabularySize Number of distinct terms.
+     * @param zipfExponent Zipf exponent of the term frequencies.
+     * @param seed Seed of the random engine.
+     */
+    CorpusGenerator::CorpusGenerator(std::size_t vocabularySize, double zipfExponent, std::uint64_t seed)
+        : sampler(vocabularySize, zipfExponent), engine(seed) {
+        this->words.reserve(vocabularySize);
+        for (std::size_t rank = 0; rank < vocabularySize; rank++) {
+            this->words.push_back(word(rank));
+        }
+    }
+
+    const std::vector<std::string>& CorpusGenerator::vocabulary() const {
+        return this->words;
+    }
+
+    const std::string& CorpusGenerator::term() {
+        return this->words[this->sampler.sample(this->engine)];
+    }
+
+    std::string CorpusGenerator::document(std::size_t words) {
+        std::string content;
+        content.reserve(words * 7);
+        for (std::size_t i = 0; i < words; i++) {
+            if (i > 0) content.push_back(' ');
+            content += this->term();
+        }
+        return content;
+    }
+
+    /**
+     * @brief Generates the URL of a page.
+     * 
+     * Pages are spread over a handful of hosts and nested sections, so URLs share long prefixes.
+     * 
+     * @param id The page number.
+     * @return std::string The URL.
+     */
+    std::string CorpusGenerator::url(std::size_t id) const {
+        std::string result = "https://";
+        result += HOSTS[id % HOST_COUNT];
+        result += "/";
+        result += word((id / HOST_COUNT) % 50);
+        result += "/";
+        result += word((id / (HOST_COUNT * 50)) % 20);
+        result += "/page-" + std::to_string(id);
+        return result;
+    }
+
+    std::string CorpusGenerator::query(std::size_t terms) {
+        std::string result;
+        for (std::size_t i = 0; i < terms; i++) {
+            if (i > 0) result.push_back('+');
+            result += this->term();
+        }
+        return result;
+    }
+
+    std::size_t CorpusGenerator::documentLength() {
+        std::lognormal_distribution<double> length(6.4, 0.8);
+        return std::max<std::size_t>(16, static_cast<std::size_t>(length(this->engine)));
+    }
+
+    std::mt19937_64& CorpusGenerator::random() {
+        return this->engine;
+    }
+
+}
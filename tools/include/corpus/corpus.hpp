@@ -0,0 +1,118 @@
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace corpus {
+
+    /**
+     * @class ZipfSampler
+     * @brief Draws ranks 0..n-1 following a Zipf distribution with exponent s.
+     * 
+     * Rank 0 is the most frequent. Sampling is a binary search over the precomputed CDF.
+     */
+    class ZipfSampler {
+    public:
+        /**
+         * @brief Constructor for the ZipfSampler class.
+         * 
+         * @param n Number of ranks.
+         * @param s Zipf exponent (1.0 is close to natural language term frequencies).
+         */
+        ZipfSampler(std::size_t n, double s);
+
+        /**
+         * @brief Draws a rank.
+         * 
+         * @param random The random engine.
+         * @return std::size_t The rank in [0, n).
+         */
+        std::size_t sample(std::mt19937_64& random) const;
+
+    private:
+        std::vector<double> cdf; ///< Cumulative probabilities by rank.
+    };
+
+    /**
+     * @class CorpusGenerator
+     * @brief Generates a deterministic synthetic corpus of web pages and queries.
+     * 
+     * The vocabulary consists of pronounceable pseudo-words; page content and queries draw
+     * terms from it with Zipf-distributed frequencies, URLs share scheme, host and path
+     * prefixes like crawled pages do. The same seed always yields the same corpus.
+     */
+    class CorpusGenerator {
+    public:
+        /**
+         * @brief Constructor for the CorpusGenerator class.
+         * 
+         * @param vocabularySize Number of distinct terms.
+         * @param zipfExponent Zipf exponent of the term frequencies.
+         * @param seed Seed of the random engine.
+         */
+        CorpusGenerator(std::size_t vocabularySize, double zipfExponent, std::uint64_t seed);
+
+        /**
+         * @brief Returns the vocabulary, most frequent term first.
+         * 
+         * @return const std::vector<std::string>& The vocabulary.
+         */
+        const std::vector<std::string>& vocabulary() const;
+
+        /**
+         * @brief Draws a term.
+         * 
+         * @return const std::string& The term.
+         */
+        const std::string& term();
+
+        /**
+         * @brief Generates page content as space separated terms.
+         * 
+         * @param words Number of terms in the page.
+         * @return std::string The content.
+         */
+        std::string document(std::size_t words);
+
+        /**
+         * @brief Generates the URL of a page.
+         * 
+         * @param id The page number; equal ids yield equal URLs.
+         * @return std::string The URL.
+         */
+        std::string url(std::size_t id) const;
+
+        /**
+         * @brief Generates a query in the /search format (terms joined with '+').
+         * 
+         * @param terms Number of terms in the query.
+         * @return std::string The query.
+         */
+        std::string query(std::size_t terms);
+
+        /**
+         * @brief Draws a realistic page length in terms (log-normal, median about 600).
+         * 
+         * @return std::size_t The page length.
+         */
+        std::size_t documentLength();
+
+        /**
+         * @brief Gives access to the random engine for additional synthetic values.
+         * 
+         * @return std::mt19937_64& The random engine.
+         */
+        std::mt19937_64& random();
+
+    private:
+        std::vector<std::string> words; ///< Vocabulary, most frequent first.
+        ZipfSampler sampler;            ///< Term rank distribution.
+        std::mt19937_64 engine;         ///< Random engine.
+    };
+
+}
+
+#endif
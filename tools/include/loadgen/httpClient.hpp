@@ -0,0 +1,58 @@
+#ifndef HTTPCLIENT_HPP
+#define HTTPCLIENT_HPP
+
+#include <string>
+
+namespace loadgen {
+
+    /**
+     * @struct Endpoint
+     * @brief Address of a service under test.
+     */
+    struct Endpoint {
+        std::string host = "127.0.0.1";   ///< IPv4 address or host name.
+        int port = 0;                     ///< TCP port.
+
+        /**
+         * @brief Parses "host:port".
+         * 
+         * @param address The address string.
+         * @return Endpoint The parsed endpoint.
+         * @throws std::invalid_argument If the port is missing or invalid.
+         */
+        static Endpoint parse(const std::string& address);
+    };
+
+    /**
+     * @struct HttpResult
+     * @brief Outcome of a single HTTP exchange.
+     */
+    struct HttpResult {
+        int status = 0;         ///< HTTP status code, 0 if the exchange failed.
+        std::size_t bytes = 0;  ///< Bytes received, headers included.
+        std::string error;      ///< Transport error, empty on success.
+    };
+
+    /**
+     * @brief Sends one HTTP/1.1 request on a fresh connection and reads the response until the server closes it.
+     * 
+     * @param endpoint The service address.
+     * @param method The request method, e.g. "POST".
+     * @param target The request target including the query string.
+     * @param body The request body (may be empty).
+     * @param timeoutMs Socket send/receive timeout in milliseconds.
+     * @return HttpResult The outcome.
+     */
+    HttpResult httpRequest(const Endpoint& endpoint, const std::string& method, const std::string& target, const std::string& body, int timeoutMs);
+
+    /**
+     * @brief Percent-encodes a query string value.
+     * 
+     * @param value The raw value.
+     * @return std::string The encoded value ('+' is kept, it separates search terms).
+     */
+    std::string urlEncode(const std::string& value);
+
+}
+
+#endif
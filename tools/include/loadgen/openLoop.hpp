@@ -0,0 +1,81 @@
+#ifndef OPENLOOP_HPP
+#define OPENLOOP_HPP
+
+#include <loadgen/httpClient.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace loadgen {
+
+    /**
+     * @struct PhaseReport
+     * @brief Measurements of one load phase (ingest or query replay).
+     */
+    struct PhaseReport {
+        std::string name;                   ///< Phase name.
+        double targetRate = 0;              ///< Requested arrival rate in requests per second.
+        double seconds = 0;                 ///< Wall time from first intended send to last completion.
+        std::size_t sent = 0;               ///< Requests issued.
+        std::size_t ok = 0;                 ///< Responses with a 2xx status.
+        std::size_t rejected = 0;           ///< Responses with 503 (shed by admission control).
+        std::size_t failed = 0;             ///< Other statuses and transport errors.
+        std::vector<double> latencies;      ///< Latency from the intended send time, in milliseconds (corrected for coordinated omission).
+        std::vector<double> serviceTimes;   ///< Latency from the actual send time, in milliseconds (uncorrected).
+    };
+
+    /**
+     * @class OpenLoopRunner
+     * @brief Issues requests on a precomputed Poisson arrival schedule, independent of response times.
+     * 
+     * Every request has an intended send time fixed before the phase starts. Latency is
+     * measured from that intended time, so when the service (or the worker pool) falls
+     * behind, the waiting time is charged to the requests that had to wait instead of
+     * silently lowering the offered load (coordinated omission).
+     */
+    class OpenLoopRunner {
+    public:
+        /**
+         * @brief Constructor for the OpenLoopRunner class.
+         * 
+         * @param workers Number of sender threads; bounds the requests in flight.
+         * @param seed Seed of the arrival schedule.
+         */
+        OpenLoopRunner(std::size_t workers, std::uint64_t seed);
+
+        /**
+         * @brief Runs one phase.
+         * 
+         * @param name The phase name used in the report.
+         * @param rate The arrival rate in requests per second.
+         * @param count The number of requests.
+         * @param request Issues the i-th request and returns its outcome; called concurrently.
+         * @return PhaseReport The measurements.
+         */
+        PhaseReport run(const std::string& name, double rate, std::size_t count, const std::function<HttpResult(std::size_t)>& request);
+
+    private:
+        std::size_t workers;    ///< Sender threads.
+        std::uint64_t seed;     ///< Seed of the arrival schedule.
+    };
+
+    /**
+     * @brief Formats a report as human-readable text.
+     * 
+     * @param report The phase report.
+     * @return std::string The text.
+     */
+    std::string formatReport(const PhaseReport& report);
+
+    /**
+     * @brief Formats a report as a JSON object.
+     * 
+     * @param report The phase report.
+     * @return std::string The JSON text.
+     */
+    std::string reportJson(const PhaseReport& report);
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <loadgen/httpClient.hpp>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace loadgen {
+
+    Endpoint Endpoint::parse(const std::string& address) {
+        std::size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon + 1 == address.size()) {
+            throw std::invalid_argument("expected host:port, got " + address);
+        }
+        Endpoint endpoint;
+        endpoint.host = address.substr(0, colon);
+        endpoint.port = std::stoi(address.substr(colon + 1));
+        return endpoint;
+    }
+
+    namespace {
+
+        // Closes the socket when leaving the scope
+        struct Socket {
+            int fd;
+            ~Socket() { if (fd >= 0) close(fd); }
+        };
+
+        bool sendAll(int fd, const char* data, std::size_t size) {
+            while (size > 0) {
+                ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+                if (sent <= 0) return false;
+                data += sent;
+                size -= static_cast<std::size_t>(sent);
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Sends one HTTP/1.1 request on a fresh connection and reads the response until the server closes it.
+     * 
+     * A new connection per request matches how the Jet++ server handles clients and keeps
+     * the client free of connection state.
+     */
+    HttpResult httpRequest(const Endpoint& endpoint, const std::string& method, const std::string& target, const std::string& body, int timeoutMs) {
+        HttpResult result;
+
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(endpoint.host.c_str(), std::to_string(endpoint.port).c_str(), &hints, &addresses) != 0 || !addresses) {
+            result.error = "cannot resolve " + endpoint.host;
+            return result;
+        }
+
+        Socket sock{socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol)};
+        if (sock.fd < 0) {
+            freeaddrinfo(addresses);
+            result.error = std::strerror(errno);
+            return result;
+        }
+
+        timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        setsockopt(sock.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(sock.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        int noDelay = 1;
+        setsockopt(sock.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        int connected = connect(sock.fd, addresses->ai_addr, addresses->ai_addrlen);
+        freeaddrinfo(addresses);
+        if (connected != 0) {
+            result.error = std::string("connect: ") + std::strerror(errno);
+            return result;
+        }
+
+        std::string request = method + " " + target + " HTTP/1.1\r\n"
+                              "Host: " + endpoint.host + "\r\n"
+                              "Connection: close\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        if (!sendAll(sock.fd, request.data(), request.size())) {
+            result.error = std::string("send: ") + std::strerror(errno);
+            return result;
+        }
+
+        std::string head;
+        char buffer[16384];
+        while (true) {
+            ssize_t received = recv(sock.fd, buffer, sizeof(buffer), 0);
+            if (received < 0) {
+                result.error = std::string("recv: ") + std::strerror(errno);
+                return result;
+            }
+            if (received == 0) break;
+            if (head.size() < 32) {
+                head.append(buffer, static_cast<std::size_t>(received));
+            }
+            result.bytes += static_cast<std::size_t>(received);
+        }
+
+        // Status line: HTTP/1.1 200 OK
+        std::size_t space = head.find(' ');
+        if (head.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+            result.error = "malformed response";
+            return result;
+        }
+        result.status = std::atoi(head.c_str() + space + 1);
+        return result;
+    }
+
+    std::string urlEncode(const std::string& value) {
+        static const char hex[] = "0123456789ABCDEF";
+        std::string encoded;
+        for (unsigned char c : value) {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' || c == '+') {
+                encoded.push_back(static_cast<char>(c));
+            } else {
+                encoded.push_back('%');
+                encoded.push_back(hex[c >> 4]);
+                encoded.push_back(hex[c & 0xF]);
+            }
+        }
+        return encoded;
+    }
+
+}
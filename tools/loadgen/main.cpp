@@ -0,0 +1,167 @@
+#include <corpus/corpus.hpp>
+#include <loadgen/httpClient.hpp>
+#include <loadgen/openLoop.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    const char* const USAGE =
+        "Usage: LoadGen [options]\n"
+        "  --indexer HOST:PORT   indexer address (default 127.0.0.1:7001)\n"
+        "  --search HOST:PORT    search service address (default 127.0.0.1:7002)\n"
+        "  --documents N         synthetic pages to ingest through /index (default 1000)\n"
+        "  --index-rate R        ingest arrival rate in pages/s (default 50)\n"
+        "  --skip-index          do not ingest, only replay queries\n"
+        "  --queries N           queries to send to /search (default 5000)\n"
+        "  --query-rate R        query arrival rate in queries/s (default 200)\n"
+        "  --query-log FILE      replay queries from FILE (one per line, terms joined with '+')\n"
+        "                        instead of the synthetic Zipf query mix\n"
+        "  --workers N           sender threads, bounds requests in flight (default 64)\n"
+        "  --timeout-ms N        socket timeout per request (default 5000)\n"
+        "  --vocabulary N        distinct terms of the synthetic corpus (default 50000)\n"
+        "  --zipf S              Zipf exponent of term frequencies (default 1.0)\n"
+        "  --seed N              seed of corpus, queries and arrivals (default 1)\n"
+        "  --corpus-out FILE     write the synthetic corpus as JSONL ({url, content} per line)\n"
+        "  --offline             only generate (with --corpus-out), send no requests\n"
+        "  --json FILE           write the phase reports as JSON\n";
+
+    /**
+     * @brief Parses "--name value" pairs and "--flag" switches.
+     * 
+     * @return std::map<std::string, std::string> Options by name; switches map to "1".
+     */
+    std::map<std::string, std::string> parseArguments(int argc, char** argv) {
+        std::map<std::string, std::string> options;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") != 0) {
+                throw std::invalid_argument("unexpected argument " + arg);
+            }
+            std::string name = arg.substr(2);
+            if (name == "skip-index" || name == "offline" || name == "help") {
+                options[name] = "1";
+            } else if (i + 1 < argc) {
+                options[name] = argv[++i];
+            } else {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+        }
+        return options;
+    }
+
+    std::string option(const std::map<std::string, std::string>& options, const std::string& name, const std::string& fallback) {
+        auto it = options.find(name);
+        return it == options.end() ? fallback : it->second;
+    }
+}
+
+/**
+ * @brief Load generator for the indexer and search services.
+ * 
+ * Generates a Zipf-distributed synthetic corpus, ingests it through /index at a target rate,
+ * then replays a query log or a synthetic Zipf query mix against /search with open-loop
+ * arrivals, and reports throughput and latency percentiles corrected for coordinated omission.
+ * 
+ * @return int 0 on success, 1 on invalid arguments, 2 if any request failed.
+ */
+int main(int argc, char** argv) {
+    std::map<std::string, std::string> options;
+    try {
+        options = parseArguments(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n" << USAGE;
+        return 1;
+    }
+    if (options.count("help")) {
+        std::cout << USAGE;
+        return 0;
+    }
+
+    loadgen::Endpoint indexer = loadgen::Endpoint::parse(option(options, "indexer", "127.0.0.1:7001"));
+    loadgen::Endpoint search = loadgen::Endpoint::parse(option(options, "search", "127.0.0.1:7002"));
+    std::size_t documents = std::stoul(option(options, "documents", "1000"));
+    double indexRate = std::stod(option(options, "index-rate", "50"));
+    std::size_t queries = std::stoul(option(options, "queries", "5000"));
+    double queryRate = std::stod(option(options, "query-rate", "200"));
+    std::size_t workers = std::stoul(option(options, "workers", "64"));
+    int timeoutMs = std::stoi(option(options, "timeout-ms", "5000"));
+    std::uint64_t seed = std::stoull(option(options, "seed", "1"));
+    bool offline = options.count("offline") > 0;
+    bool ingest = options.count("skip-index") == 0;
+
+    corpus::CorpusGenerator generator(std::stoul(option(options, "vocabulary", "50000")), std::stod(option(options, "zipf", "1.0")), seed);
+
+    // Generate the corpus up front so that generation cost does not distort the measurements
+    std::vector<std::string> bodies;
+    if (ingest || options.count("corpus-out")) {
+        bodies.reserve(documents);
+        for (std::size_t i = 0; i < documents; i++) {
+            bodies.push_back("{\"url\":\"" + generator.url(i) + "\",\"content\":\"" + generator.document(generator.documentLength()) + "\"}");
+        }
+    }
+
+    if (options.count("corpus-out")) {
+        std::ofstream out(options["corpus-out"]);
+        for (const std::string& body : bodies) {
+            out << body << '\n';
+        }
+        std::cout << "wrote " << bodies.size() << " documents to " << options["corpus-out"] << std::endl;
+    }
+    if (offline) {
+        return 0;
+    }
+
+    // Queries: replayed from a log, or drawn from the corpus vocabulary (1-3 terms)
+    std::vector<std::string> queryMix;
+    if (options.count("query-log")) {
+        std::ifstream log(options["query-log"]);
+        for (std::string line; std::getline(log, line);) {
+            if (!line.empty()) queryMix.push_back(line);
+        }
+        if (queryMix.empty()) {
+            std::cerr << "query log " << options["query-log"] << " is empty or unreadable" << std::endl;
+            return 1;
+        }
+    } else {
+        std::uniform_int_distribution<std::size_t> terms(1, 3);
+        for (std::size_t i = 0; i < queries; i++) {
+            queryMix.push_back(generator.query(terms(generator.random())));
+        }
+    }
+
+    loadgen::OpenLoopRunner runner(workers, seed);
+    std::vector<loadgen::PhaseReport> reports;
+
+    if (ingest) {
+        reports.push_back(runner.run("ingest /index", indexRate, bodies.size(), [&](std::size_t i) {
+            return loadgen::httpRequest(indexer, "POST", "/index", bodies[i], timeoutMs);
+        }));
+        std::cout << loadgen::formatReport(reports.back()) << std::endl;
+    }
+
+    reports.push_back(runner.run("query /search", queryRate, queries, [&](std::size_t i) {
+        return loadgen::httpRequest(search, "POST", "/search?q=" + loadgen::urlEncode(queryMix[i % queryMix.size()]), "", timeoutMs);
+    }));
+    std::cout << loadgen::formatReport(reports.back()) << std::endl;
+
+    if (options.count("json")) {
+        std::ofstream out(options["json"]);
+        out << "[";
+        for (std::size_t i = 0; i < reports.size(); i++) {
+            out << (i ? "," : "") << loadgen::reportJson(reports[i]);
+        }
+        out << "]\n";
+    }
+
+    for (const loadgen::PhaseReport& report : reports) {
+        if (report.failed > 0) return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <loadgen/openLoop.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace loadgen {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double millisBetween(Clock::time_point from, Clock::time_point to) {
+            return std::chrono::duration<double, std::milli>(to - from).count();
+        }
+
+        // Value at the given quantile of a sorted sample, 0 if empty
+        double percentile(const std::vector<double>& sorted, double quantile) {
+            if (sorted.empty()) return 0;
+            std::size_t index = static_cast<std::size_t>(quantile * static_cast<double>(sorted.size() - 1) + 0.5);
+            return sorted[std::min(index, sorted.size() - 1)];
+        }
+
+        const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+        const char* const QUANTILE_NAMES[] = {"p50", "p90", "p99", "p99.9", "max"};
+    }
+
+    /**
+     * @brief Constructor for the OpenLoopRunner class.
+     * 
+     * @param workers Number of sender threads.
+     * @param seed Seed of the arrival schedule.
+     */
+    OpenLoopRunner::OpenLoopRunner(std::size_t workers, std::uint64_t seed) : workers(std::max<std::size_t>(1, workers)), seed(seed) {
+    }
+
+    /**
+     * @brief Runs one phase.
+     * 
+     * Workers claim requests in schedule order and sleep until their intended send time; a
+     * request claimed late is sent immediately and its latency includes the delay.
+     */
+    PhaseReport OpenLoopRunner::run(const std::string& name, double rate, std::size_t count, const std::function<HttpResult(std::size_t)>& request) {
+        PhaseReport report;
+        report.name = name;
+        report.targetRate = rate;
+        report.sent = count;
+
+        // Poisson arrivals: exponentially distributed gaps around 1/rate
+        std::mt19937_64 random(this->seed);
+        std::exponential_distribution<double> gap(rate);
+        std::vector<Clock::duration> offsets(count);
+        double at = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            offsets[i] = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(at));
+            at += gap(random);
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::mutex resultsMutex;
+        Clock::time_point start = Clock::now() + std::chrono::milliseconds(50);
+        Clock::time_point last = start;
+
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < std::min(this->workers, count); w++) {
+            threads.emplace_back([&]() {
+                std::vector<double> latencies, serviceTimes;
+                std::size_t ok = 0, rejected = 0, failed = 0;
+                Clock::time_point finished = start;
+
+                for (std::size_t i = next++; i < count; i = next++) {
+                    Clock::time_point intended = start + offsets[i];
+                    std::this_thread::sleep_until(intended);
+
+                    Clock::time_point sent = Clock::now();
+                    HttpResult result = request(i);
+                    finished = Clock::now();
+
+                    latencies.push_back(millisBetween(intended, finished));
+                    serviceTimes.push_back(millisBetween(sent, finished));
+                    if (result.status >= 200 && result.status < 300) ok++;
+                    else if (result.status == 503) rejected++;
+                    else failed++;
+                }
+
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                report.latencies.insert(report.latencies.end(), latencies.begin(), latencies.end());
+                report.serviceTimes.insert(report.serviceTimes.end(), serviceTimes.begin(), serviceTimes.end());
+                report.ok += ok;
+                report.rejected += rejected;
+                report.failed += failed;
+                last = std::max(last, finished);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        report.seconds = std::chrono::duration<double>(last - start).count();
+        std::sort(report.latencies.begin(), report.latencies.end());
+        std::sort(report.serviceTimes.begin(), report.serviceTimes.end());
+        return report;
+    }
+
+    std::string formatReport(const PhaseReport& report) {
+        char line[256];
+        std::string out = "== " + report.name + " ==\n";
+        double throughput = report.seconds > 0 ? static_cast<double>(report.ok) / report.seconds : 0;
+        std::snprintf(line, sizeof(line), "target %.1f req/s, achieved %.1f req/s over %.2f s\n", report.targetRate, throughput, report.seconds);
+        out += line;
+        std::snprintf(line, sizeof(line), "sent %zu, ok %zu, rejected (503) %zu, failed %zu\n", report.sent, report.ok, report.rejected, report.failed);
+        out += line;
+
+        out += "latency ms (corrected):  ";
+        for (std::size_t q = 0; q < 5; q++) {
+            std::snprintf(line, sizeof(line), "%s %.2f  ", QUANTILE_NAMES[q], percentile(report.latencies, QUANTILES[q]));
+            out += line;
+        }
+        out += "\nservice ms (uncorrected): ";
+        for (std::size_t q = 0; q < 5; q++) {
+            std::snprintf(line, sizeof(line), "%s %.2f  ", QUANTILE_NAMES[q], percentile(report.serviceTimes, QUANTILES[q]));
+            out += line;
+        }
+        return out + "\n";
+    }
+
+    std::string reportJson(const PhaseReport& report) {
+        char buffer[128];
+        std::string out = "{\"name\":\"" + report.name + "\"";
+        std::snprintf(buffer, sizeof(buffer), ",\"targetRate\":%.3f,\"seconds\":%.3f", report.targetRate, report.seconds);
+        out += buffer;
+        out += ",\"sent\":" + std::to_string(report.sent) + ",\"ok\":" + std::to_string(report.ok) +
+               ",\"rejected\":" + std::to_string(report.rejected) + ",\"failed\":" + std::to_string(report.failed);
+
+        const std::vector<double>* samples[] = {&report.latencies, &report.serviceTimes};
+        const char* keys[] = {"latencyMs", "serviceMs"};
+        for (int s = 0; s < 2; s++) {
+            out += std::string(",\"") + keys[s] + "\":{";
+            for (std::size_t q = 0; q < 5; q++) {
+                std::snprintf(buffer, sizeof(buffer), "%s\"%s\":%.3f", q ? "," : "", QUANTILE_NAMES[q], percentile(*samples[s], QUANTILES[q]));
+                out += buffer;
+            }
+            out += "}";
+        }
+        return out + "}";
+    }
+
+}
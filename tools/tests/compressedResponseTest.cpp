@@ -0,0 +1,133 @@
+#include <http/httpResponse.hpp>
+#include <compression/compression.hpp>
+#include <zlib.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// The Jet++ library is not linked into the test; these are the two members the test needs to
+// set up a response, with the layout the library uses.
+namespace jetpp {
+    Response::Response(int clientSocket) : statuscode(200), clientSocket(clientSocket) {
+    }
+
+    void Response::addHeader(const std::string& key, const std::string& value) {
+        this->header.push_back(key + ": " + value);
+    }
+}
+
+namespace {
+
+    int failures = 0;
+
+    /**
+     * @brief Records a failed check.
+     */
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    /**
+     * @brief Builds a search response body large enough to be compressed.
+     */
+    std::string searchBody() {
+        std::string body = "{\"results\":[";
+        for (int i = 0; i < 100; i++) {
+            if (i > 0) body.push_back(',');
+            body += "{\"url\":\"https://example.com/page-" + std::to_string(i) + "\",\"score\":" + std::to_string(100 - i) + ".5}";
+        }
+        return body + "]}";
+    }
+
+    /**
+     * @brief Inflates a gzip or zlib stream.
+     *
+     * @return std::string The inflated bytes, empty if the stream is invalid.
+     */
+    std::string inflateBody(const std::string& compressed) {
+        z_stream stream{};
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+            return "";
+        }
+        std::string out;
+        char buffer[16384];
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+        stream.avail_in = static_cast<uInt>(compressed.size());
+        int status = Z_OK;
+        while (status == Z_OK) {
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            status = inflate(&stream, Z_NO_FLUSH);
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        }
+        inflateEnd(&stream);
+        return status == Z_STREAM_END ? out : "";
+    }
+
+    /**
+     * @brief Sends a body through http::send on one end of a socket pair and reads the other end.
+     *
+     * @return std::string Everything the client received.
+     */
+    std::string roundTrip(const std::string& body, const std::string& encoding) {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+            return "";
+        }
+        // A compressed search body fits into the socket buffer, so it is written before it is read
+        jetpp::Response res(sockets[0]);
+        res.addHeader("Content-Type", "application/json");
+        res.addHeader("Content-Encoding", encoding);
+        check(http::send(res, 200, body), encoding + ": the response was not written");
+        close(sockets[0]);
+
+        std::string received;
+        char buffer[16384];
+        ssize_t read;
+        while ((read = recv(sockets[1], buffer, sizeof(buffer), 0)) > 0) {
+            received.append(buffer, static_cast<std::size_t>(read));
+        }
+        close(sockets[1]);
+        return received;
+    }
+}
+
+/**
+ * @brief Sends gzip and deflate compressed search responses, which hold NUL bytes, through
+ * http::send and checks that the client receives the whole body and can inflate it.
+ */
+int main() {
+    std::string body = searchBody();
+    check(body.size() >= compression::MIN_COMPRESS_SIZE, "the body is too small to be compressed");
+
+    for (compression::Encoding encoding : {compression::Encoding::Gzip, compression::Encoding::Deflate}) {
+        std::string name = compression::encodingName(encoding);
+        std::string compressed = compression::compress(body, encoding);
+        check(compressed.find('\0') != std::string::npos, name + ": the compressed body holds no NUL byte");
+
+        std::string received = roundTrip(compressed, name);
+        std::size_t headerEnd = received.find("\r\n\r\n");
+        check(received.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0, name + ": wrong status line");
+        check(headerEnd != std::string::npos, name + ": no end of headers");
+        if (headerEnd == std::string::npos) {
+            continue;
+        }
+        std::string head = received.substr(0, headerEnd + 2);
+        std::string receivedBody = received.substr(headerEnd + 4);
+        check(head.find("Content-Length: " + std::to_string(compressed.size()) + "\r\n") != std::string::npos, name + ": wrong Content-Length");
+        check(head.find("Content-Encoding: " + name + "\r\n") != std::string::npos, name + ": the added headers were not sent");
+        check(receivedBody == compressed, name + ": received " + std::to_string(receivedBody.size()) + " of " + std::to_string(compressed.size()) + " bytes");
+        check(inflateBody(receivedBody) == body, name + ": the body does not inflate to the original");
+    }
+
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "compressedResponseTest passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "delta/deltaIndex.hpp"
+#include "delta/deltaPersister.hpp"
+#include "delta/writeAheadLog.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+
+    /// Documents logged while the database is down.
+    const int DOCUMENTS = 200;
+
+    /// Small segments, so the log has closed segments the flusher could delete.
+    const std::size_t SEGMENT_BYTES = 1024;
+
+    int failures = 0;
+
+    /**
+     * @brief Records a failed check.
+     */
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    /**
+     * @brief Waits until a condition holds or the timeout passes.
+     *
+     * @return True if the condition held in time.
+     */
+    bool waitFor(const std::function<bool()>& condition, std::chrono::seconds timeout) {
+        auto end = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() >= end) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Counts the segment files of a log directory.
+     */
+    std::size_t segmentFiles(const std::string& directory) {
+        std::size_t count = 0;
+        if (DIR* dir = opendir(directory.c_str())) {
+            while (dirent* entry = readdir(dir)) {
+                if (std::string(entry->d_name).rfind("wal-", 0) == 0) count++;
+            }
+            closedir(dir);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Deletes a log directory.
+     */
+    void removeDirectory(const std::string& directory) {
+        if (DIR* dir = opendir(directory.c_str())) {
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..") unlink((directory + "/" + name).c_str());
+            }
+            closedir(dir);
+        }
+        rmdir(directory.c_str());
+    }
+}
+
+/**
+ * @brief Logs documents while every database write fails, restarts, and checks that recovery
+ * brings all of them back and that the log is only truncated once they are written.
+ */
+int main() {
+    char pattern[] = "/tmp/walRecoveryTest-XXXXXX";
+    if (!mkdtemp(pattern)) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string directory = pattern;
+
+    // Database down: the writer throws, nothing may leave the delta or the log
+    {
+        delta::DeltaIndex index(1);
+        delta::WriteAheadLog log(directory, index, std::chrono::microseconds(0), SEGMENT_BYTES);
+        std::atomic<int> attempts{0};
+        delta::DeltaPersister persister(index, [&](const delta::PendingDocument&) {
+            attempts++;
+            throw std::runtime_error("database unavailable");
+        });
+        for (int i = 0; i < DOCUMENTS; i++) {
+            log.add("https://example.com/page-" + std::to_string(i), {{"term", 0.5f}, {"page" + std::to_string(i), 0.5f}}, 100);
+        }
+
+        // Two retries, and at least one idle round of the flusher in between
+        check(waitFor([&]() { return attempts >= 3; }, std::chrono::seconds(10)), "the writer was not retried");
+        check(index.stats().documents == DOCUMENTS, "failed writes drained the delta");
+        check(log.stats().segments > 1 && segmentFiles(directory) == log.stats().segments, "the log did not keep its closed segments");
+    }
+
+    // Restart: every acknowledged document is replayed, then written once the database is back
+    {
+        delta::DeltaIndex index(1);
+        delta::WriteAheadLog log(directory, index, std::chrono::microseconds(0), SEGMENT_BYTES);
+        check(log.stats().recovered == DOCUMENTS, "recovery lost documents: " + std::to_string(log.stats().recovered));
+        check(index.stats().documents == DOCUMENTS, "the recovered documents are not in the delta");
+
+        std::atomic<int> written{0};
+        delta::DeltaPersister persister(index, [&](const delta::PendingDocument&) { written++; });
+        check(waitFor([&]() { return index.stats().documents == 0; }, std::chrono::seconds(10)), "the delta was not drained");
+        check(written == DOCUMENTS, "written " + std::to_string(written.load()) + " versions");
+
+        // The next round closes the recovered segment, which can go once the round is written
+        std::uint64_t before = log.stats().bytes;
+        for (int i = 0; i < 20; i++) {
+            log.add("https://example.com/new-" + std::to_string(i), {{"term", 0.5f}}, 100);
+        }
+        check(waitFor([&]() { return index.stats().documents == 0 && log.stats().bytes < before; }, std::chrono::seconds(10)), "the log was not truncated after the writes");
+    }
+
+    removeDirectory(directory);
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "walRecoveryTest passed" << std::endl;
+    return EXIT_SUCCESS;
+}